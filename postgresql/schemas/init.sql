@@ -5,9 +5,21 @@ CREATE TABLE IF NOT EXISTS users (
     salt_encoded TEXT NOT NULL,
     totp_secret TEXT NOT NULL,
     created_at TIMESTAMPTZ NOT NULL DEFAULT NOW(),
-    updated_at TIMESTAMPTZ NOT NULL DEFAULT NOW()
+    updated_at TIMESTAMPTZ NOT NULL DEFAULT NOW(),
+    vault_version BIGINT NOT NULL DEFAULT 0,
+    data_key_wrapped TEXT,
+    deleted_at TIMESTAMPTZ
 );
 
+-- bumped on every change of the vault, used as the ETag of listings
+ALTER TABLE users ADD COLUMN IF NOT EXISTS vault_version BIGINT NOT NULL DEFAULT 0;
+
+-- data keys, existing vaults are converted on the next login of the user
+ALTER TABLE users ADD COLUMN IF NOT EXISTS data_key_wrapped TEXT;
+
+-- set by DELETE /api/v1/user, the rows of the user are then removed in batches by component-user-purge
+ALTER TABLE users ADD COLUMN IF NOT EXISTS deleted_at TIMESTAMPTZ;
+
 CREATE TABLE IF NOT EXISTS passwords (
     id SERIAL PRIMARY KEY,
     user_id INTEGER REFERENCES users(id) ON DELETE CASCADE,
@@ -15,9 +27,106 @@ CREATE TABLE IF NOT EXISTS passwords (
     login TEXT NOT NULL,
     password_encrypted TEXT NOT NULL,
     created_at TIMESTAMPTZ NOT NULL DEFAULT NOW(),
-    updated_at TIMESTAMPTZ NOT NULL DEFAULT NOW()
+    updated_at TIMESTAMPTZ NOT NULL DEFAULT NOW(),
+    use_count BIGINT NOT NULL DEFAULT 0,
+    last_used_at TIMESTAMPTZ,
+    fingerprint TEXT,
+    change_version BIGINT NOT NULL DEFAULT 0,
+    totp_secret_encrypted TEXT
 );
 
+-- reads of an entry, flushed by component-usage for frecency ordering
+ALTER TABLE passwords ADD COLUMN IF NOT EXISTS use_count BIGINT NOT NULL DEFAULT 0;
+ALTER TABLE passwords ADD COLUMN IF NOT EXISTS last_used_at TIMESTAMPTZ;
+
+-- keyed hash of the password for reuse detection, filled on the next login of the owner for older entries
+ALTER TABLE passwords ADD COLUMN IF NOT EXISTS fingerprint TEXT;
+
+-- vault version of the last change of the entry, older entries are only sent by a full sync
+ALTER TABLE passwords ADD COLUMN IF NOT EXISTS change_version BIGINT NOT NULL DEFAULT 0;
+
+-- second factor of the service, encrypted with the data key like the password
+ALTER TABLE passwords ADD COLUMN IF NOT EXISTS totp_secret_encrypted TEXT;
+
 CREATE INDEX IF NOT EXISTS idx_passwords_user_id ON passwords(user_id);
 CREATE INDEX IF NOT EXISTS idx_users_username_hash ON users USING hash(username);
+CREATE INDEX IF NOT EXISTS idx_users_updated_at ON users (updated_at);
+CREATE INDEX IF NOT EXISTS idx_users_deleted_at ON users (deleted_at) WHERE deleted_at IS NOT NULL;
 CREATE INDEX IF NOT EXISTS idx_passwords_user_service_lower ON passwords (user_id, LOWER(service));
+CREATE INDEX IF NOT EXISTS idx_passwords_user_fingerprint ON passwords (user_id, fingerprint);
+CREATE INDEX IF NOT EXISTS idx_passwords_user_change_version ON passwords (user_id, change_version);
+
+-- deleted entries for delta sync, removed after the retention period by component-tombstones
+CREATE TABLE IF NOT EXISTS password_tombstones (
+    user_id INTEGER NOT NULL REFERENCES users(id) ON DELETE CASCADE,
+    password_id BIGINT NOT NULL,
+    change_version BIGINT NOT NULL,
+    deleted_at TIMESTAMPTZ NOT NULL DEFAULT NOW()
+);
+
+CREATE INDEX IF NOT EXISTS idx_password_tombstones_user_version ON password_tombstones (user_id, change_version);
+CREATE INDEX IF NOT EXISTS idx_password_tombstones_deleted_at ON password_tombstones (deleted_at);
+
+-- wakes the long-polls of the user through component-change-notifications, sent on commit
+CREATE OR REPLACE FUNCTION notify_vault_change() RETURNS TRIGGER AS $$
+BEGIN
+    PERFORM pg_notify('vaulty_events', NEW.id || ':' || NEW.vault_version);
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE OR REPLACE TRIGGER users_vault_change AFTER UPDATE OF vault_version ON users
+FOR EACH ROW WHEN (NEW.vault_version <> OLD.vault_version) EXECUTE FUNCTION notify_vault_change();
+
+-- newest compacted tombstone of each user
+CREATE TABLE IF NOT EXISTS password_sync_horizons (
+    user_id INTEGER PRIMARY KEY REFERENCES users(id) ON DELETE CASCADE,
+    change_version BIGINT NOT NULL
+);
+
+-- opaque session tokens by the SHA-256 of the token, cached in memory by component-sessions
+CREATE TABLE IF NOT EXISTS sessions (
+    id TEXT PRIMARY KEY,
+    user_id INTEGER NOT NULL REFERENCES users(id) ON DELETE CASCADE,
+    data_key_encrypted TEXT NOT NULL,
+    created_at TIMESTAMPTZ NOT NULL DEFAULT NOW(),
+    expires_at TIMESTAMPTZ NOT NULL
+);
+
+CREATE INDEX IF NOT EXISTS idx_sessions_user_id ON sessions (user_id);
+CREATE INDEX IF NOT EXISTS idx_sessions_expires_at ON sessions (expires_at);
+
+-- progress of the background re-encryption, one row per encrypted column
+CREATE TABLE IF NOT EXISTS reencryption_checkpoints (
+    target TEXT PRIMARY KEY,
+    primary_key_id BIGINT NOT NULL DEFAULT -1,
+    last_id BIGINT NOT NULL DEFAULT 0,
+    completed_at TIMESTAMPTZ,
+    updated_at TIMESTAMPTZ NOT NULL DEFAULT NOW()
+);
+
+-- access trail, written in batches by component-audit, one partition per month
+CREATE TABLE IF NOT EXISTS audit_events (
+    created_at TIMESTAMPTZ NOT NULL,
+    user_id INTEGER NOT NULL,
+    action TEXT NOT NULL,
+    password_id BIGINT
+) PARTITION BY RANGE (created_at);
+
+CREATE TABLE IF NOT EXISTS audit_events_default PARTITION OF audit_events DEFAULT;
+CREATE INDEX IF NOT EXISTS idx_audit_events_user_created ON audit_events (user_id, created_at);
+
+CREATE OR REPLACE FUNCTION audit_create_partition(at TIMESTAMPTZ) RETURNS VOID AS $$
+DECLARE
+    month_start TIMESTAMPTZ := DATE_TRUNC('month', at);
+BEGIN
+    EXECUTE FORMAT(
+        'CREATE TABLE IF NOT EXISTS %I PARTITION OF audit_events FOR VALUES FROM (%L) TO (%L)',
+        'audit_events_' || TO_CHAR(month_start, 'YYYYMM'),
+        month_start,
+        month_start + INTERVAL '1 month'
+    );
+END;
+$$ LANGUAGE plpgsql;
+
+SELECT audit_create_partition(NOW());
@@ -0,0 +1,162 @@
+#include "component.hpp"
+#include "db/sql.hpp"
+
+#include <userver/components/component.hpp>
+#include <userver/components/statistics_storage.hpp>
+#include <userver/engine/sleep.hpp>
+#include <userver/logging/log.hpp>
+#include <userver/storages/postgres/cluster.hpp>
+#include <userver/storages/postgres/component.hpp>
+#include <userver/utils/async.hpp>
+#include <userver/utils/statistics/writer.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+namespace {
+
+/// Partitions for the current and the next month are created at most this often.
+constexpr std::chrono::hours kPartitionCheckInterval{1};
+
+}  // namespace
+
+namespace audit {
+
+Component::Component(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& context
+)
+    : userver::components::LoggableComponentBase(config, context),
+      pg_cluster_{context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()},
+      batch_size_{config["batch_size"].As<std::size_t>(1000)},
+      flush_interval_{config["flush_interval"].As<std::chrono::milliseconds>(std::chrono::seconds{1})},
+      push_timeout_{config["push_timeout"].As<std::chrono::milliseconds>(std::chrono::milliseconds{0})},
+      queue_{Queue::Create(config["max_queue_size"].As<std::size_t>(65536))},
+      producer_{queue_->GetMultiProducer()},
+      consumer_{queue_->GetConsumer()} {
+    auto& storage = context.FindComponent<userver::components::StatisticsStorage>().GetStorage();
+    statistics_holder_ = storage.RegisterWriter("vaulty.audit", [this](userver::utils::statistics::Writer& writer) {
+        writer["pushed"] = statistics_.pushed.load();
+        writer["dropped"] = statistics_.dropped.load();
+        writer["written"] = statistics_.written.load();
+        writer["batches"] = statistics_.batches.load();
+        writer["write_errors"] = statistics_.write_errors.load();
+        writer["queue_size"] = queue_->GetSizeApproximate();
+    });
+
+    writer_task_ = userver::utils::CriticalAsync("audit-writer", [this] { Run(); });
+}
+
+Component::~Component() {
+    statistics_holder_.Unregister();
+
+    // handlers are destroyed by now, closing the queue lets the writer drain it and stop
+    producer_.reset();
+    writer_task_.BlockingWait();
+}
+
+bool Component::Push(Event event) {
+    const bool pushed = push_timeout_.count() > 0
+                            ? producer_->Push(std::move(event), userver::engine::Deadline::FromDuration(push_timeout_))
+                            : producer_->PushNoblock(std::move(event));
+    if (!pushed) {
+        ++statistics_.dropped;
+        return false;
+    }
+    ++statistics_.pushed;
+    return true;
+}
+
+void Component::Run() {
+    Batch batch;
+    Event event;
+    bool open = true;
+    while (open) {
+        const auto deadline = userver::engine::Deadline::FromDuration(flush_interval_);
+        while (batch.Size() < batch_size_) {
+            if (!consumer_.Pop(event, deadline)) {
+                // without a timeout the queue is empty and all producers are gone
+                open = deadline.IsReached();
+                break;
+            }
+            batch.Append(event);
+        }
+
+        if (batch.Size() == 0) {
+            continue;
+        }
+        Flush(batch);
+        if (batch.Size() == 0) {
+            continue;
+        }
+
+        if (!open) {
+            statistics_.dropped += batch.Size();
+            LOG_ERROR() << "Dropped " << batch.Size() << " audit events on shutdown";
+            break;
+        }
+        userver::engine::InterruptibleSleepFor(flush_interval_);
+    }
+}
+
+void Component::Flush(Batch& batch) {
+    const auto now = std::chrono::steady_clock::now();
+    if (now - partitions_checked_at_ >= kPartitionCheckInterval) {
+        try {
+            CreatePartitions();
+            partitions_checked_at_ = now;
+        } catch (const std::exception& ex) {
+            // events still go to the default partition
+            LOG_WARNING() << "Failed to create audit partitions: " << ex.what();
+        }
+    }
+
+    try {
+        pg_cluster_->Execute(
+            userver::storages::postgres::ClusterHostType::kMaster,
+            db::sql::kInsertAuditEvents,
+            batch.times,
+            batch.user_ids,
+            batch.actions,
+            batch.password_ids
+        );
+    } catch (const std::exception& ex) {
+        ++statistics_.write_errors;
+        LOG_ERROR() << "Failed to write " << batch.Size() << " audit events: " << ex.what();
+        return;
+    }
+
+    statistics_.written += batch.Size();
+    ++statistics_.batches;
+    batch.Clear();
+}
+
+void Component::CreatePartitions() {
+    pg_cluster_->Execute(userver::storages::postgres::ClusterHostType::kMaster, db::sql::kCreateAuditPartitions);
+}
+
+userver::yaml_config::Schema Component::GetStaticConfigSchema() {
+    constexpr auto schema = R"(
+        type: object
+        description: asynchronous audit trail writer
+        additionalProperties: false
+        properties:
+            max_queue_size:
+                type: integer
+                description: events waiting to be written, new events are dropped above it
+                defaultDescription: 65536
+            batch_size:
+                type: integer
+                description: maximum number of events written with a single statement
+                defaultDescription: 1000
+            flush_interval:
+                type: string
+                description: longest time an event waits in a partial batch
+                defaultDescription: 1s
+            push_timeout:
+                type: string
+                description: how long a request waits for space in a full queue before the event is dropped
+                defaultDescription: 0ms
+    )";
+    return userver::yaml_config::MergeSchemas<userver::components::LoggableComponentBase>(schema);
+}
+
+}  // namespace audit
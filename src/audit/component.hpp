@@ -0,0 +1,76 @@
+#pragma once
+
+#include "event.hpp"
+
+#include <userver/components/loggable_component_base.hpp>
+#include <userver/concurrent/queue.hpp>
+#include <userver/engine/task/task_with_result.hpp>
+#include <userver/storages/postgres/postgres_fwd.hpp>
+#include <userver/utils/statistics/entry.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <optional>
+
+namespace audit {
+
+/// Counters of the audit pipeline.
+struct Statistics {
+    std::atomic<std::uint64_t> pushed{0};
+    std::atomic<std::uint64_t> dropped{0};
+    std::atomic<std::uint64_t> written{0};
+    std::atomic<std::uint64_t> batches{0};
+    std::atomic<std::uint64_t> write_errors{0};
+};
+
+/// @brief Asynchronous writer of the audit trail.
+///
+/// Handlers Push() events into a bounded lock-free queue and never wait for
+/// the database. A background task drains the queue and writes it to the
+/// month-partitioned `audit_events` table with one multi-row insert per batch
+/// of up to `batch_size` events, or every `flush_interval` for slower traffic.
+///
+/// When the writer falls behind and the queue is full, Push() waits up to
+/// `push_timeout` and then drops the event; drops are counted in
+/// `vaulty.audit.dropped`. A failed batch is retried, the queue fills up in the
+/// meantime. On shutdown the queue is closed and drained before the component
+/// is destroyed.
+class Component final : public userver::components::LoggableComponentBase {
+public:
+    static constexpr std::string_view kName = "component-audit";
+
+    Component(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
+    ~Component() override;
+
+    /// @brief Enqueues the event.
+    /// @return false if the event was dropped.
+    bool Push(Event event);
+
+    static userver::yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    using Queue = userver::concurrent::NonFifoMpscQueue<Event>;
+
+    void Run();
+
+    /// Writes the batch, keeps it for a retry on failure.
+    void Flush(Batch& batch);
+
+    void CreatePartitions();
+
+    userver::storages::postgres::ClusterPtr pg_cluster_;
+    const std::size_t batch_size_;
+    const std::chrono::milliseconds flush_interval_;
+    const std::chrono::milliseconds push_timeout_;
+
+    std::shared_ptr<Queue> queue_;
+    std::optional<Queue::MultiProducer> producer_;
+    Queue::Consumer consumer_;
+    std::chrono::steady_clock::time_point partitions_checked_at_;
+
+    Statistics statistics_;
+    userver::engine::TaskWithResult<void> writer_task_;
+    userver::utils::statistics::Entry statistics_holder_;
+};
+
+}  // namespace audit
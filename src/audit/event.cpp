@@ -0,0 +1,33 @@
+#include "event.hpp"
+
+namespace audit {
+
+std::string_view ToString(Action action) {
+    switch (action) {
+        case Action::kRead:
+            return "read";
+        case Action::kList:
+            return "list";
+        case Action::kCreate:
+            return "create";
+        case Action::kDelete:
+            return "delete";
+    }
+    return "unknown";
+}
+
+void Batch::Append(const Event& event) {
+    times.push_back(std::chrono::duration_cast<std::chrono::microseconds>(event.time.time_since_epoch()).count());
+    user_ids.push_back(event.user_id);
+    actions.emplace_back(ToString(event.action));
+    password_ids.push_back(event.password_id);
+}
+
+void Batch::Clear() {
+    times.clear();
+    user_ids.clear();
+    actions.clear();
+    password_ids.clear();
+}
+
+}  // namespace audit
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace audit {
+
+/// Access to a vault recorded in the audit trail.
+enum class Action {
+    kRead,
+    kList,
+    kCreate,
+    kDelete,
+};
+
+std::string_view ToString(Action action);
+
+/// Single audit record, cheap to copy through the queue.
+struct Event {
+    std::chrono::system_clock::time_point time;
+    std::int32_t user_id{0};
+    Action action{Action::kRead};
+
+    /// Entry the action was performed on, 0 for actions on the whole vault.
+    std::int64_t password_id{0};
+};
+
+/// @brief Events in the column layout of the batch insert query.
+///
+/// Each member is passed as a single array parameter, so a batch of any size
+/// is written with one statement.
+struct Batch {
+    void Append(const Event& event);
+    void Clear();
+    std::size_t Size() const noexcept { return user_ids.size(); }
+
+    /// Microseconds since the epoch.
+    std::vector<std::int64_t> times;
+    std::vector<std::int32_t> user_ids;
+    std::vector<std::string> actions;
+    std::vector<std::int64_t> password_ids;
+};
+
+}  // namespace audit
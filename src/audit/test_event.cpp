@@ -0,0 +1,31 @@
+#include "event.hpp"
+
+#include <userver/utest/utest.hpp>
+
+using namespace audit;
+
+TEST(AuditBatchTest, AppendsColumns) {
+    const std::chrono::system_clock::time_point time{std::chrono::microseconds{1'700'000'000'123'456}};
+
+    Batch batch;
+    batch.Append({time, 1, Action::kRead, 10});
+    batch.Append({time + std::chrono::microseconds{1}, 2, Action::kList, 0});
+
+    ASSERT_EQ(batch.Size(), 2);
+    EXPECT_EQ(batch.times, (std::vector<std::int64_t>{1'700'000'000'123'456, 1'700'000'000'123'457}));
+    EXPECT_EQ(batch.user_ids, (std::vector<std::int32_t>{1, 2}));
+    EXPECT_EQ(batch.actions, (std::vector<std::string>{"read", "list"}));
+    EXPECT_EQ(batch.password_ids, (std::vector<std::int64_t>{10, 0}));
+
+    batch.Clear();
+    EXPECT_EQ(batch.Size(), 0);
+    EXPECT_TRUE(batch.times.empty());
+    EXPECT_TRUE(batch.actions.empty());
+}
+
+TEST(AuditBatchTest, ActionNames) {
+    EXPECT_EQ(ToString(Action::kRead), "read");
+    EXPECT_EQ(ToString(Action::kList), "list");
+    EXPECT_EQ(ToString(Action::kCreate), "create");
+    EXPECT_EQ(ToString(Action::kDelete), "delete");
+}
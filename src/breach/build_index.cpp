@@ -0,0 +1,95 @@
+#include "breach/index.hpp"
+
+#include <boost/program_options.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace {
+
+/// Reads the digest of a line: `<SHA-1 hex>[:<count>]` as in the Pwned Passwords dump, or a plaintext password.
+breach::Digest ReadDigest(std::string_view line, bool plaintext) {
+    if (plaintext) {
+        return breach::HashPassword(line);
+    }
+    return breach::ParseDigest(line.substr(0, line.find(':')));
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    namespace po = boost::program_options;
+
+    po::options_description description("Builds a breached password index for component-breach-index");
+    description.add_options()("help,h", "produce help message")(
+        "input,i",
+        po::value<std::string>()->required(),
+        "file with a SHA-1 digest in hex per line, `:count` suffixes are ignored"
+    )("output,o", po::value<std::string>()->required(), "path of the index file")(
+        "prefix-bytes", po::value<std::size_t>()->default_value(6), "stored length of the digests, 4-8 bytes"
+    )("bloom-bits-per-entry",
+      po::value<std::size_t>()->default_value(0),
+      "size of the Bloom pre-filter, 0 to build without it"
+    )("plaintext", "the input holds plaintext passwords instead of digests");
+
+    po::variables_map vm;
+    try {
+        po::store(po::parse_command_line(argc, argv, description), vm);
+        if (vm.count("help")) {
+            std::cout << description << std::endl;
+            return 0;
+        }
+        po::notify(vm);
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << "\n" << description << std::endl;
+        return 1;
+    }
+
+    const auto& input_path = vm["input"].as<std::string>();
+    const bool plaintext = vm.count("plaintext") > 0;
+
+    try {
+        // the first pass only counts the lines to size the Bloom filter
+        std::uint64_t lines = 0;
+        std::string line;
+        {
+            std::ifstream input{input_path};
+            if (!input) {
+                throw std::runtime_error("Failed to open " + input_path);
+            }
+            while (std::getline(input, line)) {
+                ++lines;
+            }
+        }
+
+        breach::BuildSettings settings;
+        settings.prefix_bytes = vm["prefix-bytes"].as<std::size_t>();
+        settings.bloom_bits_per_entry = vm["bloom-bits-per-entry"].as<std::size_t>();
+        breach::Builder builder{settings, lines};
+
+        std::ifstream input{input_path};
+        std::uint64_t line_number = 0;
+        while (std::getline(input, line)) {
+            ++line_number;
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (line.empty()) {
+                continue;
+            }
+            try {
+                builder.Add(ReadDigest(line, plaintext));
+            } catch (const std::invalid_argument& ex) {
+                throw std::runtime_error("Line " + std::to_string(line_number) + ": " + ex.what());
+            }
+        }
+
+        const auto entries = builder.Write(vm["output"].as<std::string>());
+        std::cout << "Written " << entries << " entries" << std::endl;
+    } catch (const std::exception& ex) {
+        std::cerr << "Failed to build the index: " << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,25 @@
+#include "checker.hpp"
+#include "secure/arena.hpp"
+
+namespace breach {
+
+Checker::Checker(std::unique_ptr<const Index> index) : index_{std::move(index)} {}
+
+bool Checker::IsBreached(std::string_view password) const {
+    if (!index_) {
+        return false;
+    }
+
+    auto digest = HashPassword(password);
+    const bool breached = index_->Contains(digest);
+    // an unsalted digest is as good as the password for a dictionary attack
+    secure::Wipe({reinterpret_cast<char*>(digest.data()), digest.size()});
+
+    statistics_.checks.fetch_add(1, std::memory_order_relaxed);
+    if (breached) {
+        statistics_.hits.fetch_add(1, std::memory_order_relaxed);
+    }
+    return breached;
+}
+
+}  // namespace breach
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "index.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+namespace breach {
+
+/// Counters of a checker.
+struct Statistics {
+    std::atomic<std::uint64_t> checks{0};
+    std::atomic<std::uint64_t> hits{0};
+};
+
+/// @brief Checks passwords against an optional breach index.
+///
+/// Without an index every password passes, so the check can stay in the
+/// request path of deployments that do not ship the index.
+class Checker final {
+public:
+    /// @param index The index to check against, nullptr to disable the check.
+    explicit Checker(std::unique_ptr<const Index> index = nullptr);
+
+    bool IsEnabled() const noexcept { return index_ != nullptr; }
+
+    /// @brief Returns whether the password appears in the index, always false when disabled.
+    bool IsBreached(std::string_view password) const;
+
+    const Index* GetIndex() const noexcept { return index_.get(); }
+
+    const Statistics& GetStatistics() const noexcept { return statistics_; }
+
+private:
+    std::unique_ptr<const Index> index_;
+    mutable Statistics statistics_;
+};
+
+}  // namespace breach
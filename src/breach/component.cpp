@@ -0,0 +1,62 @@
+#include "component.hpp"
+
+#include <userver/components/component.hpp>
+#include <userver/components/statistics_storage.hpp>
+#include <userver/logging/log.hpp>
+#include <userver/utils/statistics/writer.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+#include <optional>
+
+namespace {
+
+std::unique_ptr<const breach::Index> LoadIndex(const userver::components::ComponentConfig& config) {
+    const auto path = config["path"].As<std::optional<std::string>>();
+    if (!path || path->empty()) {
+        LOG_INFO() << "Breach index is not configured, passwords are not checked";
+        return nullptr;
+    }
+
+    auto index = std::make_unique<const breach::Index>(*path);
+    LOG_INFO() << "Loaded breach index " << *path << " with " << index->GetSize() << " entries"
+               << (index->HasBloomFilter() ? " and a Bloom filter" : "");
+    return index;
+}
+
+}  // namespace
+
+namespace breach {
+
+Component::Component(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& context
+)
+    : userver::components::LoggableComponentBase(config, context), checker_{LoadIndex(config)} {
+    auto& storage = context.FindComponent<userver::components::StatisticsStorage>().GetStorage();
+    statistics_holder_ =
+        storage.RegisterWriter("vaulty.breach", [this](userver::utils::statistics::Writer& writer) {
+            const auto* index = checker_.GetIndex();
+            writer["entries"] = index ? index->GetSize() : 0;
+            writer["checks"] = checker_.GetStatistics().checks.load();
+            writer["hits"] = checker_.GetStatistics().hits.load();
+        });
+}
+
+Component::~Component() { statistics_holder_.Unregister(); }
+
+const Checker& Component::GetChecker() const { return checker_; }
+
+userver::yaml_config::Schema Component::GetStaticConfigSchema() {
+    constexpr auto schema = R"(
+        type: object
+        description: offline check of passwords against a memory-mapped index of breached password digests
+        additionalProperties: false
+        properties:
+            path:
+                type: string
+                description: index file built by vaulty_breach_index, the check is disabled if not set
+    )";
+    return userver::yaml_config::MergeSchemas<userver::components::LoggableComponentBase>(schema);
+}
+
+}  // namespace breach
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "checker.hpp"
+
+#include <userver/components/loggable_component_base.hpp>
+#include <userver/utils/statistics/entry.hpp>
+
+namespace breach {
+
+/// @brief Owns the breached password checker.
+///
+/// The index file given by `path` is mapped at startup, the check is disabled
+/// if no path is configured. A configured file that cannot be loaded stops the
+/// service from starting.
+class Component final : public userver::components::LoggableComponentBase {
+public:
+    static constexpr std::string_view kName = "component-breach-index";
+
+    Component(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
+    ~Component() override;
+
+    const Checker& GetChecker() const;
+
+    static userver::yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    const Checker checker_;
+    userver::utils::statistics::Entry statistics_holder_;
+};
+
+}  // namespace breach
@@ -0,0 +1,284 @@
+#include "index.hpp"
+
+#include <cryptopp/sha.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+
+namespace {
+
+constexpr std::size_t kFanoutBytes = breach::Index::kFanoutSize * sizeof(std::uint64_t);
+constexpr std::uint32_t kMaxBloomHashes = 16;
+
+std::uint64_t LoadLe(const std::uint8_t* data, std::size_t bytes) noexcept {
+    std::uint64_t value = 0;
+    for (std::size_t i = bytes; i > 0; --i) {
+        value = (value << 8) | data[i - 1];
+    }
+    return value;
+}
+
+void AppendLe(std::string& output, std::uint64_t value, std::size_t bytes) {
+    for (std::size_t i = 0; i < bytes; ++i) {
+        output.push_back(static_cast<char>(value >> (8 * i)));
+    }
+}
+
+void AppendBe(std::string& output, std::uint64_t value, std::size_t bytes) {
+    for (std::size_t i = bytes; i > 0; --i) {
+        output.push_back(static_cast<char>(value >> (8 * (i - 1))));
+    }
+}
+
+int HexDigit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+/// Bit `i` of the digest in a Bloom filter, by double hashing over the digest bytes after the fanout bucket.
+std::uint64_t BloomPosition(const breach::Digest& digest, std::uint32_t i, std::uint64_t bits) noexcept {
+    const auto h1 = LoadLe(digest.data() + 4, 8);
+    const auto h2 = LoadLe(digest.data() + 12, 8) | 1;
+    return (h1 + i * h2) % bits;
+}
+
+std::system_error MakeSystemError(const std::string& what) {
+    return std::system_error{errno, std::generic_category(), what};
+}
+
+}  // namespace
+
+namespace breach {
+
+Digest HashPassword(std::string_view password) {
+    Digest digest;
+    CryptoPP::SHA1{}.CalculateDigest(
+        digest.data(), reinterpret_cast<const CryptoPP::byte*>(password.data()), password.size()
+    );
+    return digest;
+}
+
+Digest ParseDigest(std::string_view hex) {
+    Digest digest;
+    if (hex.size() != digest.size() * 2) {
+        throw std::invalid_argument("SHA-1 digest must be 40 hex characters");
+    }
+    for (std::size_t i = 0; i < digest.size(); ++i) {
+        const int high = HexDigit(hex[2 * i]);
+        const int low = HexDigit(hex[2 * i + 1]);
+        if (high < 0 || low < 0) {
+            throw std::invalid_argument("SHA-1 digest must be 40 hex characters");
+        }
+        digest[i] = static_cast<std::uint8_t>((high << 4) | low);
+    }
+    return digest;
+}
+
+Index::Index(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw MakeSystemError("Failed to open breach index " + path);
+    }
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        const auto error = MakeSystemError("Failed to stat breach index " + path);
+        ::close(fd);
+        throw error;
+    }
+    mapping_size_ = static_cast<std::size_t>(st.st_size);
+    if (mapping_size_ < kHeaderSize + kFanoutBytes) {
+        ::close(fd);
+        throw std::runtime_error("Breach index " + path + " is truncated");
+    }
+
+    mapping_ = ::mmap(nullptr, mapping_size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping_ == MAP_FAILED) {
+        mapping_ = nullptr;
+        throw MakeSystemError("Failed to map breach index " + path);
+    }
+    // lookups jump around the file, readahead would only pollute the page cache
+    ::madvise(mapping_, mapping_size_, MADV_RANDOM);
+
+    try {
+        const auto* data = static_cast<const std::uint8_t*>(mapping_);
+        if (std::memcmp(data, kMagic.data(), kMagic.size()) != 0) {
+            throw std::runtime_error("not a breach index");
+        }
+        if (LoadLe(data + 8, 4) != kVersion) {
+            throw std::runtime_error("unsupported version");
+        }
+        prefix_bytes_ = LoadLe(data + 12, 4);
+        count_ = LoadLe(data + 16, 8);
+        bloom_bits_ = LoadLe(data + 24, 8);
+        bloom_hashes_ = static_cast<std::uint32_t>(LoadLe(data + 32, 4));
+
+        if (prefix_bytes_ < kMinPrefixBytes || prefix_bytes_ > kMaxPrefixBytes) {
+            throw std::runtime_error("invalid prefix length");
+        }
+        if (bloom_bits_ % 64 != 0 || (bloom_bits_ != 0 && (bloom_hashes_ == 0 || bloom_hashes_ > kMaxBloomHashes))) {
+            throw std::runtime_error("invalid Bloom filter parameters");
+        }
+
+        const std::uint64_t entries_size = count_ * (prefix_bytes_ - 2);
+        if (kHeaderSize + kFanoutBytes + bloom_bits_ / 8 + entries_size != mapping_size_) {
+            throw std::runtime_error("size does not match the header");
+        }
+
+        fanout_ = data + kHeaderSize;
+        bloom_ = fanout_ + kFanoutBytes;
+        entries_ = bloom_ + bloom_bits_ / 8;
+        if (LoadLe(fanout_ + (kFanoutSize - 1) * sizeof(std::uint64_t), 8) != count_) {
+            throw std::runtime_error("fanout table does not match the header");
+        }
+    } catch (const std::runtime_error& ex) {
+        ::munmap(mapping_, mapping_size_);
+        throw std::runtime_error("Invalid breach index " + path + ": " + ex.what());
+    }
+}
+
+Index::~Index() { ::munmap(mapping_, mapping_size_); }
+
+bool Index::Contains(const Digest& digest) const noexcept {
+    if (!MayContain(digest)) {
+        return false;
+    }
+
+    const std::size_t bucket = (digest[0] << 8) | digest[1];
+    auto low = bucket == 0 ? 0 : LoadLe(fanout_ + (bucket - 1) * sizeof(std::uint64_t), 8);
+    auto high = LoadLe(fanout_ + bucket * sizeof(std::uint64_t), 8);
+
+    const std::size_t width = prefix_bytes_ - 2;
+    const auto* key = digest.data() + 2;
+    while (low < high) {
+        const auto middle = low + (high - low) / 2;
+        const int order = std::memcmp(entries_ + middle * width, key, width);
+        if (order == 0) {
+            return true;
+        }
+        if (order < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return false;
+}
+
+bool Index::MayContain(const Digest& digest) const noexcept {
+    for (std::uint32_t i = 0; i < bloom_hashes_ && bloom_bits_ != 0; ++i) {
+        const auto position = BloomPosition(digest, i, bloom_bits_);
+        if ((bloom_[position / 8] & (1u << (position % 8))) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Builder::Builder(const BuildSettings& settings, std::uint64_t expected_count) : settings_{settings} {
+    if (settings.prefix_bytes < Index::kMinPrefixBytes || settings.prefix_bytes > Index::kMaxPrefixBytes) {
+        throw std::invalid_argument("Breach index prefix length must be between 4 and 8 bytes");
+    }
+    if (settings.bloom_bits_per_entry != 0) {
+        const auto bits = std::max<std::uint64_t>(expected_count * settings.bloom_bits_per_entry, 64);
+        bloom_.resize((bits + 63) / 64);
+        // optimal number of hash functions for the filter size
+        bloom_hashes_ = std::clamp<std::uint32_t>(
+            static_cast<std::uint32_t>(std::lround(settings.bloom_bits_per_entry * std::log(2.0))), 1, kMaxBloomHashes
+        );
+    }
+    prefixes_.reserve(expected_count);
+}
+
+void Builder::Add(const Digest& digest) {
+    std::uint64_t prefix = 0;
+    for (std::size_t i = 0; i < settings_.prefix_bytes; ++i) {
+        prefix = (prefix << 8) | digest[i];
+    }
+    prefixes_.push_back(prefix);
+
+    const std::uint64_t bits = bloom_.size() * 64;
+    for (std::uint32_t i = 0; i < bloom_hashes_; ++i) {
+        const auto position = BloomPosition(digest, i, bits);
+        bloom_[position / 64] |= std::uint64_t{1} << (position % 64);
+    }
+}
+
+std::uint64_t Builder::Write(const std::string& path) {
+    std::sort(prefixes_.begin(), prefixes_.end());
+    prefixes_.erase(std::unique(prefixes_.begin(), prefixes_.end()), prefixes_.end());
+
+    const std::size_t bucket_shift = 8 * (settings_.prefix_bytes - 2);
+    const std::size_t width = settings_.prefix_bytes - 2;
+
+    std::string header;
+    header.append(Index::kMagic);
+    AppendLe(header, Index::kVersion, 4);
+    AppendLe(header, settings_.prefix_bytes, 4);
+    AppendLe(header, prefixes_.size(), 8);
+    AppendLe(header, bloom_.size() * 64, 8);
+    AppendLe(header, bloom_hashes_, 4);
+    header.resize(Index::kHeaderSize, '\0');
+
+    std::string fanout;
+    fanout.reserve(kFanoutBytes);
+    auto it = prefixes_.begin();
+    for (std::uint64_t bucket = 0; bucket < Index::kFanoutSize; ++bucket) {
+        it = std::find_if(it, prefixes_.end(), [&](std::uint64_t prefix) { return (prefix >> bucket_shift) > bucket; });
+        AppendLe(fanout, static_cast<std::uint64_t>(it - prefixes_.begin()), 8);
+    }
+
+    std::string bloom;
+    bloom.reserve(bloom_.size() * 8);
+    for (const auto word : bloom_) {
+        AppendLe(bloom, word, 8);
+    }
+
+    const auto temporary_path = path + ".tmp";
+    std::ofstream output{temporary_path, std::ios::binary | std::ios::trunc};
+    output.write(header.data(), header.size());
+    output.write(fanout.data(), fanout.size());
+    output.write(bloom.data(), bloom.size());
+
+    std::string chunk;
+    constexpr std::size_t kChunkEntries = 1 << 16;
+    for (std::size_t i = 0; i < prefixes_.size(); ++i) {
+        AppendBe(chunk, prefixes_[i], width);
+        if ((i + 1) % kChunkEntries == 0) {
+            output.write(chunk.data(), chunk.size());
+            chunk.clear();
+        }
+    }
+    output.write(chunk.data(), chunk.size());
+    output.close();
+    if (!output) {
+        throw std::runtime_error("Failed to write breach index " + temporary_path);
+    }
+
+    if (std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+        throw MakeSystemError("Failed to rename breach index to " + path);
+    }
+    return prefixes_.size();
+}
+
+}  // namespace breach
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace breach {
+
+/// SHA-1 digest of a password, the key of the index.
+using Digest = std::array<std::uint8_t, 20>;
+
+/// @brief Computes the SHA-1 digest of a password, as used by public breach corpora.
+Digest HashPassword(std::string_view password);
+
+/// @brief Parses a 40-character hex SHA-1 digest, in either case.
+/// @throws std::invalid_argument On malformed input.
+Digest ParseDigest(std::string_view hex);
+
+/// @brief Read-only index of breached password digests, mapped from a file.
+///
+/// File layout, integers are little-endian:
+///   - header: magic, version, prefix length, entry count, Bloom filter size and hash count;
+///   - fanout table: for each 16-bit value of the first two digest bytes, the
+///     number of entries whose first two bytes are less or equal to it;
+///   - optional Bloom filter over the full digests;
+///   - the entries: digests truncated to the prefix length, sorted, without
+///     the two bytes already given by their fanout bucket.
+///
+/// A lookup checks the Bloom filter, then binary searches the bucket, touching
+/// a handful of pages. The file is mapped read-only and shared, so the memory
+/// is the page cache, shared by all processes that map the same file and
+/// loaded only as far as lookups touch it.
+///
+/// Digests are truncated, so an unrelated password matches with a probability
+/// of about entries / 2^(8 * prefix length). Thread-safe.
+class Index final {
+public:
+    static constexpr std::string_view kMagic = "VLTYBRIX";
+    static constexpr std::uint32_t kVersion = 1;
+    static constexpr std::size_t kHeaderSize = 64;
+    static constexpr std::size_t kFanoutSize = 1 << 16;
+    static constexpr std::size_t kMinPrefixBytes = 4;
+    static constexpr std::size_t kMaxPrefixBytes = 8;
+
+    /// @throws std::runtime_error If the file cannot be mapped or is not a valid index.
+    explicit Index(const std::string& path);
+    ~Index();
+
+    Index(const Index&) = delete;
+    Index& operator=(const Index&) = delete;
+
+    /// @brief Checks whether the digest is in the index.
+    bool Contains(const Digest& digest) const noexcept;
+
+    std::uint64_t GetSize() const noexcept { return count_; }
+
+    bool HasBloomFilter() const noexcept { return bloom_bits_ != 0; }
+
+private:
+    bool MayContain(const Digest& digest) const noexcept;
+
+    void* mapping_{nullptr};
+    std::size_t mapping_size_{0};
+
+    std::size_t prefix_bytes_{0};
+    std::uint64_t count_{0};
+    std::uint64_t bloom_bits_{0};
+    std::uint32_t bloom_hashes_{0};
+
+    const std::uint8_t* fanout_{nullptr};
+    const std::uint8_t* bloom_{nullptr};
+    const std::uint8_t* entries_{nullptr};
+};
+
+/// Parameters of a built index.
+struct BuildSettings {
+    /// Stored length of the digests, see Index.
+    std::size_t prefix_bytes{6};
+
+    /// Bloom filter size per entry, 0 to build without the filter. 10 bits give about 1% false positives.
+    std::size_t bloom_bits_per_entry{0};
+};
+
+/// @brief Builds an index file from digests.
+///
+/// Keeps 8 bytes per added digest in memory until Write().
+class Builder final {
+public:
+    /// @param expected_count Number of digests that will be added, sizes the Bloom filter.
+    /// @throws std::invalid_argument On settings out of range.
+    Builder(const BuildSettings& settings, std::uint64_t expected_count);
+
+    void Add(const Digest& digest);
+
+    /// @brief Writes the index to a temporary file next to `path` and renames it over `path`.
+    /// @return The number of distinct entries written.
+    /// @throws std::runtime_error On I/O errors.
+    std::uint64_t Write(const std::string& path);
+
+private:
+    const BuildSettings settings_;
+    std::vector<std::uint64_t> prefixes_;
+    std::vector<std::uint64_t> bloom_;
+    std::uint32_t bloom_hashes_{0};
+};
+
+}  // namespace breach
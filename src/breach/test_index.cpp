@@ -0,0 +1,100 @@
+#include "index.hpp"
+
+#include <userver/utest/utest.hpp>
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+using namespace breach;
+
+namespace {
+
+/// Index file in the temporary directory, removed at the end of the test.
+class TemporaryFile {
+public:
+    TemporaryFile() : path_{"/tmp/breach_index_test_" + std::to_string(::getpid()) + ".idx"} {}
+    ~TemporaryFile() { std::remove(path_.c_str()); }
+
+    const std::string& GetPath() const { return path_; }
+
+private:
+    std::string path_;
+};
+
+Digest MakeDigest(std::uint32_t seed) { return HashPassword("password" + std::to_string(seed)); }
+
+}  // namespace
+
+TEST(BreachDigestTest, HashAndParse) {
+    EXPECT_EQ(HashPassword("password"), ParseDigest("5BAA61E4C9B93F3F0682250B6CF8331B7EE68FD8"));
+    EXPECT_EQ(ParseDigest("5baa61e4c9b93f3f0682250b6cf8331b7ee68fd8"), HashPassword("password"));
+    EXPECT_THROW(ParseDigest("5BAA61E4"), std::invalid_argument);
+    EXPECT_THROW(ParseDigest("ZBAA61E4C9B93F3F0682250B6CF8331B7EE68FD8"), std::invalid_argument);
+}
+
+TEST(BreachIndexTest, FindsAddedDigests) {
+    constexpr std::uint32_t kCount = 10'000;
+    const TemporaryFile file;
+
+    for (const std::size_t bloom_bits_per_entry : {0, 10}) {
+        Builder builder{{8, bloom_bits_per_entry}, kCount};
+        for (std::uint32_t i = 0; i < kCount; ++i) {
+            builder.Add(MakeDigest(i));
+        }
+        // duplicates are stored once
+        builder.Add(MakeDigest(0));
+        EXPECT_EQ(builder.Write(file.GetPath()), kCount);
+
+        const Index index{file.GetPath()};
+        EXPECT_EQ(index.GetSize(), kCount);
+        EXPECT_EQ(index.HasBloomFilter(), bloom_bits_per_entry != 0);
+        for (std::uint32_t i = 0; i < kCount; ++i) {
+            ASSERT_TRUE(index.Contains(MakeDigest(i))) << i;
+        }
+        for (std::uint32_t i = kCount; i < 2 * kCount; ++i) {
+            ASSERT_FALSE(index.Contains(MakeDigest(i))) << i;
+        }
+    }
+}
+
+TEST(BreachIndexTest, ShortPrefixes) {
+    const TemporaryFile file;
+    Builder builder{{4, 0}, 2};
+    builder.Add(HashPassword("password"));
+    builder.Add(HashPassword("123456"));
+    builder.Write(file.GetPath());
+
+    const Index index{file.GetPath()};
+    EXPECT_TRUE(index.Contains(HashPassword("password")));
+    EXPECT_TRUE(index.Contains(HashPassword("123456")));
+    EXPECT_FALSE(index.Contains(HashPassword("correct horse battery staple")));
+}
+
+TEST(BreachIndexTest, EmptyIndex) {
+    const TemporaryFile file;
+    Builder builder{{}, 0};
+    EXPECT_EQ(builder.Write(file.GetPath()), 0);
+
+    const Index index{file.GetPath()};
+    EXPECT_FALSE(index.Contains(HashPassword("password")));
+}
+
+TEST(BreachIndexTest, RejectsInvalidFiles) {
+    const TemporaryFile file;
+    EXPECT_THROW(Index{file.GetPath()}, std::runtime_error);
+
+    Builder builder{{6, 0}, 1};
+    builder.Add(HashPassword("password"));
+    builder.Write(file.GetPath());
+    {
+        std::ofstream output{file.GetPath(), std::ios::binary | std::ios::app};
+        output << "garbage";
+    }
+    EXPECT_THROW(Index{file.GetPath()}, std::runtime_error);
+
+    EXPECT_THROW((Builder{{3, 0}, 1}), std::invalid_argument);
+    EXPECT_THROW((Builder{{9, 0}, 1}), std::invalid_argument);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <userver/cache/base_postgres_cache.hpp>
+#include <userver/storages/postgres/io/chrono.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+namespace cache {
+
+/// User deleted but not purged yet.
+struct DeletedUser final {
+    std::int32_t id;
+    std::chrono::system_clock::time_point deleted_at;
+};
+
+/// @brief IDs of deleted users, for rejecting the sessions they still hold.
+///
+/// Session tokens carry only the user ID, so UsersCache, keyed by username,
+/// cannot answer this. Only the users whose rows are still being purged are
+/// loaded, through a partial index; purged users are dropped by the full
+/// update, their sessions find nothing to read anyway. Read from the primary,
+/// so a deletion takes effect within an update interval whatever the replica lag.
+struct DeletedUsersCachePolicy {
+    static constexpr std::string_view kName = "deleted-users-pg-cache";
+
+    using ValueType = DeletedUser;
+    static constexpr auto kKeyMember = &DeletedUser::id;
+
+    static constexpr const char* kQuery = "SELECT id, deleted_at FROM users";
+    static constexpr const char* kWhere = "deleted_at IS NOT NULL";
+    static constexpr const char* kUpdatedField = "updated_at";
+    using UpdatedFieldType = userver::storages::postgres::TimePointTz;
+
+    static constexpr auto kClusterHostType = userver::storages::postgres::ClusterHostType::kMaster;
+};
+
+using DeletedUsersCache = userver::components::PostgreCache<DeletedUsersCachePolicy>;
+
+}  // namespace cache
+
+template <>
+inline constexpr bool userver::components::kHasValidate<cache::DeletedUsersCache> = true;
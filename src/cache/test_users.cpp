@@ -0,0 +1,40 @@
+#include "users.hpp"
+
+#include <userver/dump/test_helpers.hpp>
+#include <userver/utest/utest.hpp>
+
+TEST(UsersCacheDumpTest, UserRoundTrip) {
+    models::User user;
+    user.id = 42;
+    user.username = "alice";
+    user.master_key_hash = "hash";
+    user.salt_encoded = "c2FsdA==";
+    user.totp_secret = "JBSWY3DPEHPK3PXP";
+    user.created_at = std::chrono::system_clock::time_point{std::chrono::seconds{1'700'000'000}};
+    user.updated_at = user.created_at + std::chrono::microseconds{123};
+    user.vault_version = 7;
+    user.data_key_wrapped = "d3JhcHBlZA==";
+    user.deleted_at = user.updated_at;
+
+    const auto restored = userver::dump::FromBinary<models::User>(userver::dump::ToBinary(user));
+    EXPECT_EQ(restored.id, user.id);
+    EXPECT_EQ(restored.username, user.username);
+    EXPECT_EQ(restored.master_key_hash, user.master_key_hash);
+    EXPECT_EQ(restored.salt_encoded, user.salt_encoded);
+    EXPECT_EQ(restored.totp_secret, user.totp_secret);
+    EXPECT_EQ(restored.created_at, user.created_at);
+    EXPECT_EQ(restored.updated_at, user.updated_at);
+    EXPECT_EQ(restored.vault_version, user.vault_version);
+    EXPECT_EQ(restored.data_key_wrapped, user.data_key_wrapped);
+    EXPECT_EQ(restored.deleted_at, user.deleted_at);
+}
+
+TEST(UsersCacheDumpTest, UserWithoutDataKey) {
+    models::User user{};
+    user.username = "bob";
+
+    const auto restored = userver::dump::FromBinary<models::User>(userver::dump::ToBinary(user));
+    EXPECT_EQ(restored.username, user.username);
+    EXPECT_EQ(restored.data_key_wrapped, std::nullopt);
+    EXPECT_EQ(restored.deleted_at, std::nullopt);
+}
@@ -0,0 +1,33 @@
+#include "users.hpp"
+
+namespace models {
+
+void Write(userver::dump::Writer& writer, const User& user) {
+    writer.Write(user.id);
+    writer.Write(user.username);
+    writer.Write(user.master_key_hash);
+    writer.Write(user.salt_encoded);
+    writer.Write(user.totp_secret);
+    writer.Write(user.created_at);
+    writer.Write(user.updated_at);
+    writer.Write(user.vault_version);
+    writer.Write(user.data_key_wrapped);
+    writer.Write(user.deleted_at);
+}
+
+User Read(userver::dump::Reader& reader, userver::dump::To<User>) {
+    User user;
+    user.id = reader.Read<std::int32_t>();
+    user.username = reader.Read<std::string>();
+    user.master_key_hash = reader.Read<std::string>();
+    user.salt_encoded = reader.Read<std::string>();
+    user.totp_secret = reader.Read<std::string>();
+    user.created_at = reader.Read<std::chrono::system_clock::time_point>();
+    user.updated_at = reader.Read<std::chrono::system_clock::time_point>();
+    user.vault_version = reader.Read<std::int64_t>();
+    user.data_key_wrapped = reader.Read<std::optional<std::string>>();
+    user.deleted_at = reader.Read<std::optional<std::chrono::system_clock::time_point>>();
+    return user;
+}
+
+}  // namespace models
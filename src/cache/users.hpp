@@ -0,0 +1,56 @@
+#pragma once
+
+#include "models/user.hpp"
+
+#include <userver/cache/base_postgres_cache.hpp>
+#include <userver/dump/common.hpp>
+#include <userver/dump/common_containers.hpp>
+#include <userver/dump/operations.hpp>
+#include <userver/storages/postgres/io/chrono.hpp>
+
+#include <string_view>
+
+namespace models {
+
+void Write(userver::dump::Writer& writer, const User& user);
+
+User Read(userver::dump::Reader& reader, userver::dump::To<User>);
+
+}  // namespace models
+
+namespace cache {
+
+/// @brief Users by username, for login and account operations.
+///
+/// Updated incrementally by `updated_at`. Deleting a user sets `deleted_at`
+/// and bumps `updated_at`, so the deletion reaches the cache with the next
+/// incremental update; the row itself is dropped by the full update after
+/// component-user-purge removes it. Dumps of the cache let a restarted
+/// instance start from the last snapshot and only fetch what changed since,
+/// instead of reading the whole table on startup.
+///
+/// Only fields that never change after registration may be trusted from the
+/// cache: `vault_version` lags behind and must be read from the database. The
+/// credentials and `data_key_wrapped` change with the master key, the cache
+/// catches up with that within an update interval.
+struct UsersCachePolicy {
+    static constexpr std::string_view kName = "users-pg-cache";
+
+    using ValueType = models::User;
+    static constexpr auto kKeyMember = &models::User::username;
+
+    static constexpr const char* kQuery =
+        "SELECT id, username, master_key_hash, salt_encoded, totp_secret, created_at, updated_at, vault_version, "
+        "data_key_wrapped, deleted_at FROM users";
+    static constexpr const char* kUpdatedField = "updated_at";
+    using UpdatedFieldType = userver::storages::postgres::TimePointTz;
+
+    static constexpr auto kClusterHostType = userver::storages::postgres::ClusterHostType::kSlave;
+};
+
+using UsersCache = userver::components::PostgreCache<UsersCachePolicy>;
+
+}  // namespace cache
+
+template <>
+inline constexpr bool userver::components::kHasValidate<cache::UsersCache> = true;
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <userver/engine/condition_variable.hpp>
+#include <userver/engine/deadline.hpp>
+#include <userver/engine/mutex.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace coalesce {
+
+/// Counters of a group.
+struct Statistics {
+    /// Calls that ran the function.
+    std::atomic<std::uint64_t> executed{0};
+
+    /// Calls that got the result of an identical call in flight.
+    std::atomic<std::uint64_t> joined{0};
+
+    /// Calls that waited for a call that failed, or gave up waiting, and ran the function on their own.
+    std::atomic<std::uint64_t> fallbacks{0};
+};
+
+/// @brief Single-flight execution of identical concurrent calls.
+///
+/// The first call with a key runs the function; calls with the same key that
+/// arrive while it runs wait for it and share its result. Nothing is kept once
+/// the call finishes, the next call with the key runs the function again. A
+/// failure is not shared: the waiting calls then run the function on their
+/// own, so an error or a deadline of one request never ends another. A waiting
+/// call whose deadline passes does the same, which lets the function report
+/// the deadline its own way.
+///
+/// The key must identify everything the result depends on, including the
+/// user it belongs to. Thread-safe.
+template <typename Value>
+class Group final {
+public:
+    /// @brief Returns the result of `function`, or of the identical call in flight.
+    template <typename Function>
+    std::shared_ptr<const Value> Run(const std::string& key, userver::engine::Deadline deadline, Function&& function) {
+        std::shared_ptr<Flight> flight;
+        bool leader = false;
+        {
+            const std::lock_guard lock{mutex_};
+            auto [it, inserted] = flights_.try_emplace(key);
+            if (inserted) {
+                it->second = std::make_shared<Flight>();
+            }
+            flight = it->second;
+            leader = inserted;
+        }
+
+        if (!leader) {
+            ++statistics_.joined;
+            {
+                std::unique_lock lock{flight->mutex};
+                if (flight->finished.WaitUntil(lock, deadline, [&] { return flight->done; }) && flight->value) {
+                    return flight->value;
+                }
+            }
+            ++statistics_.fallbacks;
+            return std::make_shared<const Value>(function());
+        }
+
+        ++statistics_.executed;
+        std::shared_ptr<const Value> value;
+        try {
+            value = std::make_shared<const Value>(function());
+        } catch (...) {
+            Finish(key, *flight, nullptr);
+            throw;
+        }
+        Finish(key, *flight, value);
+        return value;
+    }
+
+    std::size_t GetInFlight() const {
+        const std::lock_guard lock{mutex_};
+        return flights_.size();
+    }
+
+    const Statistics& GetStatistics() const noexcept { return statistics_; }
+
+private:
+    struct Flight {
+        userver::engine::Mutex mutex;
+        userver::engine::ConditionVariable finished;
+        bool done{false};
+
+        /// nullptr if the call failed.
+        std::shared_ptr<const Value> value;
+    };
+
+    void Finish(const std::string& key, Flight& flight, std::shared_ptr<const Value> value) {
+        {
+            // later calls start a new flight, they may depend on changes made since this one started
+            const std::lock_guard lock{mutex_};
+            flights_.erase(key);
+        }
+        {
+            const std::lock_guard lock{flight.mutex};
+            flight.done = true;
+            flight.value = std::move(value);
+        }
+        flight.finished.NotifyAll();
+    }
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<Flight>> flights_;
+    Statistics statistics_;
+};
+
+}  // namespace coalesce
@@ -0,0 +1,138 @@
+#include "group.hpp"
+
+#include <userver/engine/single_consumer_event.hpp>
+#include <userver/engine/sleep.hpp>
+#include <userver/engine/task/task_with_result.hpp>
+#include <userver/utest/utest.hpp>
+#include <userver/utils/async.hpp>
+
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+using namespace coalesce;
+
+namespace {
+
+using Result = std::shared_ptr<const std::string>;
+
+constexpr std::size_t kFollowers = 3;
+
+/// Waits until the followers are waiting for the call in flight.
+void WaitForJoined(const Group<std::string>& group, std::uint64_t joined) {
+    while (group.GetStatistics().joined < joined) {
+        userver::engine::SleepFor(std::chrono::milliseconds{1});
+    }
+}
+
+}  // namespace
+
+UTEST(CoalesceGroupTest, FinishedCallsAreNotShared) {
+    Group<std::string> group;
+    int calls = 0;
+    const auto function = [&] { return std::to_string(++calls); };
+
+    EXPECT_EQ(*group.Run("1:a", {}, function), "1");
+    EXPECT_EQ(*group.Run("1:a", {}, function), "2");
+    EXPECT_EQ(group.GetInFlight(), 0);
+    EXPECT_EQ(group.GetStatistics().executed, 2);
+}
+
+UTEST_MT(CoalesceGroupTest, ConcurrentCallsShareTheResult, 4) {
+    Group<std::string> group;
+    std::atomic<int> calls{0};
+    userver::engine::SingleConsumerEvent release;
+
+    auto leader = userver::utils::Async("leader", [&] {
+        return group.Run("1:a", {}, [&] {
+            ++calls;
+            release.WaitForEventUntil({});
+            return std::string{"vault"};
+        });
+    });
+    while (calls == 0) {
+        userver::engine::SleepFor(std::chrono::milliseconds{1});
+    }
+
+    std::vector<userver::engine::TaskWithResult<Result>> followers;
+    for (std::size_t i = 0; i < kFollowers; ++i) {
+        followers.push_back(userver::utils::Async("follower", [&] {
+            return group.Run("1:a", {}, [&] {
+                ++calls;
+                return std::string{"other"};
+            });
+        }));
+    }
+    WaitForJoined(group, kFollowers);
+
+    // another user or other parameters never join
+    EXPECT_EQ(*group.Run("2:a", {}, [] { return std::string{"second user"}; }), "second user");
+
+    release.Send();
+    const auto result = leader.Get();
+    EXPECT_EQ(*result, "vault");
+    for (auto& follower : followers) {
+        EXPECT_EQ(follower.Get(), result);
+    }
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(group.GetInFlight(), 0);
+}
+
+UTEST_MT(CoalesceGroupTest, FailuresAreNotShared, 4) {
+    Group<std::string> group;
+    std::atomic<int> calls{0};
+    userver::engine::SingleConsumerEvent release;
+
+    auto leader = userver::utils::Async("leader", [&] {
+        return group.Run("1:a", {}, [&]() -> std::string {
+            ++calls;
+            release.WaitForEventUntil({});
+            throw std::runtime_error("query failed");
+        });
+    });
+    while (calls == 0) {
+        userver::engine::SleepFor(std::chrono::milliseconds{1});
+    }
+
+    std::vector<userver::engine::TaskWithResult<Result>> followers;
+    for (std::size_t i = 0; i < kFollowers; ++i) {
+        followers.push_back(userver::utils::Async("follower", [&] {
+            return group.Run("1:a", {}, [&] {
+                ++calls;
+                return std::string{"retried"};
+            });
+        }));
+    }
+    WaitForJoined(group, kFollowers);
+
+    release.Send();
+    EXPECT_THROW(leader.Get(), std::runtime_error);
+    for (auto& follower : followers) {
+        EXPECT_EQ(*follower.Get(), "retried");
+    }
+    EXPECT_EQ(calls, 1 + kFollowers);
+    EXPECT_EQ(group.GetStatistics().fallbacks, kFollowers);
+}
+
+UTEST_MT(CoalesceGroupTest, WaitEndsAtTheDeadline, 2) {
+    Group<std::string> group;
+    std::atomic<int> calls{0};
+    userver::engine::SingleConsumerEvent release;
+
+    auto leader = userver::utils::Async("leader", [&] {
+        return group.Run("1:a", {}, [&] {
+            ++calls;
+            release.WaitForEventUntil({});
+            return std::string{"vault"};
+        });
+    });
+    while (calls == 0) {
+        userver::engine::SleepFor(std::chrono::milliseconds{1});
+    }
+
+    const auto deadline = userver::engine::Deadline::FromDuration(std::chrono::milliseconds{10});
+    EXPECT_EQ(*group.Run("1:a", deadline, [] { return std::string{"own"}; }), "own");
+
+    release.Send();
+    EXPECT_EQ(*leader.Get(), "vault");
+}
@@ -0,0 +1,336 @@
+#include "codec.hpp"
+
+#include <userver/yaml_config/yaml_config.hpp>
+
+#include <zlib.h>
+#include <zstd.h>
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+namespace {
+
+constexpr std::size_t kOutputChunkSize = 16 * 1024;
+
+// gzip wrapper instead of the raw zlib one; +32 on inflate auto-detects both
+constexpr int kGzipWindowBits = 15 + 16;
+constexpr int kInflateWindowBits = 15 + 32;
+
+std::string_view Trim(std::string_view value) {
+    const auto begin = value.find_first_not_of(" \t");
+    if (begin == std::string_view::npos) {
+        return {};
+    }
+    return value.substr(begin, value.find_last_not_of(" \t") - begin + 1);
+}
+
+/// Parses the ";q=0.5" part of an Accept-Encoding item, returns 1.0 when there is none
+double ParseQuality(std::string_view params) {
+    while (!params.empty()) {
+        const auto separator = params.find(';');
+        const auto param = Trim(params.substr(0, separator));
+        params.remove_prefix(separator == std::string_view::npos ? params.size() : separator + 1);
+
+        if (param.size() < 2 || (param[0] != 'q' && param[0] != 'Q') || param[1] != '=') {
+            continue;
+        }
+
+        // qvalue = ( "0" [ "." 0*3DIGIT ] ) / ( "1" [ "." 0*3("0") ] )
+        const auto value = param.substr(2);
+        if (value.empty() || value[0] != '0') {
+            return value.empty() ? 0.0 : 1.0;
+        }
+
+        double quality = 0;
+        double scale = 0.1;
+        for (const char c : value.substr(std::min<std::size_t>(value.size(), 2))) {
+            if (c < '0' || c > '9') {
+                break;
+            }
+            quality += (c - '0') * scale;
+            scale /= 10;
+        }
+        return quality;
+    }
+    return 1.0;
+}
+
+}  // namespace
+
+namespace compression {
+
+std::string_view ToString(Encoding encoding) {
+    switch (encoding) {
+        case Encoding::kIdentity:
+            return "identity";
+        case Encoding::kGzip:
+            return "gzip";
+        case Encoding::kZstd:
+            return "zstd";
+    }
+    return "identity";
+}
+
+Encoding Negotiate(std::string_view accept_encoding) {
+    double gzip_quality = 0;
+    double zstd_quality = 0;
+    double wildcard_quality = -1;
+    bool gzip_listed = false;
+    bool zstd_listed = false;
+
+    while (!accept_encoding.empty()) {
+        const auto separator = accept_encoding.find(',');
+        const auto item = accept_encoding.substr(0, separator);
+        accept_encoding.remove_prefix(separator == std::string_view::npos ? accept_encoding.size() : separator + 1);
+
+        const auto params_begin = item.find(';');
+        const auto coding = Trim(item.substr(0, params_begin));
+        const auto quality =
+            params_begin == std::string_view::npos ? 1.0 : ParseQuality(item.substr(params_begin + 1));
+
+        if (coding == "gzip" || coding == "x-gzip") {
+            gzip_quality = quality;
+            gzip_listed = true;
+        } else if (coding == "zstd") {
+            zstd_quality = quality;
+            zstd_listed = true;
+        } else if (coding == "*") {
+            wildcard_quality = quality;
+        }
+    }
+
+    if (wildcard_quality > 0) {
+        gzip_quality = gzip_listed ? gzip_quality : wildcard_quality;
+        zstd_quality = zstd_listed ? zstd_quality : wildcard_quality;
+    }
+
+    if (zstd_quality > 0 && zstd_quality >= gzip_quality) {
+        return Encoding::kZstd;
+    }
+    if (gzip_quality > 0) {
+        return Encoding::kGzip;
+    }
+    return Encoding::kIdentity;
+}
+
+int Settings::GetLevel(Encoding encoding) const {
+    switch (encoding) {
+        case Encoding::kGzip:
+            return gzip_level;
+        case Encoding::kZstd:
+            return zstd_level;
+        case Encoding::kIdentity:
+            break;
+    }
+    return 0;
+}
+
+Settings Parse(const userver::yaml_config::YamlConfig& value, userver::formats::parse::To<Settings>) {
+    Settings settings;
+    settings.min_size = value["min_size"].As<std::size_t>(settings.min_size);
+    settings.gzip_level = value["gzip_level"].As<int>(settings.gzip_level);
+    settings.zstd_level = value["zstd_level"].As<int>(settings.zstd_level);
+    return settings;
+}
+
+class StreamEncoder::Impl {
+public:
+    virtual ~Impl() = default;
+
+    virtual std::string Push(std::string_view chunk) = 0;
+    virtual std::string Flush() = 0;
+    virtual std::string Finish() = 0;
+};
+
+namespace {
+
+class GzipEncoder final : public StreamEncoder::Impl {
+public:
+    explicit GzipEncoder(int level) {
+        if (deflateInit2(&stream_, level, Z_DEFLATED, kGzipWindowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            throw std::runtime_error("Failed to initialize gzip encoder");
+        }
+    }
+
+    ~GzipEncoder() override { deflateEnd(&stream_); }
+
+    std::string Push(std::string_view chunk) override { return Deflate(chunk, Z_NO_FLUSH); }
+    std::string Flush() override { return Deflate({}, Z_SYNC_FLUSH); }
+    std::string Finish() override { return Deflate({}, Z_FINISH); }
+
+private:
+    std::string Deflate(std::string_view input, int flush) {
+        stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+        stream_.avail_in = static_cast<uInt>(input.size());
+
+        std::string output;
+        std::array<char, kOutputChunkSize> buffer;
+        do {
+            stream_.next_out = reinterpret_cast<Bytef*>(buffer.data());
+            stream_.avail_out = static_cast<uInt>(buffer.size());
+            const auto status = deflate(&stream_, flush);
+            if (status == Z_STREAM_ERROR) {
+                throw std::runtime_error("gzip compression failed");
+            }
+            output.append(buffer.data(), buffer.size() - stream_.avail_out);
+        } while (stream_.avail_out == 0);
+
+        return output;
+    }
+
+    z_stream stream_{};
+};
+
+class ZstdEncoder final : public StreamEncoder::Impl {
+public:
+    explicit ZstdEncoder(int level) : context_{ZSTD_createCCtx()} {
+        if (!context_ || ZSTD_isError(ZSTD_CCtx_setParameter(context_, ZSTD_c_compressionLevel, level))) {
+            ZSTD_freeCCtx(context_);
+            throw std::runtime_error("Failed to initialize zstd encoder");
+        }
+    }
+
+    ~ZstdEncoder() override { ZSTD_freeCCtx(context_); }
+
+    std::string Push(std::string_view chunk) override { return Compress(chunk, ZSTD_e_continue); }
+    std::string Flush() override { return Compress({}, ZSTD_e_flush); }
+    std::string Finish() override { return Compress({}, ZSTD_e_end); }
+
+private:
+    std::string Compress(std::string_view input, ZSTD_EndDirective directive) {
+        ZSTD_inBuffer in{input.data(), input.size(), 0};
+
+        std::string output;
+        std::array<char, kOutputChunkSize> buffer;
+        while (true) {
+            ZSTD_outBuffer out{buffer.data(), buffer.size(), 0};
+            const auto remaining = ZSTD_compressStream2(context_, &out, &in, directive);
+            if (ZSTD_isError(remaining)) {
+                throw std::runtime_error(std::string{"zstd compression failed: "} + ZSTD_getErrorName(remaining));
+            }
+            output.append(buffer.data(), out.pos);
+
+            const bool done =
+                directive == ZSTD_e_continue ? in.pos == in.size && out.pos < out.size : remaining == 0;
+            if (done) {
+                break;
+            }
+        }
+
+        return output;
+    }
+
+    ZSTD_CCtx* context_;
+};
+
+std::string InflateGzip(std::string_view data) {
+    z_stream stream{};
+    if (inflateInit2(&stream, kInflateWindowBits) != Z_OK) {
+        throw std::runtime_error("Failed to initialize gzip decoder");
+    }
+
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+
+    std::string output;
+    std::array<char, kOutputChunkSize> buffer;
+    int status = Z_OK;
+    while (status != Z_STREAM_END) {
+        stream.next_out = reinterpret_cast<Bytef*>(buffer.data());
+        stream.avail_out = static_cast<uInt>(buffer.size());
+        status = inflate(&stream, Z_NO_FLUSH);
+        if (status != Z_OK && status != Z_STREAM_END) {
+            inflateEnd(&stream);
+            throw std::runtime_error("Malformed gzip stream");
+        }
+        output.append(buffer.data(), buffer.size() - stream.avail_out);
+        if (status == Z_OK && stream.avail_in == 0 && stream.avail_out != 0) {
+            inflateEnd(&stream);
+            throw std::runtime_error("Truncated gzip stream");
+        }
+    }
+
+    inflateEnd(&stream);
+    return output;
+}
+
+std::string DecompressZstd(std::string_view data) {
+    ZSTD_DCtx* context = ZSTD_createDCtx();
+    if (!context) {
+        throw std::runtime_error("Failed to initialize zstd decoder");
+    }
+
+    ZSTD_inBuffer in{data.data(), data.size(), 0};
+    std::string output;
+    std::array<char, kOutputChunkSize> buffer;
+    std::size_t status = 1;
+    while (in.pos < in.size || status != 0) {
+        ZSTD_outBuffer out{buffer.data(), buffer.size(), 0};
+        status = ZSTD_decompressStream(context, &out, &in);
+        if (ZSTD_isError(status)) {
+            ZSTD_freeDCtx(context);
+            throw std::runtime_error(std::string{"Malformed zstd stream: "} + ZSTD_getErrorName(status));
+        }
+        output.append(buffer.data(), out.pos);
+        if (in.pos == in.size && out.pos < out.size && status != 0) {
+            ZSTD_freeDCtx(context);
+            throw std::runtime_error("Truncated zstd stream");
+        }
+    }
+
+    ZSTD_freeDCtx(context);
+    return output;
+}
+
+}  // namespace
+
+StreamEncoder::StreamEncoder(Encoding encoding, int level) {
+    switch (encoding) {
+        case Encoding::kGzip:
+            impl_ = std::make_unique<GzipEncoder>(level);
+            break;
+        case Encoding::kZstd:
+            impl_ = std::make_unique<ZstdEncoder>(level);
+            break;
+        case Encoding::kIdentity:
+            throw std::invalid_argument("Identity encoding has no stream encoder");
+    }
+}
+
+StreamEncoder::~StreamEncoder() = default;
+
+StreamEncoder::StreamEncoder(StreamEncoder&&) noexcept = default;
+
+StreamEncoder& StreamEncoder::operator=(StreamEncoder&&) noexcept = default;
+
+std::string StreamEncoder::Push(std::string_view chunk) { return impl_->Push(chunk); }
+
+std::string StreamEncoder::Flush() { return impl_->Flush(); }
+
+std::string StreamEncoder::Finish() { return impl_->Finish(); }
+
+std::string Compress(std::string_view data, Encoding encoding, int level) {
+    if (encoding == Encoding::kIdentity) {
+        return std::string{data};
+    }
+
+    StreamEncoder encoder{encoding, level};
+    auto output = encoder.Push(data);
+    output += encoder.Finish();
+    return output;
+}
+
+std::string Decompress(std::string_view data, Encoding encoding) {
+    switch (encoding) {
+        case Encoding::kGzip:
+            return InflateGzip(data);
+        case Encoding::kZstd:
+            return DecompressZstd(data);
+        case Encoding::kIdentity:
+            break;
+    }
+    return std::string{data};
+}
+
+}  // namespace compression
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <userver/formats/parse/to.hpp>
+#include <userver/yaml_config/fwd.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace compression {
+
+/// Content codings supported for HTTP responses.
+enum class Encoding {
+    kIdentity,
+    kGzip,
+    kZstd,
+};
+
+/// @brief Returns the Content-Encoding token of the encoding.
+std::string_view ToString(Encoding encoding);
+
+/// @brief Picks the preferred encoding from an Accept-Encoding header value.
+///
+/// Honors q-values; on a tie zstd wins over gzip. Returns kIdentity if the
+/// client accepts neither.
+///
+/// @param accept_encoding The raw Accept-Encoding header value.
+/// @return The encoding to use for the response.
+Encoding Negotiate(std::string_view accept_encoding);
+
+/// Per-handler response compression settings.
+struct Settings {
+    /// Responses smaller than this are sent as is.
+    std::size_t min_size{1024};
+
+    /// zlib compression level, 1 (fastest) to 9 (smallest).
+    int gzip_level{6};
+
+    /// zstd compression level, 1 (fastest) to 19 (smallest).
+    int zstd_level{3};
+
+    /// @brief Returns the configured level for the given encoding.
+    int GetLevel(Encoding encoding) const;
+};
+
+Settings Parse(const userver::yaml_config::YamlConfig& value, userver::formats::parse::To<Settings>);
+
+/// @brief Incremental compressor for chunked responses.
+///
+/// Feed chunks with Push(), call Flush() whenever the produced bytes have to
+/// reach the client, and Finish() once to terminate the stream. Every call
+/// returns the compressed bytes produced by that call.
+class StreamEncoder {
+public:
+    /// Constructs an encoder.
+    /// @param encoding Either kGzip or kZstd.
+    /// @param level Compression level for the encoding.
+    /// @throws std::invalid_argument For kIdentity.
+    StreamEncoder(Encoding encoding, int level);
+    ~StreamEncoder();
+
+    StreamEncoder(StreamEncoder&&) noexcept;
+    StreamEncoder& operator=(StreamEncoder&&) noexcept;
+
+    std::string Push(std::string_view chunk);
+    std::string Flush();
+    std::string Finish();
+
+    class Impl;
+
+private:
+    std::unique_ptr<Impl> impl_;
+};
+
+/// @brief Compresses the whole buffer at once.
+/// @throws std::runtime_error On codec failure.
+std::string Compress(std::string_view data, Encoding encoding, int level);
+
+/// @brief Decompresses the whole buffer at once.
+/// @throws std::runtime_error On malformed input.
+std::string Decompress(std::string_view data, Encoding encoding);
+
+}  // namespace compression
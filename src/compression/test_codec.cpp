@@ -0,0 +1,93 @@
+#include "codec.hpp"
+
+#include <userver/utest/utest.hpp>
+
+using namespace compression;
+
+namespace {
+
+std::string MakeJsonLikePayload(size_t rows) {
+    std::string payload = "[";
+    for (size_t i = 0; i < rows; ++i) {
+        payload += R"({"id":)" + std::to_string(i) + R"(,"service":"service)" + std::to_string(i) +
+                   R"(","login":"user","password":"secret","created_at":"2024-01-01T00:00:00+0000"},)";
+    }
+    payload.back() = ']';
+    return payload;
+}
+
+}  // namespace
+
+TEST(CompressionNegotiateTest, PrefersZstdOnTie) {
+    EXPECT_EQ(Negotiate("gzip, deflate, br, zstd"), Encoding::kZstd);
+    EXPECT_EQ(Negotiate("gzip"), Encoding::kGzip);
+    EXPECT_EQ(Negotiate("zstd"), Encoding::kZstd);
+}
+
+TEST(CompressionNegotiateTest, HonorsQualityValues) {
+    EXPECT_EQ(Negotiate("zstd;q=0.5, gzip;q=0.8"), Encoding::kGzip);
+    EXPECT_EQ(Negotiate("zstd;q=0, gzip"), Encoding::kGzip);
+    EXPECT_EQ(Negotiate("gzip;q=0, zstd;q=0"), Encoding::kIdentity);
+    EXPECT_EQ(Negotiate("gzip; q=1.0, zstd; q=0.999"), Encoding::kGzip);
+}
+
+TEST(CompressionNegotiateTest, HandlesWildcardAndIdentity) {
+    EXPECT_EQ(Negotiate(""), Encoding::kIdentity);
+    EXPECT_EQ(Negotiate("identity"), Encoding::kIdentity);
+    EXPECT_EQ(Negotiate("br, deflate"), Encoding::kIdentity);
+    EXPECT_EQ(Negotiate("*"), Encoding::kZstd);
+    EXPECT_EQ(Negotiate("zstd;q=0, *"), Encoding::kGzip);
+}
+
+TEST(CompressionCodecTest, RoundTrip) {
+    const auto payload = MakeJsonLikePayload(100);
+
+    for (const auto encoding : {Encoding::kGzip, Encoding::kZstd}) {
+        const auto compressed = Compress(payload, encoding, 3);
+        EXPECT_LT(compressed.size(), payload.size() / 4);
+        EXPECT_EQ(Decompress(compressed, encoding), payload);
+    }
+}
+
+TEST(CompressionCodecTest, RoundTripEmpty) {
+    for (const auto encoding : {Encoding::kGzip, Encoding::kZstd}) {
+        EXPECT_EQ(Decompress(Compress({}, encoding, 3), encoding), "");
+    }
+}
+
+TEST(CompressionCodecTest, StreamingMatchesInput) {
+    const auto payload = MakeJsonLikePayload(1000);
+
+    for (const auto encoding : {Encoding::kGzip, Encoding::kZstd}) {
+        StreamEncoder encoder{encoding, 1};
+        std::string compressed;
+        for (size_t offset = 0; offset < payload.size(); offset += 777) {
+            compressed += encoder.Push(std::string_view{payload}.substr(offset, 777));
+        }
+        compressed += encoder.Flush();
+        compressed += encoder.Finish();
+
+        EXPECT_EQ(Decompress(compressed, encoding), payload);
+    }
+}
+
+TEST(CompressionCodecTest, FlushMakesPrefixDecodable) {
+    const std::string chunk = MakeJsonLikePayload(10);
+
+    StreamEncoder encoder{Encoding::kZstd, 3};
+    auto compressed = encoder.Push(chunk);
+    compressed += encoder.Flush();
+    EXPECT_FALSE(compressed.empty());
+}
+
+TEST(CompressionCodecTest, RejectsMalformedInput) {
+    EXPECT_THROW(Decompress("definitely not compressed", Encoding::kGzip), std::runtime_error);
+    EXPECT_THROW(Decompress("definitely not compressed", Encoding::kZstd), std::runtime_error);
+
+    const auto compressed = Compress(MakeJsonLikePayload(10), Encoding::kGzip, 6);
+    EXPECT_THROW(Decompress(compressed.substr(0, compressed.size() / 2), Encoding::kGzip), std::runtime_error);
+}
+
+TEST(CompressionCodecTest, IdentityHasNoStreamEncoder) {
+    EXPECT_THROW(StreamEncoder(Encoding::kIdentity, 0), std::invalid_argument);
+}
@@ -2,16 +2,60 @@
 
 #include <userver/components/component.hpp>
 #include <userver/crypto/base64.hpp>
+#include <userver/formats/common/items.hpp>
+#include <userver/formats/json/value.hpp>
+#include <userver/logging/log.hpp>
+#include <userver/storages/secdist/component.hpp>
 #include <userver/utils/algo.hpp>
 #include <userver/yaml_config/merge_schemas.hpp>
 
+namespace {
+
+/// Additional server keys, secdist `{"CRYPTO_KEYS": {"<key id>": "<base64 key>"}}`.
+struct SecdistKeys {
+    explicit SecdistKeys(const userver::formats::json::Value& doc) {
+        if (!doc.HasMember("CRYPTO_KEYS")) {
+            return;
+        }
+        for (const auto& [key_id, key] : userver::formats::common::Items(doc["CRYPTO_KEYS"])) {
+            keys.emplace(std::stoul(key_id), key.As<std::string>());
+        }
+    }
+
+    std::unordered_map<std::uint32_t, std::string> keys;
+};
+
+crypto::Keyring MakeKeyring(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& context
+) {
+    auto legacy_key = userver::crypto::base64::Base64Decode(config["aes256_base64_key"].As<std::string>());
+
+    std::unordered_map<std::uint32_t, std::string> keys{{crypto::Component::kLegacyKeyId, legacy_key}};
+    const auto& secdist = context.FindComponent<userver::components::Secdist>().Get().Get<SecdistKeys>();
+    for (const auto& [key_id, key_encoded] : secdist.keys) {
+        if (key_id == crypto::Component::kLegacyKeyId) {
+            throw std::runtime_error("Key ID 0 is reserved for aes256_base64_key");
+        }
+        keys.emplace(key_id, userver::crypto::base64::Base64Decode(key_encoded));
+    }
+
+    const auto primary_key_id = config["primary_key_id"].As<std::uint32_t>(crypto::Component::kLegacyKeyId);
+    LOG_INFO() << "Server keyring has " << keys.size() << " keys, primary key ID: " << primary_key_id;
+    return crypto::Keyring{std::move(keys), primary_key_id, std::move(legacy_key)};
+}
+
+}  // namespace
+
 namespace crypto {
 
 Component::Component(
     const userver::components::ComponentConfig& config,
     const userver::components::ComponentContext& context
 )
-    : userver::components::LoggableComponentBase(config, context), storage_{config.As<Component::Storage>()} {}
+    : userver::components::LoggableComponentBase(config, context),
+      storage_{config.As<Component::Storage>()},
+      keyring_{MakeKeyring(config, context)} {}
 
 std::string Component::GetDecodedKey(const std::string& name) const {
     const std::string* key_encoded = userver::utils::FindOrNullptr(storage_, name);
@@ -22,6 +66,8 @@ std::string Component::GetDecodedKey(const std::string& name) const {
     return userver::crypto::base64::Base64Decode(*key_encoded);
 }
 
+const Keyring& Component::GetKeyring() const { return keyring_; }
+
 userver::yaml_config::Schema Component::GetStaticConfigSchema() {
     constexpr auto schema = R"(
         type: object
@@ -30,9 +76,13 @@ userver::yaml_config::Schema Component::GetStaticConfigSchema() {
         properties:
             aes256_base64_key:
                 type: string
-                description: AES-256 key for working with master key stored in JWT token
+                description: AES-256 key for working with master key stored in JWT token, key ID 0 of the keyring
+            primary_key_id:
+                type: integer
+                description: ID of the key new data is encrypted with, other keys are only used for decryption
+                defaultDescription: 0
     )";
     return userver::yaml_config::MergeSchemas<userver::components::LoggableComponentBase>(schema);
 }
 
-}  // namespace crypto
\ No newline at end of file
+}  // namespace crypto
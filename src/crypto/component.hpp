@@ -1,5 +1,7 @@
 #pragma once
 
+#include "keyring.hpp"
+
 #include <userver/components/loggable_component_base.hpp>
 
 #include <unordered_map>
@@ -10,14 +12,21 @@ class Component final : public userver::components::LoggableComponentBase {
 public:
     static constexpr std::string_view kName = "component-crypto";
 
+    /// Key ID of aes256_base64_key, the only key of ciphertexts written before key IDs were introduced.
+    static constexpr std::uint32_t kLegacyKeyId = 0;
+
     Component(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
 
     std::string GetDecodedKey(const std::string& name) const;
 
+    /// @brief Returns the server keyring: aes256_base64_key and the keys from secdist CRYPTO_KEYS.
+    const Keyring& GetKeyring() const;
+
     static userver::yaml_config::Schema GetStaticConfigSchema();
 
 private:
     using Storage = std::unordered_map<std::string, std::string>;
     const Storage storage_;
+    const Keyring keyring_;
 };
-}  // namespace crypto
\ No newline at end of file
+}  // namespace crypto
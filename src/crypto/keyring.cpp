@@ -0,0 +1,127 @@
+#include "keyring.hpp"
+#include "utils.hpp"
+
+#include "secure/arena.hpp"
+
+#include <userver/crypto/base64.hpp>
+
+#include <stdexcept>
+
+namespace {
+
+constexpr std::size_t kKeySize = 32;
+constexpr std::size_t kHeaderSize = 5;
+
+// IV and tag of crypto::Encrypt output
+constexpr std::size_t kMinPayloadSize = 12 + 16;
+
+std::uint32_t ReadKeyId(std::string_view ciphertext) {
+    std::uint32_t key_id = 0;
+    for (std::size_t i = 1; i < kHeaderSize; ++i) {
+        key_id = (key_id << 8) | static_cast<std::uint8_t>(ciphertext[i]);
+    }
+    return key_id;
+}
+
+}  // namespace
+
+namespace crypto {
+
+Keyring::Keyring(
+    std::unordered_map<std::uint32_t, std::string> keys,
+    std::uint32_t primary_key_id,
+    std::string legacy_key
+)
+    : keys_{std::move(keys)}, primary_key_id_{primary_key_id}, legacy_key_{std::move(legacy_key)} {
+    if (!keys_.count(primary_key_id_)) {
+        throw std::invalid_argument("Primary key " + std::to_string(primary_key_id_) + " is not in the keyring");
+    }
+    for (const auto& [key_id, key] : keys_) {
+        if (key.size() != kKeySize) {
+            throw std::invalid_argument("Key " + std::to_string(key_id) + " is not an AES-256 key");
+        }
+    }
+    if (!legacy_key_.empty() && legacy_key_.size() != kKeySize) {
+        throw std::invalid_argument("Legacy key is not an AES-256 key");
+    }
+}
+
+std::string Keyring::Encrypt(std::string_view plaintext) const {
+    std::string ciphertext(kHeaderSize, '\0');
+    ciphertext[0] = static_cast<char>(kFormatVersion);
+    for (std::size_t i = 1; i < kHeaderSize; ++i) {
+        ciphertext[i] = static_cast<char>(primary_key_id_ >> (8 * (kHeaderSize - 1 - i)));
+    }
+    ciphertext += crypto::Encrypt(plaintext, keys_.at(primary_key_id_));
+    return ciphertext;
+}
+
+std::string Keyring::Decrypt(std::string_view ciphertext) const {
+    if (const auto* key = FindKey(ciphertext)) {
+        try {
+            return crypto::Decrypt(ciphertext.substr(kHeaderSize), *key);
+        } catch (const std::exception&) {
+            // a legacy ciphertext that happens to start with a valid header
+            if (legacy_key_.empty()) {
+                throw;
+            }
+        }
+    }
+    if (legacy_key_.empty()) {
+        throw std::runtime_error("Ciphertext is encrypted with an unknown key");
+    }
+    return crypto::Decrypt(ciphertext, legacy_key_);
+}
+
+std::string_view Keyring::Decrypt(std::string_view ciphertext, secure::Arena& arena) const {
+    if (const auto* key = FindKey(ciphertext)) {
+        try {
+            return crypto::Decrypt(ciphertext.substr(kHeaderSize), *key, arena);
+        } catch (const std::exception&) {
+            if (legacy_key_.empty()) {
+                throw;
+            }
+        }
+    }
+    if (legacy_key_.empty()) {
+        throw std::runtime_error("Ciphertext is encrypted with an unknown key");
+    }
+    return crypto::Decrypt(ciphertext, legacy_key_, arena);
+}
+
+std::optional<std::uint32_t> Keyring::GetKeyId(std::string_view ciphertext) const {
+    if (ciphertext.size() < kHeaderSize + kMinPayloadSize ||
+        static_cast<std::uint8_t>(ciphertext[0]) != kFormatVersion) {
+        return std::nullopt;
+    }
+    const auto key_id = ReadKeyId(ciphertext);
+    if (!keys_.count(key_id)) {
+        return std::nullopt;
+    }
+    return key_id;
+}
+
+std::string Keyring::EncryptText(std::string_view plaintext) const {
+    return std::string{kTextPrefix} + userver::crypto::base64::Base64Encode(Encrypt(plaintext));
+}
+
+std::string Keyring::DecryptText(std::string_view text) const {
+    if (!text.starts_with(kTextPrefix)) {
+        return std::string{text};
+    }
+    return Decrypt(userver::crypto::base64::Base64Decode(text.substr(kTextPrefix.size())));
+}
+
+bool Keyring::NeedsReencryption(std::string_view text) const {
+    if (!text.starts_with(kTextPrefix)) {
+        return true;
+    }
+    return GetKeyId(userver::crypto::base64::Base64Decode(text.substr(kTextPrefix.size()))) != primary_key_id_;
+}
+
+const std::string* Keyring::FindKey(std::string_view ciphertext) const {
+    const auto key_id = GetKeyId(ciphertext);
+    return key_id ? &keys_.at(*key_id) : nullptr;
+}
+
+}  // namespace crypto
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace secure {
+
+class Arena;
+
+}  // namespace secure
+
+namespace crypto {
+
+/// @brief Set of server keys identified by numeric key IDs.
+///
+/// New data is always encrypted with the primary key. Ciphertexts carry a
+/// header with the format version and the key ID, so data encrypted with
+/// older keys stays readable while those keys are kept in the keyring for
+/// decryption only:
+///
+///     | version (1 byte) | key ID (4 bytes, big endian) | IV | ciphertext | tag |
+///
+/// Data encrypted before key IDs were introduced has no header; it is
+/// decrypted with the legacy key, if one is configured.
+///
+/// For TEXT columns the ciphertext is stored base64 encoded behind
+/// kTextPrefix, which also tells it apart from values written in plaintext
+/// before encryption at rest was introduced.
+class Keyring final {
+public:
+    static constexpr std::uint8_t kFormatVersion = 1;
+    static constexpr std::string_view kTextPrefix = "enc:";
+
+    /// @param keys Raw AES-256 keys by key ID.
+    /// @param primary_key_id ID of the key used for encryption.
+    /// @param legacy_key Raw key of ciphertexts without a header, empty if there are none.
+    /// @throws std::invalid_argument If the primary key is missing or a key has a wrong size.
+    Keyring(std::unordered_map<std::uint32_t, std::string> keys, std::uint32_t primary_key_id, std::string legacy_key);
+
+    std::uint32_t GetPrimaryKeyId() const noexcept { return primary_key_id_; }
+
+    /// @brief Encrypts with the primary key and prepends the header.
+    std::string Encrypt(std::string_view plaintext) const;
+
+    /// @brief Decrypts a ciphertext of any key in the keyring, or a legacy one.
+    /// @throws std::runtime_error If the key is unknown or the data is corrupted.
+    std::string Decrypt(std::string_view ciphertext) const;
+
+    /// @brief Same as Decrypt(), the plaintext is allocated in the arena.
+    std::string_view Decrypt(std::string_view ciphertext, secure::Arena& arena) const;
+
+    /// @brief Returns the key ID from the header of a ciphertext.
+    /// @return std::nullopt for legacy ciphertexts and unknown keys.
+    std::optional<std::uint32_t> GetKeyId(std::string_view ciphertext) const;
+
+    /// @brief Encrypts a value for a TEXT column.
+    std::string EncryptText(std::string_view plaintext) const;
+
+    /// @brief Decrypts a value written by EncryptText(); values without kTextPrefix are returned as is.
+    std::string DecryptText(std::string_view text) const;
+
+    /// @brief Checks whether a TEXT column value is plaintext or not encrypted with the primary key.
+    bool NeedsReencryption(std::string_view text) const;
+
+private:
+    const std::string* FindKey(std::string_view ciphertext) const;
+
+    const std::unordered_map<std::uint32_t, std::string> keys_;
+    const std::uint32_t primary_key_id_;
+    const std::string legacy_key_;
+};
+
+}  // namespace crypto
@@ -0,0 +1,78 @@
+#include "keyring.hpp"
+#include "utils.hpp"
+#include "secure/arena.hpp"
+
+#include <userver/utest/utest.hpp>
+
+using namespace crypto;
+
+namespace {
+
+Keyring MakeKeyring(const std::unordered_map<std::uint32_t, std::string>& keys, std::uint32_t primary_key_id) {
+    return Keyring{keys, primary_key_id, keys.at(0)};
+}
+
+}  // namespace
+
+TEST(CryptoKeyringTest, RoundTripWithKeyId) {
+    const auto keyring = MakeKeyring({{0, GenerateMasterKey()}, {7, GenerateMasterKey()}}, 7);
+
+    const auto ciphertext = keyring.Encrypt("secret");
+    EXPECT_EQ(keyring.GetKeyId(ciphertext), 7u);
+    EXPECT_EQ(keyring.Decrypt(ciphertext), "secret");
+
+    secure::Pool pool;
+    secure::Arena arena{pool};
+    EXPECT_EQ(keyring.Decrypt(ciphertext, arena), "secret");
+}
+
+TEST(CryptoKeyringTest, DecryptsWithRetiredPrimaryKey) {
+    const auto old_key = GenerateMasterKey();
+    const auto new_key = GenerateMasterKey();
+    const auto old_keyring = MakeKeyring({{0, old_key}, {1, new_key}}, 0);
+    const auto new_keyring = MakeKeyring({{0, old_key}, {1, new_key}}, 1);
+
+    const auto ciphertext = old_keyring.Encrypt("secret");
+    EXPECT_EQ(new_keyring.GetKeyId(ciphertext), 0u);
+    EXPECT_EQ(new_keyring.Decrypt(ciphertext), "secret");
+}
+
+TEST(CryptoKeyringTest, DecryptsLegacyCiphertext) {
+    const auto legacy_key = GenerateMasterKey();
+    const auto keyring = MakeKeyring({{0, legacy_key}, {1, GenerateMasterKey()}}, 1);
+
+    const auto ciphertext = crypto::Encrypt("secret", legacy_key);
+    EXPECT_EQ(keyring.Decrypt(ciphertext), "secret");
+}
+
+TEST(CryptoKeyringTest, RejectsUnknownKey) {
+    const auto keyring = MakeKeyring({{0, GenerateMasterKey()}, {1, GenerateMasterKey()}}, 1);
+    const Keyring other{{{2, GenerateMasterKey()}}, 2, {}};
+
+    const auto ciphertext = other.Encrypt("secret");
+    EXPECT_EQ(keyring.GetKeyId(ciphertext), std::nullopt);
+    EXPECT_THROW(keyring.Decrypt(ciphertext), std::exception);
+    EXPECT_THROW(other.Decrypt(keyring.Encrypt("secret")), std::exception);
+}
+
+TEST(CryptoKeyringTest, TextForm) {
+    const std::unordered_map<std::uint32_t, std::string> keys{{0, GenerateMasterKey()}, {1, GenerateMasterKey()}};
+    const auto old_keyring = MakeKeyring(keys, 0);
+    const auto new_keyring = MakeKeyring(keys, 1);
+
+    EXPECT_TRUE(new_keyring.NeedsReencryption("JBSWY3DPEHPK3PXP"));
+    EXPECT_EQ(new_keyring.DecryptText("JBSWY3DPEHPK3PXP"), "JBSWY3DPEHPK3PXP");
+
+    const auto old_text = old_keyring.EncryptText("JBSWY3DPEHPK3PXP");
+    EXPECT_TRUE(old_text.starts_with(Keyring::kTextPrefix));
+    EXPECT_TRUE(new_keyring.NeedsReencryption(old_text));
+    EXPECT_EQ(new_keyring.DecryptText(old_text), "JBSWY3DPEHPK3PXP");
+
+    const auto new_text = new_keyring.EncryptText("JBSWY3DPEHPK3PXP");
+    EXPECT_FALSE(new_keyring.NeedsReencryption(new_text));
+}
+
+TEST(CryptoKeyringTest, RejectsInvalidKeys) {
+    EXPECT_THROW(Keyring({{0, GenerateMasterKey()}}, 1, {}), std::invalid_argument);
+    EXPECT_THROW(Keyring({{0, "short"}}, 0, {}), std::invalid_argument);
+}
@@ -1,4 +1,5 @@
 #include "utils.hpp"
+#include "secure/arena.hpp"
 
 #include <userver/utest/utest.hpp>
 
@@ -59,3 +60,48 @@ TEST(CryptoUtilsTest, EncryptDecrypt_InvalidKey) {
 
     EXPECT_THROW(Decrypt(encrypted_data, wrong_key), std::runtime_error);
 }
+
+// Test HashMasterKeyWithSalt against a known digest
+TEST(CryptoUtilsTest, HashMasterKeyWithSalt_KnownValue) {
+    // SHA-256("abc")
+    const std::string expected = "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad";
+    EXPECT_EQ(HashMasterKeyWithSalt("ab", "c"), expected);
+    EXPECT_EQ(HashMasterKeyWithSalt("", "abc"), expected);
+}
+
+// Test Decrypt into a secure arena
+TEST(CryptoUtilsTest, DecryptIntoArena) {
+    secure::Pool pool;
+    secure::Arena arena{pool};
+
+    auto master_key = GenerateMasterKey();
+    const auto encrypted_data = Encrypt("Sensitive data", master_key);
+
+    EXPECT_EQ(Decrypt(encrypted_data, master_key, arena), "Sensitive data");
+    EXPECT_EQ(Decrypt(Encrypt("", master_key), master_key, arena), "");
+    EXPECT_THROW(Decrypt(encrypted_data, GenerateMasterKey(), arena), std::runtime_error);
+    EXPECT_THROW(Decrypt(encrypted_data.substr(0, 20), master_key, arena), std::invalid_argument);
+}
+
+// Test Base64Decode into a secure arena
+TEST(CryptoUtilsTest, Base64DecodeIntoArena) {
+    secure::Pool pool;
+    secure::Arena arena{pool};
+
+    EXPECT_EQ(Base64Decode("U2Vuc2l0aXZlIGRhdGE=", arena), "Sensitive data");
+    EXPECT_EQ(Base64Decode("YWJj", arena), "abc");
+    EXPECT_EQ(Base64Decode("", arena), "");
+}
+
+// Test FingerprintPassword
+TEST(CryptoUtilsTest, FingerprintPassword) {
+    const auto data_key = GenerateMasterKey();
+
+    const auto fingerprint = FingerprintPassword("hunter2", data_key);
+    EXPECT_EQ(fingerprint.size(), 32);
+    EXPECT_EQ(FingerprintPassword("hunter2", data_key), fingerprint);
+    EXPECT_NE(FingerprintPassword("hunter3", data_key), fingerprint);
+
+    // fingerprints of different users are unrelated
+    EXPECT_NE(FingerprintPassword("hunter2", GenerateMasterKey()), fingerprint);
+}
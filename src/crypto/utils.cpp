@@ -1,19 +1,84 @@
 #include "utils.hpp"
 
+#include "secure/arena.hpp"
+
 #include <cryptopp/aes.h>
+#include <cryptopp/base64.h>
 #include <cryptopp/filters.h>
 #include <cryptopp/gcm.h>
-#include <cryptopp/hex.h>
+#include <cryptopp/hmac.h>
 #include <cryptopp/osrng.h>
-#include <userver/crypto/hash.hpp>
+#include <cryptopp/sha.h>
 #include <userver/crypto/random.hpp>
 
+#include <algorithm>
+#include <array>
 #include <stdexcept>
 
 namespace crypto {
 
 static constexpr size_t kAesKeySize = 32;  // 256 bits
 static constexpr size_t kAesIvSize = 12;   // recommended IV size fore AES-GCM
+static constexpr size_t kAesTagSize = 16;  // authentication tag appended to the ciphertext
+static constexpr size_t kFingerprintSize = 16;  // truncated HMAC-SHA256
+static constexpr std::string_view kFingerprintKeyLabel = "vaulty password fingerprint v1";
+
+namespace {
+
+size_t GetPlaintextSize(std::string_view packed_data) {
+    if (packed_data.size() < kAesIvSize + kAesTagSize) {
+        throw std::invalid_argument("Packed data size is invalid. It must include IV and tag.");
+    }
+    return packed_data.size() - kAesIvSize - kAesTagSize;
+}
+
+/// Decrypts packed IV, ciphertext and tag into `output`, which must hold GetPlaintextSize() bytes.
+void DecryptTo(std::string_view packed_data, std::string_view master_key, char* output) {
+    if (master_key.size() != kAesKeySize) {
+        throw std::invalid_argument("Master key size must be 32 bytes (AES-256 key size).");
+    }
+
+    const auto* iv = reinterpret_cast<const std::uint8_t*>(packed_data.data());
+    const auto* ciphertext = iv + kAesIvSize;
+    const size_t ciphertext_size = packed_data.size() - kAesIvSize - kAesTagSize;
+
+    bool verified = false;
+    try {
+        CryptoPP::GCM<CryptoPP::AES>::Decryption decryptor;
+        decryptor.SetKeyWithIV(
+            reinterpret_cast<const std::uint8_t*>(master_key.data()), master_key.size(), iv, kAesIvSize
+        );
+        verified = decryptor.DecryptAndVerify(
+            reinterpret_cast<std::uint8_t*>(output),
+            ciphertext + ciphertext_size,
+            kAesTagSize,
+            iv,
+            kAesIvSize,
+            nullptr,
+            0,
+            ciphertext,
+            ciphertext_size
+        );
+    } catch (const std::exception& ex) {
+        throw std::runtime_error(ex.what());
+    }
+
+    if (!verified) {
+        throw std::runtime_error("Decryption failed: message hash or MAC not valid");
+    }
+}
+
+using HmacSha256 = CryptoPP::HMAC<CryptoPP::SHA256>;
+using HmacDigest = std::array<std::uint8_t, HmacSha256::DIGESTSIZE>;
+
+HmacDigest CalculateHmac(const std::uint8_t* key, size_t key_size, std::string_view message) {
+    HmacDigest digest;
+    HmacSha256 hmac{key, key_size};
+    hmac.CalculateDigest(digest.data(), reinterpret_cast<const std::uint8_t*>(message.data()), message.size());
+    return digest;
+}
+
+}  // namespace
 
 std::vector<std::uint8_t> GenerateRandomBytes(size_t size) {
     std::vector<std::uint8_t> buffer(size);
@@ -32,18 +97,49 @@ std::string GenerateSalt(size_t size) {
     return std::string(bytes.begin(), bytes.end());
 }
 
-std::string HashMasterKeyWithSalt(const std::string& master_key, const std::string& salt) {
-    const auto combined = master_key + salt;
-    const auto encoding = userver::crypto::hash::OutputEncoding::kHex;
-    return userver::crypto::hash::Sha256(combined, encoding);
+std::string HashMasterKeyWithSalt(std::string_view master_key, std::string_view salt) {
+    // hash the parts one after another instead of concatenating the key into a temporary
+    CryptoPP::SHA256 hash;
+    hash.Update(reinterpret_cast<const std::uint8_t*>(master_key.data()), master_key.size());
+    hash.Update(reinterpret_cast<const std::uint8_t*>(salt.data()), salt.size());
+
+    std::array<std::uint8_t, CryptoPP::SHA256::DIGESTSIZE> digest;
+    hash.Final(digest.data());
+
+    constexpr std::string_view kHexDigits = "0123456789abcdef";
+    std::string result;
+    result.reserve(digest.size() * 2);
+    for (const auto byte : digest) {
+        result.push_back(kHexDigits[byte >> 4]);
+        result.push_back(kHexDigits[byte & 0x0F]);
+    }
+    return result;
 }
 
-bool VerifyMasterKeyHashWithSalt(const std::string& master_key, const std::string& salt, const std::string& hash) {
+bool VerifyMasterKeyHashWithSalt(std::string_view master_key, std::string_view salt, std::string_view hash) {
     return HashMasterKeyWithSalt(master_key, salt) == hash;
 }
 
+std::string FingerprintPassword(std::string_view password, std::string_view data_key) {
+    // a separate key, so that the fingerprints reveal nothing about the data key itself
+    auto fingerprint_key = CalculateHmac(
+        reinterpret_cast<const std::uint8_t*>(data_key.data()), data_key.size(), kFingerprintKeyLabel
+    );
+    const auto digest = CalculateHmac(fingerprint_key.data(), fingerprint_key.size(), password);
+    secure::Wipe({reinterpret_cast<char*>(fingerprint_key.data()), fingerprint_key.size()});
+
+    constexpr std::string_view kHexDigits = "0123456789abcdef";
+    std::string result;
+    result.reserve(kFingerprintSize * 2);
+    for (size_t i = 0; i < kFingerprintSize; ++i) {
+        result.push_back(kHexDigits[digest[i] >> 4]);
+        result.push_back(kHexDigits[digest[i] & 0x0F]);
+    }
+    return result;
+}
+
 /// Encrypts plaintext using AES-GCM.
-std::string Encrypt(const std::string& plaintext, const std::string& master_key) {
+std::string Encrypt(std::string_view plaintext, std::string_view master_key) {
     if (master_key.size() != kAesKeySize) {
         throw std::invalid_argument("Master key size must be 32 bytes (AES-256 key size).");
     }
@@ -52,66 +148,61 @@ std::string Encrypt(const std::string& plaintext, const std::string& master_key)
     const auto iv = GenerateRandomBytes(kAesIvSize);
 
     try {
-        // prepare encryption
         CryptoPP::GCM<CryptoPP::AES>::Encryption encryptor;
         encryptor.SetKeyWithIV(
             reinterpret_cast<const std::uint8_t*>(master_key.data()), master_key.size(), iv.data(), iv.size()
         );
 
-        // Buffers for ciphertext and tag
-        std::string ciphertext;
-        auto encryption_filter =
-            std::make_unique<CryptoPP::AuthenticatedEncryptionFilter>(encryptor, new CryptoPP::StringSink(ciphertext));
-        CryptoPP::StringSource encryptor_source(
-            plaintext,
-            true,
-            new CryptoPP::AuthenticatedEncryptionFilter(encryptor, new CryptoPP::StringSink(ciphertext))
+        // IV, ciphertext and tag are written straight into the result
+        std::string packed_data(kAesIvSize + plaintext.size() + kAesTagSize, '\0');
+        auto* output = reinterpret_cast<std::uint8_t*>(packed_data.data());
+        std::copy(iv.begin(), iv.end(), output);
+        encryptor.EncryptAndAuthenticate(
+            output + kAesIvSize,
+            output + kAesIvSize + plaintext.size(),
+            kAesTagSize,
+            iv.data(),
+            iv.size(),
+            nullptr,
+            0,
+            reinterpret_cast<const std::uint8_t*>(plaintext.data()),
+            plaintext.size()
         );
-
-        // combine IV and ciphertext
-        std::vector<std::uint8_t> packed_data(iv.begin(), iv.end());
-        packed_data.insert(packed_data.end(), ciphertext.begin(), ciphertext.end());
-
-        return {packed_data.begin(), packed_data.end()};
+        return packed_data;
     } catch (const std::exception& ex) {
         throw std::runtime_error(ex.what());
     }
 }
 
 /// Decrypts ciphertext using AES-GCM.
-std::string Decrypt(const std::string& packed_data, const std::string& master_key) {
-    if (master_key.size() != kAesKeySize) {
-        throw std::invalid_argument("Master key size must be 32 bytes (AES-256 key size).");
-    }
-
-    if (packed_data.size() < kAesIvSize) {
-        throw std::invalid_argument("Packed data size is invalid. It must include IV and tag.");
-    }
-
-    // extract IV and ciphertext
-    const auto* iv = reinterpret_cast<const std::uint8_t*>(packed_data.data());
-    const auto* ciphertext = reinterpret_cast<const std::uint8_t*>(packed_data.data()) + kAesIvSize;
-    const size_t ciphertext_size = packed_data.size() - kAesIvSize;
-
+std::string Decrypt(std::string_view packed_data, std::string_view master_key) {
+    std::string plaintext(GetPlaintextSize(packed_data), '\0');
     try {
-        CryptoPP::GCM<CryptoPP::AES>::Decryption decryptor;
-        decryptor.SetKeyWithIV(
-            reinterpret_cast<const std::uint8_t*>(master_key.data()), master_key.size(), iv, kAesIvSize
-        );
-
-        std::string plaintext;
+        DecryptTo(packed_data, master_key, plaintext.data());
+    } catch (...) {
+        // the buffer may hold unauthenticated plaintext
+        secure::Wipe(plaintext);
+        throw;
+    }
+    return plaintext;
+}
 
-        CryptoPP::StringSource decryptor_source(
-            ciphertext,
-            ciphertext_size,
-            true,
-            new CryptoPP::AuthenticatedDecryptionFilter(decryptor, new CryptoPP::StringSink(plaintext))
-        );
+std::string_view Decrypt(std::string_view packed_data, std::string_view master_key, secure::Arena& arena) {
+    const auto plaintext = arena.Allocate(GetPlaintextSize(packed_data));
+    DecryptTo(packed_data, master_key, plaintext.data());
+    return {plaintext.data(), plaintext.size()};
+}
 
-        return plaintext;
-    } catch (const std::exception& ex) {
-        throw std::runtime_error(ex.what());
-    }
+std::string_view Base64Decode(std::string_view encoded, secure::Arena& arena) {
+    const auto decoded = arena.Allocate(encoded.size() / 4 * 3 + 3);
+    CryptoPP::ArraySink sink{reinterpret_cast<std::uint8_t*>(decoded.data()), decoded.size()};
+    CryptoPP::StringSource source{
+        reinterpret_cast<const std::uint8_t*>(encoded.data()),
+        encoded.size(),
+        true,
+        new CryptoPP::Base64Decoder(new CryptoPP::Redirector(sink)),
+    };
+    return {decoded.data(), static_cast<std::size_t>(sink.TotalPutLength())};
 }
 
-}  // namespace crypto
\ No newline at end of file
+}  // namespace crypto
@@ -1,8 +1,16 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
+namespace secure {
+
+class Arena;
+
+}  // namespace secure
+
 namespace crypto {
 
 /// @brief Generates a random master key.
@@ -28,7 +36,7 @@ std::string GenerateSalt(size_t size = 16);
 /// @param master_key The master key to hash.
 /// @param salt The salt to use for hashing.
 /// @return The resulting hash as a string.
-std::string HashMasterKeyWithSalt(const std::string& master_key, const std::string& salt);
+std::string HashMasterKeyWithSalt(std::string_view master_key, std::string_view salt);
 
 /// @brief Verifies the hash of a master key with a salt.
 ///
@@ -39,7 +47,19 @@ std::string HashMasterKeyWithSalt(const std::string& master_key, const std::stri
 /// @param salt The salt used during hashing.
 /// @param hash The hash to verify against.
 /// @return true if the hash is valid; false otherwise.
-bool VerifyMasterKeyHashWithSalt(const std::string& master_key, const std::string& salt, const std::string& hash);
+bool VerifyMasterKeyHashWithSalt(std::string_view master_key, std::string_view salt, std::string_view hash);
+
+/// @brief Computes a keyed fingerprint of a password.
+///
+/// Equal passwords of one user have equal fingerprints, so reuse can be found
+/// without decrypting anything, while the fingerprints cannot be checked
+/// against a dictionary without the user's key. The HMAC-SHA256 key is
+/// derived from the data key, so fingerprints survive master key changes.
+///
+/// @param password The plaintext password.
+/// @param data_key The user's data key.
+/// @return 32 hex characters.
+std::string FingerprintPassword(std::string_view password, std::string_view data_key);
 
 /// @brief Encrypts plaintext using AES-GCM.
 ///
@@ -49,7 +69,7 @@ bool VerifyMasterKeyHashWithSalt(const std::string& master_key, const std::strin
 /// @param plaintext The data to encrypt.
 /// @param master_key The master key used for encryption.
 /// @return A vector of bytes containing the encrypted data.
-std::string Encrypt(const std::string& plaintext, const std::string& master_key);
+std::string Encrypt(std::string_view plaintext, std::string_view master_key);
 
 /// @brief Decrypts ciphertext using AES-GCM.
 ///
@@ -59,7 +79,25 @@ std::string Encrypt(const std::string& plaintext, const std::string& master_key)
 /// @param packed_data The encrypted data, including IV and tag.
 /// @param master_key The master key used for decryption.
 /// @return The decrypted plaintext as a string.
-std::string Decrypt(const std::string& packed_data, const std::string& master_key);
+std::string Decrypt(std::string_view packed_data, std::string_view master_key);
+
+/// @brief Decrypts ciphertext using AES-GCM into a secure arena.
+///
+/// Same as Decrypt(), but the plaintext never touches the heap: it is written
+/// to arena memory that is wiped when the arena is destroyed.
+///
+/// @param packed_data The encrypted data, including IV and tag.
+/// @param master_key The master key used for decryption.
+/// @param arena The arena the plaintext is allocated in.
+/// @return A view of the plaintext, valid for the lifetime of the arena.
+std::string_view Decrypt(std::string_view packed_data, std::string_view master_key, secure::Arena& arena);
+
+/// @brief Decodes base64 into a secure arena.
+///
+/// @param encoded The base64 encoded data.
+/// @param arena The arena the decoded data is allocated in.
+/// @return A view of the decoded data, valid for the lifetime of the arena.
+std::string_view Base64Decode(std::string_view encoded, secure::Arena& arena);
 
 /// @brief Generates random bytes.
 ///
@@ -7,15 +7,93 @@ SELECT * FROM users WHERE username = $1
 )~"};
 
 inline constexpr const char* kCreateUser{R"~(
-INSERT INTO users (username, master_key_hash, salt_encoded, totp_secret) VALUES ($1, $2, $3, $4)
+INSERT INTO users (username, master_key_hash, salt_encoded, totp_secret, data_key_wrapped)
+VALUES ($1, $2, $3, $4, $5)
 )~"};
 
-inline constexpr const char* kDeleteUser{R"~(
-DELETE FROM users WHERE username = $1;
+// the rows of the user are removed later by component-user-purge
+inline constexpr const char* kMarkUserDeleted{R"~(
+UPDATE users SET deleted_at = NOW(), updated_at = NOW() WHERE id = $1 AND deleted_at IS NULL
 )~"};
 
+inline constexpr const char* kCheckUserActive{R"~(
+SELECT 1 FROM users WHERE id = $1 AND deleted_at IS NULL
+)~"};
+
+inline constexpr const char* kGetUserDataKey{R"~(
+SELECT data_key_wrapped FROM users WHERE id = $1
+)~"};
+
+inline constexpr const char* kLockUserDataKey{R"~(
+SELECT data_key_wrapped FROM users WHERE id = $1 FOR UPDATE
+)~"};
+
+// every ciphertext of the vault changes, the version bump drops the vault from the row caches
+inline constexpr const char* kSetUserDataKey{R"~(
+UPDATE users SET data_key_wrapped = $2, vault_version = vault_version + 1, updated_at = NOW() WHERE id = $1
+RETURNING vault_version
+)~"};
+
+// compare-and-set on the old hash, a concurrent change of the master key wins
+inline constexpr const char* kChangeMasterKey{R"~(
+UPDATE users SET master_key_hash = $2, salt_encoded = $3, data_key_wrapped = $4, updated_at = NOW()
+WHERE id = $1 AND master_key_hash = $5 AND deleted_at IS NULL
+)~"};
+
+inline constexpr const char* kGetVaultVersion{R"~(
+SELECT vault_version FROM users WHERE id = $1
+)~"};
+
+// the entry is stamped with the new vault version as its change sequence; also returns the services
+// of the entries that already use the same password, the reused CTE reads the snapshot from before the insert
 inline constexpr const char* kCreatePassword{R"~(
-INSERT INTO passwords (user_id, service, login, password_encrypted) VALUES ($1, $2, $3, $4)
+WITH version AS (
+    UPDATE users SET vault_version = vault_version + 1 WHERE id = $1 AND deleted_at IS NULL RETURNING vault_version
+), inserted AS (
+    INSERT INTO passwords (
+        user_id, service, login, password_encrypted, fingerprint, totp_secret_encrypted, change_version
+    )
+    SELECT $1, $2, $3, $4, $5, $6, vault_version FROM version
+    RETURNING id, created_at, updated_at
+), reused AS (
+    SELECT COALESCE(ARRAY_AGG(service ORDER BY id), '{}') AS services
+    FROM passwords WHERE user_id = $1 AND fingerprint = $5
+)
+SELECT inserted.id::BIGINT, version.vault_version, reused.services, inserted.created_at, inserted.updated_at
+FROM inserted, version, reused
+)~"};
+
+inline constexpr const char* kReencryptPasswords{R"~(
+UPDATE passwords p SET password_encrypted = v.password_encrypted, fingerprint = v.fingerprint
+FROM UNNEST($1::INTEGER[], $2::TEXT[], $3::TEXT[]) AS v(id, password_encrypted, fingerprint)
+WHERE p.id = v.id AND p.user_id = $4
+)~"};
+
+inline constexpr const char* kReencryptPasswordTotpSecrets{R"~(
+UPDATE passwords p SET totp_secret_encrypted = v.totp_secret_encrypted
+FROM UNNEST($1::INTEGER[], $2::TEXT[]) AS v(id, totp_secret_encrypted)
+WHERE p.id = v.id AND p.user_id = $3
+)~"};
+
+inline constexpr const char* kGetPasswordsWithoutFingerprint{R"~(
+SELECT * FROM passwords WHERE user_id = $1 AND fingerprint IS NULL
+)~"};
+
+inline constexpr const char* kSetPasswordFingerprints{R"~(
+UPDATE passwords p SET fingerprint = v.fingerprint
+FROM UNNEST($1::INTEGER[], $2::TEXT[]) AS v(id, fingerprint)
+WHERE p.id = v.id AND p.user_id = $3 AND p.fingerprint IS NULL
+)~"};
+
+inline constexpr const char* kGetReusedPasswords{R"~(
+SELECT ARRAY_AGG(id::BIGINT ORDER BY id), ARRAY_AGG(service ORDER BY id), ARRAY_AGG(login ORDER BY id)
+FROM passwords WHERE user_id = $1 AND fingerprint IS NOT NULL
+GROUP BY fingerprint HAVING COUNT(*) > 1
+ORDER BY MIN(id)
+)~"};
+
+inline constexpr const char* kGetPasswordsWithTotp{R"~(
+SELECT * FROM passwords WHERE user_id = $1 AND totp_secret_encrypted IS NOT NULL ORDER BY id
 )~"};
 
 inline constexpr const char* kGetPassword{R"~(
@@ -26,12 +104,174 @@ inline constexpr const char* kGetPasswords{R"~(
 SELECT * FROM passwords WHERE user_id = $1
 )~"};
 
+// a NULL limit returns all entries
 inline constexpr const char* kSearchPasswords{R"~(
-SELECT * FROM passwords WHERE user_id = $1 AND LOWER(service) LIKE '%' || $2 || '%';
+SELECT * FROM passwords WHERE user_id = $1 AND LOWER(service) LIKE '%' || $2 || '%'
+ORDER BY id
+LIMIT $3
+)~"};
+
+// frecency: the number of uses halved for every week since the last one
+inline constexpr const char* kSearchPasswordsByFrecency{R"~(
+SELECT * FROM passwords WHERE user_id = $1 AND LOWER(service) LIKE '%' || $2 || '%'
+ORDER BY use_count * POWER(0.5, EXTRACT(EPOCH FROM NOW() - COALESCE(last_used_at, created_at)) / 604800) DESC, id
+LIMIT $3
+)~"};
+
+// counts are added rather than assigned, every instance flushes its own uses of the same entries
+inline constexpr const char* kUpdatePasswordUsage{R"~(
+UPDATE passwords p SET use_count = p.use_count + v.use_count, last_used_at = GREATEST(p.last_used_at, v.last_used_at)
+FROM (
+    SELECT u.id, u.use_count, TO_TIMESTAMP(u.last_used_us / 1000000.0) AS last_used_at
+    FROM UNNEST($1::BIGINT[], $2::BIGINT[], $3::BIGINT[]) AS u(id, use_count, last_used_us)
+) AS v
+WHERE p.id = v.id
 )~"};
 
+// leaves a tombstone stamped with the new vault version for delta sync
 inline constexpr const char* kDeletePassword{R"~(
-DELETE FROM passwords WHERE id = $1 AND user_id = $2
+WITH deleted AS (
+    DELETE FROM passwords WHERE id = $1 AND user_id = $2 RETURNING id, user_id
+), version AS (
+    UPDATE users SET vault_version = vault_version + 1 WHERE id IN (SELECT user_id FROM deleted)
+    RETURNING id, vault_version
+), tombstone AS (
+    INSERT INTO password_tombstones (user_id, password_id, change_version)
+    SELECT version.id, deleted.id, version.vault_version FROM deleted, version
+)
+SELECT vault_version FROM version
+)~"};
+
+// the horizon is the newest compacted tombstone, cursors before it cannot be served incrementally
+inline constexpr const char* kGetSyncState{R"~(
+SELECT u.vault_version, COALESCE(h.change_version, 0)
+FROM users u LEFT JOIN password_sync_horizons h ON h.user_id = u.id
+WHERE u.id = $1
+)~"};
+
+inline constexpr const char* kGetChangedPasswords{R"~(
+SELECT * FROM passwords WHERE user_id = $1 AND change_version > $2
+ORDER BY change_version, id
+)~"};
+
+inline constexpr const char* kGetPasswordTombstones{R"~(
+SELECT password_id FROM password_tombstones WHERE user_id = $1 AND change_version > $2
+ORDER BY change_version
+)~"};
+
+// removes a batch of expired tombstones and advances the sync horizons of their owners
+inline constexpr const char* kCompactPasswordTombstones{R"~(
+WITH compacted AS (
+    DELETE FROM password_tombstones WHERE ctid IN (
+        SELECT ctid FROM password_tombstones
+        WHERE deleted_at < NOW() - MAKE_INTERVAL(secs => $1)
+        LIMIT $2
+        FOR UPDATE SKIP LOCKED
+    )
+    RETURNING user_id, change_version
+), horizons AS (
+    INSERT INTO password_sync_horizons (user_id, change_version)
+    SELECT user_id, MAX(change_version) FROM compacted GROUP BY user_id
+    ON CONFLICT (user_id) DO UPDATE
+    SET change_version = GREATEST(password_sync_horizons.change_version, EXCLUDED.change_version)
+)
+SELECT COUNT(*) FROM compacted
+)~"};
+
+inline constexpr const char* kCreateSession{R"~(
+INSERT INTO sessions (id, user_id, data_key_encrypted, expires_at)
+VALUES ($1, $2, $3, NOW() + MAKE_INTERVAL(secs => $4))
+RETURNING expires_at
+)~"};
+
+inline constexpr const char* kGetSession{R"~(
+SELECT user_id, data_key_encrypted, expires_at FROM sessions WHERE id = $1 AND expires_at > NOW()
+)~"};
+
+// every instance drops the session from memory on the notification, see component-sessions
+inline constexpr const char* kRevokeSession{R"~(
+WITH revoked AS (
+    DELETE FROM sessions WHERE id = $1 RETURNING id
+)
+SELECT pg_notify('vaulty_events', 'session:' || id) FROM revoked
+)~"};
+
+inline constexpr const char* kRevokeUserSessions{R"~(
+WITH revoked AS (
+    DELETE FROM sessions WHERE user_id = $1 RETURNING id
+)
+SELECT pg_notify('vaulty_events', 'session:' || id) FROM revoked
+)~"};
+
+inline constexpr const char* kDeleteExpiredSessions{R"~(
+WITH deleted AS (
+    DELETE FROM sessions WHERE ctid IN (
+        SELECT ctid FROM sessions WHERE expires_at < NOW() LIMIT $1 FOR UPDATE SKIP LOCKED
+    )
+    RETURNING 1
+)
+SELECT COUNT(*) FROM deleted
+)~"};
+
+inline constexpr const char* kGetDeletedUsers{R"~(
+SELECT id FROM users WHERE deleted_at IS NOT NULL ORDER BY deleted_at LIMIT $1
+)~"};
+
+// one batch of each table, instances purging the same user skip the rows locked by each other
+inline constexpr const char* kPurgeUserRows{R"~(
+WITH passwords_purged AS (
+    DELETE FROM passwords WHERE id IN (
+        SELECT id FROM passwords WHERE user_id = $1 LIMIT $2 FOR UPDATE SKIP LOCKED
+    )
+    RETURNING 1
+), tombstones_purged AS (
+    DELETE FROM password_tombstones WHERE ctid IN (
+        SELECT ctid FROM password_tombstones WHERE user_id = $1 LIMIT $2 FOR UPDATE SKIP LOCKED
+    )
+    RETURNING 1
+)
+SELECT (SELECT COUNT(*) FROM passwords_purged) + (SELECT COUNT(*) FROM tombstones_purged)
+)~"};
+
+// only once the batches are done, the cascade is then down to a few rows
+inline constexpr const char* kDeletePurgedUser{R"~(
+DELETE FROM users WHERE id = $1 AND deleted_at IS NOT NULL
+    AND NOT EXISTS (SELECT 1 FROM passwords WHERE user_id = $1)
+    AND NOT EXISTS (SELECT 1 FROM password_tombstones WHERE user_id = $1)
+)~"};
+
+inline constexpr const char* kInitReencryptionCheckpoint{R"~(
+INSERT INTO reencryption_checkpoints (target) VALUES ($1) ON CONFLICT DO NOTHING
+)~"};
+
+inline constexpr const char* kLockReencryptionCheckpoint{R"~(
+SELECT primary_key_id, last_id, completed_at FROM reencryption_checkpoints WHERE target = $1 FOR UPDATE SKIP LOCKED
+)~"};
+
+inline constexpr const char* kUpdateReencryptionCheckpoint{R"~(
+UPDATE reencryption_checkpoints SET primary_key_id = $2, last_id = $3, completed_at = $4, updated_at = NOW()
+WHERE target = $1
+)~"};
+
+inline constexpr const char* kGetTotpSecretsBatch{R"~(
+SELECT id, totp_secret FROM users WHERE id > $1 ORDER BY id LIMIT $2
+)~"};
+
+// compare-and-set: rows changed since they were read are left for the next pass
+inline constexpr const char* kReencryptTotpSecrets{R"~(
+UPDATE users u SET totp_secret = v.new_value, updated_at = NOW()
+FROM UNNEST($1::INTEGER[], $2::TEXT[], $3::TEXT[]) AS v(id, old_value, new_value)
+WHERE u.id = v.id AND u.totp_secret = v.old_value
+)~"};
+
+inline constexpr const char* kInsertAuditEvents{R"~(
+INSERT INTO audit_events (created_at, user_id, action, password_id)
+SELECT TO_TIMESTAMP(v.time_us / 1000000.0), v.user_id, v.action, NULLIF(v.password_id, 0)
+FROM UNNEST($1::BIGINT[], $2::INTEGER[], $3::TEXT[], $4::BIGINT[]) AS v(time_us, user_id, action, password_id)
+)~"};
+
+inline constexpr const char* kCreateAuditPartitions{R"~(
+SELECT audit_create_partition(NOW()), audit_create_partition(NOW() + INTERVAL '1 month')
 )~"};
 
 }  // namespace db::sql
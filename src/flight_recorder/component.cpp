@@ -0,0 +1,48 @@
+#include "component.hpp"
+
+#include <userver/components/component.hpp>
+#include <userver/dynamic_config/storage/component.hpp>
+#include <userver/dynamic_config/value.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+namespace {
+
+/// Requests running at least this many milliseconds are recorded, 0 disables recording.
+const userver::dynamic_config::Key<std::int64_t> kSlowRequestThresholdMs{"VAULTY_SLOW_REQUEST_THRESHOLD_MS", 500};
+
+}  // namespace
+
+namespace flight_recorder {
+
+Component::Component(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& context
+)
+    : userver::components::LoggableComponentBase(config, context),
+      config_source_{context.FindComponent<userver::components::DynamicConfig>().GetSource()},
+      recorder_{config["capacity"].As<std::size_t>(256)} {}
+
+Recorder& Component::GetRecorder() { return recorder_; }
+
+std::optional<std::chrono::milliseconds> Component::GetThreshold() const {
+    const auto threshold_ms = config_source_.GetCopy(kSlowRequestThresholdMs);
+    if (threshold_ms <= 0) {
+        return std::nullopt;
+    }
+    return std::chrono::milliseconds{threshold_ms};
+}
+
+userver::yaml_config::Schema Component::GetStaticConfigSchema() {
+    constexpr auto schema = R"(
+        type: object
+        description: slow request flight recorder
+        additionalProperties: false
+        properties:
+            capacity:
+                type: integer
+                description: number of most recent slow requests kept in memory
+    )";
+    return userver::yaml_config::MergeSchemas<userver::components::LoggableComponentBase>(schema);
+}
+
+}  // namespace flight_recorder
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "recorder.hpp"
+
+#include <userver/components/loggable_component_base.hpp>
+#include <userver/dynamic_config/source.hpp>
+
+#include <chrono>
+#include <optional>
+
+namespace flight_recorder {
+
+/// Owns the slow request recorder shared by all API handlers.
+class Component final : public userver::components::LoggableComponentBase {
+public:
+    static constexpr std::string_view kName = "component-flight-recorder";
+
+    Component(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
+
+    Recorder& GetRecorder();
+
+    /// @brief Returns the current VAULTY_SLOW_REQUEST_THRESHOLD_MS, requests at least this slow are recorded.
+    /// @return std::nullopt if recording is disabled.
+    std::optional<std::chrono::milliseconds> GetThreshold() const;
+
+    static userver::yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    const userver::dynamic_config::Source config_source_;
+    Recorder recorder_;
+};
+
+}  // namespace flight_recorder
@@ -0,0 +1,77 @@
+#include "recorder.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+namespace {
+
+static_assert(std::is_trivially_copyable_v<flight_recorder::Record>);
+
+template <std::size_t Size>
+void CopyTruncated(std::string_view value, std::array<char, Size>& destination) noexcept {
+    const auto size = std::min(value.size(), Size - 1);
+    std::memcpy(destination.data(), value.data(), size);
+    destination[size] = '\0';
+}
+
+}  // namespace
+
+namespace flight_recorder {
+
+void Record::SetHandler(std::string_view value) noexcept { CopyTruncated(value, handler); }
+
+void Record::SetMethod(std::string_view value) noexcept { CopyTruncated(value, method); }
+
+void Record::SetPath(std::string_view value) noexcept { CopyTruncated(value.substr(0, value.find('?')), path); }
+
+Recorder::Recorder(std::size_t capacity) : capacity_{capacity}, slots_{std::make_unique<Slot[]>(capacity)} {
+    if (capacity == 0) {
+        throw std::invalid_argument("Flight recorder capacity must be positive");
+    }
+}
+
+void Recorder::Push(const Record& record) noexcept {
+    auto& slot = slots_[next_.fetch_add(1, std::memory_order_relaxed) % capacity_];
+
+    auto sequence = slot.sequence.load(std::memory_order_relaxed);
+    if (sequence % 2 == 1 ||
+        !slot.sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // keeps the record stores from being reordered before the odd sequence store
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(static_cast<void*>(&slot.record), &record, sizeof(Record));
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+std::vector<Record> Recorder::Snapshot() const {
+    const auto next = next_.load(std::memory_order_acquire);
+    const auto count = std::min<std::uint64_t>(next, capacity_);
+
+    std::vector<Record> records;
+    records.reserve(count);
+    for (std::uint64_t i = 1; i <= count; ++i) {
+        const auto& slot = slots_[(next - i) % capacity_];
+
+        const auto before = slot.sequence.load(std::memory_order_acquire);
+        if (before == 0 || before % 2 == 1) {
+            // never written or being written right now
+            continue;
+        }
+
+        Record record;
+        std::memcpy(static_cast<void*>(&record), &slot.record, sizeof(Record));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before) {
+            continue;
+        }
+        records.push_back(record);
+    }
+    return records;
+}
+
+}  // namespace flight_recorder
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "metrics/stages.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace flight_recorder {
+
+/// @brief Timing breakdown of one slow request.
+///
+/// Only non-sensitive data is kept: the path without the query string, the
+/// status and the timings. Request bodies, headers, tokens and usernames are
+/// never recorded. Fixed-size and trivially copyable, so that records can be
+/// copied in and out of the ring buffer without allocations.
+struct Record {
+    static constexpr std::size_t kMaxHandlerSize = 47;
+    static constexpr std::size_t kMaxMethodSize = 7;
+    static constexpr std::size_t kMaxPathSize = 127;
+
+    std::chrono::system_clock::time_point time;
+    std::chrono::steady_clock::duration total{};
+    metrics::RequestTimings timings;
+    std::size_t bytes{0};
+
+    /// HTTP status, 0 if the handler failed with an exception.
+    int status{0};
+
+    std::array<char, kMaxHandlerSize + 1> handler{};
+    std::array<char, kMaxMethodSize + 1> method{};
+    std::array<char, kMaxPathSize + 1> path{};
+
+    void SetHandler(std::string_view value) noexcept;
+    void SetMethod(std::string_view value) noexcept;
+
+    /// @brief Stores the path, dropping the query string and truncating it to kMaxPathSize.
+    void SetPath(std::string_view value) noexcept;
+};
+
+/// @brief Fixed-capacity ring buffer of the most recent slow requests.
+///
+/// Push() and Snapshot() are lock-free. Every slot is a seqlock: a writer makes
+/// the slot sequence odd while it copies the record in, and readers retry or
+/// skip slots whose sequence changed under them. A writer that finds its slot
+/// busy, which only happens when writers lap the whole ring at once, drops its
+/// record instead of waiting.
+class Recorder final {
+public:
+    explicit Recorder(std::size_t capacity);
+
+    void Push(const Record& record) noexcept;
+
+    /// @brief Returns the recorded requests, newest first.
+    std::vector<Record> Snapshot() const;
+
+    std::uint64_t GetDroppedCount() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        std::atomic<std::uint64_t> sequence{0};
+        Record record;
+    };
+
+    const std::size_t capacity_;
+    const std::unique_ptr<Slot[]> slots_;
+    std::atomic<std::uint64_t> next_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+};
+
+}  // namespace flight_recorder
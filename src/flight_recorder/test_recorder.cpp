@@ -0,0 +1,87 @@
+#include "recorder.hpp"
+
+#include <userver/utest/utest.hpp>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace flight_recorder;
+
+namespace {
+
+Record MakeRecord(std::size_t id) {
+    Record record;
+    record.time = std::chrono::system_clock::now();
+    record.status = 200;
+    record.bytes = id;
+    record.timings.rows = id;
+    record.SetHandler("handler-get-passwords");
+    record.SetMethod("GET");
+    record.SetPath("/api/v1/passwords/" + std::to_string(id));
+    return record;
+}
+
+}  // namespace
+
+TEST(FlightRecorderTest, KeepsNewestRecordsFirst) {
+    Recorder recorder{4};
+    EXPECT_TRUE(recorder.Snapshot().empty());
+
+    for (std::size_t i = 0; i < 10; ++i) {
+        recorder.Push(MakeRecord(i));
+    }
+
+    const auto records = recorder.Snapshot();
+    ASSERT_EQ(records.size(), 4);
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        EXPECT_EQ(records[i].bytes, 9 - i);
+        EXPECT_EQ(std::string{records[i].path.data()}, "/api/v1/passwords/" + std::to_string(9 - i));
+    }
+    EXPECT_EQ(recorder.GetDroppedCount(), 0);
+}
+
+TEST(FlightRecorderTest, RedactsQueryAndTruncates) {
+    Record record;
+    record.SetPath("/api/v1/passwords?search_term=bank");
+    EXPECT_EQ(std::string{record.path.data()}, "/api/v1/passwords");
+
+    record.SetPath(std::string(1000, 'a'));
+    EXPECT_EQ(std::string{record.path.data()}.size(), Record::kMaxPathSize);
+
+    record.SetMethod("VERYLONGMETHOD");
+    EXPECT_EQ(std::string{record.method.data()}, "VERYLON");
+}
+
+TEST(FlightRecorderTest, ConcurrentPushAndSnapshot) {
+    Recorder recorder{64};
+    std::atomic<bool> stop{false};
+
+    std::thread reader{[&] {
+        while (!stop) {
+            for (const auto& record : recorder.Snapshot()) {
+                // a torn record would mix fields of different writes
+                ASSERT_EQ(record.bytes, record.timings.rows);
+                ASSERT_EQ(std::string{record.path.data()}, "/api/v1/passwords/" + std::to_string(record.bytes));
+            }
+        }
+    }};
+
+    std::vector<std::thread> writers;
+    for (std::size_t t = 0; t < 4; ++t) {
+        writers.emplace_back([&, t] {
+            for (std::size_t i = 0; i < 10'000; ++i) {
+                recorder.Push(MakeRecord(t * 100'000 + i));
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    stop = true;
+    reader.join();
+
+    EXPECT_EQ(recorder.Snapshot().size(), 64);
+}
+
+TEST(FlightRecorderTest, RejectsZeroCapacity) { EXPECT_THROW(Recorder{0}, std::invalid_argument); }
@@ -0,0 +1,365 @@
+#include "base.hpp"
+#include "audit/component.hpp"
+#include "flight_recorder/component.hpp"
+#include "handlers/auth/auth.hpp"
+#include "json/reader.hpp"
+#include "secure/component.hpp"
+#include "vault/service.hpp"
+
+#include <userver/components/component.hpp>
+#include <userver/components/component_config.hpp>
+#include <userver/components/statistics_storage.hpp>
+#include <userver/engine/task/local_variable.hpp>
+#include <userver/http/common_headers.hpp>
+#include <userver/http/content_type.hpp>
+#include <userver/logging/log.hpp>
+#include <userver/server/handlers/exceptions.hpp>
+#include <userver/server/handlers/json_error_builder.hpp>
+#include <userver/utils/statistics/writer.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+#include <charconv>
+
+namespace {
+
+constexpr std::string_view kContentEncodingHeader = "Content-Encoding";
+constexpr std::string_view kVaryHeader = "Vary";
+constexpr std::string_view kRequestTimeoutHeader = "X-Request-Timeout-Ms";
+
+class BadRequest
+    : public userver::server::handlers::ExceptionWithCode<userver::server::handlers::HandlerErrorCode::kClientError> {
+public:
+    using BaseType::BaseType;
+};
+
+class TooManyRequests
+    : public userver::server::handlers::ExceptionWithCode<userver::server::handlers::HandlerErrorCode::kTooManyRequests> {
+public:
+    using BaseType::BaseType;
+};
+
+class Forbidden
+    : public userver::server::handlers::ExceptionWithCode<userver::server::handlers::HandlerErrorCode::kForbidden> {
+public:
+    using BaseType::BaseType;
+};
+
+class ServiceUnavailable : public userver::server::handlers::ExceptionWithCode<
+                               userver::server::handlers::HandlerErrorCode::kServiceUnavailable> {
+public:
+    using BaseType::BaseType;
+};
+
+class GatewayTimeout : public userver::server::handlers::ExceptionWithCode<
+                           userver::server::handlers::HandlerErrorCode::kGatewayTimeout> {
+public:
+    using BaseType::BaseType;
+};
+
+[[noreturn]] void ThrowHttpError(const vault::Error& error) {
+    userver::server::handlers::ExternalBody body{error.what()};
+    switch (error.GetCode()) {
+        case vault::ErrorCode::kInvalidArgument:
+            throw BadRequest(std::move(body));
+        case vault::ErrorCode::kUnauthenticated:
+            throw userver::server::handlers::Unauthorized(std::move(body));
+        case vault::ErrorCode::kForbidden:
+            throw Forbidden(std::move(body));
+        case vault::ErrorCode::kNotFound:
+            throw userver::server::handlers::ResourceNotFound(std::move(body));
+        case vault::ErrorCode::kUnavailable:
+            throw ServiceUnavailable(std::move(body));
+        case vault::ErrorCode::kDeadlineExceeded:
+            throw GatewayTimeout(std::move(body));
+        case vault::ErrorCode::kResourceExhausted:
+            throw TooManyRequests(std::move(body));
+        case vault::ErrorCode::kInternal:
+            break;
+    }
+    throw userver::server::handlers::InternalServerError(std::move(body));
+}
+
+/// Stage breakdown of the request handled by the current task.
+userver::engine::TaskLocalVariable<metrics::RequestTimings> request_timings;
+
+/// Secure arena of the request handled by the current task.
+userver::engine::TaskLocalVariable<secure::Arena*> request_arena;
+
+/// Deadline of the request handled by the current task.
+userver::engine::TaskLocalVariable<userver::engine::Deadline> request_deadline;
+
+std::unique_ptr<ratelimit::Limiter> MakeLimiter(const userver::yaml_config::YamlConfig& config) {
+    const auto settings = config.As<std::optional<ratelimit::Settings>>();
+    return settings ? std::make_unique<ratelimit::Limiter>(*settings) : nullptr;
+}
+
+}  // namespace
+
+namespace handlers::api {
+
+HandlerBase::HandlerBase(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& context
+)
+    : HttpHandlerBase(config, context),
+      compression_settings_{config["response_compression"].As<std::optional<compression::Settings>>()},
+      request_timeout_{config["request_timeout"].As<std::optional<std::chrono::milliseconds>>()},
+      ip_limiter_{MakeLimiter(config["rate_limit"]["per_ip"])},
+      username_limiter_{MakeLimiter(config["rate_limit"]["per_username"])},
+      flight_recorder_{context.FindComponent<flight_recorder::Component>()},
+      secure_pool_{context.FindComponent<secure::Component>().GetPool()},
+      audit_{context.FindComponent<audit::Component>()},
+      handler_name_{config.Name()} {
+    auto& storage = context.FindComponent<userver::components::StatisticsStorage>().GetStorage();
+    statistics_holder_ = storage.RegisterWriter(
+        "vaulty.handler",
+        [this](userver::utils::statistics::Writer& writer) {
+            writer = statistics_;
+            if (ip_limiter_) {
+                writer["rate-limiter"]["per_ip"] = ip_limiter_->GetStatistics();
+            }
+            if (username_limiter_) {
+                writer["rate-limiter"]["per_username"] = username_limiter_->GetStatistics();
+            }
+        },
+        {{"handler", handler_name_}}
+    );
+}
+
+HandlerBase::~HandlerBase() { statistics_holder_.Unregister(); }
+
+std::string HandlerBase::HandleRequestThrow(
+    const userver::server::http::HttpRequest& request,
+    userver::server::request::RequestContext& context
+) const {
+    const auto start = std::chrono::steady_clock::now();
+    *request_timings = {};
+    *request_deadline = {};
+
+    secure::Arena arena{secure_pool_};
+    *request_arena = &arena;
+    const userver::utils::ScopeGuard reset_arena{[] { *request_arena = nullptr; }};
+
+    if (const auto* jwt_validation_time =
+            context.GetDataOptional<std::chrono::steady_clock::duration>(handlers::auth::kJwtValidationTimeKey)) {
+        AccountStage(metrics::Stage::kJwtValidation, *jwt_validation_time);
+    }
+
+    std::string body;
+    try {
+        body = ProcessRequest(request, context);
+    } catch (...) {
+        RecordIfSlow(request, start, 0, 0);
+        throw;
+    }
+
+    statistics_.AccountBytes(body.size());
+    RecordIfSlow(request, start, static_cast<int>(request.GetHttpResponse().GetStatus()), body.size());
+    return body;
+}
+
+std::string HandlerBase::ProcessRequest(
+    const userver::server::http::HttpRequest& request,
+    userver::server::request::RequestContext& context
+) const {
+    request.GetHttpResponse().SetContentType(userver::http::content_type::kApplicationJson);
+
+    if (ip_limiter_) {
+        const auto address = request.GetRemoteAddress().PrimaryAddressString();
+        if (!ip_limiter_->TryAcquire(address)) {
+            LOG_WARNING() << "Rate limit exceeded for address: " << address;
+            throw TooManyRequests(userver::server::handlers::ExternalBody{"Too many requests"});
+        }
+    }
+    *request_deadline = MakeDeadline(request);
+
+    std::string body;
+    try {
+        body = HandleApiRequestThrow(request, context);
+    } catch (const json::ParseError& ex) {
+        LOG_WARNING() << "Invalid request body: " << ex.what();
+        throw BadRequest(userver::server::handlers::ExternalBody{ex.what()});
+    } catch (const vault::Error& error) {
+        ThrowHttpError(error);
+    }
+    if (compression_settings_) {
+        return CompressResponse(request, std::move(body));
+    }
+    return body;
+}
+
+userver::engine::Deadline HandlerBase::MakeDeadline(const userver::server::http::HttpRequest& request) const {
+    auto timeout = request_timeout_;
+
+    const auto& header = request.GetHeader(kRequestTimeoutHeader);
+    if (!header.empty()) {
+        std::int64_t value = 0;
+        const auto [end, error] = std::from_chars(header.data(), header.data() + header.size(), value);
+        if (error != std::errc{} || end != header.data() + header.size() || value <= 0) {
+            throw BadRequest(
+                userver::server::handlers::ExternalBody{"X-Request-Timeout-Ms must be a positive integer"}
+            );
+        }
+        // the client may only ask for less time than the handler allows
+        const std::chrono::milliseconds client_timeout{value};
+        timeout = timeout ? std::min(*timeout, client_timeout) : client_timeout;
+    }
+
+    if (!timeout) {
+        return {};
+    }
+    // time spent waiting in the queue counts against the budget too
+    return userver::engine::Deadline::FromTimePoint(request.GetStartTime() + *timeout);
+}
+
+void HandlerBase::RecordIfSlow(
+    const userver::server::http::HttpRequest& request,
+    std::chrono::steady_clock::time_point start,
+    int status,
+    std::size_t bytes
+) const {
+    const auto threshold = flight_recorder_.GetThreshold();
+    if (!threshold) {
+        return;
+    }
+
+    const auto& timings = *request_timings;
+    // token validation runs in the auth checker, before this handler is called
+    const auto total = std::chrono::steady_clock::now() - start +
+                       timings.stages[static_cast<std::size_t>(metrics::Stage::kJwtValidation)];
+    if (total < *threshold) {
+        return;
+    }
+
+    flight_recorder::Record record;
+    record.time = std::chrono::system_clock::now();
+    record.total = total;
+    record.timings = timings;
+    record.bytes = bytes;
+    record.status = status;
+    record.SetHandler(handler_name_);
+    record.SetMethod(request.GetMethodStr());
+    record.SetPath(request.GetRequestPath());
+    flight_recorder_.GetRecorder().Push(record);
+}
+
+void HandlerBase::AccountStage(metrics::Stage stage, std::chrono::steady_clock::duration duration) const {
+    statistics_.Account(stage, duration);
+    request_timings->stages[static_cast<std::size_t>(stage)] += duration;
+}
+
+void HandlerBase::AccountRows(std::size_t rows) const {
+    statistics_.AccountRows(rows);
+    request_timings->rows += rows;
+}
+
+secure::Arena& HandlerBase::GetSecureArena() const { return **request_arena; }
+
+userver::engine::Deadline HandlerBase::GetDeadline() const { return *request_deadline; }
+
+void HandlerBase::CheckDeadline() const { vault::CheckDeadline(*request_deadline); }
+
+void HandlerBase::Audit(audit::Action action, std::int32_t user_id, std::int64_t password_id) const {
+    audit_.Push({std::chrono::system_clock::now(), user_id, action, password_id});
+}
+
+void HandlerBase::CheckUsernameRateLimit(std::string_view username) const {
+    if (username_limiter_ && !username_limiter_->TryAcquire(username)) {
+        LOG_WARNING() << "Rate limit exceeded for user: " << username;
+        throw TooManyRequests(userver::server::handlers::ExternalBody{"Too many requests"});
+    }
+}
+
+userver::server::handlers::FormattedErrorData HandlerBase::GetFormattedExternalErrorBody(
+    const userver::server::handlers::CustomHandlerException& exc
+) const {
+    const userver::server::handlers::JsonErrorBuilder error_builder{exc};
+    return {error_builder.GetExternalBody(), userver::server::handlers::JsonErrorBuilder::GetContentType()};
+}
+
+std::string HandlerBase::CompressResponse(const userver::server::http::HttpRequest& request, std::string body) const {
+    auto& response = request.GetHttpResponse();
+    // the representation depends on Accept-Encoding even when this particular response is not compressed
+    response.SetHeader(std::string{kVaryHeader}, "Accept-Encoding");
+
+    if (body.size() < compression_settings_->min_size) {
+        return body;
+    }
+
+    const auto encoding = compression::Negotiate(request.GetHeader(userver::http::headers::kAcceptEncoding));
+    if (encoding == compression::Encoding::kIdentity) {
+        return body;
+    }
+
+    auto compressed = compression::Compress(body, encoding, compression_settings_->GetLevel(encoding));
+    LOG_DEBUG() << "Compressed response with " << compression::ToString(encoding) << ": " << body.size() << " -> "
+                << compressed.size() << " bytes";
+
+    response.SetHeader(std::string{kContentEncodingHeader}, std::string{compression::ToString(encoding)});
+    return compressed;
+}
+
+userver::yaml_config::Schema HandlerBase::GetStaticConfigSchema() {
+    constexpr auto schema = R"(
+        type: object
+        description: API handler
+        additionalProperties: false
+        properties:
+            request_timeout:
+                type: string
+                description: |
+                    time budget of a request, counted from its arrival; clients can only shorten it with the
+                    X-Request-Timeout-Ms header
+                defaultDescription: no limit
+            response_compression:
+                type: object
+                description: Accept-Encoding negotiated gzip/zstd compression of response bodies
+                additionalProperties: false
+                properties:
+                    min_size:
+                        type: integer
+                        description: responses smaller than this many bytes are sent uncompressed
+                    gzip_level:
+                        type: integer
+                        description: zlib compression level (1-9)
+                    zstd_level:
+                        type: integer
+                        description: zstd compression level (1-19)
+            rate_limit:
+                type: object
+                description: token bucket limits, over-limit requests are answered with 429
+                additionalProperties: false
+                properties:
+                    per_ip:
+                        type: object
+                        description: limit per client address, checked before the request is parsed
+                        additionalProperties: false
+                        properties:
+                            burst:
+                                type: integer
+                                description: bucket capacity
+                            rate_per_second:
+                                type: number
+                                description: tokens returned to a bucket per second
+                            max_keys:
+                                type: integer
+                                description: maximum number of tracked keys, the idlest ones are dropped above it
+                    per_username:
+                        type: object
+                        description: limit per username from the request body
+                        additionalProperties: false
+                        properties:
+                            burst:
+                                type: integer
+                                description: bucket capacity
+                            rate_per_second:
+                                type: number
+                                description: tokens returned to a bucket per second
+                            max_keys:
+                                type: integer
+                                description: maximum number of tracked keys, the idlest ones are dropped above it
+    )";
+    return userver::yaml_config::MergeSchemas<userver::server::handlers::HttpHandlerBase>(schema);
+}
+
+}  // namespace handlers::api
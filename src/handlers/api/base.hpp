@@ -0,0 +1,163 @@
+#pragma once
+
+#include "audit/event.hpp"
+#include "compression/codec.hpp"
+#include "metrics/stages.hpp"
+#include "ratelimit/limiter.hpp"
+
+#include <userver/engine/deadline.hpp>
+#include <userver/server/handlers/http_handler_base.hpp>
+#include <userver/utils/scope_guard.hpp>
+#include <userver/utils/statistics/entry.hpp>
+
+#include <chrono>
+#include <memory>
+#include <optional>
+
+namespace audit {
+
+class Component;
+
+}  // namespace audit
+
+namespace flight_recorder {
+
+class Component;
+
+}  // namespace flight_recorder
+
+namespace secure {
+
+class Arena;
+class Pool;
+
+}  // namespace secure
+
+namespace handlers::api {
+
+/// Base class for API handlers that render their JSON response body themselves.
+///
+/// Unlike userver::server::handlers::HttpHandlerJsonBase it does not force the
+/// response through a formats::json::Value, so handlers are free to answer with
+/// an empty body (e.g. 304 Not Modified) or a pre-serialized string. Errors are
+/// still reported in the usual {"code": ..., "message": ...} JSON form.
+///
+/// When the handler config has a `response_compression` section, bodies above
+/// its size threshold are compressed with the encoding negotiated from
+/// Accept-Encoding.
+///
+/// A `rate_limit` section enables token bucket limits per client IP, checked
+/// before the handler runs, and per username, checked by the handler through
+/// CheckUsernameRateLimit(). Over-limit requests get 429 Too Many Requests.
+///
+/// Per-stage latency histograms and response volume counters are exported as
+/// `vaulty.handler` with a `handler` label; handlers time their stages with
+/// TimeStage(). Requests slower than VAULTY_SLOW_REQUEST_THRESHOLD_MS are
+/// recorded with their stage breakdown by the flight recorder.
+///
+/// Master keys and decrypted secrets are allocated in a per-request arena of
+/// locked memory (GetSecureArena()), wiped when the request ends.
+///
+/// Accesses to passwords are recorded with Audit(), which only enqueues the
+/// event for the asynchronous audit writer.
+///
+/// Each request gets a deadline from the `request_timeout` of the handler config
+/// and the client's X-Request-Timeout-Ms header, whichever is shorter, counted
+/// from the arrival of the request. TimeStage() checks it, and the cancellation
+/// of the task, before every stage; loops over many rows call CheckDeadline()
+/// every vault::kDeadlineCheckRows rows. Requests past their deadline get
+/// 504 Gateway Timeout.
+///
+/// json::ParseError thrown by the handler is reported as 400 Bad Request and
+/// vault::Error with the HTTP status matching its code.
+class HandlerBase : public userver::server::handlers::HttpHandlerBase {
+public:
+    HandlerBase(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
+    ~HandlerBase() override;
+
+    std::string HandleRequestThrow(
+        const userver::server::http::HttpRequest& request,
+        userver::server::request::RequestContext& context
+    ) const final;
+
+    static userver::yaml_config::Schema GetStaticConfigSchema();
+
+protected:
+    /// Returns the serialized JSON response body.
+    virtual std::string HandleApiRequestThrow(
+        const userver::server::http::HttpRequest& request,
+        userver::server::request::RequestContext& context
+    ) const = 0;
+
+    /// @brief Takes a token from the bucket of the username, if limiting by username is configured.
+    ///
+    /// Must be called before any database or crypto work on behalf of the user.
+    ///
+    /// @throws ExceptionWithCode<kTooManyRequests> If the username is over its limit.
+    void CheckUsernameRateLimit(std::string_view username) const;
+
+    /// @brief Calls the function and accounts its duration to the stage.
+    /// @throws vault::Error kDeadlineExceeded If the request is past its deadline or cancelled.
+    template <typename Func>
+    decltype(auto) TimeStage(metrics::Stage stage, Func&& func) const {
+        CheckDeadline();
+        const userver::utils::ScopeGuard account{[this, stage, start = std::chrono::steady_clock::now()] {
+            AccountStage(stage, std::chrono::steady_clock::now() - start);
+        }};
+        return std::forward<Func>(func)();
+    }
+
+    /// @brief Returns the deadline of the current request, unreachable if it has no timeout.
+    userver::engine::Deadline GetDeadline() const;
+
+    /// @brief Stops the request if it is past its deadline or its task was cancelled.
+    /// @throws vault::Error kDeadlineExceeded
+    void CheckDeadline() const;
+
+    /// @brief Accounts the number of entries returned by the request.
+    void AccountRows(std::size_t rows) const;
+
+    /// @brief Returns the arena for secrets of the current request.
+    ///
+    /// Everything allocated in it is wiped once the response body is produced.
+    secure::Arena& GetSecureArena() const;
+
+    /// @brief Records an access to the vault of the user in the audit trail.
+    void Audit(audit::Action action, std::int32_t user_id, std::int64_t password_id = 0) const;
+
+    userver::server::handlers::FormattedErrorData GetFormattedExternalErrorBody(
+        const userver::server::handlers::CustomHandlerException& exc
+    ) const override;
+
+private:
+    std::string ProcessRequest(
+        const userver::server::http::HttpRequest& request,
+        userver::server::request::RequestContext& context
+    ) const;
+
+    userver::engine::Deadline MakeDeadline(const userver::server::http::HttpRequest& request) const;
+
+    void RecordIfSlow(
+        const userver::server::http::HttpRequest& request,
+        std::chrono::steady_clock::time_point start,
+        int status,
+        std::size_t bytes
+    ) const;
+
+    void AccountStage(metrics::Stage stage, std::chrono::steady_clock::duration duration) const;
+
+    std::string CompressResponse(const userver::server::http::HttpRequest& request, std::string body) const;
+
+    const std::optional<compression::Settings> compression_settings_;
+    const std::optional<std::chrono::milliseconds> request_timeout_;
+    const std::unique_ptr<ratelimit::Limiter> ip_limiter_;
+    const std::unique_ptr<ratelimit::Limiter> username_limiter_;
+    mutable metrics::HandlerStatistics statistics_;
+    flight_recorder::Component& flight_recorder_;
+    secure::Pool& secure_pool_;
+    audit::Component& audit_;
+    const std::string handler_name_;
+    userver::utils::statistics::Entry statistics_holder_;
+};
+
+}  // namespace handlers::api
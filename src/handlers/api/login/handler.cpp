@@ -1,17 +1,12 @@
 #include "handler.hpp"
-#include "crypto/component.hpp"
 #include "crypto/utils.hpp"
-#include "db/sql.hpp"
-#include "jwt/component.hpp"
-#include "models/user.hpp"
-#include "totp/utils.hpp"
+#include "json/requests.hpp"
+#include "secure/arena.hpp"
+#include "vault/component.hpp"
 
 #include <userver/components/component.hpp>
-#include <userver/crypto/base64.hpp>
-#include <userver/formats/json/value.hpp>
-#include <userver/formats/json/value_builder.hpp>
-#include <userver/storages/postgres/cluster.hpp>
-#include <userver/storages/postgres/component.hpp>
+#include <userver/formats/json/string_builder.hpp>
+#include <userver/logging/log.hpp>
 
 namespace handlers::api::login::post {
 
@@ -19,65 +14,60 @@ Handler::Handler(
     const userver::components::ComponentConfig& config,
     const userver::components::ComponentContext& context
 )
-    : HttpHandlerJsonBase(config, context),
-      pg_cluster_{context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()},
-      jwt_client_{context.FindComponent<jwt::Component>().GetClient()},
-      key_{context.FindComponent<crypto::Component>().GetDecodedKey("aes256_base64_key")} {}
+    : HandlerBase(config, context), service_{context.FindComponent<vault::Component>().GetService()} {}
 
-userver::formats::json::Value Handler::HandleRequestJsonThrow(
-    [[maybe_unused]] const userver::server::http::HttpRequest& request,
-    const userver::formats::json::Value& body,
+std::string Handler::HandleApiRequestThrow(
+    const userver::server::http::HttpRequest& request,
     [[maybe_unused]] userver::server::request::RequestContext& context
 ) const {
     LOG_INFO() << "Received authentication request";
 
-    const auto username = body["username"].As<std::string>();
-    LOG_DEBUG() << "Username: " << username;
+    auto body = json::ParseAuthRequest(request.RequestBody());
+    LOG_DEBUG() << "Username: " << body.username;
+    CheckUsernameRateLimit(body.username);
 
-    const auto master_key_encoded = body["master_key"].As<std::string>();
-    const uint32_t totp_code = std::stoul(body["totp_code"].As<std::string>());
-    const auto master_key = userver::crypto::base64::Base64Decode(master_key_encoded);
+    auto& arena = GetSecureArena();
+    const auto master_key = crypto::Base64Decode(body.master_key, arena);
+    secure::Wipe(body.master_key);
     LOG_DEBUG() << "Decoded master key and TOTP code";
 
-    // Fetch user from database
-    const auto result =
-        pg_cluster_->Execute(userver::storages::postgres::ClusterHostType::kSlave, db::sql::kGetUser, username);
+    const auto token = service_.Authenticate(body.username, master_key, body.totp_code, arena);
 
-    if (result.IsEmpty()) {
-        LOG_WARNING() << "Unknown user: " << username;
-        throw userver::server::handlers::Unauthorized(userver::server::handlers::ExternalBody{"Unknown user"});
+    userver::formats::json::StringBuilder response;
+    {
+        const userver::formats::json::StringBuilder::ObjectGuard guard{response};
+        response.Key("token");
+        response.WriteString(token);
     }
+    return response.GetString();
+}
 
-    const auto user = result.AsSingleRow<models::User>(userver::storages::postgres::kRowTag);
-    LOG_DEBUG() << "User found in database: " << user.id;
+}  // namespace handlers::api::login::post
 
-    // verify master key
-    const auto salt = userver::crypto::base64::Base64Decode(user.salt_encoded);
-    if (!crypto::VerifyMasterKeyHashWithSalt(master_key, salt, user.master_key_hash)) {
-        LOG_WARNING() << "Invalid master key for user: " << username;
-        throw userver::server::handlers::Unauthorized(
-            userver::server::handlers::ExternalBody{"Invalid master key or TOTP code"}
-        );
-    }
+namespace handlers::api::login::del {
 
-    // verify TOTP code
-    if (!totp::VerifyTotpCode(user.totp_secret, totp_code)) {
-        LOG_WARNING() << "Invalid TOTP code for user: " << username;
-        throw userver::server::handlers::Unauthorized(
-            userver::server::handlers::ExternalBody{"Invalid master key or TOTP code"}
-        );
-    }
+Handler::Handler(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& context
+)
+    : HandlerBase(config, context), service_{context.FindComponent<vault::Component>().GetService()} {}
 
-    jwt::Payload jwt_payload;
-    jwt_payload.user_id = user.id;
-    jwt_payload.master_key = crypto::Encrypt(master_key, key_);
-    const auto token = jwt_client_.GenerateToken(jwt_payload);
+std::string Handler::HandleApiRequestThrow(
+    const userver::server::http::HttpRequest& /*request*/,
+    userver::server::request::RequestContext& context
+) const {
+    LOG_INFO() << "Received logout request";
 
-    LOG_INFO() << "JWT token generated successfully for user: " << username;
+    const auto& session = context.GetData<vault::Session>("session");
+    service_.Logout(session);
 
-    userver::formats::json::ValueBuilder builder;
-    builder["token"] = token;
-    return builder.ExtractValue();
+    userver::formats::json::StringBuilder response;
+    {
+        const userver::formats::json::StringBuilder::ObjectGuard guard{response};
+        response.Key("message");
+        response.WriteString("Logged out successfully");
+    }
+    return response.GetString();
 }
 
-}  // namespace handlers::api::login::post
+}  // namespace handlers::api::login::del
@@ -1,32 +1,47 @@
 #pragma once
 
-#include <userver/server/handlers/http_handler_json_base.hpp>
-#include <userver/storages/postgres/postgres_fwd.hpp>
+#include "handlers/api/base.hpp"
 
-namespace jwt {
+namespace vault {
 
-class Client;
+class Service;
 
-}  // namespace jwt
+}  // namespace vault
 
 namespace handlers::api::login::post {
 
-class Handler final : public userver::server::handlers::HttpHandlerJsonBase {
+class Handler final : public handlers::api::HandlerBase {
 public:
     static constexpr std::string_view kName = "handler-post-auth";
 
     Handler(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
 
-    userver::formats::json::Value HandleRequestJsonThrow(
+    std::string HandleApiRequestThrow(
         const userver::server::http::HttpRequest& request,
-        const userver::formats::json::Value& body,
         userver::server::request::RequestContext& context
     ) const override;
 
 private:
-    userver::storages::postgres::ClusterPtr pg_cluster_;
-    const jwt::Client& jwt_client_;
-    const std::string key_;
+    const vault::Service& service_;
 };
 
-}  // namespace handlers::api::login::post
\ No newline at end of file
+}  // namespace handlers::api::login::post
+namespace handlers::api::login::del {
+
+/// Logs the caller out by revoking their opaque session.
+class Handler final : public handlers::api::HandlerBase {
+public:
+    static constexpr std::string_view kName = "handler-delete-auth";
+
+    Handler(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
+
+    std::string HandleApiRequestThrow(
+        const userver::server::http::HttpRequest& request,
+        userver::server::request::RequestContext& context
+    ) const override;
+
+private:
+    const vault::Service& service_;
+};
+
+}  // namespace handlers::api::login::del
@@ -1,36 +1,121 @@
 #include "handler.hpp"
-#include "crypto/component.hpp"
-#include "crypto/utils.hpp"
-#include "db/sql.hpp"
-#include "models/password.hpp"
+#include "json/requests.hpp"
+#include "json/writer.hpp"
+#include "secure/arena.hpp"
+#include "vault/component.hpp"
 
 #include <userver/components/component.hpp>
-#include <userver/crypto/base64.hpp>
-#include <userver/formats/json/value.hpp>
-#include <userver/formats/json/value_builder.hpp>
-#include <userver/server/handlers/exceptions.hpp>
-#include <userver/storages/postgres/cluster.hpp>
-#include <userver/storages/postgres/component.hpp>
+#include <userver/components/statistics_storage.hpp>
+#include <userver/formats/json/string_builder.hpp>
+#include <userver/logging/log.hpp>
+#include <userver/utils/statistics/writer.hpp>
 #include <userver/utils/text.hpp>
 
+#include <fmt/format.h>
+
+#include <charconv>
+
 namespace {
 
-class Forbidden
-    : public userver::server::handlers::ExceptionWithCode<userver::server::handlers::HandlerErrorCode::kForbidden> {
-public:
-    using BaseType::BaseType;
-};
+constexpr std::string_view kETagHeader = "ETag";
+constexpr std::string_view kIfNoneMatchHeader = "If-None-Match";
+
+/// Weak, the same listing is sent as gzip, zstd or identity bodies that are not byte-for-byte equal.
+std::string FormatETag(std::int64_t vault_version) { return fmt::format("W/\"{}\"", vault_version); }
+
+std::string_view RemoveWeakPrefix(std::string_view etag) {
+    if (etag.starts_with("W/")) {
+        etag.remove_prefix(2);
+    }
+    return etag;
+}
+
+/// Checks whether the If-None-Match header value (a list of entity tags or "*") matches the given tag.
+/// Tags are compared weakly, as RFC 9110 requires for If-None-Match.
+bool MatchesETag(std::string_view if_none_match, std::string_view etag) {
+    etag = RemoveWeakPrefix(etag);
+    while (!if_none_match.empty()) {
+        const auto separator = if_none_match.find(',');
+        auto candidate = if_none_match.substr(0, separator);
+        if_none_match.remove_prefix(separator == std::string_view::npos ? if_none_match.size() : separator + 1);
+
+        const auto begin = candidate.find_first_not_of(' ');
+        if (begin == std::string_view::npos) {
+            continue;
+        }
+        candidate = candidate.substr(begin, candidate.find_last_not_of(' ') - begin + 1);
+        candidate = RemoveWeakPrefix(candidate);
+        if (candidate == "*" || candidate == etag) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// Reads the `since` query argument of a sync, 0 (a full sync) if it is not set.
+std::int64_t ParseCursor(const userver::server::http::HttpRequest& request) {
+    const auto& since = request.GetArg("since");
+    std::int64_t cursor = 0;
+    if (!since.empty()) {
+        const auto [end, error] = std::from_chars(since.data(), since.data() + since.size(), cursor);
+        if (error != std::errc{} || end != since.data() + since.size() || cursor < 0) {
+            throw vault::Error(vault::ErrorCode::kInvalidArgument, "Cursor must be a non-negative integer");
+        }
+    }
+    return cursor;
+}
+
+/// Identical listings of one user, the search term goes last as it may contain anything.
+///
+/// The write generation keeps a listing from joining one that started before a write the client has already seen
+/// completed, that one may miss it.
+std::string MakeListingKey(
+    std::int32_t user_id,
+    std::uint64_t write_generation,
+    const vault::ListOptions& options,
+    std::string_view search_term
+) {
+    return fmt::format(
+        "{}\n{}\n{}\n{}\n{}",
+        user_id,
+        write_generation,
+        static_cast<int>(options.order),
+        options.limit.value_or(-1),
+        search_term
+    );
+}
+
+/// Reads the `order` and `limit` query arguments of a listing.
+vault::ListOptions ParseListOptions(const userver::server::http::HttpRequest& request) {
+    vault::ListOptions options;
+
+    const auto& order = request.GetArg("order");
+    if (order == "frecency") {
+        options.order = vault::Order::kFrecency;
+    } else if (!order.empty() && order != "id") {
+        throw vault::Error(vault::ErrorCode::kInvalidArgument, "Unknown order, expected 'id' or 'frecency'");
+    }
+
+    const auto& limit = request.GetArg("limit");
+    if (!limit.empty()) {
+        std::int64_t value = 0;
+        const auto [end, error] = std::from_chars(limit.data(), limit.data() + limit.size(), value);
+        if (error != std::errc{} || end != limit.data() + limit.size() || value <= 0) {
+            throw vault::Error(vault::ErrorCode::kInvalidArgument, "Limit must be a positive integer");
+        }
+        options.limit = value;
+    }
+    return options;
+}
 
-userver::formats::json::Value SerializePassword(const models::Password& password, const std::string& decrypted) {
-    userver::formats::json::ValueBuilder builder;
-    builder["id"] = password.id;
-    builder["user_id"] = password.user_id;
-    builder["service"] = password.service;
-    builder["login"] = password.login;
-    builder["password"] = decrypted;
-    builder["created_at"] = password.created_at;
-    builder["updated_at"] = password.updated_at;
-    return builder.ExtractValue();
+std::string MessageResponse(std::string_view message) {
+    userver::formats::json::StringBuilder response;
+    {
+        const userver::formats::json::StringBuilder::ObjectGuard guard{response};
+        response.Key("message");
+        response.WriteString(message);
+    }
+    return response.GetString();
 }
 
 }  // namespace
@@ -41,47 +126,39 @@ Handler::Handler(
     const userver::components::ComponentConfig& config,
     const userver::components::ComponentContext& context
 )
-    : HttpHandlerJsonBase(config, context),
-      pg_cluster_{context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()},
-      key_{context.FindComponent<crypto::Component>().GetDecodedKey("aes256_base64_key")} {}
+    : HandlerBase(config, context), service_{context.FindComponent<vault::Component>().GetService()} {}
 
-userver::formats::json::Value Handler::HandleRequestJsonThrow(
+std::string Handler::HandleApiRequestThrow(
     const userver::server::http::HttpRequest& request,
-    [[maybe_unused]] const userver::formats::json::Value& body,
     userver::server::request::RequestContext& context
 ) const {
     LOG_INFO() << "Received request to retrieve a password";
 
-    const auto user_id = context.GetData<std::int32_t>("user_id");
-    const auto master_key = crypto::Decrypt(context.GetData<std::string>("master_key"), key_);
+    const auto& session = context.GetData<vault::Session>("session");
+    auto& arena = GetSecureArena();
+    const auto data_key =
+        TimeStage(metrics::Stage::kMasterKeyDecrypt, [&] { return service_.OpenDataKey(session, arena); });
 
     const auto password_id = std::stoll(request.GetPathArg("id"));
-
-    const auto result = pg_cluster_->Execute(
-        userver::storages::postgres::ClusterHostType::kSlave, db::sql::kGetPassword, password_id, user_id
-    );
-
-    if (result.IsEmpty()) {
-        LOG_WARNING() << "Password not found for ID: " << password_id;
-        throw userver::server::handlers::ResourceNotFound(userver::server::handlers::ExternalBody{"Password not found"}
-        );
-    }
-
-    const auto password = result.AsSingleRow<models::Password>(userver::storages::postgres::kRowTag);
-    if (password.user_id != user_id) {
-        LOG_WARNING() << "Access denied for password ID: " << password_id;
-        throw Forbidden(userver::server::handlers::ExternalBody{"Access denied"});
-    }
-
-    const auto password_decrypted =
-        crypto::Decrypt(userver::crypto::base64::Base64Decode(password.password_encrypted), master_key);
+    const auto password = TimeStage(metrics::Stage::kDatabase, [&] {
+        return service_.GetPassword(session.user_id, password_id, GetDeadline());
+    });
+    const auto password_decrypted = TimeStage(metrics::Stage::kRowDecrypt, [&] {
+        return vault::Service::DecryptPassword(password, data_key, arena);
+    });
 
     LOG_DEBUG() << "Password decrypted successfully for ID: " << password_id;
 
-    const auto response = SerializePassword(password, password_decrypted);
+    auto body = TimeStage(metrics::Stage::kSerialization, [&] {
+        userver::formats::json::StringBuilder response;
+        json::WritePassword(password, password_decrypted, response);
+        return response.GetString();
+    });
+    AccountRows(1);
+    Audit(audit::Action::kRead, session.user_id, password.id);
     LOG_INFO() << "Password retrieved successfully for ID: " << password_id;
 
-    return response;
+    return body;
 }
 
 }  // namespace handlers::api::password::get
@@ -92,39 +169,95 @@ Handler::Handler(
     const userver::components::ComponentConfig& config,
     const userver::components::ComponentContext& context
 )
-    : HttpHandlerJsonBase(config, context),
-      pg_cluster_{context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()},
-      key_{context.FindComponent<crypto::Component>().GetDecodedKey("aes256_base64_key")} {}
+    : HandlerBase(config, context), service_{context.FindComponent<vault::Component>().GetService()} {
+    auto& storage = context.FindComponent<userver::components::StatisticsStorage>().GetStorage();
+    listings_statistics_holder_ =
+        storage.RegisterWriter("vaulty.coalesced_listings", [this](userver::utils::statistics::Writer& writer) {
+            const auto& statistics = listings_.GetStatistics();
+            writer["in_flight"] = listings_.GetInFlight();
+            writer["executed"] = statistics.executed.load();
+            writer["joined"] = statistics.joined.load();
+            writer["fallbacks"] = statistics.fallbacks.load();
+        });
+}
 
-userver::formats::json::Value Handler::HandleRequestJsonThrow(
+Handler::~Handler() { listings_statistics_holder_.Unregister(); }
+
+std::string Handler::HandleApiRequestThrow(
     const userver::server::http::HttpRequest& request,
-    [[maybe_unused]] const userver::formats::json::Value& body,
     userver::server::request::RequestContext& context
 ) const {
     LOG_INFO() << "Received request to retrieve passwords";
 
-    const auto user_id = context.GetData<std::int32_t>("user_id");
-    const auto master_key = crypto::Decrypt(context.GetData<std::string>("master_key"), key_);
-    const auto search_term = userver::utils::text::ToLower(request.GetArg("search_term"));
-
-    const auto result = pg_cluster_->Execute(
-        userver::storages::postgres::ClusterHostType::kSlave, db::sql::kSearchPasswords, user_id, search_term
-    );
-    const auto passwords = result.AsContainer<std::vector<models::Password>>(userver::storages::postgres::kRowTag);
-
-    userver::formats::json::ValueBuilder response(userver::formats::common::Type::kArray);
-    for (const auto& password : passwords) {
-        const auto password_decrypted =
-            crypto::Decrypt(userver::crypto::base64::Base64Decode(password.password_encrypted), master_key);
-
-        LOG_DEBUG() << "Password decrypted successfully for ID: " << password.id;
-
-        response.PushBack(SerializePassword(password, password_decrypted));
+    const auto& session = context.GetData<vault::Session>("session");
+    const auto options = ParseListOptions(request);
+    // frecency changes with reads that do not bump the vault version
+    const bool cacheable = options.order != vault::Order::kFrecency;
+
+    // Cheap path for pollers: a single version lookup and no row fetch, decrypt or serialization
+    const auto& if_none_match = request.GetHeader(kIfNoneMatchHeader);
+    if (cacheable && !if_none_match.empty()) {
+        const auto etag = FormatETag(TimeStage(metrics::Stage::kDatabase, [&] {
+            return service_.GetVaultVersion(session.user_id, GetDeadline());
+        }));
+        if (MatchesETag(if_none_match, etag)) {
+            LOG_DEBUG() << "Vault is not modified for user ID: " << session.user_id;
+            request.GetHttpResponse().SetHeader(std::string{kETagHeader}, etag);
+            request.SetResponseStatus(userver::server::http::HttpStatus::kNotModified);
+            return {};
+        }
     }
 
+    const auto search_term = userver::utils::text::ToLower(request.GetArg("search_term"));
+    // duplicates of a listing in flight (retries, double taps) wait for it and get the same body
+    const auto key =
+        MakeListingKey(session.user_id, service_.GetWriteGeneration(session.user_id), options, search_term);
+    const auto listing = listings_.Run(key, GetDeadline(), [&] {
+        auto& arena = GetSecureArena();
+        const auto data_key =
+            TimeStage(metrics::Stage::kMasterKeyDecrypt, [&] { return service_.OpenDataKey(session, arena); });
+        const auto snapshot = TimeStage(metrics::Stage::kDatabase, [&] {
+            return service_.ListPasswords(session.user_id, search_term, options, GetDeadline());
+        });
+
+        // an abandoned request stops within vault::kDeadlineCheckRows rows instead of finishing the whole vault
+        std::vector<std::string_view> passwords_decrypted;
+        passwords_decrypted.reserve(snapshot.passwords.size());
+        TimeStage(metrics::Stage::kRowDecrypt, [&] {
+            for (const auto& password : snapshot.passwords) {
+                if (passwords_decrypted.size() % vault::kDeadlineCheckRows == 0) {
+                    CheckDeadline();
+                }
+                passwords_decrypted.push_back(vault::Service::DecryptPassword(password, data_key, arena));
+
+                LOG_DEBUG() << "Password decrypted successfully for ID: " << password.id;
+            }
+        });
+
+        auto body = TimeStage(metrics::Stage::kSerialization, [&] {
+            userver::formats::json::StringBuilder response;
+            {
+                const userver::formats::json::StringBuilder::ArrayGuard guard{response};
+                for (std::size_t i = 0; i < snapshot.passwords.size(); ++i) {
+                    if (i % vault::kDeadlineCheckRows == 0) {
+                        CheckDeadline();
+                    }
+                    json::WritePassword(snapshot.passwords[i], passwords_decrypted[i], response);
+                }
+            }
+            return response.GetString();
+        });
+        return Listing{std::move(body), snapshot.version, snapshot.passwords.size()};
+    });
+    AccountRows(listing->rows);
+    Audit(audit::Action::kList, session.user_id);
+
     LOG_INFO() << "Passwords retrieved successfully";
 
-    return response.ExtractValue();
+    if (cacheable) {
+        request.GetHttpResponse().SetHeader(std::string{kETagHeader}, FormatETag(listing->version));
+    }
+    return listing->body;
 }
 
 }  // namespace handlers::api::passwords::get
@@ -135,40 +268,45 @@ Handler::Handler(
     const userver::components::ComponentConfig& config,
     const userver::components::ComponentContext& context
 )
-    : HttpHandlerJsonBase(config, context),
-      pg_cluster_{context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()},
-      key_{context.FindComponent<crypto::Component>().GetDecodedKey("aes256_base64_key")} {}
+    : HandlerBase(config, context), service_{context.FindComponent<vault::Component>().GetService()} {}
 
-userver::formats::json::Value Handler::HandleRequestJsonThrow(
-    [[maybe_unused]] const userver::server::http::HttpRequest& request,
-    const userver::formats::json::Value& body,
+std::string Handler::HandleApiRequestThrow(
+    const userver::server::http::HttpRequest& request,
     userver::server::request::RequestContext& context
 ) const {
     LOG_INFO() << "Received request to create a password";
 
-    const auto user_id = context.GetData<std::int32_t>("user_id");
-    const auto master_key = crypto::Decrypt(context.GetData<std::string>("master_key"), key_);
-
-    const auto service = body["service"].As<std::string>();
-    const auto login = body["login"].As<std::string>();
-    const auto password = body["password"].As<std::string>();
-    const auto password_encrypted = userver::crypto::base64::Base64Encode(crypto::Encrypt(password, master_key));
-    LOG_DEBUG() << "Password encrypted successfully";
+    const auto& session = context.GetData<vault::Session>("session");
+    auto body = json::ParseCreatePasswordRequest(request.RequestBody());
 
-    const auto result = pg_cluster_->Execute(
-        userver::storages::postgres::ClusterHostType::kMaster,
-        db::sql::kCreatePassword,
-        user_id,
-        service,
-        login,
-        password_encrypted
-    );
-
-    LOG_INFO() << "Password created successfully";
-
-    userver::formats::json::ValueBuilder response;
-    response["message"] = "Password added successfully";
-    return response.ExtractValue();
+    auto& arena = GetSecureArena();
+    const auto data_key =
+        TimeStage(metrics::Stage::kMasterKeyDecrypt, [&] { return service_.OpenDataKey(session, arena); });
+    const auto created = TimeStage(metrics::Stage::kDatabase, [&] {
+        return service_.CreatePassword(
+            session.user_id, data_key, body.service, body.login, body.password, body.totp_secret, GetDeadline()
+        );
+    });
+    secure::Wipe(body.password);
+    if (body.totp_secret) {
+        secure::Wipe(*body.totp_secret);
+    }
+    Audit(audit::Action::kCreate, session.user_id, created.id);
+
+    userver::formats::json::StringBuilder response;
+    {
+        const userver::formats::json::StringBuilder::ObjectGuard guard{response};
+        response.Key("message");
+        response.WriteString("Password added successfully");
+        response.Key("breached");
+        response.WriteBool(created.breached);
+        response.Key("reused_in");
+        const userver::formats::json::StringBuilder::ArrayGuard array_guard{response};
+        for (const auto& service : created.reused_in) {
+            response.WriteString(service);
+        }
+    }
+    return response.GetString();
 }
 
 }  // namespace handlers::api::password::post
@@ -179,34 +317,270 @@ Handler::Handler(
     const userver::components::ComponentConfig& config,
     const userver::components::ComponentContext& context
 )
-    : HttpHandlerJsonBase(config, context),
-      pg_cluster_{context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()} {}
+    : HandlerBase(config, context), service_{context.FindComponent<vault::Component>().GetService()} {}
 
-userver::formats::json::Value Handler::HandleRequestJsonThrow(
-    [[maybe_unused]] const userver::server::http::HttpRequest& request,
-    const userver::formats::json::Value& body,
-    [[maybe_unused]] userver::server::request::RequestContext& context
+std::string Handler::HandleApiRequestThrow(
+    const userver::server::http::HttpRequest& request,
+    userver::server::request::RequestContext& context
 ) const {
     LOG_INFO() << "Received request to delete a password";
 
-    const auto user_id = context.GetData<std::int32_t>("user_id");
+    const auto& session = context.GetData<vault::Session>("session");
     const auto password_id = std::stoll(request.GetPathArg("id"));
 
-    const auto result = pg_cluster_->Execute(
-        userver::storages::postgres::ClusterHostType::kMaster, db::sql::kDeletePassword, password_id, user_id
-    );
+    TimeStage(metrics::Stage::kDatabase, [&] { service_.DeletePassword(session.user_id, password_id, GetDeadline()); });
+    Audit(audit::Action::kDelete, session.user_id, password_id);
 
-    if (result.RowsAffected() == 0) {
-        LOG_WARNING() << "Password not found for ID: " << password_id;
-        throw userver::server::handlers::ResourceNotFound(userver::server::handlers::ExternalBody{"Password not found"}
-        );
+    return MessageResponse("Password deleted successfully");
+}
+
+}  // namespace handlers::api::password::del
+
+namespace handlers::api::passwords::breached::get {
+
+Handler::Handler(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& context
+)
+    : HandlerBase(config, context), service_{context.FindComponent<vault::Component>().GetService()} {}
+
+std::string Handler::HandleApiRequestThrow(
+    const userver::server::http::HttpRequest& /*request*/,
+    userver::server::request::RequestContext& context
+) const {
+    LOG_INFO() << "Received request to check passwords against the breach index";
+
+    const auto& session = context.GetData<vault::Session>("session");
+    auto& arena = GetSecureArena();
+    const auto data_key =
+        TimeStage(metrics::Stage::kMasterKeyDecrypt, [&] { return service_.OpenDataKey(session, arena); });
+    const auto report = TimeStage(metrics::Stage::kRowDecrypt, [&] {
+        return service_.FindBreachedPasswords(session.user_id, data_key, arena, GetDeadline());
+    });
+    AccountRows(report.checked);
+    Audit(audit::Action::kList, session.user_id);
+
+    // only the entries are listed, the passwords themselves are never sent back
+    return TimeStage(metrics::Stage::kSerialization, [&] {
+        userver::formats::json::StringBuilder response;
+        {
+            const userver::formats::json::StringBuilder::ObjectGuard guard{response};
+            response.Key("checked");
+            response.WriteUInt64(report.checked);
+            response.Key("breached");
+            const userver::formats::json::StringBuilder::ArrayGuard array_guard{response};
+            for (const auto& password : report.breached) {
+                const userver::formats::json::StringBuilder::ObjectGuard entry_guard{response};
+                response.Key("id");
+                response.WriteInt64(password.id);
+                response.Key("service");
+                response.WriteString(password.service);
+                response.Key("login");
+                response.WriteString(password.login);
+            }
+        }
+        return response.GetString();
+    });
+}
+
+}  // namespace handlers::api::passwords::breached::get
+
+namespace handlers::api::passwords::totp::get {
+
+Handler::Handler(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& context
+)
+    : HandlerBase(config, context), service_{context.FindComponent<vault::Component>().GetService()} {}
+
+std::string Handler::HandleApiRequestThrow(
+    const userver::server::http::HttpRequest& /*request*/,
+    userver::server::request::RequestContext& context
+) const {
+    LOG_INFO() << "Received request to get TOTP codes";
+
+    const auto& session = context.GetData<vault::Session>("session");
+    auto& arena = GetSecureArena();
+    const auto data_key =
+        TimeStage(metrics::Stage::kMasterKeyDecrypt, [&] { return service_.OpenDataKey(session, arena); });
+    const auto codes = TimeStage(metrics::Stage::kRowDecrypt, [&] {
+        return service_.GetTotpCodes(session.user_id, data_key, arena, GetDeadline());
+    });
+    AccountRows(codes.codes.size());
+    Audit(audit::Action::kList, session.user_id);
+
+    return TimeStage(metrics::Stage::kSerialization, [&] {
+        userver::formats::json::StringBuilder response;
+        {
+            const userver::formats::json::StringBuilder::ObjectGuard guard{response};
+            response.Key("period");
+            response.WriteUInt64(codes.period);
+            response.Key("expires_in");
+            response.WriteUInt64(codes.expires_in);
+            response.Key("codes");
+            const userver::formats::json::StringBuilder::ArrayGuard array_guard{response};
+            for (const auto& code : codes.codes) {
+                const userver::formats::json::StringBuilder::ObjectGuard entry_guard{response};
+                response.Key("id");
+                response.WriteInt64(code.id);
+                response.Key("service");
+                response.WriteString(code.service);
+                response.Key("login");
+                response.WriteString(code.login);
+                response.Key("code");
+                response.WriteString(fmt::format("{:06}", code.code));
+            }
+        }
+        return response.GetString();
+    });
+}
+
+}  // namespace handlers::api::passwords::totp::get
+
+namespace handlers::api::passwords::reused::get {
+
+Handler::Handler(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& context
+)
+    : HandlerBase(config, context), service_{context.FindComponent<vault::Component>().GetService()} {}
+
+std::string Handler::HandleApiRequestThrow(
+    const userver::server::http::HttpRequest& /*request*/,
+    userver::server::request::RequestContext& context
+) const {
+    LOG_INFO() << "Received request to find reused passwords";
+
+    const auto& session = context.GetData<vault::Session>("session");
+    const auto groups = TimeStage(metrics::Stage::kDatabase, [&] {
+        return service_.FindReusedPasswords(session.user_id, GetDeadline());
+    });
+
+    return TimeStage(metrics::Stage::kSerialization, [&] {
+        userver::formats::json::StringBuilder response;
+        {
+            const userver::formats::json::StringBuilder::ObjectGuard guard{response};
+            response.Key("reused");
+            const userver::formats::json::StringBuilder::ArrayGuard groups_guard{response};
+            for (const auto& group : groups) {
+                const userver::formats::json::StringBuilder::ArrayGuard group_guard{response};
+                for (std::size_t i = 0; i < group.ids.size(); ++i) {
+                    const userver::formats::json::StringBuilder::ObjectGuard entry_guard{response};
+                    response.Key("id");
+                    response.WriteInt64(group.ids[i]);
+                    response.Key("service");
+                    response.WriteString(group.services[i]);
+                    response.Key("login");
+                    response.WriteString(group.logins[i]);
+                }
+            }
+        }
+        return response.GetString();
+    });
+}
+
+}  // namespace handlers::api::passwords::reused::get
+
+namespace handlers::api::passwords::changes::get {
+
+Handler::Handler(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& context
+)
+    : HandlerBase(config, context), service_{context.FindComponent<vault::Component>().GetService()} {}
+
+std::string Handler::HandleApiRequestThrow(
+    const userver::server::http::HttpRequest& request,
+    userver::server::request::RequestContext& context
+) const {
+    LOG_INFO() << "Received request to sync passwords";
+
+    const auto& session = context.GetData<vault::Session>("session");
+    const auto cursor = ParseCursor(request);
+    const auto changes = TimeStage(metrics::Stage::kDatabase, [&] {
+        return service_.GetChanges(session.user_id, cursor, GetDeadline());
+    });
+
+    auto& arena = GetSecureArena();
+    std::vector<std::string_view> passwords_decrypted;
+    passwords_decrypted.reserve(changes.changed.size());
+    if (!changes.changed.empty()) {
+        const auto data_key =
+            TimeStage(metrics::Stage::kMasterKeyDecrypt, [&] { return service_.OpenDataKey(session, arena); });
+        TimeStage(metrics::Stage::kRowDecrypt, [&] {
+            for (const auto& password : changes.changed) {
+                if (passwords_decrypted.size() % vault::kDeadlineCheckRows == 0) {
+                    CheckDeadline();
+                }
+                passwords_decrypted.push_back(vault::Service::DecryptPassword(password, data_key, arena));
+            }
+        });
     }
 
-    LOG_INFO() << "Password deleted successfully";
+    auto body = TimeStage(metrics::Stage::kSerialization, [&] {
+        userver::formats::json::StringBuilder response;
+        {
+            const userver::formats::json::StringBuilder::ObjectGuard guard{response};
+            response.Key("cursor");
+            response.WriteInt64(changes.cursor);
+            response.Key("full");
+            response.WriteBool(changes.full);
+            response.Key("changed");
+            {
+                const userver::formats::json::StringBuilder::ArrayGuard changed_guard{response};
+                for (std::size_t i = 0; i < changes.changed.size(); ++i) {
+                    if (i % vault::kDeadlineCheckRows == 0) {
+                        CheckDeadline();
+                    }
+                    json::WritePassword(changes.changed[i], passwords_decrypted[i], response);
+                }
+            }
+            response.Key("deleted");
+            const userver::formats::json::StringBuilder::ArrayGuard deleted_guard{response};
+            for (const auto id : changes.deleted) {
+                response.WriteInt64(id);
+            }
+        }
+        return response.GetString();
+    });
+    AccountRows(changes.changed.size() + changes.deleted.size());
+    Audit(audit::Action::kList, session.user_id);
+
+    LOG_INFO() << "Passwords synced: " << changes.changed.size() << " changed, " << changes.deleted.size()
+               << " deleted";
+    return body;
+}
+
+}  // namespace handlers::api::passwords::changes::get
+
+namespace handlers::api::passwords::changes::wait {
+
+Handler::Handler(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& context
+)
+    : HandlerBase(config, context), service_{context.FindComponent<vault::Component>().GetService()} {}
 
-    userver::formats::json::ValueBuilder response;
-    response["message"] = "Password deleted successfully";
-    return response.ExtractValue();
+std::string Handler::HandleApiRequestThrow(
+    const userver::server::http::HttpRequest& request,
+    userver::server::request::RequestContext& context
+) const {
+    const auto& session = context.GetData<vault::Session>("session");
+    const auto cursor = ParseCursor(request);
+
+    // not timed as a stage, an idle wait would swamp the database latency histogram
+    const auto result = service_.WaitForChanges(session.user_id, cursor, GetDeadline());
+    LOG_DEBUG() << "Wait for changes of user " << session.user_id << " ended, changed: " << result.changed;
+
+    userver::formats::json::StringBuilder response;
+    {
+        const userver::formats::json::StringBuilder::ObjectGuard guard{response};
+        response.Key("cursor");
+        response.WriteInt64(result.cursor);
+        response.Key("changed");
+        response.WriteBool(result.changed);
+    }
+    return response.GetString();
 }
 
-}  // namespace handlers::api::password::del
\ No newline at end of file
+}  // namespace handlers::api::passwords::changes::wait
@@ -1,93 +1,196 @@
 #pragma once
 
-#include <userver/server/handlers/http_handler_json_base.hpp>
-#include <userver/storages/postgres/postgres_fwd.hpp>
+#include "coalesce/group.hpp"
+#include "handlers/api/base.hpp"
 
-namespace jwt {
+namespace vault {
 
-class Client;
+class Service;
 
-}  // namespace jwt
+}  // namespace vault
 
 namespace handlers::api::password::get {
 
-class Handler final : public userver::server::handlers::HttpHandlerJsonBase {
+class Handler final : public handlers::api::HandlerBase {
 public:
     static constexpr std::string_view kName = "handler-get-password";
 
     Handler(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
 
-    userver::formats::json::Value HandleRequestJsonThrow(
+    std::string HandleApiRequestThrow(
         const userver::server::http::HttpRequest& request,
-        const userver::formats::json::Value& body,
         userver::server::request::RequestContext& context
     ) const override;
 
 private:
-    userver::storages::postgres::ClusterPtr pg_cluster_;
-    const std::string key_;
+    const vault::Service& service_;
 };
 
 }  // namespace handlers::api::password::get
 
 namespace handlers::api::passwords::get {
 
-class Handler final : public userver::server::handlers::HttpHandlerJsonBase {
+class Handler final : public handlers::api::HandlerBase {
 public:
     static constexpr std::string_view kName = "handler-get-passwords";
 
     Handler(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
+    ~Handler() override;
 
-    userver::formats::json::Value HandleRequestJsonThrow(
+    std::string HandleApiRequestThrow(
         const userver::server::http::HttpRequest& request,
-        const userver::formats::json::Value& body,
         userver::server::request::RequestContext& context
     ) const override;
 
 private:
-    userver::storages::postgres::ClusterPtr pg_cluster_;
-    const std::string key_;
+    /// Serialized response of a listing, shared by identical concurrent requests.
+    struct Listing {
+        std::string body;
+        std::int64_t version{0};
+        std::size_t rows{0};
+    };
+
+    const vault::Service& service_;
+    mutable coalesce::Group<Listing> listings_;
+    userver::utils::statistics::Entry listings_statistics_holder_;
 };
 
 }  // namespace handlers::api::passwords::get
 
 namespace handlers::api::password::post {
 
-class Handler final : public userver::server::handlers::HttpHandlerJsonBase {
+class Handler final : public handlers::api::HandlerBase {
 public:
     static constexpr std::string_view kName = "handler-post-password";
 
     Handler(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
 
-    userver::formats::json::Value HandleRequestJsonThrow(
+    std::string HandleApiRequestThrow(
         const userver::server::http::HttpRequest& request,
-        const userver::formats::json::Value& body,
         userver::server::request::RequestContext& context
     ) const override;
 
 private:
-    userver::storages::postgres::ClusterPtr pg_cluster_;
-    const std::string key_;
+    const vault::Service& service_;
 };
 
 }  // namespace handlers::api::password::post
 
 namespace handlers::api::password::del {
 
-class Handler final : public userver::server::handlers::HttpHandlerJsonBase {
+class Handler final : public handlers::api::HandlerBase {
 public:
     static constexpr std::string_view kName = "handler-delete-password";
 
     Handler(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
 
-    userver::formats::json::Value HandleRequestJsonThrow(
+    std::string HandleApiRequestThrow(
         const userver::server::http::HttpRequest& request,
-        const userver::formats::json::Value& body,
         userver::server::request::RequestContext& context
     ) const override;
 
 private:
-    userver::storages::postgres::ClusterPtr pg_cluster_;
+    const vault::Service& service_;
 };
 
 }  // namespace handlers::api::password::del
+
+namespace handlers::api::passwords::breached::get {
+
+/// Lists the entries of the caller whose passwords appear in the breach index.
+class Handler final : public handlers::api::HandlerBase {
+public:
+    static constexpr std::string_view kName = "handler-get-breached-passwords";
+
+    Handler(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
+
+    std::string HandleApiRequestThrow(
+        const userver::server::http::HttpRequest& request,
+        userver::server::request::RequestContext& context
+    ) const override;
+
+private:
+    const vault::Service& service_;
+};
+
+}  // namespace handlers::api::passwords::breached::get
+
+namespace handlers::api::passwords::totp::get {
+
+/// Returns the current TOTP codes of the entries of the caller that have a TOTP secret.
+class Handler final : public handlers::api::HandlerBase {
+public:
+    static constexpr std::string_view kName = "handler-get-totp-codes";
+
+    Handler(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
+
+    std::string HandleApiRequestThrow(
+        const userver::server::http::HttpRequest& request,
+        userver::server::request::RequestContext& context
+    ) const override;
+
+private:
+    const vault::Service& service_;
+};
+
+}  // namespace handlers::api::passwords::totp::get
+
+namespace handlers::api::passwords::reused::get {
+
+/// Lists groups of entries of the caller that share a password.
+class Handler final : public handlers::api::HandlerBase {
+public:
+    static constexpr std::string_view kName = "handler-get-reused-passwords";
+
+    Handler(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
+
+    std::string HandleApiRequestThrow(
+        const userver::server::http::HttpRequest& request,
+        userver::server::request::RequestContext& context
+    ) const override;
+
+private:
+    const vault::Service& service_;
+};
+
+}  // namespace handlers::api::passwords::reused::get
+
+namespace handlers::api::passwords::changes::get {
+
+/// Returns the entries of the caller created, changed or deleted since a sync cursor.
+class Handler final : public handlers::api::HandlerBase {
+public:
+    static constexpr std::string_view kName = "handler-get-password-changes";
+
+    Handler(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
+
+    std::string HandleApiRequestThrow(
+        const userver::server::http::HttpRequest& request,
+        userver::server::request::RequestContext& context
+    ) const override;
+
+private:
+    const vault::Service& service_;
+};
+
+}  // namespace handlers::api::passwords::changes::get
+
+namespace handlers::api::passwords::changes::wait {
+
+/// Long-poll: answers once the vault of the caller changes past a sync cursor, or when the wait runs out.
+class Handler final : public handlers::api::HandlerBase {
+public:
+    static constexpr std::string_view kName = "handler-wait-password-changes";
+
+    Handler(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
+
+    std::string HandleApiRequestThrow(
+        const userver::server::http::HttpRequest& request,
+        userver::server::request::RequestContext& context
+    ) const override;
+
+private:
+    const vault::Service& service_;
+};
+
+}  // namespace handlers::api::passwords::changes::wait
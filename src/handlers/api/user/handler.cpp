@@ -1,15 +1,13 @@
 #include "handler.hpp"
 #include "crypto/utils.hpp"
-#include "db/sql.hpp"
-#include "models/user.hpp"
-#include "totp/utils.hpp"
+#include "json/requests.hpp"
+#include "secure/arena.hpp"
+#include "vault/component.hpp"
 
 #include <userver/components/component.hpp>
 #include <userver/crypto/base64.hpp>
-#include <userver/formats/json/value.hpp>
-#include <userver/formats/json/value_builder.hpp>
-#include <userver/storages/postgres/cluster.hpp>
-#include <userver/storages/postgres/component.hpp>
+#include <userver/formats/json/string_builder.hpp>
+#include <userver/logging/log.hpp>
 
 namespace handlers::api::user::post {
 
@@ -17,44 +15,31 @@ Handler::Handler(
     const userver::components::ComponentConfig& config,
     const userver::components::ComponentContext& context
 )
-    : HttpHandlerJsonBase(config, context),
-      pg_cluster_{context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()} {}
+    : HandlerBase(config, context), service_{context.FindComponent<vault::Component>().GetService()} {}
 
-userver::formats::json::Value Handler::HandleRequestJsonThrow(
-    [[maybe_unused]] const userver::server::http::HttpRequest& request,
-    const userver::formats::json::Value& body,
+std::string Handler::HandleApiRequestThrow(
+    const userver::server::http::HttpRequest& request,
     [[maybe_unused]] userver::server::request::RequestContext& context
 ) const {
     LOG_INFO() << "Received request to register a new user";
 
-    const auto username = body["username"].As<std::string>();
-    LOG_DEBUG() << "Username extracted: " << username;
+    const auto body = json::ParseRegisterUserRequest(request.RequestBody());
+    LOG_DEBUG() << "Username extracted: " << body.username;
 
     try {
-        const auto master_key = crypto::GenerateMasterKey();
-        const auto salt = crypto::GenerateSalt();
-        const auto master_key_hash = crypto::HashMasterKeyWithSalt(master_key, salt);
-        const auto totp_secret = totp::GenerateTotpSecret();
-        const auto master_key_encoded = userver::crypto::base64::Base64Encode(master_key);
-        const auto salt_encoded = userver::crypto::base64::Base64Encode(salt);
-
-        const auto result = pg_cluster_->Execute(
-            userver::storages::postgres::ClusterHostType::kMaster,
-            db::sql::kCreateUser,
-            username,
-            master_key_hash,
-            salt_encoded,
-            totp_secret
-        );
-
-        LOG_INFO() << "User successfully created in database: " << username;
-
-        userver::formats::json::ValueBuilder builder;
-        builder["message"] = "User registered successfully";
-        builder["master_key"] = master_key_encoded;
-        builder["totp_secret"] = totp_secret;
-
-        return builder.ExtractValue();
+        const auto registration = service_.RegisterUser(body.username);
+
+        userver::formats::json::StringBuilder response;
+        {
+            const userver::formats::json::StringBuilder::ObjectGuard guard{response};
+            response.Key("message");
+            response.WriteString("User registered successfully");
+            response.Key("master_key");
+            response.WriteString(userver::crypto::base64::Base64Encode(registration.master_key));
+            response.Key("totp_secret");
+            response.WriteString(registration.totp_secret);
+        }
+        return response.GetString();
 
     } catch (const std::exception& ex) {
         LOG_ERROR() << "Error while registering user: " << ex.what();
@@ -70,52 +55,68 @@ Handler::Handler(
     const userver::components::ComponentConfig& config,
     const userver::components::ComponentContext& context
 )
-    : HttpHandlerJsonBase(config, context),
-      pg_cluster_{context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()} {}
+    : HandlerBase(config, context), service_{context.FindComponent<vault::Component>().GetService()} {}
 
-userver::formats::json::Value Handler::HandleRequestJsonThrow(
-    [[maybe_unused]] const userver::server::http::HttpRequest& request,
-    const userver::formats::json::Value& body,
+std::string Handler::HandleApiRequestThrow(
+    const userver::server::http::HttpRequest& request,
     [[maybe_unused]] userver::server::request::RequestContext& context
 ) const {
     LOG_INFO() << "Received request to delete a user";
 
-    const auto username = body["username"].As<std::string>();
-    const auto totp_code = std::stoul(body["totp_code"].As<std::string>());
-    LOG_DEBUG() << "Username extracted: " << username;
+    const auto body = json::ParseDeleteUserRequest(request.RequestBody());
+    LOG_DEBUG() << "Username extracted: " << body.username;
+    CheckUsernameRateLimit(body.username);
 
-    const auto get_result =
-        pg_cluster_->Execute(userver::storages::postgres::ClusterHostType::kSlave, db::sql::kGetUser, username);
+    service_.DeleteUser(body.username, body.totp_code);
 
-    if (get_result.IsEmpty()) {
-        LOG_WARNING() << "Unknown user: " << username;
-        throw userver::server::handlers::Unauthorized(userver::server::handlers::ExternalBody{"Unknown user"});
-    }
-
-    const auto user = get_result.AsSingleRow<models::User>(userver::storages::postgres::kRowTag);
-    LOG_DEBUG() << "User found in database: " << user.id;
-
-    if (!totp::VerifyTotpCode(user.totp_secret, totp_code)) {
-        LOG_WARNING() << "Invalid TOTP code for user: " << username;
-        throw userver::server::handlers::Unauthorized(userver::server::handlers::ExternalBody{"Invalid TOTP code"});
+    userver::formats::json::StringBuilder response;
+    {
+        const userver::formats::json::StringBuilder::ObjectGuard guard{response};
+        response.Key("message");
+        response.WriteString("User deleted successfully");
     }
+    return response.GetString();
+}
 
-    const auto delete_result =
-        pg_cluster_->Execute(userver::storages::postgres::ClusterHostType::kMaster, db::sql::kDeleteUser, username);
+}  // namespace handlers::api::user::del
 
-    if (delete_result.RowsAffected() == 0) {
-        LOG_WARNING() << "Failed to delete user: " << username;
-        throw userver::server::handlers::InternalServerError(
-            userver::server::handlers::ExternalBody{"Failed to delete user"}
-        );
-    }
 
-    LOG_INFO() << "User successfully deleted from database: " << username;
+namespace handlers::api::user::master_key::post {
 
-    userver::formats::json::ValueBuilder builder;
-    builder["message"] = "User deleted successfully";
+Handler::Handler(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& context
+)
+    : HandlerBase(config, context), service_{context.FindComponent<vault::Component>().GetService()} {}
 
-    return builder.ExtractValue();
+std::string Handler::HandleApiRequestThrow(
+    const userver::server::http::HttpRequest& request,
+    [[maybe_unused]] userver::server::request::RequestContext& context
+) const {
+    LOG_INFO() << "Received request to change a master key";
+
+    auto body = json::ParseAuthRequest(request.RequestBody());
+    LOG_DEBUG() << "Username extracted: " << body.username;
+    CheckUsernameRateLimit(body.username);
+
+    auto& arena = GetSecureArena();
+    const auto master_key = crypto::Base64Decode(body.master_key, arena);
+    secure::Wipe(body.master_key);
+
+    auto new_master_key = service_.ChangeMasterKey(body.username, master_key, body.totp_code, arena);
+    auto new_master_key_encoded = userver::crypto::base64::Base64Encode(new_master_key);
+    secure::Wipe(new_master_key);
+
+    userver::formats::json::StringBuilder response;
+    {
+        const userver::formats::json::StringBuilder::ObjectGuard guard{response};
+        response.Key("message");
+        response.WriteString("Master key changed successfully");
+        response.Key("master_key");
+        response.WriteString(new_master_key_encoded);
+    }
+    secure::Wipe(new_master_key_encoded);
+    return response.GetString();
 }
 
-}  // namespace handlers::api::user::del
+}  // namespace handlers::api::user::master_key::post
\ No newline at end of file
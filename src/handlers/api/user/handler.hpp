@@ -1,44 +1,66 @@
 #pragma once
 
-#include <userver/server/handlers/http_handler_json_base.hpp>
-#include <userver/storages/postgres/postgres_fwd.hpp>
+#include "handlers/api/base.hpp"
+
+namespace vault {
+
+class Service;
+
+}  // namespace vault
 
 namespace handlers::api::user::post {
 
-class Handler final : public userver::server::handlers::HttpHandlerJsonBase {
+class Handler final : public handlers::api::HandlerBase {
 public:
     static constexpr std::string_view kName = "handler-post-user";
 
     Handler(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
 
-    userver::formats::json::Value HandleRequestJsonThrow(
+    std::string HandleApiRequestThrow(
         const userver::server::http::HttpRequest& request,
-        const userver::formats::json::Value& body,
         userver::server::request::RequestContext& context
     ) const override;
 
 private:
-    userver::storages::postgres::ClusterPtr pg_cluster_;
+    const vault::Service& service_;
 };
 
 }  // namespace handlers::api::user::post
 
 namespace handlers::api::user::del {
 
-class Handler final : public userver::server::handlers::HttpHandlerJsonBase {
+class Handler final : public handlers::api::HandlerBase {
 public:
     static constexpr std::string_view kName = "handler-delete-user";
 
     Handler(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
 
-    userver::formats::json::Value HandleRequestJsonThrow(
+    std::string HandleApiRequestThrow(
         const userver::server::http::HttpRequest& request,
-        const userver::formats::json::Value& body,
         userver::server::request::RequestContext& context
     ) const override;
 
 private:
-    userver::storages::postgres::ClusterPtr pg_cluster_;
+    const vault::Service& service_;
 };
 
 }  // namespace handlers::api::user::del
+
+namespace handlers::api::user::master_key::post {
+
+class Handler final : public handlers::api::HandlerBase {
+public:
+    static constexpr std::string_view kName = "handler-post-master-key";
+
+    Handler(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
+
+    std::string HandleApiRequestThrow(
+        const userver::server::http::HttpRequest& request,
+        userver::server::request::RequestContext& context
+    ) const override;
+
+private:
+    const vault::Service& service_;
+};
+
+}  // namespace handlers::api::user::master_key::post
\ No newline at end of file
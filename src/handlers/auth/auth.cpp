@@ -1,5 +1,5 @@
 #include "auth.hpp"
-#include "jwt/component.hpp"
+#include "vault/component.hpp"
 
 #include <userver/http/common_headers.hpp>
 #include <userver/logging/log.hpp>
@@ -8,7 +8,7 @@ namespace handlers::auth {
 
 constexpr std::string_view kAuthHeaderPrefix = "Bearer ";
 
-AuthChecker::AuthChecker(const jwt::Client& jwt_client) : jwt_client_{jwt_client} {}
+AuthChecker::AuthChecker(const vault::Service& service) : service_{service} {}
 
 AuthChecker::Result AuthChecker::CheckAuth(
     const userver::server::http::HttpRequest& request,
@@ -25,12 +25,14 @@ AuthChecker::Result AuthChecker::CheckAuth(
     }
     const auto token = auth_header.substr(kAuthHeaderPrefix.size());
 
-    jwt::Payload jwt_payload;
+    vault::Session session;
+    const auto validation_start = std::chrono::steady_clock::now();
     try {
-        jwt_payload = jwt_client_.ValidateToken(token);
-        LOG_DEBUG() << "Token validated for user ID: " << jwt_payload.user_id;
-    } catch (const std::exception& ex) {
-        LOG_WARNING() << "JWT validation failed: " << ex.what();
+        session = service_.ValidateToken(token);
+        request_context.SetData(
+            std::string{kJwtValidationTimeKey}, std::chrono::steady_clock::now() - validation_start
+        );
+    } catch (const vault::Error& ex) {
         Result result;
         result.status = Result::Status::kTokenNotFound;
         result.reason = "Invalid token";
@@ -39,8 +41,7 @@ AuthChecker::Result AuthChecker::CheckAuth(
         return result;
     }
 
-    request_context.SetData("master_key", jwt_payload.master_key);
-    request_context.SetData("user_id", jwt_payload.user_id);
+    request_context.SetData("session", std::move(session));
     return {};
 }
 
@@ -49,8 +50,8 @@ userver::server::handlers::auth::AuthCheckerBasePtr AuthCheckerFactory::operator
     [[maybe_unused]] const userver::server::handlers::auth::HandlerAuthConfig& config,
     [[maybe_unused]] const userver::server::handlers::auth::AuthCheckerSettings& settings
 ) const {
-    const auto& jwt_client = context.FindComponent<jwt::Component>().GetClient();
-    return std::make_shared<AuthChecker>(jwt_client);
+    const auto& service = context.FindComponent<vault::Component>().GetService();
+    return std::make_shared<AuthChecker>(service);
 }
 
 }  // namespace handlers::auth
@@ -2,17 +2,20 @@
 
 #include <userver/server/handlers/auth/auth_checker_factory.hpp>
 
-namespace jwt {
-class Client;
+namespace vault {
+class Service;
 }
 
 namespace handlers::auth {
 
+/// Request context key of the time spent validating the token, a std::chrono::steady_clock::duration.
+inline constexpr std::string_view kJwtValidationTimeKey = "jwt_validation_time";
+
 class AuthChecker final : public userver::server::handlers::auth::AuthCheckerBase {
 public:
     using Result = userver::server::handlers::auth::AuthCheckResult;
 
-    AuthChecker(const jwt::Client& jwt_client);
+    AuthChecker(const vault::Service& service);
 
     Result CheckAuth(
         const userver::server::http::HttpRequest& request,
@@ -22,7 +25,7 @@ public:
     bool SupportsUserAuth() const noexcept override { return true; }
 
 private:
-    const jwt::Client& jwt_client_;
+    const vault::Service& service_;
 };
 
 class AuthCheckerFactory final : public userver::server::handlers::auth::AuthCheckerFactoryBase {
@@ -0,0 +1,446 @@
+#include "service.hpp"
+#include "audit/component.hpp"
+#include "secure/component.hpp"
+#include "vault/component.hpp"
+
+#include <userver/components/component.hpp>
+#include <userver/components/component_config.hpp>
+#include <userver/components/statistics_storage.hpp>
+#include <userver/logging/log.hpp>
+#include <userver/ugrpc/server/service_component_base.hpp>
+#include <userver/utils/statistics/writer.hpp>
+#include <userver/utils/text.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+#include <fmt/format.h>
+#include <grpcpp/support/status.h>
+
+#include <optional>
+
+namespace {
+
+constexpr std::string_view kAuthMetadataKey = "authorization";
+constexpr std::string_view kAuthPrefix = "Bearer ";
+
+::grpc::StatusCode ToStatusCode(vault::ErrorCode code) {
+    switch (code) {
+        case vault::ErrorCode::kInvalidArgument:
+            return ::grpc::StatusCode::INVALID_ARGUMENT;
+        case vault::ErrorCode::kUnauthenticated:
+            return ::grpc::StatusCode::UNAUTHENTICATED;
+        case vault::ErrorCode::kForbidden:
+            return ::grpc::StatusCode::PERMISSION_DENIED;
+        case vault::ErrorCode::kNotFound:
+            return ::grpc::StatusCode::NOT_FOUND;
+        case vault::ErrorCode::kUnavailable:
+            return ::grpc::StatusCode::UNAVAILABLE;
+        case vault::ErrorCode::kDeadlineExceeded:
+            return ::grpc::StatusCode::DEADLINE_EXCEEDED;
+        case vault::ErrorCode::kResourceExhausted:
+            return ::grpc::StatusCode::RESOURCE_EXHAUSTED;
+        case vault::ErrorCode::kInternal:
+            break;
+    }
+    return ::grpc::StatusCode::INTERNAL;
+}
+
+/// Runs the call body, turning vault::Error into the matching gRPC status.
+template <typename Call, typename Func>
+void HandleCall(Call& call, Func&& func) {
+    try {
+        func();
+    } catch (const vault::Error& error) {
+        LOG_WARNING() << "gRPC call failed: " << error.what();
+        call.FinishWithError(::grpc::Status{ToStatusCode(error.GetCode()), error.what()});
+    }
+}
+
+/// Extracts the session from the `authorization: Bearer <token>` metadata.
+template <typename Call>
+vault::Session Authorize(Call& call, const vault::Service& service) {
+    const auto& metadata = call.GetContext().client_metadata();
+    const auto it = metadata.find(::grpc::string_ref{kAuthMetadataKey.data(), kAuthMetadataKey.size()});
+    if (it == metadata.end()) {
+        throw vault::Error(vault::ErrorCode::kUnauthenticated, "Invalid Authorization header");
+    }
+
+    const std::string_view value{it->second.data(), it->second.size()};
+    if (!value.starts_with(kAuthPrefix)) {
+        throw vault::Error(vault::ErrorCode::kUnauthenticated, "Invalid Authorization header");
+    }
+    return service.ValidateToken(std::string{value.substr(kAuthPrefix.size())});
+}
+
+/// Client address without the port, e.g. "ipv4:127.0.0.1" for "ipv4:127.0.0.1:53412", so that the
+/// connections of one client share a bucket.
+std::string GetPeerAddress(const ::grpc::ServerContext& context) {
+    auto peer = context.peer();
+    const auto port = peer.rfind(':');
+    if (port != std::string::npos && peer.find(':') != port) {
+        peer.resize(port);
+    }
+    return peer;
+}
+
+std::unique_ptr<ratelimit::Limiter> MakeLimiter(const userver::yaml_config::YamlConfig& config) {
+    const auto settings = config.As<std::optional<ratelimit::Settings>>();
+    return settings ? std::make_unique<ratelimit::Limiter>(*settings) : nullptr;
+}
+
+/// Converts the deadline set by the client, if any.
+template <typename Call>
+userver::engine::Deadline GetDeadline(Call& call) {
+    const auto deadline = call.GetContext().deadline();
+    if (deadline == std::chrono::system_clock::time_point::max()) {
+        return {};
+    }
+    return userver::engine::Deadline::FromDuration(deadline - std::chrono::system_clock::now());
+}
+
+void SetTimestamp(std::chrono::system_clock::time_point time_point, google::protobuf::Timestamp& timestamp) {
+    const auto since_epoch = time_point.time_since_epoch();
+    const auto seconds = std::chrono::floor<std::chrono::seconds>(since_epoch);
+    timestamp.set_seconds(seconds.count());
+    timestamp.set_nanos(static_cast<std::int32_t>(std::chrono::nanoseconds{since_epoch - seconds}.count()));
+}
+
+vaulty::v1::Password MakePassword(const models::Password& password, std::string_view password_decrypted) {
+    vaulty::v1::Password message;
+    message.set_id(password.id);
+    message.set_service(password.service);
+    message.set_login(password.login);
+    message.set_password(password_decrypted.data(), password_decrypted.size());
+    SetTimestamp(password.created_at, *message.mutable_created_at());
+    SetTimestamp(password.updated_at, *message.mutable_updated_at());
+    return message;
+}
+
+}  // namespace
+
+namespace handlers::grpc {
+
+VaultService::VaultService(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& context
+)
+    : vaulty::v1::VaultServiceBase::Component(config, context),
+      service_{context.FindComponent<vault::Component>().GetService()},
+      secure_pool_{context.FindComponent<secure::Component>().GetPool()},
+      audit_{context.FindComponent<audit::Component>()},
+      peer_limiter_{MakeLimiter(config["rate_limit"]["per_ip"])},
+      username_limiter_{MakeLimiter(config["rate_limit"]["per_username"])} {
+    auto& storage = context.FindComponent<userver::components::StatisticsStorage>().GetStorage();
+    statistics_holder_ = storage.RegisterWriter("vaulty.grpc", [this](userver::utils::statistics::Writer& writer) {
+        if (peer_limiter_) {
+            writer["rate-limiter"]["per_ip"] = peer_limiter_->GetStatistics();
+        }
+        if (username_limiter_) {
+            writer["rate-limiter"]["per_username"] = username_limiter_->GetStatistics();
+        }
+    });
+}
+
+VaultService::~VaultService() { statistics_holder_.Unregister(); }
+
+void VaultService::Register(RegisterCall& call, vaulty::v1::RegisterRequest&& request) {
+    HandleCall(call, [&] {
+        auto registration = service_.RegisterUser(request.username());
+
+        vaulty::v1::RegisterResponse response;
+        response.set_master_key(std::move(registration.master_key));
+        response.set_totp_secret(std::move(registration.totp_secret));
+        call.Finish(response);
+    });
+}
+
+void VaultService::Authenticate(AuthenticateCall& call, vaulty::v1::AuthenticateRequest&& request) {
+    HandleCall(call, [&] {
+        CheckRateLimit(call.GetContext(), request.username());
+        secure::Arena arena{secure_pool_};
+        vaulty::v1::AuthenticateResponse response;
+        response.set_token(service_.Authenticate(request.username(), request.master_key(), request.totp_code(), arena));
+        call.Finish(response);
+    });
+}
+
+void VaultService::ChangeMasterKey(ChangeMasterKeyCall& call, vaulty::v1::ChangeMasterKeyRequest&& request) {
+    HandleCall(call, [&] {
+        CheckRateLimit(call.GetContext(), request.username());
+        secure::Arena arena{secure_pool_};
+        vaulty::v1::ChangeMasterKeyResponse response;
+        response.set_master_key(
+            service_.ChangeMasterKey(request.username(), request.master_key(), request.totp_code(), arena)
+        );
+        call.Finish(response);
+    });
+}
+
+void VaultService::DeleteUser(DeleteUserCall& call, vaulty::v1::DeleteUserRequest&& request) {
+    HandleCall(call, [&] {
+        CheckRateLimit(call.GetContext(), request.username());
+        service_.DeleteUser(request.username(), request.totp_code());
+        call.Finish(vaulty::v1::DeleteUserResponse{});
+    });
+}
+
+void VaultService::Logout(LogoutCall& call, vaulty::v1::LogoutRequest&& /*request*/) {
+    HandleCall(call, [&] {
+        service_.Logout(Authorize(call, service_));
+        call.Finish(vaulty::v1::LogoutResponse{});
+    });
+}
+
+void VaultService::GetPassword(GetPasswordCall& call, vaulty::v1::GetPasswordRequest&& request) {
+    HandleCall(call, [&] {
+        const auto session = Authorize(call, service_);
+        const auto password = service_.GetPassword(session.user_id, request.id(), GetDeadline(call));
+
+        secure::Arena arena{secure_pool_};
+        const auto data_key = service_.OpenDataKey(session, arena);
+        auto message = MakePassword(password, vault::Service::DecryptPassword(password, data_key, arena));
+        Audit(audit::Action::kRead, session.user_id, password.id);
+        call.Finish(message);
+    });
+}
+
+void VaultService::ListPasswords(ListPasswordsCall& call, vaulty::v1::ListPasswordsRequest&& request) {
+    HandleCall(call, [&] {
+        const auto session = Authorize(call, service_);
+        const auto deadline = GetDeadline(call);
+        secure::Arena arena{secure_pool_};
+        const auto data_key = service_.OpenDataKey(session, arena);
+        const auto search_term = userver::utils::text::ToLower(request.search_term());
+        vault::ListOptions options;
+        if (request.order() == vaulty::v1::ListPasswordsRequest::ORDER_FRECENCY) {
+            options.order = vault::Order::kFrecency;
+        }
+        if (request.limit() > 0) {
+            options.limit = request.limit();
+        }
+        const auto snapshot = service_.ListPasswords(session.user_id, search_term, options, deadline);
+
+        // entries are decrypted one at a time as they are written, not all upfront
+        for (std::size_t i = 0; i < snapshot.passwords.size(); ++i) {
+            if (i % vault::kDeadlineCheckRows == 0) {
+                vault::CheckDeadline(deadline);
+            }
+            const auto& password = snapshot.passwords[i];
+            call.Write(MakePassword(password, vault::Service::DecryptPassword(password, data_key, arena)));
+        }
+        Audit(audit::Action::kList, session.user_id);
+        call.Finish();
+    });
+}
+
+void VaultService::CreatePassword(CreatePasswordCall& call, vaulty::v1::CreatePasswordRequest&& request) {
+    HandleCall(call, [&] {
+        const auto session = Authorize(call, service_);
+        secure::Arena arena{secure_pool_};
+        const auto data_key = service_.OpenDataKey(session, arena);
+
+        vaulty::v1::CreatePasswordResponse response;
+        std::optional<std::string> totp_secret;
+        if (request.has_totp_secret()) {
+            totp_secret = request.totp_secret();
+        }
+        auto created = service_.CreatePassword(
+            session.user_id,
+            data_key,
+            request.service(),
+            request.login(),
+            request.password(),
+            totp_secret,
+            GetDeadline(call)
+        );
+        if (totp_secret) {
+            secure::Wipe(*totp_secret);
+        }
+        Audit(audit::Action::kCreate, session.user_id, created.id);
+        response.set_vault_version(created.vault_version);
+        response.set_breached(created.breached);
+        for (auto& service : created.reused_in) {
+            response.add_reused_in(std::move(service));
+        }
+        call.Finish(response);
+    });
+}
+
+void VaultService::DeletePassword(DeletePasswordCall& call, vaulty::v1::DeletePasswordRequest&& request) {
+    HandleCall(call, [&] {
+        const auto session = Authorize(call, service_);
+
+        vaulty::v1::DeletePasswordResponse response;
+        response.set_vault_version(service_.DeletePassword(session.user_id, request.id(), GetDeadline(call)));
+        Audit(audit::Action::kDelete, session.user_id, request.id());
+        call.Finish(response);
+    });
+}
+
+void VaultService::ListBreachedPasswords(
+    ListBreachedPasswordsCall& call,
+    vaulty::v1::ListBreachedPasswordsRequest&& /*request*/
+) {
+    HandleCall(call, [&] {
+        const auto session = Authorize(call, service_);
+        secure::Arena arena{secure_pool_};
+        const auto data_key = service_.OpenDataKey(session, arena);
+        const auto report = service_.FindBreachedPasswords(session.user_id, data_key, arena, GetDeadline(call));
+        Audit(audit::Action::kList, session.user_id);
+
+        vaulty::v1::ListBreachedPasswordsResponse response;
+        response.set_checked(report.checked);
+        for (const auto& password : report.breached) {
+            auto& entry = *response.add_breached();
+            entry.set_id(password.id);
+            entry.set_service(password.service);
+            entry.set_login(password.login);
+        }
+        call.Finish(response);
+    });
+}
+
+void VaultService::ListReusedPasswords(
+    ListReusedPasswordsCall& call,
+    vaulty::v1::ListReusedPasswordsRequest&& /*request*/
+) {
+    HandleCall(call, [&] {
+        const auto session = Authorize(call, service_);
+
+        vaulty::v1::ListReusedPasswordsResponse response;
+        for (const auto& group : service_.FindReusedPasswords(session.user_id, GetDeadline(call))) {
+            auto& reused = *response.add_reused();
+            for (std::size_t i = 0; i < group.ids.size(); ++i) {
+                auto& entry = *reused.add_entries();
+                entry.set_id(group.ids[i]);
+                entry.set_service(group.services[i]);
+                entry.set_login(group.logins[i]);
+            }
+        }
+        call.Finish(response);
+    });
+}
+
+void VaultService::ListTotpCodes(ListTotpCodesCall& call, vaulty::v1::ListTotpCodesRequest&& /*request*/) {
+    HandleCall(call, [&] {
+        const auto session = Authorize(call, service_);
+        secure::Arena arena{secure_pool_};
+        const auto data_key = service_.OpenDataKey(session, arena);
+        const auto codes = service_.GetTotpCodes(session.user_id, data_key, arena, GetDeadline(call));
+        Audit(audit::Action::kList, session.user_id);
+
+        vaulty::v1::ListTotpCodesResponse response;
+        response.set_period(codes.period);
+        response.set_expires_in(codes.expires_in);
+        for (const auto& code : codes.codes) {
+            auto& entry = *response.add_codes();
+            entry.mutable_entry()->set_id(code.id);
+            entry.mutable_entry()->set_service(code.service);
+            entry.mutable_entry()->set_login(code.login);
+            entry.set_code(fmt::format("{:06}", code.code));
+        }
+        call.Finish(response);
+    });
+}
+
+void VaultService::ListChanges(ListChangesCall& call, vaulty::v1::ListChangesRequest&& request) {
+    HandleCall(call, [&] {
+        const auto session = Authorize(call, service_);
+        const auto deadline = GetDeadline(call);
+        const auto changes = service_.GetChanges(session.user_id, request.since(), deadline);
+
+        vaulty::v1::ListChangesResponse response;
+        response.set_cursor(changes.cursor);
+        response.set_full(changes.full);
+        if (!changes.changed.empty()) {
+            secure::Arena arena{secure_pool_};
+            const auto data_key = service_.OpenDataKey(session, arena);
+            for (std::size_t i = 0; i < changes.changed.size(); ++i) {
+                if (i % vault::kDeadlineCheckRows == 0) {
+                    vault::CheckDeadline(deadline);
+                }
+                const auto& password = changes.changed[i];
+                *response.add_changed() =
+                    MakePassword(password, vault::Service::DecryptPassword(password, data_key, arena));
+            }
+        }
+        for (const auto id : changes.deleted) {
+            response.add_deleted(id);
+        }
+        Audit(audit::Action::kList, session.user_id);
+        call.Finish(response);
+    });
+}
+
+void VaultService::WaitForChanges(WaitForChangesCall& call, vaulty::v1::WaitForChangesRequest&& request) {
+    HandleCall(call, [&] {
+        const auto session = Authorize(call, service_);
+        const auto result = service_.WaitForChanges(session.user_id, request.since(), GetDeadline(call));
+
+        vaulty::v1::WaitForChangesResponse response;
+        response.set_cursor(result.cursor);
+        response.set_changed(result.changed);
+        call.Finish(response);
+    });
+}
+
+void VaultService::Audit(audit::Action action, std::int32_t user_id, std::int64_t password_id) {
+    audit_.Push({std::chrono::system_clock::now(), user_id, action, password_id});
+}
+
+void VaultService::CheckRateLimit(const ::grpc::ServerContext& context, std::string_view username) {
+    if (peer_limiter_) {
+        const auto address = GetPeerAddress(context);
+        if (!peer_limiter_->TryAcquire(address)) {
+            LOG_WARNING() << "Rate limit exceeded for address: " << address;
+            throw vault::Error(vault::ErrorCode::kResourceExhausted, "Too many requests");
+        }
+    }
+    if (username_limiter_ && !username_limiter_->TryAcquire(username)) {
+        LOG_WARNING() << "Rate limit exceeded for user: " << username;
+        throw vault::Error(vault::ErrorCode::kResourceExhausted, "Too many requests");
+    }
+}
+
+userver::yaml_config::Schema VaultService::GetStaticConfigSchema() {
+    return userver::yaml_config::MergeSchemas<userver::ugrpc::server::ServiceComponentBase>(R"(
+type: object
+description: gRPC counterpart of the HTTP API
+additionalProperties: false
+properties:
+    rate_limit:
+        type: object
+        description: token bucket limits of the calls that check credentials, over-limit calls get RESOURCE_EXHAUSTED
+        additionalProperties: false
+        properties:
+            per_ip:
+                type: object
+                description: limit per client address, the port is ignored
+                additionalProperties: false
+                properties:
+                    burst:
+                        type: integer
+                        description: bucket capacity
+                    rate_per_second:
+                        type: number
+                        description: tokens returned to a bucket per second
+                    max_keys:
+                        type: integer
+                        description: maximum number of tracked keys, the idlest ones are dropped above it
+            per_username:
+                type: object
+                description: limit per username from the request
+                additionalProperties: false
+                properties:
+                    burst:
+                        type: integer
+                        description: bucket capacity
+                    rate_per_second:
+                        type: number
+                        description: tokens returned to a bucket per second
+                    max_keys:
+                        type: integer
+                        description: maximum number of tracked keys, the idlest ones are dropped above it
+)");
+}
+
+}  // namespace handlers::grpc
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "ratelimit/limiter.hpp"
+
+#include <userver/utils/statistics/entry.hpp>
+#include <userver/yaml_config/schema.hpp>
+
+#include <vaulty/v1/vaulty_service.usrv.pb.hpp>
+
+#include <memory>
+
+namespace vault {
+
+class Service;
+
+}  // namespace vault
+
+namespace secure {
+
+class Pool;
+
+}  // namespace secure
+
+namespace audit {
+
+class Component;
+enum class Action;
+
+}  // namespace audit
+
+namespace handlers::grpc {
+
+/// @brief gRPC counterpart of the HTTP API, see proto/vaulty/v1/vaulty.proto.
+///
+/// Only translates messages and errors; all the work is done by vault::Service,
+/// exactly as for the HTTP handlers. Secrets of a call live in a secure arena
+/// that is wiped when the call ends. Accesses to passwords are audited.
+///
+/// A `rate_limit` section limits the calls that check a master key or a TOTP
+/// code (Authenticate, ChangeMasterKey, DeleteUser) per client address and per
+/// username, like the `rate_limit` of the HTTP handlers. Over-limit calls fail
+/// with RESOURCE_EXHAUSTED before any database or crypto work.
+class VaultService final : public vaulty::v1::VaultServiceBase::Component {
+public:
+    static constexpr std::string_view kName = "grpc-vault-service";
+
+    VaultService(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
+
+    ~VaultService() override;
+
+    static userver::yaml_config::Schema GetStaticConfigSchema();
+
+    void Register(RegisterCall& call, vaulty::v1::RegisterRequest&& request) override;
+
+    void Authenticate(AuthenticateCall& call, vaulty::v1::AuthenticateRequest&& request) override;
+
+    void ChangeMasterKey(ChangeMasterKeyCall& call, vaulty::v1::ChangeMasterKeyRequest&& request) override;
+
+    void DeleteUser(DeleteUserCall& call, vaulty::v1::DeleteUserRequest&& request) override;
+
+    void Logout(LogoutCall& call, vaulty::v1::LogoutRequest&& request) override;
+
+    void GetPassword(GetPasswordCall& call, vaulty::v1::GetPasswordRequest&& request) override;
+
+    void ListPasswords(ListPasswordsCall& call, vaulty::v1::ListPasswordsRequest&& request) override;
+
+    void CreatePassword(CreatePasswordCall& call, vaulty::v1::CreatePasswordRequest&& request) override;
+
+    void DeletePassword(DeletePasswordCall& call, vaulty::v1::DeletePasswordRequest&& request) override;
+
+    void ListBreachedPasswords(
+        ListBreachedPasswordsCall& call,
+        vaulty::v1::ListBreachedPasswordsRequest&& request
+    ) override;
+
+    void ListReusedPasswords(ListReusedPasswordsCall& call, vaulty::v1::ListReusedPasswordsRequest&& request) override;
+
+    void ListTotpCodes(ListTotpCodesCall& call, vaulty::v1::ListTotpCodesRequest&& request) override;
+
+    void ListChanges(ListChangesCall& call, vaulty::v1::ListChangesRequest&& request) override;
+
+    void WaitForChanges(WaitForChangesCall& call, vaulty::v1::WaitForChangesRequest&& request) override;
+
+private:
+    void Audit(audit::Action action, std::int32_t user_id, std::int64_t password_id = 0);
+
+    /// @brief Takes a token from the buckets of the peer and of the username.
+    /// @throws vault::Error kResourceExhausted if either is over its limit.
+    void CheckRateLimit(const ::grpc::ServerContext& context, std::string_view username);
+
+    const vault::Service& service_;
+    secure::Pool& secure_pool_;
+    audit::Component& audit_;
+    const std::unique_ptr<ratelimit::Limiter> peer_limiter_;
+    const std::unique_ptr<ratelimit::Limiter> username_limiter_;
+    userver::utils::statistics::Entry statistics_holder_;
+};
+
+}  // namespace handlers::grpc
@@ -0,0 +1,84 @@
+#include "handler.hpp"
+#include "flight_recorder/component.hpp"
+#include "json/writer.hpp"
+
+#include <userver/components/component.hpp>
+#include <userver/formats/json/string_builder.hpp>
+#include <userver/http/content_type.hpp>
+
+namespace {
+
+std::int64_t ToMicroseconds(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+void WriteRecord(const flight_recorder::Record& record, userver::formats::json::StringBuilder& builder) {
+    const userver::formats::json::StringBuilder::ObjectGuard guard{builder};
+    builder.Key("time");
+    json::WriteTimestamp(record.time, builder);
+    builder.Key("handler");
+    builder.WriteString(record.handler.data());
+    builder.Key("method");
+    builder.WriteString(record.method.data());
+    builder.Key("path");
+    builder.WriteString(record.path.data());
+    builder.Key("status");
+    builder.WriteInt64(record.status);
+    builder.Key("total_us");
+    builder.WriteInt64(ToMicroseconds(record.total));
+    builder.Key("stages_us");
+    {
+        const userver::formats::json::StringBuilder::ObjectGuard stages_guard{builder};
+        for (std::size_t i = 0; i < metrics::kStageCount; ++i) {
+            builder.Key(metrics::ToString(static_cast<metrics::Stage>(i)));
+            builder.WriteInt64(ToMicroseconds(record.timings.stages[i]));
+        }
+    }
+    builder.Key("rows");
+    builder.WriteUInt64(record.timings.rows);
+    builder.Key("bytes");
+    builder.WriteUInt64(record.bytes);
+}
+
+}  // namespace
+
+namespace handlers::monitor::slow_requests::get {
+
+Handler::Handler(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& context
+)
+    : HttpHandlerBase(config, context), flight_recorder_{context.FindComponent<flight_recorder::Component>()} {}
+
+std::string Handler::HandleRequestThrow(
+    const userver::server::http::HttpRequest& request,
+    [[maybe_unused]] userver::server::request::RequestContext& context
+) const {
+    request.GetHttpResponse().SetContentType(userver::http::content_type::kApplicationJson);
+
+    const auto threshold = flight_recorder_.GetThreshold();
+    const auto& recorder = flight_recorder_.GetRecorder();
+
+    userver::formats::json::StringBuilder response;
+    {
+        const userver::formats::json::StringBuilder::ObjectGuard guard{response};
+        response.Key("threshold_ms");
+        if (threshold) {
+            response.WriteInt64(threshold->count());
+        } else {
+            response.WriteNull();
+        }
+        response.Key("dropped");
+        response.WriteUInt64(recorder.GetDroppedCount());
+        response.Key("requests");
+        {
+            const userver::formats::json::StringBuilder::ArrayGuard requests_guard{response};
+            for (const auto& record : recorder.Snapshot()) {
+                WriteRecord(record, response);
+            }
+        }
+    }
+    return response.GetString();
+}
+
+}  // namespace handlers::monitor::slow_requests::get
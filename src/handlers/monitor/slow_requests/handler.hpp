@@ -0,0 +1,29 @@
+#pragma once
+
+#include <userver/server/handlers/http_handler_base.hpp>
+
+namespace flight_recorder {
+
+class Component;
+
+}  // namespace flight_recorder
+
+namespace handlers::monitor::slow_requests::get {
+
+/// Serves the requests captured by the flight recorder as JSON, newest first.
+class Handler final : public userver::server::handlers::HttpHandlerBase {
+public:
+    static constexpr std::string_view kName = "handler-slow-requests";
+
+    Handler(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
+
+    std::string HandleRequestThrow(
+        const userver::server::http::HttpRequest& request,
+        userver::server::request::RequestContext& context
+    ) const override;
+
+private:
+    flight_recorder::Component& flight_recorder_;
+};
+
+}  // namespace handlers::monitor::slow_requests::get
\ No newline at end of file
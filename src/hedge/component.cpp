@@ -0,0 +1,112 @@
+#include "component.hpp"
+
+#include <userver/components/component.hpp>
+#include <userver/components/statistics_storage.hpp>
+#include <userver/utils/statistics/writer.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+#include <chrono>
+
+namespace {
+
+hedge::Settings ParseSettings(const userver::yaml_config::YamlConfig& config) {
+    hedge::Settings settings;
+    settings.enabled = config["enabled"].As<bool>(settings.enabled);
+    settings.percentile = config["percentile"].As<double>(settings.percentile);
+    settings.min_delay = config["min_delay"].As<std::chrono::microseconds>(settings.min_delay);
+    settings.max_delay = config["max_delay"].As<std::chrono::microseconds>(settings.max_delay);
+    settings.min_samples = config["min_samples"].As<std::uint64_t>(settings.min_samples);
+    settings.max_extra_ratio = config["max_extra_ratio"].As<double>(settings.max_extra_ratio);
+    settings.burst = config["burst"].As<std::uint32_t>(settings.burst);
+    return settings;
+}
+
+}  // namespace
+
+namespace hedge {
+
+Component::Component(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& context
+)
+    : userver::components::LoggableComponentBase(config, context), policy_{ParseSettings(config)} {
+    auto& storage = context.FindComponent<userver::components::StatisticsStorage>().GetStorage();
+    statistics_holder_ =
+        storage.RegisterWriter("vaulty.hedged_reads", [this](userver::utils::statistics::Writer& writer) {
+            for (std::size_t i = 0; i < kReadCount; ++i) {
+                const auto read = static_cast<Read>(i);
+                const auto& statistics = policy_.GetStatistics(read);
+                const auto name = ToString(read);
+                writer["reads"].ValueWithLabels(statistics.reads.load(), {"read", name});
+                writer["hedged"].ValueWithLabels(statistics.hedged.load(), {"read", name});
+                writer["won"].ValueWithLabels(statistics.won.load(), {"read", name});
+                writer["throttled"].ValueWithLabels(statistics.throttled.load(), {"read", name});
+                writer["delay_us"].ValueWithLabels(policy_.GetDelay(read).count(), {"read", name});
+            }
+        });
+
+    if (policy_.IsEnabled()) {
+        task_.Start(
+            "hedge-delay-update",
+            {config["update_interval"].As<std::chrono::milliseconds>(std::chrono::seconds{1})},
+            [this] { policy_.Update(); }
+        );
+    }
+}
+
+Component::~Component() {
+    task_.Stop();
+    statistics_holder_.Unregister();
+}
+
+Policy& Component::GetPolicy() { return policy_; }
+
+userver::yaml_config::Schema Component::GetStaticConfigSchema() {
+    constexpr auto schema = R"(
+        type: object
+        description: hedged replica reads
+        additionalProperties: false
+        properties:
+            enabled:
+                type: boolean
+                description: send a second attempt of slow replica reads to another replica
+                defaultDescription: false
+            percentile:
+                type: number
+                description: percentile of the read latency after which the second attempt is sent
+                defaultDescription: 95
+                minimum: 50
+                maximum: 100
+            min_delay:
+                type: string
+                description: lower bound of the hedge delay
+                defaultDescription: 2ms
+            max_delay:
+                type: string
+                description: upper bound of the hedge delay, also used until enough reads are seen
+                defaultDescription: 50ms
+            min_samples:
+                type: integer
+                description: recorded reads, older ones decayed, needed to trust the percentile
+                defaultDescription: 100
+                minimum: 1
+            max_extra_ratio:
+                type: number
+                description: second attempts per read on average, caps the extra load on the replicas
+                defaultDescription: 0.05
+                minimum: 0
+                maximum: 1
+            burst:
+                type: integer
+                description: second attempts allowed in a burst
+                defaultDescription: 10
+                minimum: 0
+            update_interval:
+                type: string
+                description: how often the hedge delays are recomputed
+                defaultDescription: 1s
+    )";
+    return userver::yaml_config::MergeSchemas<userver::components::LoggableComponentBase>(schema);
+}
+
+}  // namespace hedge
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "policy.hpp"
+
+#include <userver/components/loggable_component_base.hpp>
+#include <userver/utils/periodic_task.hpp>
+#include <userver/utils/statistics/entry.hpp>
+
+#include <string_view>
+
+namespace hedge {
+
+/// @brief Hedged replica reads of vault::Service, see RunHedged().
+///
+/// Opt-in with `enabled`. Every `update_interval` the hedge delays are
+/// recomputed from the latencies of the reads since, with older reads decayed.
+class Component final : public userver::components::LoggableComponentBase {
+public:
+    static constexpr std::string_view kName = "component-hedged-reads";
+
+    Component(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
+    ~Component() override;
+
+    Policy& GetPolicy();
+
+    static userver::yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    Policy policy_;
+    userver::utils::PeriodicTask task_;
+    userver::utils::statistics::Entry statistics_holder_;
+};
+
+}  // namespace hedge
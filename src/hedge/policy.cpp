@@ -0,0 +1,109 @@
+#include "policy.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double kBucketsPerOctave = 8.0;
+
+}  // namespace
+
+namespace hedge {
+
+std::string_view ToString(Read read) {
+    switch (read) {
+        case Read::kGetPassword:
+            return "get_password";
+        case Read::kListPasswords:
+            return "list_passwords";
+        case Read::kScanVault:
+            return "scan_vault";
+    }
+    return "unknown";
+}
+
+Policy::Policy(const Settings& settings)
+    : settings_{settings},
+      refill_units_{static_cast<std::int64_t>(settings.max_extra_ratio * kTokenUnits)},
+      max_units_{static_cast<std::int64_t>(settings.burst) * kTokenUnits},
+      budget_units_{max_units_} {
+    for (auto& latencies : reads_) {
+        latencies.delay_us = settings.max_delay.count();
+    }
+}
+
+std::chrono::microseconds Policy::GetDelay(Read read) const noexcept {
+    return std::chrono::microseconds{reads_[static_cast<std::size_t>(read)].delay_us.load(std::memory_order_relaxed)};
+}
+
+void Policy::Record(Read read, std::chrono::microseconds latency) noexcept {
+    auto& latencies = reads_[static_cast<std::size_t>(read)];
+    latencies.counts[GetBucket(latency)].fetch_add(1, std::memory_order_relaxed);
+    ++latencies.statistics.reads;
+
+    auto units = budget_units_.load(std::memory_order_relaxed);
+    while (units < max_units_ &&
+           !budget_units_.compare_exchange_weak(units, std::min(units + refill_units_, max_units_))) {
+    }
+}
+
+bool Policy::TryHedge(Read read) noexcept {
+    auto& statistics = reads_[static_cast<std::size_t>(read)].statistics;
+    auto units = budget_units_.load(std::memory_order_relaxed);
+    while (units >= kTokenUnits) {
+        if (budget_units_.compare_exchange_weak(units, units - kTokenUnits)) {
+            ++statistics.hedged;
+            return true;
+        }
+    }
+    ++statistics.throttled;
+    return false;
+}
+
+void Policy::AccountWin(Read read) noexcept { ++reads_[static_cast<std::size_t>(read)].statistics.won; }
+
+void Policy::Update() {
+    for (auto& latencies : reads_) {
+        std::array<std::uint64_t, kBuckets> counts{};
+        std::uint64_t total = 0;
+        for (std::size_t i = 0; i < kBuckets; ++i) {
+            counts[i] = latencies.counts[i].load(std::memory_order_relaxed);
+            total += counts[i];
+            // reads recorded meanwhile are kept whole
+            latencies.counts[i].fetch_sub(counts[i] - counts[i] / 2, std::memory_order_relaxed);
+        }
+        if (total < std::max<std::uint64_t>(settings_.min_samples, 1)) {
+            latencies.delay_us = settings_.max_delay.count();
+            continue;
+        }
+
+        const auto rank = static_cast<std::uint64_t>(std::ceil(settings_.percentile / 100.0 * total));
+        std::uint64_t seen = 0;
+        std::size_t bucket = 0;
+        while (bucket + 1 < kBuckets && (seen += counts[bucket]) < rank) {
+            ++bucket;
+        }
+        latencies.delay_us = std::clamp(GetBucketLimit(bucket), settings_.min_delay, settings_.max_delay).count();
+    }
+}
+
+const Statistics& Policy::GetStatistics(Read read) const noexcept {
+    return reads_[static_cast<std::size_t>(read)].statistics;
+}
+
+std::size_t Policy::GetBucket(std::chrono::microseconds latency) noexcept {
+    if (latency.count() <= 1) {
+        return 0;
+    }
+    const auto bucket = static_cast<std::size_t>(std::log2(static_cast<double>(latency.count())) * kBucketsPerOctave);
+    return std::min(bucket, kBuckets - 1);
+}
+
+std::chrono::microseconds Policy::GetBucketLimit(std::size_t bucket) noexcept {
+    return std::chrono::microseconds{
+        static_cast<std::int64_t>(std::ceil(std::exp2(static_cast<double>(bucket + 1) / kBucketsPerOctave)))
+    };
+}
+
+}  // namespace hedge
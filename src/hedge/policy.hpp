@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace hedge {
+
+/// Hedged read settings.
+struct Settings {
+    bool enabled{false};
+
+    /// Percentile of the read latency after which a second attempt is sent.
+    double percentile{95.0};
+
+    /// Bounds of the hedge delay; until enough reads are seen the delay is `max_delay`.
+    std::chrono::microseconds min_delay{std::chrono::milliseconds{2}};
+    std::chrono::microseconds max_delay{std::chrono::milliseconds{50}};
+
+    /// Recorded reads, older ones decayed, below which the percentile is not trusted.
+    std::uint64_t min_samples{100};
+
+    /// Hedges allowed per read, on average.
+    double max_extra_ratio{0.05};
+
+    /// Hedges allowed in a burst.
+    std::uint32_t burst{10};
+};
+
+/// Kinds of hedged reads, each with its own latency distribution.
+enum class Read {
+    kGetPassword,
+    kListPasswords,
+    kScanVault,
+};
+
+inline constexpr std::size_t kReadCount = 3;
+
+/// @brief Returns the value of the `read` metric label.
+std::string_view ToString(Read read);
+
+/// Counters of a read kind.
+struct Statistics {
+    std::atomic<std::uint64_t> reads{0};
+
+    /// Second attempts sent.
+    std::atomic<std::uint64_t> hedged{0};
+
+    /// Second attempts that answered first.
+    std::atomic<std::uint64_t> won{0};
+
+    /// Second attempts not sent because the budget was spent.
+    std::atomic<std::uint64_t> throttled{0};
+};
+
+/// @brief Decides when a replica read gets a second attempt.
+///
+/// Latencies of every kind of read are counted in logarithmic buckets, an
+/// eighth of an octave wide. Update() turns the counts into the hedge delay,
+/// the configured percentile clamped to the delay bounds, and halves them, so
+/// older reads fade out. A hedge takes a token from a bucket that every read
+/// refills by `max_extra_ratio`, which caps the extra load on the replicas.
+///
+/// Record(), TryHedge() and GetDelay() are lock-free, Update() is meant to be
+/// called periodically from a single task.
+class Policy final {
+public:
+    explicit Policy(const Settings& settings);
+
+    bool IsEnabled() const noexcept { return settings_.enabled; }
+
+    /// @brief Returns how long the first attempt of a read has before a second one is sent.
+    std::chrono::microseconds GetDelay(Read read) const noexcept;
+
+    /// @brief Accounts the latency of a finished read and refills the hedge budget.
+    void Record(Read read, std::chrono::microseconds latency) noexcept;
+
+    /// @brief Takes a hedge from the budget.
+    /// @return false if the budget is spent.
+    bool TryHedge(Read read) noexcept;
+
+    /// @brief Accounts a second attempt that answered before the first one.
+    void AccountWin(Read read) noexcept;
+
+    /// @brief Recomputes the hedge delays from the reads recorded so far.
+    void Update();
+
+    const Statistics& GetStatistics(Read read) const noexcept;
+
+private:
+    static constexpr std::size_t kBuckets = 192;
+    static constexpr std::int64_t kTokenUnits = 1'000'000;
+
+    struct Latencies {
+        std::array<std::atomic<std::uint64_t>, kBuckets> counts{};
+        std::atomic<std::int64_t> delay_us{0};
+        Statistics statistics;
+    };
+
+    static std::size_t GetBucket(std::chrono::microseconds latency) noexcept;
+
+    /// Upper bound of the latencies counted in the bucket.
+    static std::chrono::microseconds GetBucketLimit(std::size_t bucket) noexcept;
+
+    const Settings settings_;
+    const std::int64_t refill_units_;
+    const std::int64_t max_units_;
+    std::array<Latencies, kReadCount> reads_;
+    std::atomic<std::int64_t> budget_units_;
+};
+
+}  // namespace hedge
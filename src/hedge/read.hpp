@@ -0,0 +1,80 @@
+#pragma once
+
+#include "policy.hpp"
+
+#include <userver/engine/task/cancel.hpp>
+#include <userver/engine/wait_any.hpp>
+#include <userver/storages/postgres/cluster_types.hpp>
+#include <userver/utils/async.hpp>
+
+#include <chrono>
+#include <exception>
+
+namespace hedge {
+
+/// @brief Runs an idempotent replica read, with a second attempt if the first one is slower than the hedge delay.
+///
+/// `read_function` gets the hosts to query. Hedged attempts go to the replicas
+/// round robin, so the second one lands on another replica than the first if
+/// there is one. The result of the attempt that succeeds first is returned and
+/// the other attempt is cancelled; an error is only thrown if both fail. With
+/// hedging disabled this is a plain read of any replica.
+template <typename ReadFunction>
+auto RunHedged(Policy& policy, Read read, const ReadFunction& read_function) {
+    using userver::storages::postgres::ClusterHostType;
+    using userver::storages::postgres::ClusterHostTypeFlags;
+
+    if (!policy.IsEnabled()) {
+        return read_function(ClusterHostTypeFlags{ClusterHostType::kSlave});
+    }
+
+    const auto hosts = ClusterHostTypeFlags{ClusterHostType::kSlave} | ClusterHostType::kRoundRobin;
+    const auto started = std::chrono::steady_clock::now();
+    const auto record = [&] {
+        policy.Record(
+            read, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started)
+        );
+    };
+
+    auto first = userver::utils::Async("hedged-read", [&] { return read_function(hosts); });
+    first.WaitFor(policy.GetDelay(read));
+    if (first.IsFinished() || !policy.TryHedge(read)) {
+        auto result = first.Get();
+        record();
+        return result;
+    }
+
+    auto second = userver::utils::Async("hedged-read", [&] { return read_function(hosts); });
+    const auto finished = userver::engine::WaitAny(first, second);
+    if (!finished) {
+        // the caller is cancelled, Get() throws and the destructors cancel both attempts
+        return first.Get();
+    }
+
+    auto& winner = *finished == 0 ? first : second;
+    auto& loser = *finished == 0 ? second : first;
+    const bool hedge_won = *finished == 1;
+    try {
+        auto result = winner.Get();
+        loser.RequestCancel();
+        record();
+        if (hedge_won) {
+            policy.AccountWin(read);
+        }
+        return result;
+    } catch (const std::exception&) {
+        if (userver::engine::current_task::ShouldCancel()) {
+            throw;
+        }
+    }
+
+    // the other attempt may still succeed
+    auto result = loser.Get();
+    record();
+    if (!hedge_won) {
+        policy.AccountWin(read);
+    }
+    return result;
+}
+
+}  // namespace hedge
@@ -0,0 +1,100 @@
+#include "policy.hpp"
+
+#include <userver/utest/utest.hpp>
+
+using namespace hedge;
+
+namespace {
+
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+Settings MakeSettings() {
+    Settings settings;
+    settings.enabled = true;
+    settings.percentile = 90;
+    settings.min_delay = milliseconds{1};
+    settings.max_delay = milliseconds{100};
+    settings.min_samples = 10;
+    settings.max_extra_ratio = 0.5;
+    settings.burst = 2;
+    return settings;
+}
+
+}  // namespace
+
+TEST(HedgePolicyTest, DelayFollowsThePercentile) {
+    Policy policy{MakeSettings()};
+    EXPECT_EQ(policy.GetDelay(Read::kGetPassword), milliseconds{100});
+
+    // 90 fast reads and 10 slow ones, the 90th percentile is among the fast
+    for (int i = 0; i < 90; ++i) {
+        policy.Record(Read::kGetPassword, milliseconds{4});
+    }
+    for (int i = 0; i < 10; ++i) {
+        policy.Record(Read::kGetPassword, milliseconds{80});
+    }
+    policy.Update();
+    const auto delay = policy.GetDelay(Read::kGetPassword);
+    EXPECT_GE(delay, milliseconds{4});
+    EXPECT_LT(delay, microseconds{4500});
+
+    // other kinds of reads keep their own delay
+    EXPECT_EQ(policy.GetDelay(Read::kListPasswords), milliseconds{100});
+    EXPECT_EQ(policy.GetStatistics(Read::kGetPassword).reads, 100);
+}
+
+TEST(HedgePolicyTest, DelayIsClamped) {
+    Policy policy{MakeSettings()};
+    for (int i = 0; i < 100; ++i) {
+        policy.Record(Read::kScanVault, microseconds{50});
+        policy.Record(Read::kListPasswords, std::chrono::seconds{5});
+    }
+    policy.Update();
+    EXPECT_EQ(policy.GetDelay(Read::kScanVault), milliseconds{1});
+    EXPECT_EQ(policy.GetDelay(Read::kListPasswords), milliseconds{100});
+}
+
+TEST(HedgePolicyTest, OldReadsFadeOut) {
+    Policy policy{MakeSettings()};
+    for (int i = 0; i < 100; ++i) {
+        policy.Record(Read::kGetPassword, milliseconds{50});
+    }
+    policy.Update();
+    EXPECT_GE(policy.GetDelay(Read::kGetPassword), milliseconds{50});
+
+    for (int round = 0; round < 5; ++round) {
+        for (int i = 0; i < 100; ++i) {
+            policy.Record(Read::kGetPassword, milliseconds{2});
+        }
+        policy.Update();
+    }
+    EXPECT_LT(policy.GetDelay(Read::kGetPassword), milliseconds{3});
+}
+
+TEST(HedgePolicyTest, BudgetCapsHedges) {
+    Policy policy{MakeSettings()};
+    EXPECT_TRUE(policy.TryHedge(Read::kGetPassword));
+    EXPECT_TRUE(policy.TryHedge(Read::kGetPassword));
+    EXPECT_FALSE(policy.TryHedge(Read::kGetPassword));
+
+    // every read refills half a hedge
+    policy.Record(Read::kGetPassword, milliseconds{1});
+    EXPECT_FALSE(policy.TryHedge(Read::kListPasswords));
+    policy.Record(Read::kGetPassword, milliseconds{1});
+    EXPECT_TRUE(policy.TryHedge(Read::kListPasswords));
+
+    // the budget does not grow past the burst
+    for (int i = 0; i < 100; ++i) {
+        policy.Record(Read::kGetPassword, milliseconds{1});
+    }
+    EXPECT_TRUE(policy.TryHedge(Read::kGetPassword));
+    EXPECT_TRUE(policy.TryHedge(Read::kGetPassword));
+    EXPECT_FALSE(policy.TryHedge(Read::kGetPassword));
+
+    policy.AccountWin(Read::kGetPassword);
+    const auto& statistics = policy.GetStatistics(Read::kGetPassword);
+    EXPECT_EQ(statistics.hedged, 4);
+    EXPECT_EQ(statistics.throttled, 2);
+    EXPECT_EQ(statistics.won, 1);
+}
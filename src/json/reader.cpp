@@ -0,0 +1,301 @@
+#include "reader.hpp"
+
+#include <limits>
+
+namespace {
+
+constexpr std::uint64_t kMaxUInt64 = std::numeric_limits<std::uint64_t>::max();
+
+int HexDigit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+void AppendUtf8(std::string& output, std::uint32_t code_point) {
+    if (code_point < 0x80) {
+        output.push_back(static_cast<char>(code_point));
+    } else if (code_point < 0x800) {
+        output.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+        output.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    } else if (code_point < 0x10000) {
+        output.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+        output.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        output.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    } else {
+        output.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+        output.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+        output.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        output.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+}
+
+std::uint64_t ParseDigits(std::string_view digits) {
+    if (digits.empty()) {
+        throw json::ParseError("Expected an unsigned integer");
+    }
+
+    std::uint64_t result = 0;
+    for (const char c : digits) {
+        if (c < '0' || c > '9') {
+            throw json::ParseError("Expected an unsigned integer");
+        }
+        const std::uint64_t digit = c - '0';
+        if (result > (kMaxUInt64 - digit) / 10) {
+            throw json::ParseError("Integer is out of range");
+        }
+        result = result * 10 + digit;
+    }
+    return result;
+}
+
+}  // namespace
+
+namespace json {
+
+ObjectReader::ObjectReader(std::string_view input) : input_{input} {
+    SkipWhitespace();
+    Expect('{');
+}
+
+bool ObjectReader::Next() {
+    if (finished_) {
+        return false;
+    }
+    if (value_pending_) {
+        SkipValue();
+    }
+
+    SkipWhitespace();
+    if (Peek() == '}' || !first_member_) {
+        if (Peek() == '}') {
+            ++pos_;
+            finished_ = true;
+            SkipWhitespace();
+            if (pos_ != input_.size()) {
+                throw ParseError("Unexpected characters after the object");
+            }
+            return false;
+        }
+        Expect(',');
+        SkipWhitespace();
+    }
+    first_member_ = false;
+
+    if (Peek() != '"') {
+        throw ParseError("Expected an object key");
+    }
+    key_ = ReadStringView(key_scratch_);
+    SkipWhitespace();
+    Expect(':');
+    SkipWhitespace();
+    value_pending_ = true;
+    return true;
+}
+
+std::string ObjectReader::ReadString() {
+    if (!value_pending_ || Peek() != '"') {
+        throw ParseError("Expected a string value for '" + std::string{key_} + "'");
+    }
+
+    std::string scratch;
+    const auto value = ReadStringView(scratch);
+    value_pending_ = false;
+    return scratch.empty() ? std::string{value} : std::move(scratch);
+}
+
+std::uint64_t ObjectReader::ReadUInt64() {
+    if (!value_pending_) {
+        throw ParseError("No value to read");
+    }
+
+    if (Peek() == '"') {
+        std::string scratch;
+        const auto value = ReadStringView(scratch);
+        value_pending_ = false;
+        return ParseDigits(value);
+    }
+
+    const auto begin = pos_;
+    while (pos_ < input_.size() && input_[pos_] >= '0' && input_[pos_] <= '9') {
+        ++pos_;
+    }
+    value_pending_ = false;
+    return ParseDigits(input_.substr(begin, pos_ - begin));
+}
+
+void ObjectReader::SkipValue() {
+    if (!value_pending_) {
+        return;
+    }
+    value_pending_ = false;
+
+    switch (Peek()) {
+        case '"':
+            SkipString();
+            return;
+        case '{':
+        case '[': {
+            std::size_t depth = 0;
+            do {
+                const char c = Peek();
+                if (c == '"') {
+                    SkipString();
+                    continue;
+                }
+                if (c == '{' || c == '[') {
+                    ++depth;
+                } else if (c == '}' || c == ']') {
+                    --depth;
+                }
+                ++pos_;
+            } while (depth > 0);
+            return;
+        }
+        default: {
+            // number or literal
+            const auto begin = pos_;
+            while (pos_ < input_.size() && input_[pos_] != ',' && input_[pos_] != '}' && input_[pos_] != ' ' &&
+                   input_[pos_] != '\t' && input_[pos_] != '\n' && input_[pos_] != '\r') {
+                ++pos_;
+            }
+            if (begin == pos_) {
+                throw ParseError("Expected a value");
+            }
+            return;
+        }
+    }
+}
+
+void ObjectReader::SkipWhitespace() {
+    while (pos_ < input_.size() &&
+           (input_[pos_] == ' ' || input_[pos_] == '\t' || input_[pos_] == '\n' || input_[pos_] == '\r')) {
+        ++pos_;
+    }
+}
+
+char ObjectReader::Peek() {
+    if (pos_ >= input_.size()) {
+        throw ParseError("Unexpected end of input");
+    }
+    return input_[pos_];
+}
+
+void ObjectReader::Expect(char expected) {
+    if (Peek() != expected) {
+        throw ParseError(std::string{"Expected '"} + expected + "'");
+    }
+    ++pos_;
+}
+
+std::string_view ObjectReader::ReadStringView(std::string& scratch) {
+    Expect('"');
+
+    // fast path: no escapes, return a view into the input
+    const auto begin = pos_;
+    while (pos_ < input_.size() && input_[pos_] != '"' && input_[pos_] != '\\') {
+        if (static_cast<unsigned char>(input_[pos_]) < 0x20) {
+            throw ParseError("Control character in string");
+        }
+        ++pos_;
+    }
+    if (Peek() == '"') {
+        ++pos_;
+        return input_.substr(begin, pos_ - begin - 1);
+    }
+
+    scratch.assign(input_.substr(begin, pos_ - begin));
+    while (Peek() != '"') {
+        const char c = input_[pos_++];
+        if (c != '\\') {
+            if (static_cast<unsigned char>(c) < 0x20) {
+                throw ParseError("Control character in string");
+            }
+            scratch.push_back(c);
+            continue;
+        }
+
+        switch (Peek()) {
+            case '"':
+            case '\\':
+            case '/':
+                scratch.push_back(input_[pos_]);
+                break;
+            case 'b':
+                scratch.push_back('\b');
+                break;
+            case 'f':
+                scratch.push_back('\f');
+                break;
+            case 'n':
+                scratch.push_back('\n');
+                break;
+            case 'r':
+                scratch.push_back('\r');
+                break;
+            case 't':
+                scratch.push_back('\t');
+                break;
+            case 'u': {
+                const auto read_code_unit = [this] {
+                    if (pos_ + 4 >= input_.size()) {
+                        throw ParseError("Truncated unicode escape");
+                    }
+                    std::uint32_t code_unit = 0;
+                    for (std::size_t i = 1; i <= 4; ++i) {
+                        const int digit = HexDigit(input_[pos_ + i]);
+                        if (digit < 0) {
+                            throw ParseError("Invalid unicode escape");
+                        }
+                        code_unit = (code_unit << 4) | static_cast<std::uint32_t>(digit);
+                    }
+                    pos_ += 4;
+                    return code_unit;
+                };
+
+                std::uint32_t code_point = read_code_unit();
+                if (code_point >= 0xD800 && code_point <= 0xDBFF) {
+                    // high surrogate, must be followed by \uDC00-\uDFFF
+                    if (pos_ + 2 >= input_.size() || input_[pos_ + 1] != '\\' || input_[pos_ + 2] != 'u') {
+                        throw ParseError("Unpaired surrogate in unicode escape");
+                    }
+                    pos_ += 2;
+                    const std::uint32_t low = read_code_unit();
+                    if (low < 0xDC00 || low > 0xDFFF) {
+                        throw ParseError("Unpaired surrogate in unicode escape");
+                    }
+                    code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                } else if (code_point >= 0xDC00 && code_point <= 0xDFFF) {
+                    throw ParseError("Unpaired surrogate in unicode escape");
+                }
+                AppendUtf8(scratch, code_point);
+                break;
+            }
+            default:
+                throw ParseError("Invalid escape sequence");
+        }
+        ++pos_;
+    }
+    ++pos_;
+    return scratch;
+}
+
+void ObjectReader::SkipString() {
+    Expect('"');
+    while (Peek() != '"') {
+        if (input_[pos_] == '\\') {
+            ++pos_;
+        }
+        ++pos_;
+    }
+    ++pos_;
+}
+
+}  // namespace json
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace json {
+
+/// Thrown on malformed input or on a value of unexpected type.
+class ParseError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/// @brief Pull-style reader over the members of a single JSON object.
+///
+/// Walks the input once without building a DOM: the caller advances with
+/// Next(), dispatches on Key() and either reads the value into its own typed
+/// field or skips it. Keys are returned as views into the input unless they
+/// contain escapes.
+class ObjectReader {
+public:
+    /// @throws ParseError If the input does not start with an object.
+    explicit ObjectReader(std::string_view input);
+
+    /// @brief Advances to the next member.
+    /// @return false once the closing brace is consumed.
+    /// @throws ParseError On malformed input or trailing garbage.
+    bool Next();
+
+    /// @brief Returns the key of the current member.
+    std::string_view Key() const { return key_; }
+
+    /// @brief Reads the current value as a string.
+    /// @throws ParseError If the value is not a string.
+    std::string ReadString();
+
+    /// @brief Reads the current value as an unsigned integer.
+    ///
+    /// Both JSON numbers and numeric strings are accepted.
+    ///
+    /// @throws ParseError If the value is neither, or does not fit.
+    std::uint64_t ReadUInt64();
+
+    /// @brief Skips the current value, including nested objects and arrays.
+    void SkipValue();
+
+private:
+    void SkipWhitespace();
+    char Peek();
+    void Expect(char expected);
+    std::string_view ReadStringView(std::string& scratch);
+    void SkipString();
+
+    std::string_view input_;
+    std::size_t pos_{0};
+    std::string_view key_;
+    std::string key_scratch_;
+    bool value_pending_{false};
+    bool first_member_{true};
+    bool finished_{false};
+};
+
+}  // namespace json
@@ -0,0 +1,128 @@
+#include "requests.hpp"
+#include "reader.hpp"
+
+#include <limits>
+
+namespace {
+
+void RequireField(bool present, std::string_view name) {
+    if (!present) {
+        throw json::ParseError("Missing required field '" + std::string{name} + "'");
+    }
+}
+
+std::uint32_t ReadTotpCode(json::ObjectReader& reader) {
+    const auto totp_code = reader.ReadUInt64();
+    if (totp_code > std::numeric_limits<std::uint32_t>::max()) {
+        throw json::ParseError("TOTP code is out of range");
+    }
+    return static_cast<std::uint32_t>(totp_code);
+}
+
+}  // namespace
+
+namespace json {
+
+RegisterUserRequest ParseRegisterUserRequest(std::string_view body) {
+    RegisterUserRequest request;
+    bool has_username = false;
+
+    ObjectReader reader{body};
+    while (reader.Next()) {
+        if (reader.Key() == "username") {
+            request.username = reader.ReadString();
+            has_username = true;
+        } else {
+            reader.SkipValue();
+        }
+    }
+
+    RequireField(has_username, "username");
+    return request;
+}
+
+DeleteUserRequest ParseDeleteUserRequest(std::string_view body) {
+    DeleteUserRequest request;
+    bool has_username = false;
+    bool has_totp_code = false;
+
+    ObjectReader reader{body};
+    while (reader.Next()) {
+        const auto key = reader.Key();
+        if (key == "username") {
+            request.username = reader.ReadString();
+            has_username = true;
+        } else if (key == "totp_code") {
+            request.totp_code = ReadTotpCode(reader);
+            has_totp_code = true;
+        } else {
+            reader.SkipValue();
+        }
+    }
+
+    RequireField(has_username, "username");
+    RequireField(has_totp_code, "totp_code");
+    return request;
+}
+
+AuthRequest ParseAuthRequest(std::string_view body) {
+    AuthRequest request;
+    bool has_username = false;
+    bool has_master_key = false;
+    bool has_totp_code = false;
+
+    ObjectReader reader{body};
+    while (reader.Next()) {
+        const auto key = reader.Key();
+        if (key == "username") {
+            request.username = reader.ReadString();
+            has_username = true;
+        } else if (key == "master_key") {
+            request.master_key = reader.ReadString();
+            has_master_key = true;
+        } else if (key == "totp_code") {
+            request.totp_code = ReadTotpCode(reader);
+            has_totp_code = true;
+        } else {
+            reader.SkipValue();
+        }
+    }
+
+    RequireField(has_username, "username");
+    RequireField(has_master_key, "master_key");
+    RequireField(has_totp_code, "totp_code");
+    return request;
+}
+
+CreatePasswordRequest ParseCreatePasswordRequest(std::string_view body) {
+    CreatePasswordRequest request;
+    bool has_service = false;
+    bool has_login = false;
+    bool has_password = false;
+
+    ObjectReader reader{body};
+    while (reader.Next()) {
+        const auto key = reader.Key();
+        if (key == "service") {
+            request.service = reader.ReadString();
+            has_service = true;
+        } else if (key == "login") {
+            request.login = reader.ReadString();
+            has_login = true;
+        } else if (key == "password") {
+            request.password = reader.ReadString();
+            has_password = true;
+        } else if (key == "totp_secret") {
+            request.totp_secret = reader.ReadString();
+        } else {
+            reader.SkipValue();
+        }
+    }
+
+    RequireField(has_service, "service");
+    RequireField(has_login, "login");
+    RequireField(has_password, "password");
+    return request;
+}
+
+}  // namespace json
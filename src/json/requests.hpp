@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace json {
+
+/// Body of POST /api/v1/user.
+struct RegisterUserRequest {
+    std::string username;
+};
+
+/// Body of DELETE /api/v1/user.
+struct DeleteUserRequest {
+    std::string username;
+    std::uint32_t totp_code;
+};
+
+/// Body of POST /api/v1/auth and POST /api/v1/user/master-key.
+struct AuthRequest {
+    std::string username;
+    std::string master_key;
+    std::uint32_t totp_code;
+};
+
+/// Body of POST /api/v1/password.
+struct CreatePasswordRequest {
+    std::string service;
+    std::string login;
+    std::string password;
+
+    /// Base32 secret of the second factor of the service, if the entry has one.
+    std::optional<std::string> totp_secret;
+};
+
+/// @brief Parses a user registration request body.
+/// @throws json::ParseError On malformed input or missing fields.
+RegisterUserRequest ParseRegisterUserRequest(std::string_view body);
+
+/// @brief Parses a user deletion request body.
+/// @throws json::ParseError On malformed input or missing fields.
+DeleteUserRequest ParseDeleteUserRequest(std::string_view body);
+
+/// @brief Parses an authentication request body.
+/// @throws json::ParseError On malformed input or missing fields.
+AuthRequest ParseAuthRequest(std::string_view body);
+
+/// @brief Parses a password creation request body.
+/// @throws json::ParseError On malformed input or missing fields.
+CreatePasswordRequest ParseCreatePasswordRequest(std::string_view body);
+
+}  // namespace json
@@ -0,0 +1,121 @@
+#include "requests.hpp"
+#include "writer.hpp"
+
+#include <userver/formats/json/serialize.hpp>
+#include <userver/formats/json/value.hpp>
+#include <userver/formats/json/value_builder.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Counts heap allocations made by the whole binary, so the benchmarks can report allocations per request.
+namespace {
+std::atomic<std::size_t> allocations{0};
+}  // namespace
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace {
+
+constexpr std::string_view kAuthBody =
+    R"({"username": "svinokrys2000", "master_key": "0fP7zSWbm7qQ3vJ0mYcUq3lXq+4L2mC9s0r0bJ6Hn1I=", "totp_code": "123456"})";
+
+std::vector<models::Password> MakePasswords(std::size_t count) {
+    std::vector<models::Password> passwords(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        auto& password = passwords[i];
+        password.id = static_cast<std::int32_t>(i + 1);
+        password.user_id = 42;
+        password.service = "service-" + std::to_string(i);
+        password.login = "login-" + std::to_string(i);
+        password.created_at = std::chrono::system_clock::now();
+        password.updated_at = password.created_at;
+    }
+    return passwords;
+}
+
+/// The serialization used before the StringBuilder writer: a ValueBuilder per row
+std::string SerializeWithValueBuilder(const std::vector<models::Password>& passwords, const std::string& decrypted) {
+    userver::formats::json::ValueBuilder response(userver::formats::common::Type::kArray);
+    for (const auto& password : passwords) {
+        userver::formats::json::ValueBuilder builder;
+        builder["id"] = password.id;
+        builder["user_id"] = password.user_id;
+        builder["service"] = password.service;
+        builder["login"] = password.login;
+        builder["password"] = decrypted;
+        builder["created_at"] = password.created_at;
+        builder["updated_at"] = password.updated_at;
+        response.PushBack(builder.ExtractValue());
+    }
+    return userver::formats::json::ToString(response.ExtractValue());
+}
+
+std::string SerializeWithStringBuilder(const std::vector<models::Password>& passwords, const std::string& decrypted) {
+    userver::formats::json::StringBuilder response;
+    {
+        const userver::formats::json::StringBuilder::ArrayGuard guard{response};
+        for (const auto& password : passwords) {
+            json::WritePassword(password, decrypted, response);
+        }
+    }
+    return response.GetString();
+}
+
+template <typename Function>
+void RunCountingAllocations(benchmark::State& state, Function function) {
+    const auto allocations_before = allocations.load(std::memory_order_relaxed);
+    for ([[maybe_unused]] auto _ : state) {
+        benchmark::DoNotOptimize(function());
+    }
+    state.counters["allocs_per_request"] = benchmark::Counter(
+        static_cast<double>(allocations.load(std::memory_order_relaxed) - allocations_before),
+        benchmark::Counter::kAvgIterations
+    );
+}
+
+void PasswordsValueBuilder(benchmark::State& state) {
+    const auto passwords = MakePasswords(state.range(0));
+    const std::string decrypted = "correct horse battery staple";
+    RunCountingAllocations(state, [&] { return SerializeWithValueBuilder(passwords, decrypted); });
+}
+BENCHMARK(PasswordsValueBuilder)->Arg(1)->Arg(20)->Arg(200);
+
+void PasswordsStringBuilder(benchmark::State& state) {
+    const auto passwords = MakePasswords(state.range(0));
+    const std::string decrypted = "correct horse battery staple";
+    RunCountingAllocations(state, [&] { return SerializeWithStringBuilder(passwords, decrypted); });
+}
+BENCHMARK(PasswordsStringBuilder)->Arg(1)->Arg(20)->Arg(200);
+
+void AuthRequestDom(benchmark::State& state) {
+    RunCountingAllocations(state, [] {
+        const auto body = userver::formats::json::FromString(kAuthBody);
+        return body["username"].As<std::string>().size() + body["master_key"].As<std::string>().size() +
+               std::stoul(body["totp_code"].As<std::string>());
+    });
+}
+BENCHMARK(AuthRequestDom);
+
+void AuthRequestTyped(benchmark::State& state) {
+    RunCountingAllocations(state, [] {
+        const auto request = json::ParseAuthRequest(kAuthBody);
+        return request.username.size() + request.master_key.size() + request.totp_code;
+    });
+}
+BENCHMARK(AuthRequestTyped);
+
+}  // namespace
@@ -0,0 +1,129 @@
+#include "reader.hpp"
+#include "requests.hpp"
+
+#include <userver/utest/utest.hpp>
+
+using namespace json;
+
+TEST(JsonObjectReaderTest, ReadsMembersInOrder) {
+    ObjectReader reader{R"( { "a" : "x", "b":42 ,"c":"y" } )"};
+
+    ASSERT_TRUE(reader.Next());
+    EXPECT_EQ(reader.Key(), "a");
+    EXPECT_EQ(reader.ReadString(), "x");
+
+    ASSERT_TRUE(reader.Next());
+    EXPECT_EQ(reader.Key(), "b");
+    EXPECT_EQ(reader.ReadUInt64(), 42);
+
+    ASSERT_TRUE(reader.Next());
+    EXPECT_EQ(reader.Key(), "c");
+    EXPECT_EQ(reader.ReadString(), "y");
+
+    EXPECT_FALSE(reader.Next());
+    EXPECT_FALSE(reader.Next());
+}
+
+TEST(JsonObjectReaderTest, EmptyObject) {
+    ObjectReader reader{"{}"};
+    EXPECT_FALSE(reader.Next());
+}
+
+TEST(JsonObjectReaderTest, UnescapesStrings) {
+    ObjectReader reader{R"({"k\"ey": "line\nbreak \"quoted\" \\ \/ é 😀"})"};
+
+    ASSERT_TRUE(reader.Next());
+    EXPECT_EQ(reader.Key(), "k\"ey");
+    EXPECT_EQ(reader.ReadString(), "line\nbreak \"quoted\" \\ / \xc3\xa9 \xf0\x9f\x98\x80");
+    EXPECT_FALSE(reader.Next());
+}
+
+TEST(JsonObjectReaderTest, SkipsUnreadAndNestedValues) {
+    ObjectReader reader{R"({"skip": {"x": [1, 2, {"y": "}]"}]}, "flag": true, "n": null, "f": -1.5e3, "last": "v"})"};
+
+    std::vector<std::string> keys;
+    std::string last;
+    while (reader.Next()) {
+        keys.emplace_back(reader.Key());
+        if (reader.Key() == "last") {
+            last = reader.ReadString();
+        }
+    }
+
+    EXPECT_EQ(keys, (std::vector<std::string>{"skip", "flag", "n", "f", "last"}));
+    EXPECT_EQ(last, "v");
+}
+
+TEST(JsonObjectReaderTest, ReadsNumericStrings) {
+    ObjectReader reader{R"({"code": "012345"})"};
+    ASSERT_TRUE(reader.Next());
+    EXPECT_EQ(reader.ReadUInt64(), 12345);
+}
+
+TEST(JsonObjectReaderTest, RejectsMalformedInput) {
+    const auto read_all = [](std::string_view input) {
+        ObjectReader reader{input};
+        while (reader.Next()) {
+            reader.ReadString();
+        }
+    };
+
+    EXPECT_THROW(read_all(""), ParseError);
+    EXPECT_THROW(read_all("[]"), ParseError);
+    EXPECT_THROW(read_all(R"({"a": "b")"), ParseError);
+    EXPECT_THROW(read_all(R"({"a": "b",})"), ParseError);
+    EXPECT_THROW(read_all(R"({"a" "b"})"), ParseError);
+    EXPECT_THROW(read_all(R"({"a": 1})"), ParseError);
+    EXPECT_THROW(read_all(R"({"a": "b"} trailing)"), ParseError);
+    EXPECT_THROW(read_all(R"({"a": "\x"})"), ParseError);
+    EXPECT_THROW(read_all(R"({"a": "\ud83d"})"), ParseError);
+    EXPECT_THROW(read_all("{\"a\": \"raw\ncontrol\"}"), ParseError);
+}
+
+TEST(JsonObjectReaderTest, RejectsInvalidIntegers) {
+    for (const auto* input : {R"({"n": -1})", R"({"n": "12a"})", R"({"n": ""})", R"({"n": 99999999999999999999})"}) {
+        ObjectReader reader{input};
+        ASSERT_TRUE(reader.Next());
+        EXPECT_THROW(reader.ReadUInt64(), ParseError) << input;
+    }
+}
+
+TEST(JsonRequestsTest, ParseAuthRequest) {
+    const auto request = ParseAuthRequest(R"({"username": "alice", "master_key": "a2V5", "totp_code": "000123"})");
+    EXPECT_EQ(request.username, "alice");
+    EXPECT_EQ(request.master_key, "a2V5");
+    EXPECT_EQ(request.totp_code, 123);
+
+    EXPECT_EQ(ParseAuthRequest(R"({"totp_code": 7, "master_key": "", "username": "bob", "extra": [1]})").totp_code, 7);
+}
+
+TEST(JsonRequestsTest, ParseAuthRequestMissingField) {
+    EXPECT_THROW(ParseAuthRequest(R"({"username": "alice", "master_key": "a2V5"})"), ParseError);
+    EXPECT_THROW(ParseAuthRequest(R"({"username": "alice", "master_key": "a2V5", "totp_code": "99999999999"})"), ParseError);
+}
+
+TEST(JsonRequestsTest, ParseCreatePasswordRequest) {
+    const auto request = ParseCreatePasswordRequest(R"({"service": "mail", "login": "me", "password": "p\"w"})");
+    EXPECT_EQ(request.service, "mail");
+    EXPECT_EQ(request.login, "me");
+    EXPECT_EQ(request.password, "p\"w");
+    EXPECT_FALSE(request.totp_secret);
+
+    const auto with_totp = ParseCreatePasswordRequest(
+        R"({"service": "mail", "login": "me", "password": "pw", "totp_secret": "JBSWY3DPEHPK3PXP"})"
+    );
+    EXPECT_EQ(with_totp.totp_secret, "JBSWY3DPEHPK3PXP");
+
+    EXPECT_THROW(ParseCreatePasswordRequest(R"({"service": "mail", "login": "me"})"), ParseError);
+    EXPECT_THROW(ParseCreatePasswordRequest(R"({"service": "mail", "login": "me", "password": 1})"), ParseError);
+}
+
+TEST(JsonRequestsTest, ParseUserRequests) {
+    EXPECT_EQ(ParseRegisterUserRequest(R"({"username": "alice"})").username, "alice");
+    EXPECT_THROW(ParseRegisterUserRequest(R"({"name": "alice"})"), ParseError);
+
+    const auto request = ParseDeleteUserRequest(R"({"username": "alice", "totp_code": "123456"})");
+    EXPECT_EQ(request.username, "alice");
+    EXPECT_EQ(request.totp_code, 123456);
+    EXPECT_THROW(ParseDeleteUserRequest(R"({"username": "alice"})"), ParseError);
+}
@@ -0,0 +1,63 @@
+#include "writer.hpp"
+
+#include <userver/formats/json/serialize.hpp>
+#include <userver/formats/json/value.hpp>
+#include <userver/utest/utest.hpp>
+#include <userver/utils/datetime.hpp>
+
+using namespace json;
+
+namespace {
+
+std::chrono::system_clock::time_point MakeTimePoint(std::int64_t microseconds) {
+    return std::chrono::system_clock::time_point{
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::microseconds{microseconds})
+    };
+}
+
+}  // namespace
+
+TEST(JsonWriterTest, FormatTimestampMatchesTimestring) {
+    // epoch, leap day, end of century, microseconds, far future
+    for (const std::int64_t microseconds :
+         {0LL, 951782400000000LL, 946684799999999LL, 1672531200123456LL, 4102444800000001LL}) {
+        const auto timestamp = MakeTimePoint(microseconds);
+        TimestampBuffer buffer;
+        EXPECT_EQ(FormatTimestamp(timestamp, buffer), userver::utils::datetime::Timestring(timestamp));
+    }
+}
+
+TEST(JsonWriterTest, FormatTimestamp) {
+    TimestampBuffer buffer;
+    EXPECT_EQ(FormatTimestamp(MakeTimePoint(951782400000000LL), buffer), "2000-02-29T00:00:00.000000+0000");
+    EXPECT_EQ(FormatTimestamp(MakeTimePoint(1672531199654321LL), buffer), "2022-12-31T23:59:59.654321+0000");
+}
+
+TEST(JsonWriterTest, WritePasswordArray) {
+    models::Password password;
+    password.id = 7;
+    password.user_id = 3;
+    password.service = "mail \"work\"";
+    password.login = "me";
+    password.created_at = MakeTimePoint(0);
+    password.updated_at = MakeTimePoint(1000000);
+
+    userver::formats::json::StringBuilder builder;
+    {
+        const userver::formats::json::StringBuilder::ArrayGuard guard{builder};
+        WritePassword(password, "s3cr3t", builder);
+        WritePassword(password, "", builder);
+    }
+
+    const auto parsed = userver::formats::json::FromString(builder.GetString());
+    ASSERT_TRUE(parsed.IsArray());
+    ASSERT_EQ(parsed.GetSize(), 2);
+    EXPECT_EQ(parsed[0]["id"].As<int>(), 7);
+    EXPECT_EQ(parsed[0]["user_id"].As<int>(), 3);
+    EXPECT_EQ(parsed[0]["service"].As<std::string>(), "mail \"work\"");
+    EXPECT_EQ(parsed[0]["login"].As<std::string>(), "me");
+    EXPECT_EQ(parsed[0]["password"].As<std::string>(), "s3cr3t");
+    EXPECT_EQ(parsed[0]["created_at"].As<std::string>(), "1970-01-01T00:00:00.000000+0000");
+    EXPECT_EQ(parsed[0]["updated_at"].As<std::string>(), "1970-01-01T00:00:01.000000+0000");
+    EXPECT_EQ(parsed[1]["password"].As<std::string>(), "");
+}
@@ -0,0 +1,97 @@
+#include "writer.hpp"
+
+namespace {
+
+/// Writes a zero-padded decimal of exactly `width` digits.
+char* WriteDigits(char* out, std::int64_t value, int width) {
+    for (int i = width - 1; i >= 0; --i) {
+        out[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+    return out + width;
+}
+
+struct CivilDate {
+    std::int64_t year;
+    unsigned month;
+    unsigned day;
+};
+
+/// Howard Hinnant's civil_from_days: days since 1970-01-01 to a proleptic Gregorian date.
+CivilDate CivilFromDays(std::int64_t days) {
+    days += 719468;
+    const std::int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const auto day_of_era = static_cast<unsigned>(days - era * 146097);
+    const unsigned year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    const unsigned day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    const unsigned month_index = (5 * day_of_year + 2) / 153;
+    const unsigned day = day_of_year - (153 * month_index + 2) / 5 + 1;
+    const unsigned month = month_index < 10 ? month_index + 3 : month_index - 9;
+    const std::int64_t year = static_cast<std::int64_t>(year_of_era) + era * 400 + (month <= 2);
+    return {year, month, day};
+}
+
+}  // namespace
+
+namespace json {
+
+std::string_view FormatTimestamp(std::chrono::system_clock::time_point timestamp, TimestampBuffer& buffer) {
+    using std::chrono::duration_cast;
+
+    const auto since_epoch = duration_cast<std::chrono::microseconds>(timestamp.time_since_epoch());
+    const auto days = std::chrono::floor<std::chrono::days>(since_epoch);
+    const auto time_of_day = since_epoch - days;
+
+    const auto date = CivilFromDays(days.count());
+    const auto seconds = duration_cast<std::chrono::seconds>(time_of_day).count();
+    const auto microseconds = (time_of_day - std::chrono::seconds{seconds}).count();
+
+    char* out = buffer.data();
+    out = WriteDigits(out, date.year, 4);
+    *out++ = '-';
+    out = WriteDigits(out, date.month, 2);
+    *out++ = '-';
+    out = WriteDigits(out, date.day, 2);
+    *out++ = 'T';
+    out = WriteDigits(out, seconds / 3600, 2);
+    *out++ = ':';
+    out = WriteDigits(out, seconds / 60 % 60, 2);
+    *out++ = ':';
+    out = WriteDigits(out, seconds % 60, 2);
+    *out++ = '.';
+    out = WriteDigits(out, microseconds, 6);
+    for (const char c : std::string_view{"+0000"}) {
+        *out++ = c;
+    }
+
+    return {buffer.data(), static_cast<std::size_t>(out - buffer.data())};
+}
+
+void WriteTimestamp(std::chrono::system_clock::time_point timestamp, userver::formats::json::StringBuilder& builder) {
+    TimestampBuffer buffer;
+    builder.WriteString(FormatTimestamp(timestamp, buffer));
+}
+
+void WritePassword(
+    const models::Password& password,
+    std::string_view decrypted,
+    userver::formats::json::StringBuilder& builder
+) {
+    const userver::formats::json::StringBuilder::ObjectGuard guard{builder};
+    builder.Key("id");
+    builder.WriteInt64(password.id);
+    builder.Key("user_id");
+    builder.WriteInt64(password.user_id);
+    builder.Key("service");
+    builder.WriteString(password.service);
+    builder.Key("login");
+    builder.WriteString(password.login);
+    builder.Key("password");
+    builder.WriteString(decrypted);
+    builder.Key("created_at");
+    WriteTimestamp(password.created_at, builder);
+    builder.Key("updated_at");
+    WriteTimestamp(password.updated_at, builder);
+}
+
+}  // namespace json
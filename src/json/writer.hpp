@@ -0,0 +1,41 @@
+#pragma once
+
+#include "models/password.hpp"
+
+#include <userver/formats/json/string_builder.hpp>
+
+#include <array>
+#include <chrono>
+#include <string_view>
+
+namespace json {
+
+/// Enough for "YYYY-MM-DDTHH:MM:SS.ffffff+0000".
+inline constexpr std::size_t kTimestampBufferSize = 32;
+
+using TimestampBuffer = std::array<char, kTimestampBufferSize>;
+
+/// @brief Formats a timestamp in UTC without allocating.
+///
+/// Produces the same text as userver::utils::datetime::Timestring() with its
+/// default format and time zone, which is what ValueBuilder used to emit.
+///
+/// @param timestamp The time point to format.
+/// @param buffer Storage for the result.
+/// @return A view into the buffer.
+std::string_view FormatTimestamp(std::chrono::system_clock::time_point timestamp, TimestampBuffer& buffer);
+
+/// @brief Appends a timestamp as a JSON string value.
+void WriteTimestamp(std::chrono::system_clock::time_point timestamp, userver::formats::json::StringBuilder& builder);
+
+/// @brief Appends a password entry as a JSON object.
+/// @param password The stored entry.
+/// @param decrypted The decrypted password of the entry.
+/// @param builder The output.
+void WritePassword(
+    const models::Password& password,
+    std::string_view decrypted,
+    userver::formats::json::StringBuilder& builder
+);
+
+}  // namespace json
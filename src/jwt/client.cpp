@@ -31,7 +31,12 @@ std::string Client::GenerateToken(const Payload& payload) const {
     // encode payload
     userver::formats::json::ValueBuilder body;
     body["user_id"] = payload.user_id;
-    body["master_key"] = payload.master_key;
+    if (!payload.master_key.empty()) {
+        body["master_key"] = payload.master_key;
+    }
+    if (!payload.data_key.empty()) {
+        body["data_key"] = payload.data_key;
+    }
     const auto encoded_body =
         userver::crypto::base64::Base64Encode(userver::formats::json::ToString(body.ExtractValue()));
 
@@ -74,7 +79,8 @@ Payload Client::ValidateToken(const std::string& token) const {
     const auto decoded_body = userver::formats::json::FromString(userver::crypto::base64::Base64Decode(encoded_body));
     Payload payload;
     payload.user_id = decoded_body["user_id"].As<int32_t>();
-    payload.master_key = decoded_body["master_key"].As<std::string>();
+    payload.master_key = decoded_body["master_key"].As<std::string>("");
+    payload.data_key = decoded_body["data_key"].As<std::string>("");
 
     return payload;
 }
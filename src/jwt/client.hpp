@@ -10,8 +10,11 @@ struct Payload {
     /// User ID associated with the token.
     std::int32_t user_id;
 
-    /// Master key used for encryption/decryption.
+    /// Master key used for encryption/decryption, only in tokens issued before data keys were introduced.
     std::string master_key;
+
+    /// Data key used for encryption/decryption.
+    std::string data_key;
 };
 
 /// Provides functionality for generating and validating JWT tokens.
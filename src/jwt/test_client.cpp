@@ -69,3 +69,16 @@ TEST(JwtClientTest, ValidateToken_InvalidToken) {
     // Validating an invalid token should throw an exception
     EXPECT_THROW(client.ValidateToken(invalid_token), std::runtime_error);
 }
+
+/// Test ValidateToken with a data key instead of a master key
+TEST(JwtClientTest, ValidateToken_DataKey) {
+    Client client("test_secret_key", std::chrono::milliseconds{60000});
+
+    Payload payload = {.user_id = 12345, .data_key = "test_data_key"};
+
+    auto parsed_payload = client.ValidateToken(client.GenerateToken(payload));
+
+    EXPECT_EQ(parsed_payload.user_id, payload.user_id);
+    EXPECT_EQ(parsed_payload.data_key, payload.data_key);
+    EXPECT_TRUE(parsed_payload.master_key.empty());
+}
@@ -0,0 +1,134 @@
+#include "client.hpp"
+#include "totp/utils.hpp"
+
+#include <userver/clients/http/client.hpp>
+#include <userver/formats/json/serialize.hpp>
+#include <userver/formats/json/string_builder.hpp>
+#include <userver/formats/json/value.hpp>
+#include <userver/http/common_headers.hpp>
+#include <userver/http/content_type.hpp>
+#include <userver/http/url.hpp>
+
+#include <stdexcept>
+
+namespace {
+
+constexpr int kOk = 200;
+
+void ExpectOk(int status, std::string_view what, std::string_view body) {
+    if (status != kOk) {
+        throw std::runtime_error(
+            std::string{what} + " failed with status " + std::to_string(status) + ": " + std::string{body}
+        );
+    }
+}
+
+}  // namespace
+
+namespace loadgen {
+
+ApiClient::ApiClient(
+    userver::clients::http::Client& http_client,
+    std::string base_url,
+    std::chrono::milliseconds timeout
+)
+    : http_client_{http_client}, base_url_{std::move(base_url)}, timeout_{timeout} {}
+
+Credentials ApiClient::Register(const std::string& username) const {
+    userver::formats::json::StringBuilder request;
+    {
+        const userver::formats::json::StringBuilder::ObjectGuard guard{request};
+        request.Key("username");
+        request.WriteString(username);
+    }
+
+    const auto response = Post("/api/v1/user", request.GetString(), {});
+    ExpectOk(response.status, "Registration of " + username, response.body);
+
+    const auto json = userver::formats::json::FromString(response.body);
+    return {username, json["master_key"].As<std::string>(), json["totp_secret"].As<std::string>()};
+}
+
+std::string ApiClient::Login(const Credentials& credentials) const {
+    const auto response = PostAuth(credentials);
+    ExpectOk(response.status, "Login of " + credentials.username, response.body);
+    return userver::formats::json::FromString(response.body)["token"].As<std::string>();
+}
+
+std::vector<std::int64_t> ApiClient::GetPasswordIds(const std::string& token) const {
+    const auto response = Get("/api/v1/passwords", token);
+    ExpectOk(response.status, "Password listing", response.body);
+
+    std::vector<std::int64_t> ids;
+    for (const auto& password : userver::formats::json::FromString(response.body)) {
+        ids.push_back(password["id"].As<std::int64_t>());
+    }
+    return ids;
+}
+
+int ApiClient::Authenticate(const Credentials& credentials) const { return PostAuth(credentials).status; }
+
+int ApiClient::ListPasswords(const std::string& token, std::string_view search_term) const {
+    if (search_term.empty()) {
+        return Get("/api/v1/passwords", token).status;
+    }
+    return Get(userver::http::MakeUrl("/api/v1/passwords", {{"search_term", search_term}}), token).status;
+}
+
+int ApiClient::GetPassword(const std::string& token, std::int64_t password_id) const {
+    return Get("/api/v1/password/" + std::to_string(password_id), token).status;
+}
+
+int ApiClient::CreatePassword(const std::string& token, std::string_view service, std::string_view login) const {
+    userver::formats::json::StringBuilder request;
+    {
+        const userver::formats::json::StringBuilder::ObjectGuard guard{request};
+        request.Key("service");
+        request.WriteString(service);
+        request.Key("login");
+        request.WriteString(login);
+        request.Key("password");
+        request.WriteString("loadgen-password");
+    }
+    return Post("/api/v1/password", request.GetString(), token).status;
+}
+
+ApiClient::Response ApiClient::Get(const std::string& path, const std::string& token) const {
+    auto request = http_client_.CreateRequest()
+                       .get(base_url_ + path)
+                       .headers({{userver::http::headers::kAuthorization, "Bearer " + token}})
+                       .timeout(timeout_);
+    const auto response = request.perform();
+    return {static_cast<int>(response->status_code()), response->body()};
+}
+
+ApiClient::Response ApiClient::Post(const std::string& path, std::string body, const std::string& token) const {
+    const auto content_type = userver::http::content_type::kApplicationJson.ToString();
+    auto request = http_client_.CreateRequest().post(base_url_ + path, std::move(body)).timeout(timeout_);
+    if (token.empty()) {
+        request.headers({{userver::http::headers::kContentType, content_type}});
+    } else {
+        request.headers({
+            {userver::http::headers::kContentType, content_type},
+            {userver::http::headers::kAuthorization, "Bearer " + token},
+        });
+    }
+    const auto response = request.perform();
+    return {static_cast<int>(response->status_code()), response->body()};
+}
+
+ApiClient::Response ApiClient::PostAuth(const Credentials& credentials) const {
+    userver::formats::json::StringBuilder request;
+    {
+        const userver::formats::json::StringBuilder::ObjectGuard guard{request};
+        request.Key("username");
+        request.WriteString(credentials.username);
+        request.Key("master_key");
+        request.WriteString(credentials.master_key);
+        request.Key("totp_code");
+        request.WriteUInt64(totp::GenerateTotpCode(credentials.totp_secret));
+    }
+    return Post("/api/v1/auth", request.GetString(), {});
+}
+
+}  // namespace loadgen
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace userver::clients::http {
+class Client;
+}  // namespace userver::clients::http
+
+namespace loadgen {
+
+/// Secrets returned by the registration endpoint.
+struct Credentials {
+    std::string username;
+    std::string master_key;  ///< base64, as sent by the service
+    std::string totp_secret;
+};
+
+/// @brief Thin client over the vaulty HTTP API.
+///
+/// Setup calls throw std::runtime_error on unexpected statuses. Calls used in the measured
+/// loop return the HTTP status and leave it to the caller to count failures.
+class ApiClient final {
+public:
+    ApiClient(userver::clients::http::Client& http_client, std::string base_url, std::chrono::milliseconds timeout);
+
+    Credentials Register(const std::string& username) const;
+
+    /// @brief Logs in with a freshly computed TOTP code and returns the JWT.
+    std::string Login(const Credentials& credentials) const;
+
+    /// @brief Returns ids of all passwords in the vault.
+    std::vector<std::int64_t> GetPasswordIds(const std::string& token) const;
+
+    int Authenticate(const Credentials& credentials) const;
+    int ListPasswords(const std::string& token, std::string_view search_term) const;
+    int GetPassword(const std::string& token, std::int64_t password_id) const;
+    int CreatePassword(const std::string& token, std::string_view service, std::string_view login) const;
+
+private:
+    struct Response {
+        int status;
+        std::string body;
+    };
+
+    Response Get(const std::string& path, const std::string& token) const;
+    Response Post(const std::string& path, std::string body, const std::string& token) const;
+    Response PostAuth(const Credentials& credentials) const;
+
+    userver::clients::http::Client& http_client_;
+    const std::string base_url_;
+    const std::chrono::milliseconds timeout_;
+};
+
+}  // namespace loadgen
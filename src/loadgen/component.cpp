@@ -0,0 +1,374 @@
+#include "component.hpp"
+
+#include <userver/clients/http/component.hpp>
+#include <userver/components/component.hpp>
+#include <userver/engine/sleep.hpp>
+#include <userver/engine/task/task_with_result.hpp>
+#include <userver/logging/log.hpp>
+#include <userver/utils/async.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+constexpr std::chrono::milliseconds kLateThreshold{1};
+
+bool IsSuccess(int status) { return status >= 200 && status < 300; }
+
+std::uint64_t ToMicroseconds(std::chrono::steady_clock::duration duration) {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+}
+
+void Account(
+    loadgen::Results& results,
+    loadgen::Operation operation,
+    int status,
+    std::chrono::steady_clock::duration latency
+) {
+    const auto index = static_cast<std::size_t>(operation);
+    results.latencies[index].Record(ToMicroseconds(latency));
+    if (!IsSuccess(status)) {
+        ++results.errors[index];
+    }
+}
+
+loadgen::Mode ParseMode(const std::string& mode) {
+    if (mode == "closed") {
+        return loadgen::Mode::kClosed;
+    }
+    if (mode == "open") {
+        return loadgen::Mode::kOpen;
+    }
+    throw std::invalid_argument("Unknown load generator mode: " + mode);
+}
+
+std::string FormatLatencies(const loadgen::Histogram& histogram) {
+    return fmt::format(
+        "{:>9} {:>9} {:>9} {:>9} {:>9} {:>9}",
+        histogram.GetValueAtPercentile(50),
+        histogram.GetValueAtPercentile(90),
+        histogram.GetValueAtPercentile(99),
+        histogram.GetValueAtPercentile(99.9),
+        histogram.GetMax(),
+        static_cast<std::uint64_t>(histogram.GetMean())
+    );
+}
+
+}  // namespace
+
+namespace loadgen {
+
+Settings Parse(const userver::yaml_config::YamlConfig& value, userver::formats::parse::To<Settings>) {
+    Settings settings;
+    settings.base_url = value["base_url"].As<std::string>(settings.base_url);
+    settings.timeout = value["timeout"].As<std::chrono::milliseconds>(settings.timeout);
+    settings.users = value["users"].As<std::size_t>(settings.users);
+    settings.passwords_per_user = value["passwords_per_user"].As<std::size_t>(settings.passwords_per_user);
+    settings.mix = value["mix"].As<std::string>(settings.mix);
+    settings.mode = ParseMode(value["mode"].As<std::string>("closed"));
+    settings.steps = value["steps"].As<std::vector<std::size_t>>(settings.steps);
+    settings.max_in_flight = value["max_in_flight"].As<std::size_t>(settings.max_in_flight);
+    settings.warmup = value["warmup"].As<std::chrono::seconds>(settings.warmup);
+    settings.duration = value["duration"].As<std::chrono::seconds>(settings.duration);
+    settings.label = value["label"].As<std::string>(settings.label);
+
+    if (settings.users == 0 || settings.steps.empty() || settings.max_in_flight == 0) {
+        throw std::invalid_argument("users, steps and max_in_flight must not be empty");
+    }
+    return settings;
+}
+
+void Results::Merge(const Results& other) {
+    for (std::size_t i = 0; i < kOperationCount; ++i) {
+        latencies[i].Merge(other.latencies[i]);
+        errors[i] += other.errors[i];
+    }
+    late += other.late;
+}
+
+Component::Component(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& context
+)
+    : userver::components::LoggableComponentBase(config, context),
+      settings_{config.As<Settings>()},
+      mix_{Mix::Parse(settings_.mix)},
+      client_{
+          context.FindComponent<userver::components::HttpClient>().GetHttpClient(),
+          settings_.base_url,
+          settings_.timeout,
+      } {}
+
+void Component::OnAllComponentsLoaded() {
+    SetUp();
+
+    std::cout << fmt::format(
+        "mode={} mix={} users={} warmup={}s duration={}s label={}\n",
+        settings_.mode == Mode::kClosed ? "closed" : "open",
+        mix_.ToString(),
+        settings_.users,
+        settings_.warmup.count(),
+        settings_.duration.count(),
+        settings_.label
+    );
+
+    for (const auto step : settings_.steps) {
+        const auto results = settings_.mode == Mode::kClosed ? RunClosed(step) : RunOpen(step);
+        Report(step, results);
+    }
+}
+
+void Component::SetUp() {
+    // unique per run, so repeated runs against the same database do not collide
+    const auto run_id =
+        std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+    std::vector<userver::engine::TaskWithResult<User>> tasks;
+    tasks.reserve(settings_.users);
+    for (std::size_t i = 0; i < settings_.users; ++i) {
+        tasks.push_back(userver::utils::Async("loadgen-setup", [this, run_id, i] {
+            User user;
+            user.credentials = client_.Register(fmt::format("loadgen-{}-{}", run_id, i));
+            user.token = client_.Login(user.credentials);
+            for (std::size_t j = 0; j < settings_.passwords_per_user; ++j) {
+                const auto status = client_.CreatePassword(user.token, fmt::format("service-{}", j), "loadgen");
+                if (!IsSuccess(status)) {
+                    throw std::runtime_error("Password creation failed with status " + std::to_string(status));
+                }
+            }
+            user.password_ids = client_.GetPasswordIds(user.token);
+            return user;
+        }));
+    }
+
+    users_.clear();
+    for (auto& task : tasks) {
+        users_.push_back(task.Get());
+    }
+    LOG_INFO() << "Registered " << users_.size() << " users with " << settings_.passwords_per_user
+               << " passwords each";
+}
+
+Results Component::RunClosed(std::size_t concurrency) const {
+    const auto measure_from = std::chrono::steady_clock::now() + settings_.warmup;
+    const auto deadline = measure_from + settings_.duration;
+
+    std::vector<userver::engine::TaskWithResult<Results>> workers;
+    workers.reserve(concurrency);
+    for (std::size_t i = 0; i < concurrency; ++i) {
+        workers.push_back(userver::utils::Async("loadgen-worker", [this, i, measure_from, deadline] {
+            Results results;
+            std::mt19937_64 random{i};
+            const auto& user = users_[i % users_.size()];
+
+            for (auto start = std::chrono::steady_clock::now(); start < deadline;
+                 start = std::chrono::steady_clock::now()) {
+                const auto operation = mix_.Pick(random());
+                const auto status = Execute(operation, user, random());
+                if (start >= measure_from) {
+                    Account(results, operation, status, std::chrono::steady_clock::now() - start);
+                }
+            }
+            return results;
+        }));
+    }
+
+    Results total;
+    for (auto& worker : workers) {
+        total.Merge(worker.Get());
+    }
+    return total;
+}
+
+Results Component::RunOpen(std::size_t rate) const {
+    const auto start = std::chrono::steady_clock::now();
+    const auto measure_from = start + settings_.warmup;
+    const auto deadline = measure_from + settings_.duration;
+    const auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::seconds{1}) /
+                          static_cast<std::int64_t>(std::max<std::size_t>(rate, 1));
+
+    // Workers claim arrivals from a shared schedule. Latency is measured from the scheduled
+    // arrival rather than from the actual send, so time spent waiting for a free worker when
+    // the service falls behind is accounted instead of silently lowering the offered load.
+    std::atomic<std::uint64_t> next_arrival{0};
+
+    std::vector<userver::engine::TaskWithResult<Results>> workers;
+    workers.reserve(settings_.max_in_flight);
+    for (std::size_t i = 0; i < settings_.max_in_flight; ++i) {
+        workers.push_back(userver::utils::Async(
+            "loadgen-worker",
+            [this, i, start, measure_from, deadline, interval, &next_arrival] {
+                Results results;
+                std::mt19937_64 random{i};
+
+                while (true) {
+                    const auto arrival = next_arrival.fetch_add(1, std::memory_order_relaxed);
+                    const auto scheduled = start + interval * static_cast<std::int64_t>(arrival);
+                    if (scheduled >= deadline) {
+                        break;
+                    }
+                    userver::engine::SleepUntil(userver::engine::Deadline::FromTimePoint(scheduled));
+
+                    const auto& user = users_[arrival % users_.size()];
+                    const auto sent = std::chrono::steady_clock::now();
+                    const auto operation = mix_.Pick(random());
+                    const auto status = Execute(operation, user, random());
+                    if (scheduled >= measure_from) {
+                        Account(results, operation, status, std::chrono::steady_clock::now() - scheduled);
+                        if (sent - scheduled > kLateThreshold) {
+                            ++results.late;
+                        }
+                    }
+                }
+                return results;
+            }
+        ));
+    }
+
+    Results total;
+    for (auto& worker : workers) {
+        total.Merge(worker.Get());
+    }
+    return total;
+}
+
+int Component::Execute(Operation operation, const User& user, std::uint64_t random) const {
+    try {
+        switch (operation) {
+            case Operation::kAuth:
+                return client_.Authenticate(user.credentials);
+            case Operation::kList:
+                return client_.ListPasswords(user.token, {});
+            case Operation::kSearch: {
+                const auto services = std::max<std::size_t>(settings_.passwords_per_user, 1);
+                return client_.ListPasswords(user.token, fmt::format("service-{}", random % services));
+            }
+            case Operation::kGet:
+                if (user.password_ids.empty()) {
+                    return client_.ListPasswords(user.token, {});
+                }
+                return client_.GetPassword(user.token, user.password_ids[random % user.password_ids.size()]);
+            case Operation::kCreate:
+                return client_.CreatePassword(user.token, fmt::format("created-{}", random), "loadgen");
+        }
+    } catch (const std::exception& ex) {
+        LOG_LIMITED_WARNING() << "Request failed: " << ex.what();
+    }
+    return 0;
+}
+
+void Component::Report(std::size_t step, const Results& results) const {
+    Histogram overall;
+    std::uint64_t errors = 0;
+    for (std::size_t i = 0; i < kOperationCount; ++i) {
+        overall.Merge(results.latencies[i]);
+        errors += results.errors[i];
+    }
+    const auto seconds = static_cast<double>(settings_.duration.count());
+    const auto throughput = seconds > 0 ? static_cast<double>(overall.GetTotalCount()) / seconds : 0.0;
+
+    std::string report = fmt::format(
+        "\n{} {}: {:.1f} req/s, {} errors{}\n{:<8} {:>9} {:>7} {:>9} {:>9} {:>9} {:>9} {:>9} {:>9}\n",
+        settings_.mode == Mode::kClosed ? "concurrency" : "rate",
+        step,
+        throughput,
+        errors,
+        settings_.mode == Mode::kOpen ? fmt::format(", {} late starts", results.late) : std::string{},
+        "op",
+        "count",
+        "errors",
+        "p50 us",
+        "p90 us",
+        "p99 us",
+        "p99.9 us",
+        "max us",
+        "mean us"
+    );
+    for (std::size_t i = 0; i < kOperationCount; ++i) {
+        const auto& histogram = results.latencies[i];
+        if (histogram.GetTotalCount() == 0) {
+            continue;
+        }
+        report += fmt::format(
+            "{:<8} {:>9} {:>7} {}\n",
+            ToString(static_cast<Operation>(i)),
+            histogram.GetTotalCount(),
+            results.errors[i],
+            FormatLatencies(histogram)
+        );
+    }
+    report += fmt::format("{:<8} {:>9} {:>7} {}\n", "all", overall.GetTotalCount(), errors, FormatLatencies(overall));
+
+    // one machine-readable line per step for tools/thread_scaling.sh
+    report += fmt::format(
+        "summary label={} mode={} step={} rps={:.1f} errors={} p50_us={} p99_us={} p999_us={} max_us={}\n",
+        settings_.label.empty() ? "-" : settings_.label,
+        settings_.mode == Mode::kClosed ? "closed" : "open",
+        step,
+        throughput,
+        errors,
+        overall.GetValueAtPercentile(50),
+        overall.GetValueAtPercentile(99),
+        overall.GetValueAtPercentile(99.9),
+        overall.GetMax()
+    );
+    std::cout << report << std::flush;
+}
+
+userver::yaml_config::Schema Component::GetStaticConfigSchema() {
+    constexpr auto schema = R"(
+        type: object
+        description: closed/open loop load generator for the vaulty API
+        additionalProperties: false
+        properties:
+            base_url:
+                type: string
+                description: service address, e.g. http://localhost:8080
+            timeout:
+                type: string
+                description: per request timeout
+            users:
+                type: integer
+                description: number of test users registered before the run
+            passwords_per_user:
+                type: integer
+                description: passwords created in every test vault before the run
+            mix:
+                type: string
+                description: operation weights, e.g. auth=2,list=40,search=30,get=23,create=5
+            mode:
+                type: string
+                description: closed (fixed concurrency) or open (fixed request rate)
+                enum:
+                  - closed
+                  - open
+            steps:
+                type: array
+                description: concurrency levels (closed) or requests per second (open), one measured step each
+                items:
+                    type: integer
+                    description: concurrency or rate of the step
+            max_in_flight:
+                type: integer
+                description: number of open loop workers, i.e. the maximum number of concurrent requests
+            warmup:
+                type: string
+                description: time at the start of every step that is not measured
+            duration:
+                type: string
+                description: measured time of every step
+            label:
+                type: string
+                description: tag copied to the summary lines
+    )";
+    return userver::yaml_config::MergeSchemas<userver::components::LoggableComponentBase>(schema);
+}
+
+}  // namespace loadgen
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "client.hpp"
+#include "histogram.hpp"
+#include "mix.hpp"
+
+#include <userver/components/loggable_component_base.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace loadgen {
+
+/// How the offered load is generated.
+enum class Mode {
+    /// A fixed number of workers, each sending the next request once the previous one completes.
+    kClosed,
+    /// Requests are sent on a fixed schedule regardless of how fast the service answers.
+    kOpen,
+};
+
+/// Load generator settings from the static config.
+struct Settings {
+    std::string base_url{"http://localhost:8080"};
+    std::chrono::milliseconds timeout{5000};
+    std::size_t users{16};
+    std::size_t passwords_per_user{50};
+    std::string mix{"auth=2,list=40,search=30,get=23,create=5"};
+    Mode mode{Mode::kClosed};
+
+    /// Concurrency levels (closed loop) or request rates per second (open loop), one step each.
+    std::vector<std::size_t> steps{1, 4, 16, 64};
+
+    /// Upper bound on concurrent requests in the open loop.
+    std::size_t max_in_flight{256};
+
+    std::chrono::seconds warmup{5};
+    std::chrono::seconds duration{30};
+
+    /// Free-form tag copied to every summary line, e.g. the service worker-threads value.
+    std::string label;
+};
+
+Settings Parse(const userver::yaml_config::YamlConfig& value, userver::formats::parse::To<Settings>);
+
+/// Outcome of a measured run, latencies are in microseconds.
+struct Results {
+    std::array<Histogram, kOperationCount> latencies;
+    std::array<std::uint64_t, kOperationCount> errors{};
+
+    /// Open loop only: requests that started over a millisecond behind their schedule.
+    std::uint64_t late{0};
+
+    void Merge(const Results& other);
+};
+
+/// @brief Registers test users, then drives the configured traffic mix against the service
+/// and prints latency percentiles per operation for every load step.
+class Component final : public userver::components::LoggableComponentBase {
+public:
+    static constexpr std::string_view kName = "loadgen";
+
+    Component(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
+
+    void OnAllComponentsLoaded() override;
+
+    static userver::yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    /// Credentials, token and known password ids of a test user.
+    struct User {
+        Credentials credentials;
+        std::string token;
+        std::vector<std::int64_t> password_ids;
+    };
+
+    void SetUp();
+    Results RunClosed(std::size_t concurrency) const;
+    Results RunOpen(std::size_t rate) const;
+    int Execute(Operation operation, const User& user, std::uint64_t random) const;
+    void Report(std::size_t step, const Results& results) const;
+
+    const Settings settings_;
+    const Mix mix_;
+    const ApiClient client_;
+    std::vector<User> users_;
+};
+
+}  // namespace loadgen
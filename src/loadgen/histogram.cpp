@@ -0,0 +1,80 @@
+#include "histogram.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace {
+
+constexpr std::size_t kHalfSubBucketCount = loadgen::Histogram::kSubBucketCount / 2;
+
+// bucket 0 uses all sub-buckets, every next bucket only the upper half
+constexpr std::size_t kCounterCount =
+    (64 - loadgen::Histogram::kSubBucketBits + 2) * kHalfSubBucketCount;
+
+}  // namespace
+
+namespace loadgen {
+
+Histogram::Histogram() : counts_(kCounterCount, 0) {}
+
+std::size_t Histogram::GetIndex(std::uint64_t value) noexcept {
+    const auto width = static_cast<std::size_t>(std::bit_width(value));
+    const auto bucket = width > kSubBucketBits ? width - kSubBucketBits : 0;
+    const auto sub_bucket = static_cast<std::size_t>(value >> bucket);
+    return bucket * kHalfSubBucketCount + sub_bucket;
+}
+
+std::uint64_t Histogram::GetHighestEquivalentValue(std::size_t index) noexcept {
+    if (index < kSubBucketCount) {
+        return index;
+    }
+    const auto bucket = index / kHalfSubBucketCount - 1;
+    const auto sub_bucket = index - bucket * kHalfSubBucketCount;
+    return ((std::uint64_t{sub_bucket} + 1) << bucket) - 1;
+}
+
+void Histogram::Record(std::uint64_t value) noexcept {
+    ++counts_[GetIndex(value)];
+    ++total_count_;
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+    sum_ += value;
+}
+
+void Histogram::Merge(const Histogram& other) noexcept {
+    for (std::size_t i = 0; i < counts_.size(); ++i) {
+        counts_[i] += other.counts_[i];
+    }
+    total_count_ += other.total_count_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+    sum_ += other.sum_;
+}
+
+std::uint64_t Histogram::GetMin() const noexcept { return total_count_ == 0 ? 0 : min_; }
+
+double Histogram::GetMean() const noexcept {
+    return total_count_ == 0 ? 0 : static_cast<double>(sum_ / total_count_);
+}
+
+std::uint64_t Histogram::GetValueAtPercentile(double percentile) const noexcept {
+    if (total_count_ == 0) {
+        return 0;
+    }
+
+    const auto rank = std::max<std::uint64_t>(
+        1, static_cast<std::uint64_t>(std::ceil(std::clamp(percentile, 0.0, 100.0) / 100 * total_count_))
+    );
+
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < counts_.size(); ++i) {
+        seen += counts_[i];
+        if (seen >= rank) {
+            return std::min(GetHighestEquivalentValue(i), max_);
+        }
+    }
+    return max_;
+}
+
+}  // namespace loadgen
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace loadgen {
+
+/// @brief Log-linear latency histogram in the spirit of HdrHistogram.
+///
+/// Every power-of-two range is split into kSubBucketCount / 2 equal
+/// sub-buckets, so any recorded value is reported with a relative error below
+/// 1 / 64 (~1.6%) over the whole 64-bit range, with a fixed memory footprint
+/// and O(1) recording. Not thread-safe: keep one histogram per worker and
+/// Merge() them.
+class Histogram final {
+public:
+    static constexpr std::size_t kSubBucketBits = 7;
+    static constexpr std::size_t kSubBucketCount = std::size_t{1} << kSubBucketBits;
+
+    Histogram();
+
+    void Record(std::uint64_t value) noexcept;
+
+    void Merge(const Histogram& other) noexcept;
+
+    std::uint64_t GetTotalCount() const noexcept { return total_count_; }
+
+    std::uint64_t GetMin() const noexcept;
+
+    std::uint64_t GetMax() const noexcept { return max_; }
+
+    double GetMean() const noexcept;
+
+    /// @brief Returns the value at the given percentile (0-100).
+    ///
+    /// The result is the highest value equivalent to the bucket the percentile
+    /// falls into, clamped to the largest recorded value; 0 if empty.
+    std::uint64_t GetValueAtPercentile(double percentile) const noexcept;
+
+    /// @brief Returns the index of the counter a value is accounted in.
+    static std::size_t GetIndex(std::uint64_t value) noexcept;
+
+    /// @brief Returns the highest value accounted in the counter.
+    static std::uint64_t GetHighestEquivalentValue(std::size_t index) noexcept;
+
+private:
+    std::vector<std::uint64_t> counts_;
+    std::uint64_t total_count_{0};
+    std::uint64_t min_{UINT64_MAX};
+    std::uint64_t max_{0};
+    long double sum_{0};
+};
+
+}  // namespace loadgen
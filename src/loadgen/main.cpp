@@ -0,0 +1,60 @@
+#include "loadgen/component.hpp"
+
+#include <userver/clients/http/component.hpp>
+#include <userver/components/minimal_component_list.hpp>
+#include <userver/components/run.hpp>
+#include <userver/testsuite/testsuite_support.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <iostream>
+#include <optional>
+
+int main(int argc, char* argv[]) {
+    namespace po = boost::program_options;
+
+    po::options_description description("Allowed options");
+    description.add_options()("help,h", "produce help message")(
+        "config,c", po::value<std::string>()->required(), "path to the load generator static config"
+    )("config_vars", po::value<std::string>(), "path to config_vars.yaml")(
+        "config_vars_override", po::value<std::string>(), "path to a config_vars.yaml with overrides, e.g. per run"
+    );
+
+    po::variables_map vm;
+    try {
+        po::store(po::parse_command_line(argc, argv, description), vm);
+        if (vm.count("help")) {
+            std::cout << description << std::endl;
+            return 0;
+        }
+        po::notify(vm);
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << "\n" << description << std::endl;
+        return 1;
+    }
+
+    const auto optional_option = [&vm](const char* name) -> std::optional<std::string> {
+        if (!vm.count(name)) {
+            return std::nullopt;
+        }
+        return vm[name].as<std::string>();
+    };
+
+    const auto component_list = userver::components::MinimalComponentList()
+                                    .Append<userver::components::TestsuiteSupport>()
+                                    .Append<userver::components::HttpClient>()
+                                    .Append<loadgen::Component>();
+
+    try {
+        userver::components::RunOnce(
+            vm["config"].as<std::string>(),
+            optional_option("config_vars"),
+            optional_option("config_vars_override"),
+            component_list
+        );
+    } catch (const std::exception& ex) {
+        std::cerr << "Load generation failed: " << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
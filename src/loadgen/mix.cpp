@@ -0,0 +1,112 @@
+#include "mix.hpp"
+
+#include <charconv>
+#include <stdexcept>
+
+namespace {
+
+std::string_view Trim(std::string_view value) {
+    const auto begin = value.find_first_not_of(' ');
+    if (begin == std::string_view::npos) {
+        return {};
+    }
+    return value.substr(begin, value.find_last_not_of(' ') - begin + 1);
+}
+
+loadgen::Operation ParseOperation(std::string_view name) {
+    for (std::size_t i = 0; i < loadgen::kOperationCount; ++i) {
+        const auto operation = static_cast<loadgen::Operation>(i);
+        if (loadgen::ToString(operation) == name) {
+            return operation;
+        }
+    }
+    throw std::invalid_argument("Unknown operation in mix: " + std::string{name});
+}
+
+}  // namespace
+
+namespace loadgen {
+
+std::string_view ToString(Operation operation) {
+    switch (operation) {
+        case Operation::kAuth:
+            return "auth";
+        case Operation::kList:
+            return "list";
+        case Operation::kSearch:
+            return "search";
+        case Operation::kGet:
+            return "get";
+        case Operation::kCreate:
+            return "create";
+    }
+    return "unknown";
+}
+
+Mix Mix::Parse(std::string_view spec) {
+    Mix mix;
+    while (!spec.empty()) {
+        const auto separator = spec.find(',');
+        const auto item = Trim(spec.substr(0, separator));
+        spec.remove_prefix(separator == std::string_view::npos ? spec.size() : separator + 1);
+        if (item.empty()) {
+            continue;
+        }
+
+        const auto equals = item.find('=');
+        if (equals == std::string_view::npos) {
+            throw std::invalid_argument("Expected operation=weight in mix: " + std::string{item});
+        }
+
+        const auto operation = ParseOperation(Trim(item.substr(0, equals)));
+        const auto weight_text = Trim(item.substr(equals + 1));
+        std::uint32_t weight = 0;
+        const auto [end, error] = std::from_chars(weight_text.data(), weight_text.data() + weight_text.size(), weight);
+        if (error != std::errc{} || end != weight_text.data() + weight_text.size()) {
+            throw std::invalid_argument("Invalid weight in mix: " + std::string{item});
+        }
+
+        auto& slot = mix.weights_[static_cast<std::size_t>(operation)];
+        mix.total_weight_ += weight;
+        mix.total_weight_ -= slot;
+        slot = weight;
+    }
+
+    if (mix.total_weight_ == 0) {
+        throw std::invalid_argument("Mix must have at least one operation with a positive weight");
+    }
+    return mix;
+}
+
+Operation Mix::Pick(std::uint64_t random) const noexcept {
+    auto point = random % total_weight_;
+    for (std::size_t i = 0; i < kOperationCount; ++i) {
+        if (point < weights_[i]) {
+            return static_cast<Operation>(i);
+        }
+        point -= weights_[i];
+    }
+    return Operation::kList;
+}
+
+std::uint32_t Mix::GetWeight(Operation operation) const noexcept {
+    return weights_[static_cast<std::size_t>(operation)];
+}
+
+std::string Mix::ToString() const {
+    std::string result;
+    for (std::size_t i = 0; i < kOperationCount; ++i) {
+        if (weights_[i] == 0) {
+            continue;
+        }
+        if (!result.empty()) {
+            result += ',';
+        }
+        result += loadgen::ToString(static_cast<Operation>(i));
+        result += '=';
+        result += std::to_string(weights_[i]);
+    }
+    return result;
+}
+
+}  // namespace loadgen
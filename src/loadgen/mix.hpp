@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace loadgen {
+
+/// API calls the load generator can issue.
+enum class Operation {
+    kAuth,
+    kList,
+    kSearch,
+    kGet,
+    kCreate,
+};
+
+inline constexpr std::size_t kOperationCount = 5;
+
+/// @brief Returns the name used for the operation in mixes and reports.
+std::string_view ToString(Operation operation);
+
+/// @brief Weighted set of operations, e.g. "auth=5,list=40,search=30,get=20,create=5".
+class Mix final {
+public:
+    /// @brief Parses a comma-separated list of operation=weight pairs.
+    /// @throws std::invalid_argument On unknown operations, bad weights or an all-zero mix.
+    static Mix Parse(std::string_view spec);
+
+    /// @brief Picks an operation for a uniformly distributed random number.
+    Operation Pick(std::uint64_t random) const noexcept;
+
+    std::uint32_t GetWeight(Operation operation) const noexcept;
+
+    std::string ToString() const;
+
+private:
+    Mix() = default;
+
+    std::array<std::uint32_t, kOperationCount> weights_{};
+    std::uint64_t total_weight_{0};
+};
+
+}  // namespace loadgen
@@ -0,0 +1,77 @@
+#include "histogram.hpp"
+
+#include <userver/utest/utest.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace loadgen;
+
+TEST(LoadgenHistogramTest, ExactForSmallValues) {
+    Histogram histogram;
+    for (std::uint64_t value = 1; value <= 100; ++value) {
+        histogram.Record(value);
+    }
+
+    EXPECT_EQ(histogram.GetTotalCount(), 100);
+    EXPECT_EQ(histogram.GetMin(), 1);
+    EXPECT_EQ(histogram.GetMax(), 100);
+    EXPECT_DOUBLE_EQ(histogram.GetMean(), 50.5);
+    EXPECT_EQ(histogram.GetValueAtPercentile(50), 50);
+    EXPECT_EQ(histogram.GetValueAtPercentile(99), 99);
+    EXPECT_EQ(histogram.GetValueAtPercentile(100), 100);
+    EXPECT_EQ(histogram.GetValueAtPercentile(0), 1);
+}
+
+TEST(LoadgenHistogramTest, IndexesAreContiguousAndMonotonic) {
+    std::size_t previous_index = 0;
+    for (std::uint64_t value = 1; value < (1 << 20); ++value) {
+        const auto index = Histogram::GetIndex(value);
+        ASSERT_GE(index, previous_index);
+        ASSERT_LE(index, previous_index + 1);
+        ASSERT_GE(Histogram::GetHighestEquivalentValue(index), value);
+        previous_index = index;
+    }
+
+    EXPECT_NO_FATAL_FAILURE(Histogram::GetIndex(UINT64_MAX));
+    EXPECT_EQ(Histogram::GetHighestEquivalentValue(Histogram::GetIndex(UINT64_MAX)), UINT64_MAX);
+}
+
+TEST(LoadgenHistogramTest, RelativeErrorIsBounded) {
+    std::mt19937_64 random{42};
+    std::lognormal_distribution<double> distribution{8, 1.5};
+
+    Histogram histogram;
+    std::vector<std::uint64_t> values;
+    for (int i = 0; i < 100'000; ++i) {
+        values.push_back(static_cast<std::uint64_t>(distribution(random)) + 1);
+        histogram.Record(values.back());
+    }
+    std::sort(values.begin(), values.end());
+
+    for (const double percentile : {50.0, 90.0, 99.0, 99.9}) {
+        const auto exact = values[static_cast<std::size_t>(std::ceil(percentile / 100 * values.size())) - 1];
+        const auto reported = histogram.GetValueAtPercentile(percentile);
+        EXPECT_GE(reported, exact) << percentile;
+        EXPECT_LE(reported, exact + exact / 64 + 1) << percentile;
+    }
+}
+
+TEST(LoadgenHistogramTest, Merge) {
+    Histogram first;
+    Histogram second;
+    first.Record(10);
+    second.Record(1'000'000);
+    second.Record(20);
+
+    first.Merge(second);
+    EXPECT_EQ(first.GetTotalCount(), 3);
+    EXPECT_EQ(first.GetMin(), 10);
+    EXPECT_EQ(first.GetMax(), 1'000'000);
+    EXPECT_EQ(first.GetValueAtPercentile(50), 20);
+
+    EXPECT_EQ(Histogram{}.GetValueAtPercentile(99), 0);
+    EXPECT_EQ(Histogram{}.GetMin(), 0);
+}
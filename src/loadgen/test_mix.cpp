@@ -0,0 +1,40 @@
+#include "mix.hpp"
+
+#include <userver/utest/utest.hpp>
+
+#include <array>
+
+using namespace loadgen;
+
+TEST(LoadgenMixTest, Parse) {
+    const auto mix = Mix::Parse("auth=5, list=40,search=30 ,get=20,create=5");
+    EXPECT_EQ(mix.GetWeight(Operation::kAuth), 5);
+    EXPECT_EQ(mix.GetWeight(Operation::kList), 40);
+    EXPECT_EQ(mix.GetWeight(Operation::kCreate), 5);
+    EXPECT_EQ(mix.ToString(), "auth=5,list=40,search=30,get=20,create=5");
+
+    // repeated operations keep the last weight
+    EXPECT_EQ(Mix::Parse("list=1,list=3").ToString(), "list=3");
+}
+
+TEST(LoadgenMixTest, RejectsInvalidSpecs) {
+    EXPECT_THROW(Mix::Parse(""), std::invalid_argument);
+    EXPECT_THROW(Mix::Parse("list=0"), std::invalid_argument);
+    EXPECT_THROW(Mix::Parse("delete=1"), std::invalid_argument);
+    EXPECT_THROW(Mix::Parse("list"), std::invalid_argument);
+    EXPECT_THROW(Mix::Parse("list=-1"), std::invalid_argument);
+    EXPECT_THROW(Mix::Parse("list=1x"), std::invalid_argument);
+}
+
+TEST(LoadgenMixTest, PickFollowsWeights) {
+    const auto mix = Mix::Parse("list=3,get=1");
+
+    std::array<int, kOperationCount> picks{};
+    for (std::uint64_t random = 0; random < 4000; ++random) {
+        ++picks[static_cast<std::size_t>(mix.Pick(random))];
+    }
+
+    EXPECT_EQ(picks[static_cast<std::size_t>(Operation::kList)], 3000);
+    EXPECT_EQ(picks[static_cast<std::size_t>(Operation::kGet)], 1000);
+    EXPECT_EQ(picks[static_cast<std::size_t>(Operation::kAuth)], 0);
+}
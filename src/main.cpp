@@ -1,9 +1,26 @@
+#include "audit/component.hpp"
+#include "breach/component.hpp"
+#include "cache/deleted_users.hpp"
+#include "cache/users.hpp"
 #include "crypto/component.hpp"
+#include "flight_recorder/component.hpp"
 #include "handlers/api/login/handler.hpp"
 #include "handlers/api/password/handler.hpp"
 #include "handlers/api/user/handler.hpp"
 #include "handlers/auth/auth.hpp"
+#include "handlers/grpc/service.hpp"
+#include "handlers/monitor/slow_requests/handler.hpp"
+#include "hedge/component.hpp"
 #include "jwt/component.hpp"
+#include "notify/component.hpp"
+#include "purge/component.hpp"
+#include "reencryption/component.hpp"
+#include "rowcache/component.hpp"
+#include "secure/component.hpp"
+#include "sessions/component.hpp"
+#include "tombstones/component.hpp"
+#include "usage/component.hpp"
+#include "vault/component.hpp"
 
 #include <userver/clients/dns/component.hpp>
 #include <userver/clients/http/component.hpp>
@@ -13,7 +30,10 @@
 #include <userver/server/handlers/server_monitor.hpp>
 #include <userver/server/handlers/tests_control.hpp>
 #include <userver/storages/postgres/component.hpp>
+#include <userver/storages/secdist/component.hpp>
+#include <userver/storages/secdist/provider_component.hpp>
 #include <userver/testsuite/testsuite_support.hpp>
+#include <userver/ugrpc/server/server_component.hpp>
 #include <userver/utils/daemon_run.hpp>
 
 int main(int argc, char* argv[]) {
@@ -25,19 +45,46 @@ int main(int argc, char* argv[]) {
                               .Append<userver::server::handlers::Ping>()
                               .Append<userver::server::handlers::TestsControl>()
                               .Append<userver::server::handlers::ServerMonitor>()
+                              .Append<handlers::monitor::slow_requests::get::Handler>()
                               .Append<userver::components::TestsuiteSupport>()
                               .Append<userver::components::HttpClient>()
                               .Append<userver::components::Postgres>("postgres-db-1")
                               .Append<userver::clients::dns::Component>()
+                              .Append<userver::components::Secdist>()
+                              .Append<userver::components::DefaultSecdistProvider>()
+                              .Append<cache::UsersCache>()
+                              .Append<cache::DeletedUsersCache>()
                               .Append<handlers::api::user::post::Handler>()
                               .Append<handlers::api::user::del::Handler>()
+                              .Append<handlers::api::user::master_key::post::Handler>()
                               .Append<handlers::api::login::post::Handler>()
+                              .Append<handlers::api::login::del::Handler>()
                               .Append<handlers::api::password::get::Handler>()
                               .Append<handlers::api::passwords::get::Handler>()
                               .Append<handlers::api::password::post::Handler>()
                               .Append<handlers::api::password::del::Handler>()
+                              .Append<handlers::api::passwords::breached::get::Handler>()
+                              .Append<handlers::api::passwords::totp::get::Handler>()
+                              .Append<handlers::api::passwords::reused::get::Handler>()
+                              .Append<handlers::api::passwords::changes::get::Handler>()
+                              .Append<handlers::api::passwords::changes::wait::Handler>()
+                              .Append<userver::ugrpc::server::ServerComponent>()
+                              .Append<handlers::grpc::VaultService>()
+                              .Append<vault::Component>()
+                              .Append<flight_recorder::Component>()
+                              .Append<audit::Component>()
+                              .Append<usage::Component>()
+                              .Append<breach::Component>()
+                              .Append<tombstones::Component>()
+                              .Append<purge::Component>()
+                              .Append<sessions::Component>()
+                              .Append<rowcache::Component>()
+                              .Append<hedge::Component>()
+                              .Append<notify::Component>()
+                              .Append<secure::Component>()
                               .Append<jwt::Component>()
-                              .Append<crypto::Component>();
+                              .Append<crypto::Component>()
+                              .Append<reencryption::Component>();
 
     return userver::utils::DaemonMain(argc, argv, component_list);
 }
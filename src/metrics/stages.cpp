@@ -0,0 +1,62 @@
+#include "stages.hpp"
+
+#include <userver/utils/statistics/writer.hpp>
+
+namespace {
+
+// microseconds, from a cached row decrypt up to a slow database round-trip
+constexpr std::array<double, 14> kBucketBounds{
+    5, 10, 25, 50, 100, 250, 500, 1'000, 2'500, 5'000, 10'000, 25'000, 50'000, 100'000,
+};
+
+}  // namespace
+
+namespace metrics {
+
+std::string_view ToString(Stage stage) {
+    switch (stage) {
+        case Stage::kJwtValidation:
+            return "jwt_validation";
+        case Stage::kMasterKeyDecrypt:
+            return "master_key_decrypt";
+        case Stage::kDatabase:
+            return "database";
+        case Stage::kRowDecrypt:
+            return "row_decrypt";
+        case Stage::kSerialization:
+            return "serialization";
+    }
+    return "unknown";
+}
+
+HandlerStatistics::HandlerStatistics()
+    : timings_{
+          userver::utils::statistics::Histogram{kBucketBounds},
+          userver::utils::statistics::Histogram{kBucketBounds},
+          userver::utils::statistics::Histogram{kBucketBounds},
+          userver::utils::statistics::Histogram{kBucketBounds},
+          userver::utils::statistics::Histogram{kBucketBounds},
+      } {}
+
+void HandlerStatistics::Account(Stage stage, std::chrono::steady_clock::duration duration) noexcept {
+    const std::chrono::duration<double, std::micro> microseconds = duration;
+    timings_[static_cast<std::size_t>(stage)].Account(microseconds.count());
+}
+
+void HandlerStatistics::AccountRows(std::size_t rows) noexcept {
+    rows_ += userver::utils::statistics::Rate{rows};
+}
+
+void HandlerStatistics::AccountBytes(std::size_t bytes) noexcept {
+    bytes_ += userver::utils::statistics::Rate{bytes};
+}
+
+void DumpMetric(userver::utils::statistics::Writer& writer, const HandlerStatistics& statistics) {
+    for (std::size_t i = 0; i < kStageCount; ++i) {
+        writer["timings"].ValueWithLabels(statistics.timings_[i], {"stage", ToString(static_cast<Stage>(i))});
+    }
+    writer["rows"] = statistics.rows_;
+    writer["bytes"] = statistics.bytes_;
+}
+
+}  // namespace metrics
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <userver/utils/statistics/histogram.hpp>
+#include <userver/utils/statistics/rate_counter.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <string_view>
+
+namespace metrics {
+
+/// Request processing stages timed by the API handlers.
+enum class Stage {
+    kJwtValidation,
+    kMasterKeyDecrypt,
+    kDatabase,
+    kRowDecrypt,
+    kSerialization,
+};
+
+inline constexpr std::size_t kStageCount = 5;
+
+/// @brief Returns the value of the `stage` metric label.
+std::string_view ToString(Stage stage);
+
+/// Stage breakdown of a single request.
+struct RequestTimings {
+    std::array<std::chrono::steady_clock::duration, kStageCount> stages{};
+    std::size_t rows{0};
+};
+
+/// @brief Per-handler latency histograms of the stages plus response volume counters.
+///
+/// All methods are thread-safe and lock-free.
+class HandlerStatistics final {
+public:
+    HandlerStatistics();
+
+    void Account(Stage stage, std::chrono::steady_clock::duration duration) noexcept;
+
+    void AccountRows(std::size_t rows) noexcept;
+
+    void AccountBytes(std::size_t bytes) noexcept;
+
+    friend void DumpMetric(userver::utils::statistics::Writer& writer, const HandlerStatistics& statistics);
+
+private:
+    std::array<userver::utils::statistics::Histogram, kStageCount> timings_;
+    userver::utils::statistics::RateCounter rows_;
+    userver::utils::statistics::RateCounter bytes_;
+};
+
+}  // namespace metrics
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -14,6 +16,17 @@ struct Password final {
     std::string password_encrypted;
     std::chrono::system_clock::time_point created_at;
     std::chrono::system_clock::time_point updated_at;
+    std::int64_t use_count;
+    std::optional<std::chrono::system_clock::time_point> last_used_at;
+
+    /// Keyed hash of the password, see crypto::FingerprintPassword(). Not set for entries created before it.
+    std::optional<std::string> fingerprint;
+
+    /// Vault version of the last change of the entry, 0 for entries changed before it was tracked.
+    std::int64_t change_version;
+
+    /// Base32 TOTP secret of the service encrypted with the data key, if the entry has one.
+    std::optional<std::string> totp_secret_encrypted;
 };
 
 }  // namespace models
\ No newline at end of file
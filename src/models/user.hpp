@@ -1,6 +1,7 @@
 #pragma once
 
 #include <chrono>
+#include <optional>
 #include <string>
 
 namespace models {
@@ -13,6 +14,13 @@ struct User final {
     std::string totp_secret;
     std::chrono::system_clock::time_point created_at;
     std::chrono::system_clock::time_point updated_at;
+    std::int64_t vault_version;
+
+    /// Base64 data key encrypted with the master key, empty for vaults not converted to a data key yet.
+    std::optional<std::string> data_key_wrapped;
+
+    /// Set when the user is deleted, until the user's rows are purged. Deleted users are treated as unknown.
+    std::optional<std::chrono::system_clock::time_point> deleted_at;
 };
 
 }  // namespace models
\ No newline at end of file
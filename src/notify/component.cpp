@@ -0,0 +1,149 @@
+#include "component.hpp"
+#include "rowcache/component.hpp"
+#include "sessions/component.hpp"
+
+#include <userver/components/component.hpp>
+#include <userver/components/statistics_storage.hpp>
+#include <userver/engine/sleep.hpp>
+#include <userver/engine/task/cancel.hpp>
+#include <userver/logging/log.hpp>
+#include <userver/storages/postgres/cluster.hpp>
+#include <userver/storages/postgres/component.hpp>
+#include <userver/storages/postgres/exceptions.hpp>
+#include <userver/utils/async.hpp>
+#include <userver/utils/statistics/writer.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+#include <string>
+
+namespace {
+
+/// How long a single wait for a notification lasts before the cancellation of the listener is checked.
+constexpr std::chrono::seconds kListenTimeout{5};
+
+notify::Settings ParseSettings(const userver::yaml_config::YamlConfig& config) {
+    notify::Settings settings;
+    settings.max_waiters = config["max_waiters"].As<std::size_t>(settings.max_waiters);
+    settings.max_waiters_per_user = config["max_waiters_per_user"].As<std::size_t>(settings.max_waiters_per_user);
+    settings.max_wait = config["max_wait"].As<std::chrono::milliseconds>(settings.max_wait);
+    return settings;
+}
+
+}  // namespace
+
+namespace notify {
+
+Component::Component(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& context
+)
+    : userver::components::LoggableComponentBase(config, context),
+      pg_cluster_{context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()},
+      reconnect_delay_{config["reconnect_delay"].As<std::chrono::milliseconds>(std::chrono::seconds{1})},
+      row_cache_{context.FindComponent<rowcache::Component>().GetCache()},
+      session_store_{context.FindComponent<sessions::Component>().GetStore()},
+      hub_{ParseSettings(config)} {
+    auto& storage = context.FindComponent<userver::components::StatisticsStorage>().GetStorage();
+    statistics_holder_ =
+        storage.RegisterWriter("vaulty.notifications", [this](userver::utils::statistics::Writer& writer) {
+            const auto& statistics = hub_.GetStatistics();
+            writer["waiters"] = hub_.GetWaiters();
+            writer["published"] = statistics.published.load();
+            writer["woken"] = statistics.woken.load();
+            writer["rejected"] = statistics.rejected.load();
+            writer["reconnects"] = reconnects_.load();
+            writer["malformed"] = malformed_.load();
+        });
+
+    listener_task_ = userver::utils::CriticalAsync("notification-listener", [this] { Run(); });
+}
+
+Component::~Component() {
+    listener_task_.SyncCancel();
+    statistics_holder_.Unregister();
+}
+
+Hub& Component::GetHub() { return hub_; }
+
+void Component::Run() {
+    while (!userver::engine::current_task::ShouldCancel()) {
+        try {
+            auto scope = pg_cluster_->Listen(kChannel);
+            LOG_INFO() << "Listening for notifications on " << kChannel;
+            // notifications sent while there was no listener are not replayed
+            Resync();
+
+            while (!userver::engine::current_task::ShouldCancel()) {
+                try {
+                    const auto notification =
+                        scope.WaitNotify(userver::engine::Deadline::FromDuration(kListenTimeout));
+                    if (notification.payload) {
+                        Dispatch(*notification.payload);
+                    }
+                } catch (const userver::storages::postgres::ConnectionTimeoutError&) {
+                    // no notifications for a while
+                }
+            }
+        } catch (const std::exception& ex) {
+            if (userver::engine::current_task::ShouldCancel()) {
+                break;
+            }
+            ++reconnects_;
+            LOG_WARNING() << "Lost the notification listener, reconnecting: " << ex.what();
+            Resync();
+            userver::engine::InterruptibleSleepFor(reconnect_delay_);
+        }
+    }
+}
+
+void Component::Dispatch(std::string_view payload) {
+    if (payload.starts_with(kSessionRevokedPrefix)) {
+        session_store_.Erase(std::string{payload.substr(kSessionRevokedPrefix.size())});
+        return;
+    }
+
+    const auto change = ParseChange(payload);
+    if (!change) {
+        ++malformed_;
+        LOG_WARNING() << "Malformed notification: " << payload;
+        return;
+    }
+    row_cache_.Invalidate(change->user_id, change->version);
+    hub_.Publish(change->user_id, change->version);
+}
+
+void Component::Resync() {
+    hub_.WakeAll();
+    row_cache_.Clear();
+    session_store_.Clear();
+}
+
+userver::yaml_config::Schema Component::GetStaticConfigSchema() {
+    constexpr auto schema = R"(
+        type: object
+        description: LISTEN connection of the instance and the clients waiting for vault changes
+        additionalProperties: false
+        properties:
+            max_wait:
+                type: string
+                description: longest wait of a long-poll, a client may only ask for less
+                defaultDescription: 30s
+            max_waiters:
+                type: integer
+                description: waiting clients of all users, further waits are rejected with 503
+                defaultDescription: 10000
+                minimum: 1
+            max_waiters_per_user:
+                type: integer
+                description: waiting clients of a single user
+                defaultDescription: 16
+                minimum: 1
+            reconnect_delay:
+                type: string
+                description: pause before the listener connection is restored
+                defaultDescription: 1s
+    )";
+    return userver::yaml_config::MergeSchemas<userver::components::LoggableComponentBase>(schema);
+}
+
+}  // namespace notify
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "hub.hpp"
+#include "rowcache/cache.hpp"
+#include "sessions/store.hpp"
+
+#include <userver/components/loggable_component_base.hpp>
+#include <userver/engine/task/task_with_result.hpp>
+#include <userver/storages/postgres/postgres_fwd.hpp>
+#include <userver/utils/statistics/entry.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+namespace notify {
+
+/// @brief Postgres channel of the instance notifications.
+///
+/// The payload of a vault change is `<user ID>:<vault version>`, the one of a
+/// revoked opaque session is kSessionRevokedPrefix and the session ID.
+inline constexpr std::string_view kChannel = "vaulty_events";
+
+/// Payload prefix of a revoked opaque session.
+inline constexpr std::string_view kSessionRevokedPrefix = "session:";
+
+/// @brief Fans out Postgres notifications to the state of the instance.
+///
+/// A trigger on `users.vault_version` sends a NOTIFY on every committed change
+/// of a vault, a revocation sends one per deleted session. Each instance keeps
+/// a single LISTEN connection: vault changes wake the long-polls of the user
+/// in the Hub and drop the outdated vault from the row cache, revocations drop
+/// the session from the session store. Notifications sent while there was no
+/// connection are gone, so whenever it is (re)established every waiter is
+/// woken to re-read its version and both caches are cleared; the connection
+/// is restored after `reconnect_delay`.
+class Component final : public userver::components::LoggableComponentBase {
+public:
+    static constexpr std::string_view kName = "component-change-notifications";
+
+    Component(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
+    ~Component() override;
+
+    Hub& GetHub();
+
+    static userver::yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    void Run();
+
+    void Dispatch(std::string_view payload);
+
+    void Resync();
+
+    userver::storages::postgres::ClusterPtr pg_cluster_;
+    const std::chrono::milliseconds reconnect_delay_;
+    rowcache::Cache& row_cache_;
+    sessions::Store& session_store_;
+
+    Hub hub_;
+    std::atomic<std::uint64_t> reconnects_{0};
+    std::atomic<std::uint64_t> malformed_{0};
+    userver::engine::TaskWithResult<void> listener_task_;
+    userver::utils::statistics::Entry statistics_holder_;
+};
+
+}  // namespace notify
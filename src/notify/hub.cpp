@@ -0,0 +1,119 @@
+#include "hub.hpp"
+
+#include <algorithm>
+#include <charconv>
+
+namespace {
+
+template <typename T>
+bool ParseNumber(std::string_view text, T& value) {
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc{} && end == text.data() + text.size();
+}
+
+}  // namespace
+
+namespace notify {
+
+std::optional<Change> ParseChange(std::string_view payload) {
+    const auto separator = payload.find(':');
+    Change change;
+    if (separator == std::string_view::npos || !ParseNumber(payload.substr(0, separator), change.user_id) ||
+        !ParseNumber(payload.substr(separator + 1), change.version)) {
+        return std::nullopt;
+    }
+    return change;
+}
+
+Hub::Subscription::Subscription(Hub& hub, std::int32_t user_id, std::shared_ptr<Waiter> waiter)
+    : hub_{&hub}, user_id_{user_id}, waiter_{std::move(waiter)} {}
+
+Hub::Subscription::Subscription(Subscription&& other) noexcept
+    : hub_{other.hub_}, user_id_{other.user_id_}, waiter_{std::move(other.waiter_)} {}
+
+Hub::Subscription::~Subscription() {
+    if (waiter_) {
+        hub_->Unsubscribe(user_id_, waiter_.get());
+    }
+}
+
+bool Hub::Subscription::Wait(userver::engine::Deadline deadline) { return waiter_->event.WaitForEventUntil(deadline); }
+
+std::int64_t Hub::Subscription::GetVersion() const noexcept { return waiter_->version.load(); }
+
+bool Hub::Subscription::TakeResync() noexcept { return waiter_->resync.exchange(false); }
+
+Hub::Hub(const Settings& settings) : settings_{settings} {}
+
+std::optional<Hub::Subscription> Hub::Subscribe(std::int32_t user_id) {
+    // the total is reserved first, a failed per-user check gives it back
+    if (waiters_.fetch_add(1) >= settings_.max_waiters) {
+        --waiters_;
+        ++statistics_.rejected;
+        return std::nullopt;
+    }
+
+    auto waiter = std::make_shared<Waiter>();
+    auto& shard = GetShard(user_id);
+    {
+        const std::lock_guard lock{shard.mutex};
+        auto& user_waiters = shard.waiters[user_id];
+        if (user_waiters.size() >= settings_.max_waiters_per_user) {
+            --waiters_;
+            ++statistics_.rejected;
+            return std::nullopt;
+        }
+        user_waiters.push_back(waiter);
+    }
+    return Subscription{*this, user_id, std::move(waiter)};
+}
+
+void Hub::Publish(std::int32_t user_id, std::int64_t version) {
+    ++statistics_.published;
+    auto& shard = GetShard(user_id);
+    const std::lock_guard lock{shard.mutex};
+    const auto it = shard.waiters.find(user_id);
+    if (it == shard.waiters.end()) {
+        return;
+    }
+    for (const auto& waiter : it->second) {
+        auto current = waiter->version.load();
+        while (current < version && !waiter->version.compare_exchange_weak(current, version)) {
+        }
+        waiter->event.Send();
+    }
+    statistics_.woken += it->second.size();
+}
+
+void Hub::WakeAll() {
+    for (auto& shard : shards_) {
+        const std::lock_guard lock{shard.mutex};
+        for (const auto& [user_id, user_waiters] : shard.waiters) {
+            for (const auto& waiter : user_waiters) {
+                waiter->resync = true;
+                waiter->event.Send();
+            }
+            statistics_.woken += user_waiters.size();
+        }
+    }
+}
+
+Hub::Shard& Hub::GetShard(std::int32_t user_id) { return shards_[static_cast<std::uint32_t>(user_id) % kShards]; }
+
+void Hub::Unsubscribe(std::int32_t user_id, const Waiter* waiter) {
+    auto& shard = GetShard(user_id);
+    {
+        const std::lock_guard lock{shard.mutex};
+        const auto it = shard.waiters.find(user_id);
+        if (it != shard.waiters.end()) {
+            auto& user_waiters = it->second;
+            std::erase_if(user_waiters, [waiter](const auto& candidate) { return candidate.get() == waiter; });
+            if (user_waiters.empty()) {
+                shard.waiters.erase(it);
+            }
+        }
+    }
+    --waiters_;
+}
+
+}  // namespace notify
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <userver/engine/deadline.hpp>
+#include <userver/engine/single_consumer_event.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace notify {
+
+/// Limits on clients waiting for changes.
+struct Settings {
+    /// Waiters of all users together.
+    std::size_t max_waiters{10'000};
+
+    /// Waiters of a single user, e.g. open long-polls of their devices.
+    std::size_t max_waiters_per_user{16};
+
+    /// Longest wait of a client.
+    std::chrono::milliseconds max_wait{std::chrono::seconds{30}};
+};
+
+/// Change of a vault, as sent by the `notify_vault_change` trigger.
+struct Change {
+    std::int32_t user_id{0};
+    std::int64_t version{0};
+};
+
+/// @brief Parses the payload of a change notification, `<user ID>:<vault version>`.
+/// @return std::nullopt if the payload is malformed.
+std::optional<Change> ParseChange(std::string_view payload);
+
+/// Counters of a hub.
+struct Statistics {
+    std::atomic<std::uint64_t> published{0};
+    std::atomic<std::uint64_t> woken{0};
+    std::atomic<std::uint64_t> rejected{0};
+};
+
+/// @brief Wakes the clients waiting for changes of a vault.
+///
+/// A waiter is an event and a version, a few dozen bytes, so an idle client
+/// only costs its coroutine. Publishing a change of a user wakes all of that
+/// user's waiters. The number of waiters is bounded in total and per user.
+/// Thread-safe.
+class Hub final {
+    struct Waiter {
+        userver::engine::SingleConsumerEvent event;
+        std::atomic<std::int64_t> version{0};
+        std::atomic<bool> resync{false};
+    };
+
+public:
+    /// Registration of a waiter, removed from the hub on destruction.
+    class Subscription final {
+    public:
+        Subscription(Subscription&& other) noexcept;
+        Subscription& operator=(Subscription&&) = delete;
+        ~Subscription();
+
+        /// @brief Waits for a change published after the subscription.
+        /// @return false on timeout or cancellation.
+        bool Wait(userver::engine::Deadline deadline);
+
+        /// @brief Returns the highest version published for the user since the subscription, 0 if none.
+        std::int64_t GetVersion() const noexcept;
+
+        /// @brief Returns whether changes may have been missed since the last call, see Hub::WakeAll().
+        bool TakeResync() noexcept;
+
+    private:
+        friend class Hub;
+
+        Subscription(Hub& hub, std::int32_t user_id, std::shared_ptr<Waiter> waiter);
+
+        Hub* hub_;
+        std::int32_t user_id_;
+        std::shared_ptr<Waiter> waiter_;
+    };
+
+    explicit Hub(const Settings& settings);
+
+    /// @brief Registers a waiter for changes of the user.
+    /// @return std::nullopt if the limits are reached.
+    std::optional<Subscription> Subscribe(std::int32_t user_id);
+
+    /// @brief Wakes the waiters of the user with the new version of their vault.
+    void Publish(std::int32_t user_id, std::int64_t version);
+
+    /// @brief Wakes every waiter to re-read its version, for when notifications may have been lost.
+    void WakeAll();
+
+    std::size_t GetWaiters() const noexcept { return waiters_.load(); }
+
+    std::chrono::milliseconds GetMaxWait() const noexcept { return settings_.max_wait; }
+
+    const Statistics& GetStatistics() const noexcept { return statistics_; }
+
+private:
+    static constexpr std::size_t kShards = 64;
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::int32_t, std::vector<std::shared_ptr<Waiter>>> waiters;
+    };
+
+    Shard& GetShard(std::int32_t user_id);
+
+    void Unsubscribe(std::int32_t user_id, const Waiter* waiter);
+
+    const Settings settings_;
+    std::array<Shard, kShards> shards_;
+    std::atomic<std::size_t> waiters_{0};
+    Statistics statistics_;
+};
+
+}  // namespace notify
@@ -0,0 +1,94 @@
+#include "hub.hpp"
+
+#include <userver/utest/utest.hpp>
+
+#include <chrono>
+
+using namespace notify;
+
+namespace {
+
+constexpr std::chrono::milliseconds kShortWait{10};
+
+userver::engine::Deadline ShortDeadline() { return userver::engine::Deadline::FromDuration(kShortWait); }
+
+}  // namespace
+
+UTEST(NotifyHubTest, PublishWakesWaitersOfTheUser) {
+    Hub hub{{}};
+    auto first = hub.Subscribe(1);
+    auto second = hub.Subscribe(1);
+    auto other = hub.Subscribe(2);
+    ASSERT_TRUE(first && second && other);
+    EXPECT_EQ(hub.GetWaiters(), 3);
+
+    hub.Publish(1, 5);
+    hub.Publish(1, 4);
+    EXPECT_TRUE(first->Wait(ShortDeadline()));
+    EXPECT_TRUE(second->Wait(ShortDeadline()));
+    EXPECT_FALSE(other->Wait(ShortDeadline()));
+
+    // the highest published version is kept
+    EXPECT_EQ(first->GetVersion(), 5);
+    EXPECT_EQ(other->GetVersion(), 0);
+    EXPECT_FALSE(first->TakeResync());
+    EXPECT_EQ(hub.GetStatistics().woken, 4);
+}
+
+UTEST(NotifyHubTest, WaitTimesOut) {
+    Hub hub{{}};
+    auto subscription = hub.Subscribe(1);
+    ASSERT_TRUE(subscription);
+    EXPECT_FALSE(subscription->Wait(ShortDeadline()));
+
+    // a change published before the wait is not lost
+    hub.Publish(1, 1);
+    EXPECT_TRUE(subscription->Wait(ShortDeadline()));
+    EXPECT_FALSE(subscription->Wait(ShortDeadline()));
+}
+
+UTEST(NotifyHubTest, WakeAllRequestsResync) {
+    Hub hub{{}};
+    auto first = hub.Subscribe(1);
+    auto second = hub.Subscribe(100);
+    ASSERT_TRUE(first && second);
+
+    hub.WakeAll();
+    EXPECT_TRUE(first->Wait(ShortDeadline()));
+    EXPECT_TRUE(second->Wait(ShortDeadline()));
+    EXPECT_TRUE(first->TakeResync());
+    EXPECT_FALSE(first->TakeResync());
+}
+
+UTEST(NotifyHubTest, EnforcesLimits) {
+    Hub hub{{3, 2}};
+    auto first = hub.Subscribe(1);
+    auto second = hub.Subscribe(1);
+    EXPECT_FALSE(hub.Subscribe(1));
+    auto third = hub.Subscribe(2);
+    EXPECT_TRUE(third);
+    EXPECT_FALSE(hub.Subscribe(3));
+    EXPECT_EQ(hub.GetStatistics().rejected, 2);
+    EXPECT_EQ(hub.GetWaiters(), 3);
+
+    // finished waits give their slots back
+    first.reset();
+    third.reset();
+    EXPECT_EQ(hub.GetWaiters(), 1);
+    EXPECT_TRUE(hub.Subscribe(1));
+    EXPECT_TRUE(hub.Subscribe(3));
+    EXPECT_EQ(hub.GetWaiters(), 1);
+}
+
+TEST(NotifyChangeTest, ParsesPayload) {
+    const auto change = ParseChange("42:7");
+    ASSERT_TRUE(change);
+    EXPECT_EQ(change->user_id, 42);
+    EXPECT_EQ(change->version, 7);
+
+    EXPECT_FALSE(ParseChange(""));
+    EXPECT_FALSE(ParseChange("42"));
+    EXPECT_FALSE(ParseChange("42:"));
+    EXPECT_FALSE(ParseChange("42:7x"));
+    EXPECT_FALSE(ParseChange("x:7"));
+}
@@ -0,0 +1,136 @@
+#include "component.hpp"
+#include "db/sql.hpp"
+
+#include <userver/components/component.hpp>
+#include <userver/components/statistics_storage.hpp>
+#include <userver/engine/sleep.hpp>
+#include <userver/engine/task/cancel.hpp>
+#include <userver/logging/log.hpp>
+#include <userver/storages/postgres/cluster.hpp>
+#include <userver/storages/postgres/component.hpp>
+#include <userver/utils/statistics/writer.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+#include <vector>
+
+namespace purge {
+
+Component::Component(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& context
+)
+    : userver::components::LoggableComponentBase(config, context),
+      pg_cluster_{context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()},
+      batch_size_{config["batch_size"].As<std::int64_t>(500)},
+      batch_delay_{config["batch_delay"].As<std::chrono::milliseconds>(std::chrono::milliseconds{20})},
+      users_per_pass_{config["users_per_pass"].As<std::int64_t>(100)} {
+    auto& storage = context.FindComponent<userver::components::StatisticsStorage>().GetStorage();
+    statistics_holder_ = storage.RegisterWriter("vaulty.purge", [this](userver::utils::statistics::Writer& writer) {
+        writer["pending"] = statistics_.pending.load();
+        writer["users"] = statistics_.users.load();
+        writer["rows"] = statistics_.rows.load();
+        writer["batches"] = statistics_.batches.load();
+        writer["passes"] = statistics_.passes.load();
+        writer["errors"] = statistics_.errors.load();
+    });
+
+    task_.Start(
+        "user-purge",
+        {config["interval"].As<std::chrono::milliseconds>(std::chrono::seconds{10})},
+        [this] { Purge(); }
+    );
+}
+
+Component::~Component() {
+    task_.Stop();
+    statistics_holder_.Unregister();
+}
+
+void Component::Purge() {
+    try {
+        const auto users = pg_cluster_
+                               ->Execute(
+                                   userver::storages::postgres::ClusterHostType::kMaster,
+                                   db::sql::kGetDeletedUsers,
+                                   users_per_pass_
+                               )
+                               .AsContainer<std::vector<std::int32_t>>();
+        statistics_.pending = users.size();
+
+        for (const auto user_id : users) {
+            if (userver::engine::current_task::ShouldCancel()) {
+                return;
+            }
+            PurgeUser(user_id);
+        }
+    } catch (const std::exception& ex) {
+        ++statistics_.errors;
+        LOG_WARNING() << "Failed to purge deleted users: " << ex.what();
+        return;
+    }
+    ++statistics_.passes;
+}
+
+void Component::PurgeUser(std::int32_t user_id) {
+    std::int64_t purged = 0;
+    // batches running short are not the end, rows locked by another instance are skipped
+    for (std::int64_t batch = -1; batch != 0;) {
+        if (userver::engine::current_task::ShouldCancel()) {
+            return;
+        }
+        batch = pg_cluster_
+                    ->Execute(
+                        userver::storages::postgres::ClusterHostType::kMaster,
+                        db::sql::kPurgeUserRows,
+                        user_id,
+                        batch_size_
+                    )
+                    .AsSingleRow<std::int64_t>();
+        purged += batch;
+        statistics_.rows += batch;
+        ++statistics_.batches;
+        if (batch != 0) {
+            userver::engine::InterruptibleSleepFor(batch_delay_);
+        }
+    }
+
+    const auto result = pg_cluster_->Execute(
+        userver::storages::postgres::ClusterHostType::kMaster, db::sql::kDeletePurgedUser, user_id
+    );
+    if (result.RowsAffected() == 0) {
+        // another instance still holds some of the rows, the next pass finishes the user
+        return;
+    }
+    ++statistics_.users;
+    LOG_INFO() << "Purged deleted user " << user_id << ", rows: " << purged;
+}
+
+userver::yaml_config::Schema Component::GetStaticConfigSchema() {
+    constexpr auto schema = R"(
+        type: object
+        description: background removal of the rows of deleted users
+        additionalProperties: false
+        properties:
+            interval:
+                type: string
+                description: how often deleted users are looked for
+                defaultDescription: 10s
+            batch_size:
+                type: integer
+                description: rows of each table removed by one statement
+                defaultDescription: 500
+                minimum: 1
+            batch_delay:
+                type: string
+                description: pause between statements, limits the load a purge puts on the database
+                defaultDescription: 20ms
+            users_per_pass:
+                type: integer
+                description: deleted users taken by one pass, the rest wait for the next one
+                defaultDescription: 100
+                minimum: 1
+    )";
+    return userver::yaml_config::MergeSchemas<userver::components::LoggableComponentBase>(schema);
+}
+
+}  // namespace purge
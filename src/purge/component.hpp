@@ -0,0 +1,60 @@
+#pragma once
+
+#include <userver/components/loggable_component_base.hpp>
+#include <userver/storages/postgres/postgres_fwd.hpp>
+#include <userver/utils/periodic_task.hpp>
+#include <userver/utils/statistics/entry.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace purge {
+
+/// Counters of the purge of deleted users.
+struct Statistics {
+    /// Deleted users taken by the last pass, at most `users_per_pass`.
+    std::atomic<std::uint64_t> pending{0};
+
+    std::atomic<std::uint64_t> users{0};
+    std::atomic<std::uint64_t> rows{0};
+    std::atomic<std::uint64_t> batches{0};
+    std::atomic<std::uint64_t> passes{0};
+    std::atomic<std::uint64_t> errors{0};
+};
+
+/// @brief Removes the rows of deleted users in small batches.
+///
+/// Deleting a user only sets `users.deleted_at`. Every `interval` the
+/// component takes the deleted users, oldest first, and deletes their
+/// passwords and tombstones `batch_size` rows per statement, pausing for
+/// `batch_delay` between statements. Once nothing is left the user row
+/// itself is deleted. Each statement is a short transaction of its own, so
+/// locks and WAL stay small whatever the vault size, and a purge interrupted
+/// by a restart simply continues on the next pass. Instances skip the rows
+/// locked by each other.
+class Component final : public userver::components::LoggableComponentBase {
+public:
+    static constexpr std::string_view kName = "component-user-purge";
+
+    Component(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
+    ~Component() override;
+
+    static userver::yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    void Purge();
+
+    void PurgeUser(std::int32_t user_id);
+
+    userver::storages::postgres::ClusterPtr pg_cluster_;
+    const std::int64_t batch_size_;
+    const std::chrono::milliseconds batch_delay_;
+    const std::int64_t users_per_pass_;
+
+    Statistics statistics_;
+    userver::utils::PeriodicTask task_;
+    userver::utils::statistics::Entry statistics_holder_;
+};
+
+}  // namespace purge
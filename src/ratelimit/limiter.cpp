@@ -0,0 +1,119 @@
+#include "limiter.hpp"
+
+#include <userver/utils/statistics/writer.hpp>
+#include <userver/yaml_config/yaml_config.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+constexpr std::chrono::seconds kMinSweepInterval{1};
+
+}  // namespace
+
+namespace ratelimit {
+
+Settings Parse(const userver::yaml_config::YamlConfig& value, userver::formats::parse::To<Settings>) {
+    Settings settings;
+    settings.burst = value["burst"].As<std::uint32_t>(settings.burst);
+    settings.rate_per_second = value["rate_per_second"].As<double>(settings.rate_per_second);
+    settings.max_keys = value["max_keys"].As<std::size_t>(settings.max_keys);
+    return settings;
+}
+
+void DumpMetric(userver::utils::statistics::Writer& writer, const Statistics& statistics) {
+    writer["allowed"] = statistics.allowed;
+    writer["rejected"] = statistics.rejected;
+    writer["overflow"] = statistics.overflow;
+    writer["evicted"] = statistics.evicted;
+    writer["keys"] = statistics.keys;
+}
+
+Limiter::Limiter(const Settings& settings)
+    : settings_{settings},
+      refill_period_{std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double>{settings.rate_per_second > 0 ? settings.burst / settings.rate_per_second : 0}
+      )},
+      max_keys_per_shard_{(settings.max_keys + kShardCount - 1) / kShardCount} {
+    if (settings.burst == 0 || settings.rate_per_second <= 0) {
+        throw std::invalid_argument("Rate limit burst and rate_per_second must be positive");
+    }
+}
+
+bool Limiter::TryAcquire(std::string_view key, Clock::time_point now) {
+    auto& shard = shards_[StringHash{}(key) % kShardCount];
+
+    const std::lock_guard lock{shard.mutex};
+    if (now >= shard.next_sweep) {
+        Sweep(shard, now);
+    }
+
+    auto it = shard.buckets.find(key);
+    if (it == shard.buckets.end()) {
+        if (shard.buckets.size() >= max_keys_per_shard_) {
+            Erase(shard, shard.order.back());
+            overflow_.fetch_add(1, std::memory_order_relaxed);
+            keys_.fetch_sub(1, std::memory_order_relaxed);
+        }
+        it = shard.buckets.emplace(std::string{key}, Bucket{static_cast<double>(settings_.burst), now, {}}).first;
+        shard.order.push_front(it->first);
+        it->second.position = shard.order.begin();
+        keys_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        shard.order.splice(shard.order.begin(), shard.order, it->second.position);
+    }
+
+    auto& bucket = it->second;
+    if (now > bucket.updated_at) {
+        const std::chrono::duration<double> elapsed = now - bucket.updated_at;
+        bucket.tokens =
+            std::min(static_cast<double>(settings_.burst), bucket.tokens + elapsed.count() * settings_.rate_per_second);
+        bucket.updated_at = now;
+    }
+
+    if (bucket.tokens < 1) {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    bucket.tokens -= 1;
+    allowed_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+Statistics Limiter::GetStatistics() const {
+    Statistics statistics;
+    statistics.allowed = allowed_.load(std::memory_order_relaxed);
+    statistics.rejected = rejected_.load(std::memory_order_relaxed);
+    statistics.overflow = overflow_.load(std::memory_order_relaxed);
+    statistics.evicted = evicted_.load(std::memory_order_relaxed);
+    statistics.keys = keys_.load(std::memory_order_relaxed);
+    return statistics;
+}
+
+void Limiter::Sweep(Shard& shard, Clock::time_point now) {
+    // buckets are used in order, the idle ones are at the back
+    std::size_t evicted = 0;
+    while (!shard.order.empty()) {
+        const auto key = shard.order.back();
+        if (now - shard.buckets.find(key)->second.updated_at < refill_period_) {
+            break;
+        }
+        Erase(shard, key);
+        ++evicted;
+    }
+
+    evicted_.fetch_add(evicted, std::memory_order_relaxed);
+    keys_.fetch_sub(evicted, std::memory_order_relaxed);
+    shard.next_sweep = now + std::max<Clock::duration>(refill_period_, kMinSweepInterval);
+}
+
+void Limiter::Erase(Shard& shard, std::string_view key) {
+    // the key may point into the erased node
+    const auto it = shard.buckets.find(key);
+    shard.order.erase(it->second.position);
+    shard.buckets.erase(it);
+}
+
+}  // namespace ratelimit
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <userver/formats/parse/to.hpp>
+#include <userver/utils/statistics/fwd.hpp>
+#include <userver/yaml_config/fwd.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace ratelimit {
+
+/// Token bucket parameters of a limiter.
+struct Settings {
+    /// Bucket capacity, i.e. how many requests a key may make in a burst.
+    std::uint32_t burst{10};
+
+    /// Tokens returned to a bucket per second.
+    double rate_per_second{1.0};
+
+    /// Upper bound on the number of tracked keys. A new key over the limit
+    /// takes the bucket of the least recently used one.
+    std::size_t max_keys{100'000};
+};
+
+Settings Parse(const userver::yaml_config::YamlConfig& value, userver::formats::parse::To<Settings>);
+
+/// Counters of a limiter.
+struct Statistics {
+    std::uint64_t allowed{0};
+    std::uint64_t rejected{0};
+
+    /// Buckets dropped to make room for new keys because max_keys was reached.
+    std::uint64_t overflow{0};
+
+    /// Buckets dropped by the sweep after a full refill.
+    std::uint64_t evicted{0};
+    std::size_t keys{0};
+};
+
+void DumpMetric(userver::utils::statistics::Writer& writer, const Statistics& statistics);
+
+/// @brief Token bucket rate limiter keyed by an arbitrary string.
+///
+/// Keys are spread over a fixed number of independently locked shards, so
+/// concurrent requests for different keys rarely contend. A bucket that has
+/// been idle long enough to refill completely is indistinguishable from a new
+/// one, so such buckets are dropped by a periodic per-shard sweep; memory is
+/// bounded by the number of keys active within one refill period and by
+/// Settings::max_keys. A full shard drops its least recently used bucket for
+/// a new key rather than rejecting it, so a flood of made-up keys can not lock
+/// out the keys of legitimate clients.
+class Limiter final {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit Limiter(const Settings& settings);
+
+    /// @brief Takes a token from the bucket of the key.
+    /// @return false if the key is over its limit.
+    bool TryAcquire(std::string_view key, Clock::time_point now = Clock::now());
+
+    Statistics GetStatistics() const;
+
+private:
+    static constexpr std::size_t kShardCount = 64;
+
+    struct Bucket {
+        double tokens;
+        Clock::time_point updated_at;
+
+        /// Position in Shard::order.
+        std::list<std::string_view>::iterator position;
+    };
+
+    struct StringHash {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view value) const noexcept { return std::hash<std::string_view>{}(value); }
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, Bucket, StringHash, std::equal_to<>> buckets;
+
+        /// Keys of the buckets, most recently used first.
+        std::list<std::string_view> order;
+        Clock::time_point next_sweep{};
+    };
+
+    void Sweep(Shard& shard, Clock::time_point now);
+    static void Erase(Shard& shard, std::string_view key);
+
+    const Settings settings_;
+    const Clock::duration refill_period_;
+    const std::size_t max_keys_per_shard_;
+
+    std::array<Shard, kShardCount> shards_;
+
+    std::atomic<std::uint64_t> allowed_{0};
+    std::atomic<std::uint64_t> rejected_{0};
+    std::atomic<std::uint64_t> overflow_{0};
+    std::atomic<std::uint64_t> evicted_{0};
+    std::atomic<std::size_t> keys_{0};
+};
+
+}  // namespace ratelimit
@@ -0,0 +1,147 @@
+#include "limiter.hpp"
+
+#include <userver/utest/utest.hpp>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ratelimit;
+using namespace std::chrono_literals;
+
+namespace {
+
+Settings MakeSettings(std::uint32_t burst, double rate_per_second, std::size_t max_keys = 100'000) {
+    Settings settings;
+    settings.burst = burst;
+    settings.rate_per_second = rate_per_second;
+    settings.max_keys = max_keys;
+    return settings;
+}
+
+}  // namespace
+
+TEST(RateLimiterTest, AllowsBurstThenRejects) {
+    Limiter limiter{MakeSettings(3, 1)};
+    const auto now = Limiter::Clock::now();
+
+    EXPECT_TRUE(limiter.TryAcquire("alice", now));
+    EXPECT_TRUE(limiter.TryAcquire("alice", now));
+    EXPECT_TRUE(limiter.TryAcquire("alice", now));
+    EXPECT_FALSE(limiter.TryAcquire("alice", now));
+
+    // other keys have their own buckets
+    EXPECT_TRUE(limiter.TryAcquire("bob", now));
+
+    const auto statistics = limiter.GetStatistics();
+    EXPECT_EQ(statistics.allowed, 4);
+    EXPECT_EQ(statistics.rejected, 1);
+    EXPECT_EQ(statistics.keys, 2);
+}
+
+TEST(RateLimiterTest, RefillsOverTime) {
+    Limiter limiter{MakeSettings(2, 2)};
+    const auto start = Limiter::Clock::now();
+
+    EXPECT_TRUE(limiter.TryAcquire("alice", start));
+    EXPECT_TRUE(limiter.TryAcquire("alice", start));
+    EXPECT_FALSE(limiter.TryAcquire("alice", start + 100ms));
+
+    // 2 tokens per second: one token after 500ms, not two
+    EXPECT_TRUE(limiter.TryAcquire("alice", start + 500ms));
+    EXPECT_FALSE(limiter.TryAcquire("alice", start + 500ms));
+
+    // never more than the burst
+    EXPECT_TRUE(limiter.TryAcquire("alice", start + 1h));
+    EXPECT_TRUE(limiter.TryAcquire("alice", start + 1h));
+    EXPECT_FALSE(limiter.TryAcquire("alice", start + 1h));
+}
+
+TEST(RateLimiterTest, EvictsRefilledBuckets) {
+    Limiter limiter{MakeSettings(1, 1)};
+    const auto start = Limiter::Clock::now();
+
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(limiter.TryAcquire("user" + std::to_string(i), start));
+    }
+    EXPECT_EQ(limiter.GetStatistics().keys, 1000);
+
+    // touching every shard after a full refill period sweeps the idle buckets
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(limiter.TryAcquire("user" + std::to_string(i), start + 10s));
+    }
+
+    const auto statistics = limiter.GetStatistics();
+    EXPECT_EQ(statistics.evicted, 1000);
+    EXPECT_EQ(statistics.keys, 1000);
+}
+
+TEST(RateLimiterTest, ServesNewKeysOverCapacity) {
+    // one key per shard
+    Limiter limiter{MakeSettings(5, 1, 1)};
+    const auto now = Limiter::Clock::now();
+
+    // a flood of made-up keys, one request each
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(limiter.TryAcquire("spray" + std::to_string(i), now));
+    }
+
+    // a key seen for the first time is still served
+    EXPECT_TRUE(limiter.TryAcquire("alice", now));
+
+    const auto statistics = limiter.GetStatistics();
+    EXPECT_LE(statistics.keys, 64);
+    EXPECT_EQ(statistics.overflow, 1001 - statistics.keys);
+    EXPECT_EQ(statistics.rejected, 0);
+}
+
+TEST(RateLimiterTest, EvictsLeastRecentlyUsedOverCapacity) {
+    Limiter limiter{MakeSettings(1, 0.001, 128)};
+    const auto now = Limiter::Clock::now();
+
+    // keys of one shard, two fit into it
+    std::vector<std::string> keys;
+    for (int i = 0; keys.size() < 3; ++i) {
+        auto key = "user" + std::to_string(i);
+        if (std::hash<std::string_view>{}(key) % 64 == std::hash<std::string_view>{}("user0") % 64) {
+            keys.push_back(std::move(key));
+        }
+    }
+
+    EXPECT_TRUE(limiter.TryAcquire(keys[0], now));
+    EXPECT_TRUE(limiter.TryAcquire(keys[1], now));
+    EXPECT_FALSE(limiter.TryAcquire(keys[0], now));
+
+    // keys[1] is the least recently used one
+    EXPECT_TRUE(limiter.TryAcquire(keys[2], now));
+    EXPECT_FALSE(limiter.TryAcquire(keys[0], now));
+    EXPECT_TRUE(limiter.TryAcquire(keys[1], now));
+
+    EXPECT_EQ(limiter.GetStatistics().overflow, 2);
+    EXPECT_EQ(limiter.GetStatistics().keys, 2);
+}
+
+TEST(RateLimiterTest, ConcurrentAcquireNeverExceedsBurst) {
+    Limiter limiter{MakeSettings(100, 0.001)};
+    const auto now = Limiter::Clock::now();
+
+    std::atomic<int> allowed{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 1000; ++i) {
+                allowed += limiter.TryAcquire("shared", now);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(allowed, 100);
+}
+
+TEST(RateLimiterTest, RejectsInvalidSettings) {
+    EXPECT_THROW(Limiter{MakeSettings(0, 1)}, std::invalid_argument);
+    EXPECT_THROW(Limiter{MakeSettings(1, 0)}, std::invalid_argument);
+}
@@ -0,0 +1,228 @@
+#include "component.hpp"
+#include "crypto/component.hpp"
+#include "crypto/keyring.hpp"
+#include "db/sql.hpp"
+#include "secure/arena.hpp"
+
+#include <userver/components/component.hpp>
+#include <userver/components/statistics_storage.hpp>
+#include <userver/engine/sleep.hpp>
+#include <userver/engine/task/cancel.hpp>
+#include <userver/logging/log.hpp>
+#include <userver/storages/postgres/cluster.hpp>
+#include <userver/storages/postgres/component.hpp>
+#include <userver/storages/postgres/io/chrono.hpp>
+#include <userver/utils/statistics/writer.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+#include <vector>
+
+namespace reencryption {
+
+/// Encrypted column: the batch is read by id and written back with compare-and-set.
+struct Target {
+    std::string_view name;
+
+    /// (last id, limit) -> (id, value) ordered by id
+    const char* select_batch;
+
+    /// (ids, old values, new values)
+    const char* update_batch;
+};
+
+namespace {
+
+const Target kTargets[] = {
+    {"users.totp_secret", db::sql::kGetTotpSecretsBatch, db::sql::kReencryptTotpSecrets},
+};
+
+struct Checkpoint {
+    std::int64_t primary_key_id;
+    std::int64_t last_id;
+    std::optional<userver::storages::postgres::TimePointTz> completed_at;
+};
+
+struct Row {
+    std::int32_t id;
+    std::string value;
+};
+
+}  // namespace
+
+void DumpMetric(userver::utils::statistics::Writer& writer, const Statistics& statistics) {
+    writer["scanned"] = statistics.scanned.load();
+    writer["reencrypted"] = statistics.reencrypted.load();
+    writer["conflicts"] = statistics.conflicts.load();
+    writer["batches"] = statistics.batches.load();
+    writer["passes"] = statistics.passes.load();
+    writer["errors"] = statistics.errors.load();
+    writer["last_id"] = statistics.last_id.load();
+}
+
+Component::Component(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& context
+)
+    : userver::components::LoggableComponentBase(config, context),
+      pg_cluster_{context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()},
+      keyring_{context.FindComponent<crypto::Component>().GetKeyring()},
+      batch_size_{config["batch_size"].As<std::size_t>(500)},
+      rows_per_second_{config["rows_per_second"].As<std::size_t>(1000)},
+      rescan_interval_{config["rescan_interval"].As<std::chrono::seconds>(std::chrono::hours{1})} {
+    if (batch_size_ == 0 || rows_per_second_ == 0) {
+        throw std::invalid_argument("Re-encryption batch_size and rows_per_second must be positive");
+    }
+
+    auto& storage = context.FindComponent<userver::components::StatisticsStorage>().GetStorage();
+    statistics_holder_ = storage.RegisterWriter(
+        "vaulty.reencryption", [this](userver::utils::statistics::Writer& writer) { writer = statistics_; }
+    );
+
+    userver::utils::PeriodicTask::Settings settings{
+        config["interval"].As<std::chrono::milliseconds>(std::chrono::seconds{10}),
+    };
+    settings.task_processor = &context.GetTaskProcessor(config["task_processor"].As<std::string>());
+    task_.Start("reencryption", settings, [this] { Run(); });
+}
+
+Component::~Component() {
+    task_.Stop();
+    statistics_holder_.Unregister();
+}
+
+void Component::Run() {
+    for (const auto& target : kTargets) {
+        try {
+            ProcessTarget(target);
+        } catch (const std::exception& ex) {
+            ++statistics_.errors;
+            LOG_ERROR() << "Re-encryption of " << target.name << " failed: " << ex.what();
+        }
+    }
+}
+
+void Component::ProcessTarget(const Target& target) {
+    pg_cluster_->Execute(
+        userver::storages::postgres::ClusterHostType::kMaster, db::sql::kInitReencryptionCheckpoint, target.name
+    );
+
+    while (!userver::engine::current_task::ShouldCancel()) {
+        const auto scanned = ProcessBatch(target);
+        if (!scanned) {
+            return;
+        }
+        // throttle outside of the transaction, the checkpoint row is not held while sleeping
+        userver::engine::InterruptibleSleepFor(std::chrono::microseconds{*scanned * 1'000'000 / rows_per_second_});
+    }
+}
+
+std::optional<std::size_t> Component::ProcessBatch(const Target& target) {
+    const std::int64_t primary_key_id = keyring_.GetPrimaryKeyId();
+
+    auto transaction = pg_cluster_->Begin(userver::storages::postgres::ClusterHostType::kMaster, {});
+    const auto checkpoint_result = transaction.Execute(db::sql::kLockReencryptionCheckpoint, target.name);
+    if (checkpoint_result.IsEmpty()) {
+        LOG_DEBUG() << "Re-encryption of " << target.name << " is running on another instance";
+        return std::nullopt;
+    }
+
+    auto checkpoint = checkpoint_result.AsSingleRow<Checkpoint>(userver::storages::postgres::kRowTag);
+    const auto now = std::chrono::system_clock::now();
+    if (checkpoint.primary_key_id != primary_key_id ||
+        (checkpoint.completed_at && checkpoint.completed_at->GetUnderlying() + rescan_interval_ < now)) {
+        LOG_INFO() << "Starting re-encryption pass of " << target.name << " with key ID " << primary_key_id;
+        checkpoint = {primary_key_id, 0, std::nullopt};
+    } else if (checkpoint.completed_at) {
+        return std::nullopt;
+    }
+
+    const auto rows =
+        transaction.Execute(target.select_batch, checkpoint.last_id, static_cast<std::int64_t>(batch_size_))
+            .AsContainer<std::vector<Row>>(userver::storages::postgres::kRowTag);
+
+    std::vector<std::int32_t> ids;
+    std::vector<std::string> old_values;
+    std::vector<std::string> new_values;
+    for (const auto& row : rows) {
+        if (!keyring_.NeedsReencryption(row.value)) {
+            continue;
+        }
+        try {
+            auto plaintext = keyring_.DecryptText(row.value);
+            new_values.push_back(keyring_.EncryptText(plaintext));
+            secure::Wipe(plaintext);
+        } catch (const std::exception& ex) {
+            // a row that cannot be decrypted must not block the rest of the table
+            ++statistics_.errors;
+            LOG_ERROR() << "Failed to re-encrypt " << target.name << " of row " << row.id << ": " << ex.what();
+            continue;
+        }
+        ids.push_back(row.id);
+        old_values.push_back(row.value);
+    }
+
+    std::size_t reencrypted = 0;
+    if (!ids.empty()) {
+        reencrypted = transaction.Execute(target.update_batch, ids, old_values, new_values).RowsAffected();
+    }
+
+    const bool completed = rows.size() < batch_size_;
+    if (!rows.empty()) {
+        checkpoint.last_id = rows.back().id;
+    }
+    if (completed) {
+        checkpoint.completed_at = userver::storages::postgres::TimePointTz{now};
+    }
+    transaction.Execute(
+        db::sql::kUpdateReencryptionCheckpoint,
+        target.name,
+        checkpoint.primary_key_id,
+        checkpoint.last_id,
+        checkpoint.completed_at
+    );
+    transaction.Commit();
+
+    statistics_.scanned += rows.size();
+    statistics_.reencrypted += reencrypted;
+    statistics_.conflicts += ids.size() - reencrypted;
+    ++statistics_.batches;
+    statistics_.last_id = checkpoint.last_id;
+
+    if (completed) {
+        ++statistics_.passes;
+        LOG_INFO() << "Re-encryption pass of " << target.name << " with key ID " << primary_key_id << " completed";
+        return std::nullopt;
+    }
+    return rows.size();
+}
+
+userver::yaml_config::Schema Component::GetStaticConfigSchema() {
+    constexpr auto schema = R"(
+        type: object
+        description: background re-encryption of stored data under the primary server key
+        additionalProperties: false
+        properties:
+            task_processor:
+                type: string
+                description: task processor the job runs on, keep it separate from the request processing one
+            interval:
+                type: string
+                description: how often to check for work
+                defaultDescription: 10s
+            batch_size:
+                type: integer
+                description: rows read, re-encrypted and written back in a single transaction
+                defaultDescription: 500
+            rows_per_second:
+                type: integer
+                description: throttling of the scan
+                defaultDescription: 1000
+            rescan_interval:
+                type: string
+                description: completed passes are repeated after this time, for rows written with an old primary key
+                defaultDescription: 1h
+    )";
+    return userver::yaml_config::MergeSchemas<userver::components::LoggableComponentBase>(schema);
+}
+
+}  // namespace reencryption
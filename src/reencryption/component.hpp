@@ -0,0 +1,76 @@
+#pragma once
+
+#include <userver/components/loggable_component_base.hpp>
+#include <userver/storages/postgres/postgres_fwd.hpp>
+#include <userver/utils/periodic_task.hpp>
+#include <userver/utils/statistics/entry.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+namespace crypto {
+
+class Keyring;
+
+}  // namespace crypto
+
+namespace reencryption {
+
+struct Target;
+
+/// Progress counters of the re-encryption job.
+struct Statistics {
+    std::atomic<std::uint64_t> scanned{0};
+    std::atomic<std::uint64_t> reencrypted{0};
+    std::atomic<std::uint64_t> conflicts{0};
+    std::atomic<std::uint64_t> batches{0};
+    std::atomic<std::uint64_t> passes{0};
+    std::atomic<std::uint64_t> errors{0};
+    std::atomic<std::int64_t> last_id{0};
+};
+
+void DumpMetric(userver::utils::statistics::Writer& writer, const Statistics& statistics);
+
+/// @brief Background job that re-encrypts data under the primary server key.
+///
+/// Walks every encrypted column in id order, in batches of `batch_size` rows
+/// throttled to `rows_per_second`. Each batch is a transaction that holds the
+/// column's checkpoint row with SKIP LOCKED, so with several instances only one
+/// of them works on a column at a time and a restarted instance continues from
+/// the last committed batch. Values are written back with compare-and-set, a
+/// concurrent change of a row wins over the job.
+///
+/// A pass starts over when the primary key changes, and every `rescan_interval`
+/// to pick up rows written by instances that were not yet switched to the new key.
+class Component final : public userver::components::LoggableComponentBase {
+public:
+    static constexpr std::string_view kName = "component-reencryption";
+
+    Component(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
+    ~Component() override;
+
+    static userver::yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    void Run();
+
+    /// Processes batches of the target until the pass is completed.
+    void ProcessTarget(const Target& target);
+
+    /// @return The number of rows scanned, std::nullopt if there is nothing more to do for the target now.
+    std::optional<std::size_t> ProcessBatch(const Target& target);
+
+    userver::storages::postgres::ClusterPtr pg_cluster_;
+    const crypto::Keyring& keyring_;
+    const std::size_t batch_size_;
+    const std::size_t rows_per_second_;
+    const std::chrono::seconds rescan_interval_;
+
+    Statistics statistics_;
+    userver::utils::PeriodicTask task_;
+    userver::utils::statistics::Entry statistics_holder_;
+};
+
+}  // namespace reencryption
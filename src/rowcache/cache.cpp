@@ -0,0 +1,235 @@
+#include "cache.hpp"
+
+#include <algorithm>
+
+namespace {
+
+/// Map and list nodes of a cached vault.
+constexpr std::size_t kEntryOverhead = 96;
+
+std::size_t EstimateBytes(const rowcache::CachedVault& vault) {
+    std::size_t bytes = kEntryOverhead + sizeof(vault) + vault.passwords.capacity() * sizeof(models::Password);
+    for (const auto& password : vault.passwords) {
+        bytes += password.service.capacity() + password.login.capacity() + password.password_encrypted.capacity();
+        if (password.fingerprint) {
+            bytes += password.fingerprint->capacity();
+        }
+        if (password.totp_secret_encrypted) {
+            bytes += password.totp_secret_encrypted->capacity();
+        }
+    }
+    return bytes;
+}
+
+auto LowerBound(const std::vector<models::Password>& passwords, std::int64_t id) {
+    return std::lower_bound(passwords.begin(), passwords.end(), id, [](const auto& password, std::int64_t id) {
+        return password.id < id;
+    });
+}
+
+}  // namespace
+
+namespace rowcache {
+
+Cache::Cache(const Settings& settings)
+    : max_shard_bytes_{settings.max_bytes / kShards},
+      max_shard_versions_{std::max<std::size_t>(settings.max_versions / kShards, 1)} {}
+
+std::shared_ptr<const CachedVault> Cache::Find(std::int32_t user_id) {
+    auto& shard = GetShard(user_id);
+    const std::lock_guard lock{shard.mutex};
+    const auto it = shard.vaults.find(user_id);
+    if (it == shard.vaults.end()) {
+        ++statistics_.misses;
+        return nullptr;
+    }
+    shard.order.splice(shard.order.begin(), shard.order, it->second.position);
+    ++statistics_.hits;
+    return it->second.vault;
+}
+
+std::uint64_t Cache::GetGeneration(std::int32_t user_id) {
+    auto& shard = GetShard(user_id);
+    const std::lock_guard lock{shard.mutex};
+    return shard.generation;
+}
+
+std::int64_t Cache::GetKnownVersion(std::int32_t user_id) {
+    auto& shard = GetShard(user_id);
+    const std::lock_guard lock{shard.mutex};
+    const auto it = shard.versions.find(user_id);
+    return it == shard.versions.end() ? 0 : it->second.version;
+}
+
+bool Cache::Insert(std::int32_t user_id, std::shared_ptr<const CachedVault> vault, std::uint64_t generation) {
+    auto& shard = GetShard(user_id);
+    const std::lock_guard lock{shard.mutex};
+    if (shard.generation != generation) {
+        return false;
+    }
+    const auto known = shard.versions.find(user_id);
+    if (known != shard.versions.end() && vault->version < known->second.version) {
+        // loaded from a replica behind a change that was seen already
+        ++statistics_.stale;
+        return false;
+    }
+    Store(shard, user_id, std::move(vault));
+    return shard.vaults.count(user_id) != 0;
+}
+
+void Cache::Add(std::int32_t user_id, std::int64_t version, models::Password password) {
+    auto& shard = GetShard(user_id);
+    const std::lock_guard lock{shard.mutex};
+    ++shard.generation;
+    Remember(shard, user_id, version);
+    const auto it = shard.vaults.find(user_id);
+    if (it == shard.vaults.end() || it->second.vault->version >= version) {
+        // not cached, or loaded after the write and holding the entry already
+        return;
+    }
+    if (it->second.vault->version != version - 1) {
+        // changes from elsewhere are in between
+        Erase(shard, it);
+        ++statistics_.invalidated;
+        return;
+    }
+
+    auto vault = std::make_shared<CachedVault>(*it->second.vault);
+    vault->version = version;
+    vault->passwords.insert(LowerBound(vault->passwords, password.id), std::move(password));
+    Store(shard, user_id, std::move(vault));
+    ++statistics_.updated;
+}
+
+void Cache::Remove(std::int32_t user_id, std::int64_t version, std::int64_t password_id) {
+    auto& shard = GetShard(user_id);
+    const std::lock_guard lock{shard.mutex};
+    ++shard.generation;
+    Remember(shard, user_id, version);
+    const auto it = shard.vaults.find(user_id);
+    if (it == shard.vaults.end() || it->second.vault->version >= version) {
+        return;
+    }
+    if (it->second.vault->version != version - 1) {
+        Erase(shard, it);
+        ++statistics_.invalidated;
+        return;
+    }
+
+    auto vault = std::make_shared<CachedVault>(*it->second.vault);
+    vault->version = version;
+    const auto position = LowerBound(vault->passwords, password_id);
+    if (position != vault->passwords.end() && position->id == password_id) {
+        vault->passwords.erase(position);
+    }
+    Store(shard, user_id, std::move(vault));
+    ++statistics_.updated;
+}
+
+void Cache::Invalidate(std::int32_t user_id, std::int64_t version) {
+    auto& shard = GetShard(user_id);
+    const std::lock_guard lock{shard.mutex};
+    ++shard.generation;
+    Remember(shard, user_id, version);
+    const auto it = shard.vaults.find(user_id);
+    if (it != shard.vaults.end() && it->second.vault->version < version) {
+        Erase(shard, it);
+        ++statistics_.invalidated;
+    }
+}
+
+void Cache::Evict(std::int32_t user_id) {
+    auto& shard = GetShard(user_id);
+    const std::lock_guard lock{shard.mutex};
+    ++shard.generation;
+    const auto it = shard.vaults.find(user_id);
+    if (it != shard.vaults.end()) {
+        Erase(shard, it);
+        ++statistics_.invalidated;
+    }
+}
+
+void Cache::Clear() {
+    for (auto& shard : shards_) {
+        const std::lock_guard lock{shard.mutex};
+        ++shard.generation;
+        size_ -= shard.vaults.size();
+        bytes_ -= shard.bytes;
+        shard.vaults.clear();
+        shard.order.clear();
+        shard.bytes = 0;
+    }
+}
+
+void Cache::Reset() {
+    Clear();
+    for (auto& shard : shards_) {
+        const std::lock_guard lock{shard.mutex};
+        shard.versions.clear();
+        shard.versions_order.clear();
+    }
+}
+
+Cache::Shard& Cache::GetShard(std::int32_t user_id) {
+    return shards_[static_cast<std::uint32_t>(user_id) % kShards];
+}
+
+void Cache::Store(Shard& shard, std::int32_t user_id, std::shared_ptr<const CachedVault> vault) {
+    const auto bytes = EstimateBytes(*vault);
+    auto it = shard.vaults.find(user_id);
+    if (bytes > max_shard_bytes_) {
+        if (it != shard.vaults.end()) {
+            Erase(shard, it);
+        }
+        ++statistics_.rejected;
+        return;
+    }
+
+    if (it == shard.vaults.end()) {
+        shard.order.push_front(user_id);
+        it = shard.vaults.emplace(user_id, Entry{nullptr, 0, shard.order.begin()}).first;
+        ++size_;
+    } else {
+        shard.order.splice(shard.order.begin(), shard.order, it->second.position);
+    }
+    shard.bytes += bytes - it->second.bytes;
+    bytes_ += bytes - it->second.bytes;
+    it->second.vault = std::move(vault);
+    it->second.bytes = bytes;
+
+    while (shard.bytes > max_shard_bytes_) {
+        Erase(shard, shard.vaults.find(shard.order.back()));
+        ++statistics_.evicted;
+    }
+}
+
+void Cache::Remember(Shard& shard, std::int32_t user_id, std::int64_t version) {
+    if (!IsEnabled()) {
+        return;
+    }
+
+    const auto it = shard.versions.find(user_id);
+    if (it != shard.versions.end()) {
+        it->second.version = std::max(it->second.version, version);
+        shard.versions_order.splice(shard.versions_order.begin(), shard.versions_order, it->second.position);
+        return;
+    }
+
+    if (shard.versions.size() >= max_shard_versions_) {
+        // replicas have long caught up with the oldest change
+        shard.versions.erase(shard.versions_order.back());
+        shard.versions_order.pop_back();
+    }
+    shard.versions_order.push_front(user_id);
+    shard.versions.emplace(user_id, KnownVersion{version, shard.versions_order.begin()});
+}
+
+void Cache::Erase(Shard& shard, std::unordered_map<std::int32_t, Entry>::iterator it) {
+    shard.bytes -= it->second.bytes;
+    bytes_ -= it->second.bytes;
+    --size_;
+    shard.order.erase(it->second.position);
+    shard.vaults.erase(it);
+}
+
+}  // namespace rowcache
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "models/password.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace rowcache {
+
+/// Row cache settings.
+struct Settings {
+    /// Memory budget of the cached rows, 0 disables the cache.
+    std::size_t max_bytes{256 << 20};
+
+    /// Newest notified versions of users remembered to check loads from replicas against.
+    std::size_t max_versions{1 << 18};
+};
+
+/// Password rows of a vault at a version, ordered by ID. Holds ciphertext only, as stored in Postgres.
+struct CachedVault {
+    std::int64_t version{0};
+    std::vector<models::Password> passwords;
+};
+
+/// Counters of a cache.
+struct Statistics {
+    std::atomic<std::uint64_t> hits{0};
+    std::atomic<std::uint64_t> misses{0};
+    std::atomic<std::uint64_t> updated{0};
+    std::atomic<std::uint64_t> invalidated{0};
+    std::atomic<std::uint64_t> evicted{0};
+    std::atomic<std::uint64_t> rejected{0};
+    std::atomic<std::uint64_t> stale{0};
+};
+
+/// @brief Per-user cache of password rows, bounded by an estimate of their memory.
+///
+/// A vault is cached whole, as the immutable CachedVault of one version, so a
+/// lookup hands out a shared pointer and copies nothing under the lock. The
+/// users are spread over shards, each with its own share of `max_bytes` and
+/// its own LRU list; a vault larger than the share of a shard is not cached.
+///
+/// Writes of the instance are applied to the cached vault if it is at the
+/// version just before the write, otherwise the vault is dropped. Changes made
+/// elsewhere arrive from the change feed and drop the vaults they are newer
+/// than. A vault loaded from Postgres may miss a change that lands while the
+/// load is in flight, so loads take a generation of the shard first and
+/// Insert() drops the vault if the shard has seen a change since. A vault
+/// loaded from a replica that has not applied a change yet is older than the
+/// newest version the cache has seen for the user, which each shard remembers
+/// for up to its share of `max_versions` users, and is not cached either.
+/// Thread-safe.
+class Cache final {
+public:
+    explicit Cache(const Settings& settings);
+
+    bool IsEnabled() const noexcept { return max_shard_bytes_ != 0; }
+
+    /// @brief Returns the cached vault of the user, nullptr if there is none.
+    std::shared_ptr<const CachedVault> Find(std::int32_t user_id);
+
+    /// @brief Returns the counter Insert() compares against, to be taken before the vault is loaded.
+    std::uint64_t GetGeneration(std::int32_t user_id);
+
+    /// @brief Returns the newest version written or notified for the user, 0 if none is remembered.
+    std::int64_t GetKnownVersion(std::int32_t user_id);
+
+    /// @brief Caches a vault loaded from Postgres unless its shard has seen a change since `generation`
+    /// or the vault is older than GetKnownVersion().
+    /// @return false if the vault was not cached.
+    bool Insert(std::int32_t user_id, std::shared_ptr<const CachedVault> vault, std::uint64_t generation);
+
+    /// @brief Applies an entry created by the write that produced `version`.
+    void Add(std::int32_t user_id, std::int64_t version, models::Password password);
+
+    /// @brief Applies the deletion of an entry by the write that produced `version`.
+    void Remove(std::int32_t user_id, std::int64_t version, std::int64_t password_id);
+
+    /// @brief Drops the vault of the user if it is older than `version`, for changes from the change feed.
+    void Invalidate(std::int32_t user_id, std::int64_t version);
+
+    /// @brief Drops the vault of a deleted user.
+    void Evict(std::int32_t user_id);
+
+    /// @brief Drops every vault, for when changes may have been missed. The known versions stay.
+    void Clear();
+
+    /// @brief Drops every vault and known version, for tests that start over with the same user IDs.
+    void Reset();
+
+    std::size_t GetSize() const noexcept { return size_.load(); }
+
+    std::size_t GetBytes() const noexcept { return bytes_.load(); }
+
+    const Statistics& GetStatistics() const noexcept { return statistics_; }
+
+private:
+    static constexpr std::size_t kShards = 16;
+
+    struct Entry {
+        std::shared_ptr<const CachedVault> vault;
+        std::size_t bytes{0};
+        std::list<std::int32_t>::iterator position;
+    };
+
+    struct KnownVersion {
+        std::int64_t version{0};
+        std::list<std::int32_t>::iterator position;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::int32_t, Entry> vaults;
+
+        /// Least recently used last.
+        std::list<std::int32_t> order;
+        std::size_t bytes{0};
+        std::uint64_t generation{0};
+
+        std::unordered_map<std::int32_t, KnownVersion> versions;
+
+        /// Least recently changed last.
+        std::list<std::int32_t> versions_order;
+    };
+
+    Shard& GetShard(std::int32_t user_id);
+
+    /// Caches the vault in place of the current one and evicts vaults over the budget, the shard must be locked.
+    void Store(Shard& shard, std::int32_t user_id, std::shared_ptr<const CachedVault> vault);
+
+    /// Remembers the version of a change of the user, the shard must be locked.
+    void Remember(Shard& shard, std::int32_t user_id, std::int64_t version);
+
+    /// The shard must be locked.
+    void Erase(Shard& shard, std::unordered_map<std::int32_t, Entry>::iterator it);
+
+    const std::size_t max_shard_bytes_;
+    const std::size_t max_shard_versions_;
+    std::array<Shard, kShards> shards_;
+    std::atomic<std::size_t> size_{0};
+    std::atomic<std::size_t> bytes_{0};
+    Statistics statistics_;
+};
+
+}  // namespace rowcache
@@ -0,0 +1,70 @@
+#include "component.hpp"
+
+#include <userver/components/component.hpp>
+#include <userver/components/statistics_storage.hpp>
+#include <userver/utils/statistics/writer.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+namespace {
+
+rowcache::Settings ParseSettings(const userver::yaml_config::YamlConfig& config) {
+    rowcache::Settings settings;
+    settings.max_bytes = config["max_bytes"].As<std::size_t>(settings.max_bytes);
+    settings.max_versions = config["max_versions"].As<std::size_t>(settings.max_versions);
+    return settings;
+}
+
+}  // namespace
+
+namespace rowcache {
+
+Component::Component(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& context
+)
+    : userver::components::LoggableComponentBase(config, context),
+      cache_{ParseSettings(config)} {
+    auto& storage = context.FindComponent<userver::components::StatisticsStorage>().GetStorage();
+    statistics_holder_ = storage.RegisterWriter("vaulty.row_cache", [this](userver::utils::statistics::Writer& writer) {
+        const auto& statistics = cache_.GetStatistics();
+        writer["vaults"] = cache_.GetSize();
+        writer["bytes"] = cache_.GetBytes();
+        writer["hits"] = statistics.hits.load();
+        writer["misses"] = statistics.misses.load();
+        writer["updated"] = statistics.updated.load();
+        writer["invalidated"] = statistics.invalidated.load();
+        writer["evicted"] = statistics.evicted.load();
+        writer["rejected"] = statistics.rejected.load();
+        writer["stale"] = statistics.stale.load();
+    });
+
+    reset_registration_ = userver::testsuite::RegisterCache(config, context, this, &Component::ResetCache);
+}
+
+Component::~Component() { statistics_holder_.Unregister(); }
+
+Cache& Component::GetCache() { return cache_; }
+
+void Component::ResetCache() { cache_.Reset(); }
+
+userver::yaml_config::Schema Component::GetStaticConfigSchema() {
+    constexpr auto schema = R"(
+        type: object
+        description: per-user cache of encrypted password rows
+        additionalProperties: false
+        properties:
+            max_bytes:
+                type: integer
+                description: memory budget of the cached rows, 0 disables the cache
+                defaultDescription: 268435456
+                minimum: 0
+            max_versions:
+                type: integer
+                description: users whose newest vault version is remembered to reject loads from lagging replicas
+                defaultDescription: 262144
+                minimum: 1
+    )";
+    return userver::yaml_config::MergeSchemas<userver::components::LoggableComponentBase>(schema);
+}
+
+}  // namespace rowcache
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "cache.hpp"
+
+#include <userver/components/loggable_component_base.hpp>
+#include <userver/testsuite/cache_control.hpp>
+#include <userver/utils/statistics/entry.hpp>
+
+#include <string_view>
+
+namespace rowcache {
+
+/// @brief Password row cache of the instance and its invalidation.
+///
+/// vault::Service reads and updates the Cache. Changes of other instances
+/// drop the outdated vaults through notify::Component, which also clears the
+/// cache whenever its LISTEN connection is (re)established. The testsuite
+/// resets it between tests through `tests-control`, as they reuse user IDs.
+class Component final : public userver::components::LoggableComponentBase {
+public:
+    static constexpr std::string_view kName = "component-row-cache";
+
+    Component(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
+    ~Component() override;
+
+    Cache& GetCache();
+
+    static userver::yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    void ResetCache();
+
+    Cache cache_;
+    userver::utils::statistics::Entry statistics_holder_;
+    userver::testsuite::CacheResetRegistration reset_registration_;
+};
+
+}  // namespace rowcache
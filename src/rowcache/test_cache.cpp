@@ -0,0 +1,179 @@
+#include "cache.hpp"
+
+#include <userver/utest/utest.hpp>
+
+#include <string>
+
+using namespace rowcache;
+
+namespace {
+
+models::Password MakePassword(std::int32_t id, std::int32_t user_id) {
+    models::Password password{};
+    password.id = id;
+    password.user_id = user_id;
+    password.service = "service" + std::to_string(id);
+    password.login = "login";
+    password.password_encrypted = std::string(64, 'x');
+    return password;
+}
+
+std::shared_ptr<const CachedVault> MakeVault(std::int32_t user_id, std::int64_t version, std::int32_t size) {
+    auto vault = std::make_shared<CachedVault>();
+    vault->version = version;
+    for (std::int32_t id = 1; id <= size; ++id) {
+        vault->passwords.push_back(MakePassword(id, user_id));
+    }
+    return vault;
+}
+
+}  // namespace
+
+TEST(RowCacheTest, FindsInsertedVaults) {
+    Cache cache{{}};
+    EXPECT_FALSE(cache.Find(1));
+
+    EXPECT_TRUE(cache.Insert(1, MakeVault(1, 3, 2), cache.GetGeneration(1)));
+    const auto vault = cache.Find(1);
+    ASSERT_TRUE(vault);
+    EXPECT_EQ(vault->version, 3);
+    EXPECT_EQ(vault->passwords.size(), 2);
+    EXPECT_FALSE(cache.Find(2));
+
+    EXPECT_EQ(cache.GetSize(), 1);
+    EXPECT_GT(cache.GetBytes(), 0);
+    EXPECT_EQ(cache.GetStatistics().hits, 1);
+    EXPECT_EQ(cache.GetStatistics().misses, 2);
+}
+
+TEST(RowCacheTest, AppliesLocalWrites) {
+    Cache cache{{}};
+    cache.Insert(1, MakeVault(1, 3, 2), cache.GetGeneration(1));
+
+    cache.Add(1, 4, MakePassword(5, 1));
+    auto vault = cache.Find(1);
+    ASSERT_TRUE(vault);
+    EXPECT_EQ(vault->version, 4);
+    ASSERT_EQ(vault->passwords.size(), 3);
+    EXPECT_EQ(vault->passwords.back().id, 5);
+
+    cache.Remove(1, 5, 1);
+    vault = cache.Find(1);
+    ASSERT_TRUE(vault);
+    EXPECT_EQ(vault->version, 5);
+    ASSERT_EQ(vault->passwords.size(), 2);
+    EXPECT_EQ(vault->passwords.front().id, 2);
+
+    // a vault loaded after the write has it already
+    cache.Add(1, 5, MakePassword(6, 1));
+    EXPECT_EQ(cache.Find(1)->passwords.size(), 2);
+
+    // a write after changes the cache has not seen drops the vault
+    cache.Add(1, 7, MakePassword(7, 1));
+    EXPECT_FALSE(cache.Find(1));
+    EXPECT_EQ(cache.GetSize(), 0);
+    EXPECT_EQ(cache.GetBytes(), 0);
+}
+
+TEST(RowCacheTest, InvalidatesOlderVaults) {
+    Cache cache{{}};
+    cache.Insert(1, MakeVault(1, 3, 2), cache.GetGeneration(1));
+
+    // the notification of a change already applied
+    cache.Invalidate(1, 3);
+    EXPECT_TRUE(cache.Find(1));
+
+    cache.Invalidate(1, 4);
+    EXPECT_FALSE(cache.Find(1));
+    EXPECT_EQ(cache.GetStatistics().invalidated, 1);
+
+    cache.Insert(1, MakeVault(1, 4, 2), cache.GetGeneration(1));
+    cache.Insert(2, MakeVault(2, 1, 2), cache.GetGeneration(2));
+    cache.Clear();
+    EXPECT_FALSE(cache.Find(1));
+    EXPECT_FALSE(cache.Find(2));
+    EXPECT_EQ(cache.GetSize(), 0);
+    EXPECT_EQ(cache.GetBytes(), 0);
+}
+
+TEST(RowCacheTest, EvictsDeletedUsers) {
+    Cache cache{{}};
+    cache.Insert(1, MakeVault(1, 3, 2), cache.GetGeneration(1));
+    const auto generation = cache.GetGeneration(1);
+    cache.Evict(1);
+    EXPECT_FALSE(cache.Find(1));
+    EXPECT_EQ(cache.GetSize(), 0);
+    EXPECT_FALSE(cache.Insert(1, MakeVault(1, 3, 2), generation));
+}
+
+TEST(RowCacheTest, DropsLoadsRacingWithChanges) {
+    Cache cache{{}};
+    const auto generation = cache.GetGeneration(1);
+    cache.Invalidate(1, 4);
+    EXPECT_FALSE(cache.Insert(1, MakeVault(1, 3, 2), generation));
+    EXPECT_FALSE(cache.Find(1));
+}
+
+TEST(RowCacheTest, RejectsLoadsBehindKnownVersions) {
+    Cache cache{{}};
+    EXPECT_EQ(cache.GetKnownVersion(1), 0);
+    cache.Invalidate(1, 4);
+    EXPECT_EQ(cache.GetKnownVersion(1), 4);
+
+    // a replica that has not applied version 4 yet
+    EXPECT_FALSE(cache.Insert(1, MakeVault(1, 3, 2), cache.GetGeneration(1)));
+    EXPECT_EQ(cache.GetStatistics().stale, 1);
+    EXPECT_TRUE(cache.Insert(1, MakeVault(1, 4, 2), cache.GetGeneration(1)));
+
+    // local writes count as well, and the versions outlive Clear()
+    cache.Add(1, 5, MakePassword(3, 1));
+    cache.Clear();
+    EXPECT_EQ(cache.GetKnownVersion(1), 5);
+    EXPECT_FALSE(cache.Insert(1, MakeVault(1, 4, 2), cache.GetGeneration(1)));
+
+    cache.Reset();
+    EXPECT_EQ(cache.GetKnownVersion(1), 0);
+    EXPECT_TRUE(cache.Insert(1, MakeVault(1, 1, 2), cache.GetGeneration(1)));
+}
+
+TEST(RowCacheTest, BoundsKnownVersions) {
+    // users 1, 17 and 33 share a shard
+    Cache cache{{1 << 20, 2 * 16}};
+    cache.Invalidate(1, 1);
+    cache.Invalidate(17, 1);
+    cache.Invalidate(1, 2);
+    cache.Invalidate(33, 1);
+
+    EXPECT_EQ(cache.GetKnownVersion(1), 2);
+    EXPECT_EQ(cache.GetKnownVersion(17), 0);
+    EXPECT_EQ(cache.GetKnownVersion(33), 1);
+}
+
+TEST(RowCacheTest, EvictsLeastRecentlyUsed) {
+    // users 1, 17 and 33 share a shard
+    const auto vault_bytes = [] {
+        Cache cache{{}};
+        cache.Insert(1, MakeVault(1, 1, 10), cache.GetGeneration(1));
+        return cache.GetBytes();
+    }();
+    Cache cache{{vault_bytes * 2 * 16}};
+
+    cache.Insert(1, MakeVault(1, 1, 10), cache.GetGeneration(1));
+    cache.Insert(17, MakeVault(17, 1, 10), cache.GetGeneration(17));
+    EXPECT_TRUE(cache.Find(1));
+    cache.Insert(33, MakeVault(33, 1, 10), cache.GetGeneration(33));
+
+    EXPECT_TRUE(cache.Find(1));
+    EXPECT_FALSE(cache.Find(17));
+    EXPECT_TRUE(cache.Find(33));
+    EXPECT_EQ(cache.GetStatistics().evicted, 1);
+    EXPECT_EQ(cache.GetBytes(), vault_bytes * 2);
+
+    // a vault over the share of its shard is not cached
+    EXPECT_FALSE(cache.Insert(2, MakeVault(2, 1, 100), cache.GetGeneration(2)));
+    EXPECT_EQ(cache.GetStatistics().rejected, 1);
+
+    Cache disabled{{0}};
+    EXPECT_FALSE(disabled.IsEnabled());
+    EXPECT_FALSE(disabled.Insert(1, MakeVault(1, 1, 1), disabled.GetGeneration(1)));
+}
@@ -0,0 +1,199 @@
+#include "arena.hpp"
+
+#include <userver/utils/statistics/writer.hpp>
+#include <userver/yaml_config/yaml_config.hpp>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+namespace {
+
+constexpr std::size_t kAlignment = 16;
+
+constexpr std::size_t AlignUp(std::size_t value, std::size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+constexpr std::size_t kHeaderSize = AlignUp(sizeof(secure::Pool::Page), kAlignment);
+
+std::size_t GetSystemPageSize() {
+    static const auto page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    return page_size;
+}
+
+void Unmap(secure::Pool::Page* page) noexcept {
+    const auto size = page->size;
+    secure::Wipe({reinterpret_cast<char*>(page), kHeaderSize + page->used});
+    munlock(page, size);
+    munmap(page, size);
+}
+
+}  // namespace
+
+namespace secure {
+
+PoolSettings Parse(const userver::yaml_config::YamlConfig& value, userver::formats::parse::To<PoolSettings>) {
+    PoolSettings settings;
+    settings.page_size = value["page_size"].As<std::size_t>(settings.page_size);
+    settings.max_pages = value["max_pages"].As<std::size_t>(settings.max_pages);
+    return settings;
+}
+
+void DumpMetric(userver::utils::statistics::Writer& writer, const PoolStatistics& statistics) {
+    writer["pages"] = statistics.pages;
+    writer["free_pages"] = statistics.free_pages;
+    writer["lock_failures"] = statistics.lock_failures;
+    writer["unpooled"] = statistics.unpooled;
+}
+
+Pool::Pool(PoolSettings settings)
+    : page_size_{AlignUp(settings.page_size, GetSystemPageSize())}, max_pages_{settings.max_pages} {
+    if (page_size_ <= kHeaderSize) {
+        throw std::invalid_argument("Secure pool page size is too small");
+    }
+}
+
+Pool::~Pool() {
+    while (free_list_) {
+        auto* page = free_list_;
+        free_list_ = page->next;
+        Unmap(page);
+    }
+}
+
+Pool::Page* Pool::Acquire(std::size_t capacity) {
+    if (capacity > GetPageCapacity()) {
+        return Map(AlignUp(capacity + kHeaderSize, GetSystemPageSize()), false);
+    }
+
+    bool pooled = false;
+    {
+        const std::lock_guard lock{mutex_};
+        if (free_list_) {
+            auto* page = free_list_;
+            free_list_ = page->next;
+            --statistics_.free_pages;
+            page->next = nullptr;
+            return page;
+        }
+        if (statistics_.pages < max_pages_) {
+            // reserve the slot, mapping happens outside of the lock
+            ++statistics_.pages;
+            pooled = true;
+        }
+    }
+
+    if (!pooled) {
+        return Map(page_size_, false);
+    }
+    try {
+        return Map(page_size_, true);
+    } catch (...) {
+        const std::lock_guard lock{mutex_};
+        --statistics_.pages;
+        throw;
+    }
+}
+
+void Pool::Release(Page* page) noexcept {
+    if (!page->pooled) {
+        Unmap(page);
+        return;
+    }
+
+    Wipe({GetData(*page), page->used});
+    page->used = 0;
+
+    const std::lock_guard lock{mutex_};
+    page->next = free_list_;
+    free_list_ = page;
+    ++statistics_.free_pages;
+}
+
+PoolStatistics Pool::GetStatistics() const {
+    const std::lock_guard lock{mutex_};
+    return statistics_;
+}
+
+std::size_t Pool::GetPageCapacity() const noexcept { return page_size_ - kHeaderSize; }
+
+std::size_t Pool::GetCapacity(const Page& page) noexcept { return page.size - kHeaderSize; }
+
+char* Pool::GetData(Page& page) noexcept { return reinterpret_cast<char*>(&page) + kHeaderSize; }
+
+Pool::Page* Pool::Map(std::size_t size, bool pooled) {
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+#ifdef MADV_DONTDUMP
+    madvise(memory, size, MADV_DONTDUMP);
+#endif
+    const bool locked = mlock(memory, size) == 0;
+
+    if (!locked || !pooled) {
+        const std::lock_guard lock{mutex_};
+        statistics_.lock_failures += locked ? 0 : 1;
+        statistics_.unpooled += pooled ? 0 : 1;
+    }
+
+    return new (memory) Page{nullptr, size, 0, pooled};
+}
+
+Arena::~Arena() {
+    while (current_) {
+        auto* page = current_;
+        current_ = page->next;
+        pool_.Release(page);
+    }
+}
+
+std::span<char> Arena::Allocate(std::size_t size) {
+    const auto aligned_size = AlignUp(std::max<std::size_t>(size, 1), kAlignment);
+    used_ += aligned_size;
+
+    if (current_ && current_->used + aligned_size <= Pool::GetCapacity(*current_)) {
+        auto* data = Pool::GetData(*current_) + current_->used;
+        current_->used += aligned_size;
+        return {data, size};
+    }
+
+    auto* page = pool_.Acquire(aligned_size);
+    page->used = aligned_size;
+    if (current_ && aligned_size > pool_.GetPageCapacity()) {
+        // a dedicated page for a large allocation, keep filling the current one
+        page->next = current_->next;
+        current_->next = page;
+    } else {
+        page->next = current_;
+        current_ = page;
+    }
+    return {Pool::GetData(*page), size};
+}
+
+std::string_view Arena::Copy(std::string_view value) {
+    const auto memory = Allocate(value.size());
+    std::memcpy(memory.data(), value.data(), value.size());
+    return {memory.data(), memory.size()};
+}
+
+void Wipe(std::span<char> memory) noexcept {
+    volatile char* data = memory.data();
+    for (std::size_t i = 0; i < memory.size(); ++i) {
+        data[i] = 0;
+    }
+}
+
+void Wipe(std::string& value) noexcept {
+    // wipe the whole buffer, a shorter value may have been assigned over a longer one
+    value.resize(value.capacity());
+    Wipe(std::span<char>{value.data(), value.size()});
+    value.clear();
+}
+
+}  // namespace secure
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <userver/formats/parse/to.hpp>
+#include <userver/utils/statistics/fwd.hpp>
+#include <userver/yaml_config/fwd.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace secure {
+
+/// Pool settings.
+struct PoolSettings {
+    /// Size of a pooled page in bytes, rounded up to the system page size.
+    std::size_t page_size{16 * 1024};
+
+    /// Pages kept locked in RAM and reused; pages above this are unmapped on release.
+    std::size_t max_pages{256};
+};
+
+PoolSettings Parse(const userver::yaml_config::YamlConfig& value, userver::formats::parse::To<PoolSettings>);
+
+/// Counters of a pool.
+struct PoolStatistics {
+    std::size_t pages{0};
+    std::size_t free_pages{0};
+
+    /// Pages that could not be mlock'd, e.g. because of RLIMIT_MEMLOCK.
+    std::uint64_t lock_failures{0};
+
+    /// Pages mapped beyond max_pages or for allocations larger than a page.
+    std::uint64_t unpooled{0};
+};
+
+void DumpMetric(userver::utils::statistics::Writer& writer, const PoolStatistics& statistics);
+
+/// @brief Source of memory for secrets.
+///
+/// Memory is mapped with mmap, locked with mlock so it is never swapped out and
+/// excluded from core dumps. Pages are wiped before they are reused or unmapped.
+/// Thread-safe.
+class Pool final {
+public:
+    /// Header at the start of every page, the usable memory follows it.
+    struct Page {
+        Page* next;
+        std::size_t size;  ///< mapped size, including the header
+        std::size_t used;  ///< bytes handed out after the header
+        bool pooled;
+    };
+
+    /// @throws std::invalid_argument If page_size cannot hold a header.
+    explicit Pool(PoolSettings settings = {});
+    ~Pool();
+
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+
+    /// @brief Returns a page with at least `capacity` usable bytes.
+    /// @throws std::bad_alloc If the memory cannot be mapped.
+    Page* Acquire(std::size_t capacity);
+
+    /// @brief Wipes the used part of the page and returns it to the pool or unmaps it.
+    void Release(Page* page) noexcept;
+
+    PoolStatistics GetStatistics() const;
+
+    /// Returns the number of usable bytes of a pooled page.
+    std::size_t GetPageCapacity() const noexcept;
+
+    /// Returns the number of usable bytes of a page.
+    static std::size_t GetCapacity(const Page& page) noexcept;
+
+    /// Returns the usable memory of a page.
+    static char* GetData(Page& page) noexcept;
+
+private:
+    Page* Map(std::size_t size, bool pooled);
+
+    const std::size_t page_size_;
+    const std::size_t max_pages_;
+
+    mutable std::mutex mutex_;
+    Page* free_list_{nullptr};
+    PoolStatistics statistics_;
+};
+
+/// @brief Bump allocator for the secrets of a single request.
+///
+/// Takes pages from a Pool and hands out consecutive chunks of them. Nothing is
+/// freed individually: on destruction all handed out memory is wiped at once and
+/// the pages go back to the pool. Not thread-safe.
+class Arena final {
+public:
+    explicit Arena(Pool& pool) : pool_{pool} {}
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /// @brief Returns `size` bytes of uninitialized memory, aligned to 16 bytes.
+    std::span<char> Allocate(std::size_t size);
+
+    /// @brief Copies the value into the arena.
+    std::string_view Copy(std::string_view value);
+
+    /// @brief Returns the number of bytes handed out so far, including padding.
+    std::size_t GetUsed() const noexcept { return used_; }
+
+private:
+    Pool& pool_;
+    Pool::Page* current_{nullptr};
+    std::size_t used_{0};
+};
+
+/// @brief Overwrites the memory in a way the compiler does not optimize out.
+void Wipe(std::span<char> memory) noexcept;
+
+/// @brief Wipes and clears a string that held a secret.
+void Wipe(std::string& value) noexcept;
+
+}  // namespace secure
@@ -0,0 +1,42 @@
+#include "component.hpp"
+
+#include <userver/components/component.hpp>
+#include <userver/components/statistics_storage.hpp>
+#include <userver/utils/statistics/writer.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+namespace secure {
+
+Component::Component(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& context
+)
+    : userver::components::LoggableComponentBase(config, context), pool_{config.As<PoolSettings>()} {
+    auto& storage = context.FindComponent<userver::components::StatisticsStorage>().GetStorage();
+    statistics_holder_ = storage.RegisterWriter(
+        "vaulty.secure-memory",
+        [this](userver::utils::statistics::Writer& writer) { writer = pool_.GetStatistics(); }
+    );
+}
+
+Component::~Component() { statistics_holder_.Unregister(); }
+
+Pool& Component::GetPool() { return pool_; }
+
+userver::yaml_config::Schema Component::GetStaticConfigSchema() {
+    constexpr auto schema = R"(
+        type: object
+        description: locked memory pool for master keys and decrypted secrets
+        additionalProperties: false
+        properties:
+            page_size:
+                type: integer
+                description: size of a pooled page in bytes
+            max_pages:
+                type: integer
+                description: number of pages kept locked in RAM, requests above it get short-lived mappings
+    )";
+    return userver::yaml_config::MergeSchemas<userver::components::LoggableComponentBase>(schema);
+}
+
+}  // namespace secure
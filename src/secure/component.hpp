@@ -0,0 +1,27 @@
+#pragma once
+
+#include "arena.hpp"
+
+#include <userver/components/loggable_component_base.hpp>
+#include <userver/utils/statistics/entry.hpp>
+
+namespace secure {
+
+/// Owns the locked memory pool that per-request arenas for secrets are taken from.
+class Component final : public userver::components::LoggableComponentBase {
+public:
+    static constexpr std::string_view kName = "component-secure-memory";
+
+    Component(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
+    ~Component() override;
+
+    Pool& GetPool();
+
+    static userver::yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    Pool pool_;
+    userver::utils::statistics::Entry statistics_holder_;
+};
+
+}  // namespace secure
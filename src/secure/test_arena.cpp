@@ -0,0 +1,112 @@
+#include "arena.hpp"
+
+#include <userver/utest/utest.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace secure;
+
+namespace {
+
+bool IsZero(std::span<const char> memory) {
+    return std::all_of(memory.begin(), memory.end(), [](char c) { return c == 0; });
+}
+
+}  // namespace
+
+TEST(SecureArenaTest, AllocationsAreAlignedAndDistinct) {
+    Pool pool;
+    Arena arena{pool};
+
+    const auto first = arena.Allocate(5);
+    const auto second = arena.Allocate(32);
+    EXPECT_EQ(first.size(), 5);
+    EXPECT_EQ(second.size(), 32);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(first.data()) % 16, 0);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(second.data()) % 16, 0);
+    EXPECT_GE(second.data(), first.data() + first.size());
+    EXPECT_EQ(arena.GetUsed(), 48);
+
+    EXPECT_EQ(arena.Copy("secret"), "secret");
+    EXPECT_EQ(pool.GetStatistics().pages, 1);
+}
+
+TEST(SecureArenaTest, WipesMemoryOnRelease) {
+    Pool pool;
+    const char* data = nullptr;
+    {
+        Arena arena{pool};
+        const auto memory = arena.Allocate(64);
+        std::memset(memory.data(), 'x', memory.size());
+        data = memory.data();
+    }
+    EXPECT_EQ(pool.GetStatistics().free_pages, 1);
+
+    // the page is kept by the pool, so it is still mapped and must have been wiped
+    EXPECT_TRUE(IsZero({data, 64}));
+
+    Arena arena{pool};
+    EXPECT_EQ(arena.Allocate(64).data(), data);
+    EXPECT_EQ(pool.GetStatistics().pages, 1);
+}
+
+TEST(SecureArenaTest, GrowsAndHandlesLargeAllocations) {
+    Pool pool{{4096, 2}};
+    const auto capacity = pool.GetPageCapacity();
+    {
+        Arena arena{pool};
+        const auto small = arena.Allocate(16);
+        const auto large = arena.Allocate(capacity * 3);
+        EXPECT_EQ(large.size(), capacity * 3);
+        std::memset(large.data(), 'x', large.size());
+
+        // the large allocation got its own mapping, the current page is still filled
+        EXPECT_EQ(arena.Allocate(16).data(), small.data() + 16);
+
+        for (int i = 0; i < 4; ++i) {
+            arena.Allocate(capacity);
+        }
+    }
+
+    const auto statistics = pool.GetStatistics();
+    EXPECT_EQ(statistics.pages, 2);
+    EXPECT_EQ(statistics.free_pages, 2);
+    // the large allocation and the pages above max_pages
+    EXPECT_EQ(statistics.unpooled, 4);
+}
+
+TEST(SecureArenaTest, ConcurrentArenas) {
+    Pool pool{{4096, 8}};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&pool, t] {
+            for (int i = 0; i < 1000; ++i) {
+                Arena arena{pool};
+                const auto memory = arena.Allocate(100 + i % 3000);
+                std::memset(memory.data(), 'a' + t, memory.size());
+                ASSERT_TRUE(std::all_of(memory.begin(), memory.end(), [t](char c) { return c == 'a' + t; }));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_LE(pool.GetStatistics().pages, 8);
+    EXPECT_EQ(pool.GetStatistics().free_pages, pool.GetStatistics().pages);
+}
+
+TEST(SecureWipeTest, WipesWholeStringBuffer) {
+    std::string value(100, 'x');
+    value = "short";
+    const auto* data = value.data();
+    const auto capacity = value.capacity();
+
+    Wipe(value);
+    EXPECT_TRUE(value.empty());
+    EXPECT_TRUE(IsZero({data, capacity}));
+}
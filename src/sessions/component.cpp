@@ -0,0 +1,144 @@
+#include "component.hpp"
+#include "db/sql.hpp"
+
+#include <userver/components/component.hpp>
+#include <userver/components/statistics_storage.hpp>
+#include <userver/engine/task/cancel.hpp>
+#include <userver/logging/log.hpp>
+#include <userver/storages/postgres/cluster.hpp>
+#include <userver/storages/postgres/component.hpp>
+#include <userver/utils/statistics/writer.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+#include <stdexcept>
+
+namespace {
+
+sessions::Settings ParseSettings(const userver::yaml_config::YamlConfig& config) {
+    sessions::Settings settings;
+    const auto mode = config["mode"].As<std::string>("jwt");
+    if (mode != "jwt" && mode != "opaque") {
+        throw std::runtime_error("Unknown session mode: " + mode);
+    }
+    settings.opaque = mode == "opaque";
+    settings.ttl = config["ttl"].As<std::chrono::milliseconds>(settings.ttl);
+    settings.max_sessions = config["max_sessions"].As<std::size_t>(settings.max_sessions);
+    settings.invalid_ttl = config["invalid_ttl"].As<std::chrono::milliseconds>(settings.invalid_ttl);
+    settings.max_invalid = config["max_invalid"].As<std::size_t>(settings.max_invalid);
+    return settings;
+}
+
+}  // namespace
+
+namespace sessions {
+
+Component::Component(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& context
+)
+    : userver::components::LoggableComponentBase(config, context),
+      pg_cluster_{context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()},
+      cleanup_batch_size_{config["cleanup_batch_size"].As<std::int64_t>(1000)},
+      store_{ParseSettings(config)} {
+    auto& storage = context.FindComponent<userver::components::StatisticsStorage>().GetStorage();
+    statistics_holder_ = storage.RegisterWriter("vaulty.sessions", [this](userver::utils::statistics::Writer& writer) {
+        const auto& statistics = store_.GetStatistics();
+        writer["size"] = store_.GetSize();
+        writer["hits"] = statistics.hits.load();
+        writer["misses"] = statistics.misses.load();
+        writer["expired"] = statistics.expired.load();
+        writer["evicted"] = statistics.evicted.load();
+        writer["revoked"] = statistics.revoked.load();
+        writer["rejected"] = statistics.rejected.load();
+        writer["deleted"] = deleted_.load();
+    });
+
+    cleanup_task_.Start(
+        "session-cleanup",
+        {config["cleanup_interval"].As<std::chrono::milliseconds>(std::chrono::minutes{1})},
+        [this] { Cleanup(); }
+    );
+}
+
+Component::~Component() {
+    cleanup_task_.Stop();
+    statistics_holder_.Unregister();
+}
+
+Store& Component::GetStore() { return store_; }
+
+void Component::Cleanup() {
+    store_.RemoveExpired(std::chrono::system_clock::now());
+
+    std::int64_t deleted = 0;
+    try {
+        // a full batch means there may be more, the rest waits for the next pass after a short one
+        for (std::int64_t batch = cleanup_batch_size_; batch == cleanup_batch_size_;) {
+            if (userver::engine::current_task::ShouldCancel()) {
+                break;
+            }
+            batch = pg_cluster_
+                        ->Execute(
+                            userver::storages::postgres::ClusterHostType::kMaster,
+                            db::sql::kDeleteExpiredSessions,
+                            cleanup_batch_size_
+                        )
+                        .AsSingleRow<std::int64_t>();
+            deleted += batch;
+            deleted_ += batch;
+        }
+    } catch (const std::exception& ex) {
+        LOG_WARNING() << "Failed to delete expired sessions: " << ex.what();
+        return;
+    }
+
+    if (deleted != 0) {
+        LOG_INFO() << "Deleted " << deleted << " expired sessions";
+    }
+}
+
+userver::yaml_config::Schema Component::GetStaticConfigSchema() {
+    constexpr auto schema = R"(
+        type: object
+        description: opaque session tokens
+        additionalProperties: false
+        properties:
+            mode:
+                type: string
+                description: tokens issued by login, `jwt` or `opaque`
+                defaultDescription: jwt
+                enum:
+                  - jwt
+                  - opaque
+            ttl:
+                type: string
+                description: lifetime of an opaque session
+                defaultDescription: 15d
+            max_sessions:
+                type: integer
+                description: opaque sessions kept in memory, the rest are read from Postgres on use
+                defaultDescription: 1000000
+                minimum: 1
+            invalid_ttl:
+                type: string
+                description: how long unknown and revoked tokens are rejected from memory, covers the replica lag
+                defaultDescription: 1s
+            max_invalid:
+                type: integer
+                description: unknown and revoked tokens kept in memory
+                defaultDescription: 100000
+                minimum: 1
+            cleanup_interval:
+                type: string
+                description: how often expired sessions are removed
+                defaultDescription: 1m
+            cleanup_batch_size:
+                type: integer
+                description: expired sessions deleted by one statement
+                defaultDescription: 1000
+                minimum: 1
+    )";
+    return userver::yaml_config::MergeSchemas<userver::components::LoggableComponentBase>(schema);
+}
+
+}  // namespace sessions
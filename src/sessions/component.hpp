@@ -0,0 +1,50 @@
+#pragma once
+
+#include "store.hpp"
+
+#include <userver/components/loggable_component_base.hpp>
+#include <userver/storages/postgres/postgres_fwd.hpp>
+#include <userver/utils/periodic_task.hpp>
+#include <userver/utils/statistics/entry.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+namespace sessions {
+
+/// @brief Opaque session store of the instance and its upkeep.
+///
+/// Sessions live in the `sessions` table, keyed by the SHA-256 of the token,
+/// and in the Store of every instance that has seen them. A revocation
+/// deletes the row and sends a NOTIFY; each instance keeps a LISTEN
+/// connection and drops the session from its store, so a logout is effective
+/// everywhere at once. Revocations sent while the connection was down are
+/// lost, so the store is cleared whenever it is (re)established. Every
+/// `cleanup_interval` expired sessions are dropped from the store and deleted
+/// from the table.
+class Component final : public userver::components::LoggableComponentBase {
+public:
+    static constexpr std::string_view kName = "component-sessions";
+
+    Component(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
+    ~Component() override;
+
+    Store& GetStore();
+
+    static userver::yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    void Cleanup();
+
+    userver::storages::postgres::ClusterPtr pg_cluster_;
+    const std::int64_t cleanup_batch_size_;
+
+    Store store_;
+    std::atomic<std::uint64_t> deleted_{0};
+    userver::utils::PeriodicTask cleanup_task_;
+    userver::utils::statistics::Entry statistics_holder_;
+};
+
+}  // namespace sessions
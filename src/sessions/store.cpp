@@ -0,0 +1,154 @@
+#include "store.hpp"
+
+#include <algorithm>
+#include <functional>
+
+namespace sessions {
+
+Store::Store(const Settings& settings)
+    : settings_{settings},
+      max_shard_size_{std::max<std::size_t>(settings.max_sessions / kShards, 1)},
+      max_shard_invalid_{std::max<std::size_t>(settings.max_invalid / kShards, 1)} {}
+
+void Store::Insert(const std::string& id, Entry entry) {
+    auto& shard = GetShard(id);
+    const std::lock_guard lock{shard.mutex};
+    shard.invalid.erase(id);
+    MakeRoom(shard, std::chrono::system_clock::now());
+    if (shard.sessions.insert_or_assign(id, std::move(entry)).second) {
+        ++size_;
+    }
+}
+
+std::uint64_t Store::GetGeneration(const std::string& id) {
+    auto& shard = GetShard(id);
+    const std::lock_guard lock{shard.mutex};
+    return shard.generation;
+}
+
+bool Store::InsertLoaded(const std::string& id, Entry entry, std::uint64_t generation) {
+    auto& shard = GetShard(id);
+    const std::lock_guard lock{shard.mutex};
+    if (shard.generation != generation) {
+        return false;
+    }
+    const auto now = std::chrono::system_clock::now();
+    const auto invalid = shard.invalid.find(id);
+    if (invalid != shard.invalid.end()) {
+        if (invalid->second > now) {
+            return false;
+        }
+        shard.invalid.erase(invalid);
+    }
+    MakeRoom(shard, now);
+    if (shard.sessions.insert_or_assign(id, std::move(entry)).second) {
+        ++size_;
+    }
+    return true;
+}
+
+void Store::InsertInvalid(const std::string& id, std::chrono::system_clock::time_point now) {
+    auto& shard = GetShard(id);
+    const std::lock_guard lock{shard.mutex};
+    RememberInvalid(shard, id, now);
+}
+
+bool Store::IsInvalid(const std::string& id, std::chrono::system_clock::time_point now) {
+    auto& shard = GetShard(id);
+    const std::lock_guard lock{shard.mutex};
+    const auto it = shard.invalid.find(id);
+    if (it == shard.invalid.end()) {
+        return false;
+    }
+    if (it->second <= now) {
+        shard.invalid.erase(it);
+        return false;
+    }
+    ++statistics_.rejected;
+    return true;
+}
+
+std::optional<Entry> Store::Find(const std::string& id, std::chrono::system_clock::time_point now) {
+    auto& shard = GetShard(id);
+    const std::lock_guard lock{shard.mutex};
+    const auto it = shard.sessions.find(id);
+    if (it == shard.sessions.end()) {
+        ++statistics_.misses;
+        return std::nullopt;
+    }
+    if (it->second.expires_at <= now) {
+        shard.sessions.erase(it);
+        --size_;
+        ++statistics_.expired;
+        ++statistics_.misses;
+        return std::nullopt;
+    }
+    ++statistics_.hits;
+    return it->second;
+}
+
+void Store::Erase(const std::string& id) {
+    auto& shard = GetShard(id);
+    const std::lock_guard lock{shard.mutex};
+    ++shard.generation;
+    if (shard.sessions.erase(id) != 0) {
+        --size_;
+    }
+    RememberInvalid(shard, id, std::chrono::system_clock::now());
+    ++statistics_.revoked;
+}
+
+void Store::Clear() {
+    for (auto& shard : shards_) {
+        const std::lock_guard lock{shard.mutex};
+        ++shard.generation;
+        size_ -= shard.sessions.size();
+        shard.sessions.clear();
+    }
+}
+
+std::size_t Store::RemoveExpired(std::chrono::system_clock::time_point now) {
+    std::size_t removed = 0;
+    for (auto& shard : shards_) {
+        const std::lock_guard lock{shard.mutex};
+        removed += std::erase_if(shard.sessions, [now](const auto& item) { return item.second.expires_at <= now; });
+        std::erase_if(shard.invalid, [now](const auto& item) { return item.second <= now; });
+    }
+    size_ -= removed;
+    statistics_.expired += removed;
+    return removed;
+}
+
+Store::Shard& Store::GetShard(const std::string& id) { return shards_[std::hash<std::string>{}(id) % kShards]; }
+
+void Store::MakeRoom(Shard& shard, std::chrono::system_clock::time_point now) {
+    if (shard.sessions.size() < max_shard_size_) {
+        return;
+    }
+    const auto expired =
+        std::erase_if(shard.sessions, [now](const auto& item) { return item.second.expires_at <= now; });
+    size_ -= expired;
+    statistics_.expired += expired;
+    if (shard.sessions.size() < max_shard_size_) {
+        return;
+    }
+    // any session will do, it is still in Postgres
+    shard.sessions.erase(shard.sessions.begin());
+    --size_;
+    ++statistics_.evicted;
+}
+
+void Store::RememberInvalid(Shard& shard, const std::string& id, std::chrono::system_clock::time_point now) {
+    if (settings_.invalid_ttl <= std::chrono::milliseconds::zero()) {
+        return;
+    }
+    if (shard.invalid.size() >= max_shard_invalid_ && !shard.invalid.contains(id)) {
+        std::erase_if(shard.invalid, [now](const auto& item) { return item.second <= now; });
+        if (shard.invalid.size() >= max_shard_invalid_) {
+            shard.invalid.erase(shard.invalid.begin());
+        }
+    }
+    shard.invalid.insert_or_assign(id, now + settings_.invalid_ttl);
+}
+
+}  // namespace sessions
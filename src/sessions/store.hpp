@@ -0,0 +1,140 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace sessions {
+
+/// Session settings.
+struct Settings {
+    /// Login issues opaque tokens instead of JWTs. Opaque tokens issued before are accepted either way.
+    bool opaque{false};
+
+    /// Lifetime of an opaque session.
+    std::chrono::milliseconds ttl{std::chrono::hours{24 * 15}};
+
+    /// Sessions kept in memory, the rest are loaded from Postgres on use.
+    std::size_t max_sessions{1'000'000};
+
+    /// How long IDs that were not found, or were revoked, are answered from memory. Covers the replication lag of
+    /// the replicas sessions are loaded from.
+    std::chrono::milliseconds invalid_ttl{std::chrono::seconds{1}};
+
+    /// Invalid IDs kept in memory.
+    std::size_t max_invalid{100'000};
+};
+
+/// Server-side state of an opaque session.
+struct Entry {
+    std::int32_t user_id{0};
+
+    /// Data key encrypted with the server keyring.
+    std::string data_key_encrypted;
+
+    std::chrono::system_clock::time_point expires_at;
+};
+
+/// Counters of a store.
+struct Statistics {
+    std::atomic<std::uint64_t> hits{0};
+    std::atomic<std::uint64_t> misses{0};
+    std::atomic<std::uint64_t> expired{0};
+    std::atomic<std::uint64_t> evicted{0};
+    std::atomic<std::uint64_t> revoked{0};
+
+    /// Lookups answered by a remembered invalid ID.
+    std::atomic<std::uint64_t> rejected{0};
+};
+
+/// @brief In-memory sessions by ID, the hash of the token.
+///
+/// A cache in front of the `sessions` table: a lookup is one hash map probe
+/// under the lock of one of the shards. Expired sessions are dropped when
+/// found and by RemoveExpired(). A shard over its share of `max_sessions`
+/// evicts expired and then arbitrary sessions, which are loaded again from
+/// Postgres on their next use.
+///
+/// A session loaded from Postgres may be revoked while the load is in
+/// flight. Loads take a generation of the shard first and InsertLoaded()
+/// drops the session if the shard saw a revocation since.
+///
+/// IDs that were not found, and revoked ones, are remembered for
+/// `invalid_ttl`, so repeated unknown tokens do not reach Postgres and a
+/// replica that has not applied a revocation yet can not bring the session
+/// back. Thread-safe.
+class Store final {
+public:
+    explicit Store(const Settings& settings);
+
+    /// @brief Adds a new session.
+    void Insert(const std::string& id, Entry entry);
+
+    /// @brief Returns the counter InsertLoaded() compares against, to be taken before the session is loaded.
+    std::uint64_t GetGeneration(const std::string& id);
+
+    /// @brief Adds a session loaded from Postgres unless a session of the shard was revoked since `generation`, or
+    /// the session itself was revoked within `invalid_ttl`.
+    /// @return false if the session was dropped.
+    bool InsertLoaded(const std::string& id, Entry entry, std::uint64_t generation);
+
+    /// @brief Remembers an ID that was not found in Postgres.
+    void InsertInvalid(const std::string& id, std::chrono::system_clock::time_point now);
+
+    /// @brief Returns whether the ID was not found or revoked within `invalid_ttl` before `now`.
+    bool IsInvalid(const std::string& id, std::chrono::system_clock::time_point now);
+
+    /// @brief Returns the session if it is known and not expired at `now`.
+    std::optional<Entry> Find(const std::string& id, std::chrono::system_clock::time_point now);
+
+    /// @brief Forgets a revoked session and remembers its ID as invalid.
+    void Erase(const std::string& id);
+
+    /// @brief Forgets every session, for when revocations may have been missed. Invalid IDs are kept.
+    void Clear();
+
+    /// @brief Drops the sessions expired at `now`.
+    /// @return The number of dropped sessions.
+    std::size_t RemoveExpired(std::chrono::system_clock::time_point now);
+
+    std::size_t GetSize() const noexcept { return size_.load(); }
+
+    const Settings& GetSettings() const noexcept { return settings_; }
+
+    const Statistics& GetStatistics() const noexcept { return statistics_; }
+
+private:
+    static constexpr std::size_t kShards = 64;
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, Entry> sessions;
+
+        /// Invalid IDs and until when they are remembered.
+        std::unordered_map<std::string, std::chrono::system_clock::time_point> invalid;
+        std::uint64_t generation{0};
+    };
+
+    Shard& GetShard(const std::string& id);
+
+    /// Makes room for one more session, the shard must be locked.
+    void MakeRoom(Shard& shard, std::chrono::system_clock::time_point now);
+
+    /// Remembers an invalid ID, the shard must be locked.
+    void RememberInvalid(Shard& shard, const std::string& id, std::chrono::system_clock::time_point now);
+
+    const Settings settings_;
+    const std::size_t max_shard_size_;
+    const std::size_t max_shard_invalid_;
+    std::array<Shard, kShards> shards_;
+    std::atomic<std::size_t> size_{0};
+    Statistics statistics_;
+};
+
+}  // namespace sessions
@@ -0,0 +1,127 @@
+#include "store.hpp"
+
+#include <userver/utest/utest.hpp>
+
+#include <string>
+
+using namespace sessions;
+
+namespace {
+
+const auto kNow = std::chrono::system_clock::time_point{std::chrono::seconds{1'700'000'000}};
+
+Entry MakeEntry(std::int32_t user_id, std::chrono::system_clock::time_point expires_at) {
+    return {user_id, "key-" + std::to_string(user_id), expires_at};
+}
+
+}  // namespace
+
+TEST(SessionStoreTest, FindsUntilExpired) {
+    Store store{{}};
+    store.Insert("a", MakeEntry(1, kNow + std::chrono::minutes{1}));
+
+    const auto found = store.Find("a", kNow);
+    ASSERT_TRUE(found);
+    EXPECT_EQ(found->user_id, 1);
+    EXPECT_EQ(found->data_key_encrypted, "key-1");
+    EXPECT_FALSE(store.Find("b", kNow));
+
+    EXPECT_FALSE(store.Find("a", kNow + std::chrono::minutes{1}));
+    EXPECT_EQ(store.GetSize(), 0);
+    EXPECT_EQ(store.GetStatistics().hits, 1);
+    EXPECT_EQ(store.GetStatistics().misses, 2);
+    EXPECT_EQ(store.GetStatistics().expired, 1);
+}
+
+TEST(SessionStoreTest, EraseAndClear) {
+    Store store{{}};
+    for (int i = 0; i < 100; ++i) {
+        store.Insert(std::to_string(i), MakeEntry(i, kNow + std::chrono::minutes{1}));
+    }
+    EXPECT_EQ(store.GetSize(), 100);
+
+    store.Erase("7");
+    EXPECT_FALSE(store.Find("7", kNow));
+    EXPECT_TRUE(store.Find("8", kNow));
+    EXPECT_EQ(store.GetSize(), 99);
+
+    store.Clear();
+    EXPECT_EQ(store.GetSize(), 0);
+    EXPECT_FALSE(store.Find("8", kNow));
+}
+
+TEST(SessionStoreTest, LoadRacingRevocation) {
+    Settings settings;
+    settings.invalid_ttl = std::chrono::milliseconds::zero();
+    Store store{settings};
+    const auto generation = store.GetGeneration("a");
+    store.Erase("a");
+    EXPECT_FALSE(store.InsertLoaded("a", MakeEntry(1, kNow + std::chrono::minutes{1}), generation));
+    EXPECT_FALSE(store.Find("a", kNow));
+
+    EXPECT_TRUE(store.InsertLoaded("a", MakeEntry(1, kNow + std::chrono::minutes{1}), store.GetGeneration("a")));
+    EXPECT_TRUE(store.Find("a", kNow));
+}
+
+TEST(SessionStoreTest, RemembersInvalidIds) {
+    Store store{{}};
+    const auto now = std::chrono::system_clock::now();
+
+    store.InsertInvalid("unknown", now);
+    EXPECT_TRUE(store.IsInvalid("unknown", now));
+    EXPECT_FALSE(store.IsInvalid("other", now));
+    EXPECT_FALSE(store.IsInvalid("unknown", now + std::chrono::seconds{1}));
+    EXPECT_EQ(store.GetStatistics().rejected, 1);
+
+    // a lagging replica still has the revoked session, loads after the revocation do not bring it back
+    store.Insert("a", MakeEntry(1, now + std::chrono::minutes{1}));
+    store.Erase("a");
+    EXPECT_TRUE(store.IsInvalid("a", now));
+    EXPECT_FALSE(store.InsertLoaded("a", MakeEntry(1, now + std::chrono::minutes{1}), store.GetGeneration("a")));
+    EXPECT_FALSE(store.Find("a", now));
+
+    // survive a clear, the revocations are what it may have missed
+    store.Clear();
+    EXPECT_TRUE(store.IsInvalid("a", now));
+
+    // a new session with the ID is valid at once
+    store.Insert("unknown", MakeEntry(2, now + std::chrono::minutes{1}));
+    EXPECT_FALSE(store.IsInvalid("unknown", now));
+}
+
+TEST(SessionStoreTest, BoundsInvalidIds) {
+    Settings settings;
+    settings.max_invalid = 64;
+    Store store{settings};
+    const auto now = std::chrono::system_clock::now();
+
+    for (int i = 0; i < 1000; ++i) {
+        store.InsertInvalid(std::to_string(i), now);
+    }
+    // one ID per shard at most
+    int remembered = 0;
+    for (int i = 0; i < 1000; ++i) {
+        remembered += store.IsInvalid(std::to_string(i), now);
+    }
+    EXPECT_LE(remembered, 64);
+    EXPECT_GT(remembered, 0);
+}
+
+TEST(SessionStoreTest, RemovesExpiredAndEvicts) {
+    Settings settings;
+    settings.max_sessions = 64;
+    Store store{settings};
+
+    const auto now = std::chrono::system_clock::now();
+    for (int i = 0; i < 1000; ++i) {
+        store.Insert(std::to_string(i), MakeEntry(i, now + std::chrono::minutes{i % 2 == 0 ? -1 : 1}));
+    }
+    // one session per shard at most
+    EXPECT_LE(store.GetSize(), 64);
+    EXPECT_GT(store.GetStatistics().evicted + store.GetStatistics().expired, 0);
+
+    store.RemoveExpired(now);
+    for (int i = 0; i < 1000; i += 2) {
+        EXPECT_FALSE(store.Find(std::to_string(i), now)) << i;
+    }
+}
@@ -0,0 +1,96 @@
+#include "component.hpp"
+#include "db/sql.hpp"
+
+#include <userver/components/component.hpp>
+#include <userver/components/statistics_storage.hpp>
+#include <userver/engine/task/cancel.hpp>
+#include <userver/logging/log.hpp>
+#include <userver/storages/postgres/cluster.hpp>
+#include <userver/storages/postgres/component.hpp>
+#include <userver/utils/statistics/writer.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+namespace tombstones {
+
+Component::Component(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& context
+)
+    : userver::components::LoggableComponentBase(config, context),
+      pg_cluster_{context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()},
+      retention_{config["retention"].As<std::chrono::seconds>(std::chrono::hours{24 * 30})},
+      batch_size_{config["batch_size"].As<std::int64_t>(1000)} {
+    auto& storage = context.FindComponent<userver::components::StatisticsStorage>().GetStorage();
+    statistics_holder_ =
+        storage.RegisterWriter("vaulty.tombstones", [this](userver::utils::statistics::Writer& writer) {
+            writer["compacted"] = statistics_.compacted.load();
+            writer["passes"] = statistics_.passes.load();
+            writer["errors"] = statistics_.errors.load();
+        });
+
+    task_.Start(
+        "tombstone-compaction",
+        {config["compaction_interval"].As<std::chrono::milliseconds>(std::chrono::hours{1})},
+        [this] { Compact(); }
+    );
+}
+
+Component::~Component() {
+    task_.Stop();
+    statistics_holder_.Unregister();
+}
+
+void Component::Compact() {
+    std::int64_t compacted = 0;
+    try {
+        // a full batch means there may be more, the rest waits for the next pass after a short one
+        for (std::int64_t batch = batch_size_; batch == batch_size_;) {
+            if (userver::engine::current_task::ShouldCancel()) {
+                break;
+            }
+            const auto result = pg_cluster_->Execute(
+                userver::storages::postgres::ClusterHostType::kMaster,
+                db::sql::kCompactPasswordTombstones,
+                static_cast<std::int64_t>(retention_.count()),
+                batch_size_
+            );
+            batch = result.AsSingleRow<std::int64_t>();
+            compacted += batch;
+            statistics_.compacted += batch;
+        }
+    } catch (const std::exception& ex) {
+        ++statistics_.errors;
+        LOG_WARNING() << "Failed to compact tombstones: " << ex.what();
+        return;
+    }
+
+    ++statistics_.passes;
+    if (compacted != 0) {
+        LOG_INFO() << "Compacted " << compacted << " tombstones";
+    }
+}
+
+userver::yaml_config::Schema Component::GetStaticConfigSchema() {
+    constexpr auto schema = R"(
+        type: object
+        description: compaction of the tombstones of deleted password entries
+        additionalProperties: false
+        properties:
+            retention:
+                type: string
+                description: how long deletions are reported by delta sync, older cursors get a full sync
+                defaultDescription: 30d
+            compaction_interval:
+                type: string
+                description: how often expired tombstones are removed
+                defaultDescription: 1h
+            batch_size:
+                type: integer
+                description: tombstones removed by one statement
+                defaultDescription: 1000
+                minimum: 1
+    )";
+    return userver::yaml_config::MergeSchemas<userver::components::LoggableComponentBase>(schema);
+}
+
+}  // namespace tombstones
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <userver/components/loggable_component_base.hpp>
+#include <userver/storages/postgres/postgres_fwd.hpp>
+#include <userver/utils/periodic_task.hpp>
+#include <userver/utils/statistics/entry.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace tombstones {
+
+/// Counters of the tombstone compaction.
+struct Statistics {
+    std::atomic<std::uint64_t> compacted{0};
+    std::atomic<std::uint64_t> passes{0};
+    std::atomic<std::uint64_t> errors{0};
+};
+
+/// @brief Removes tombstones of deleted password entries once they are older than `retention`.
+///
+/// Tombstones let delta sync report deletions; a client whose cursor is older
+/// than the newest removed tombstone of its user gets a full sync instead. The
+/// newest removed change version of every user is kept in
+/// `password_sync_horizons`. Expired tombstones are deleted in batches of
+/// `batch_size` every `compaction_interval`, instances skip the rows locked by
+/// each other.
+class Component final : public userver::components::LoggableComponentBase {
+public:
+    static constexpr std::string_view kName = "component-tombstones";
+
+    Component(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
+    ~Component() override;
+
+    static userver::yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    void Compact();
+
+    userver::storages::postgres::ClusterPtr pg_cluster_;
+    const std::chrono::seconds retention_;
+    const std::int64_t batch_size_;
+
+    Statistics statistics_;
+    userver::utils::PeriodicTask task_;
+    userver::utils::statistics::Entry statistics_holder_;
+};
+
+}  // namespace tombstones
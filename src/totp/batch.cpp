@@ -0,0 +1,220 @@
+#include "batch.hpp"
+#include "secure/arena.hpp"
+#include "utils.hpp"
+
+#include <cryptopp/sha.h>
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr std::size_t kLanes = totp::kBatchLanes;
+constexpr std::size_t kBlockBytes = 64;
+constexpr std::size_t kDigestBytes = 20;
+
+/// One 32-bit word of every lane.
+using Lanes = std::array<std::uint32_t, kLanes>;
+
+/// SHA-1 chaining values of every lane.
+using State = std::array<Lanes, 5>;
+
+/// One message block of every lane, as big-endian words.
+using Block = std::array<Lanes, 16>;
+
+constexpr std::array<std::uint32_t, 5> kInitialState = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+constexpr std::array<std::uint32_t, 3> kPowersOf10 = {1000000, 10000000, 100000000};
+
+constexpr std::uint32_t Rotl(std::uint32_t value, int bits) { return (value << bits) | (value >> (32 - bits)); }
+
+State InitialState() {
+    State state;
+    for (std::size_t i = 0; i < state.size(); ++i) {
+        state[i].fill(kInitialState[i]);
+    }
+    return state;
+}
+
+/// Runs SHA-1 rounds [from, to) with the round function `f` on all lanes.
+template <typename F>
+void Rounds(
+    std::size_t from,
+    std::size_t to,
+    std::uint32_t k,
+    F f,
+    const std::array<Lanes, 80>& w,
+    Lanes& a,
+    Lanes& b,
+    Lanes& c,
+    Lanes& d,
+    Lanes& e
+) {
+    for (std::size_t t = from; t < to; ++t) {
+        for (std::size_t lane = 0; lane < kLanes; ++lane) {
+            const auto temp = Rotl(a[lane], 5) + f(b[lane], c[lane], d[lane]) + e[lane] + k + w[t][lane];
+            e[lane] = d[lane];
+            d[lane] = c[lane];
+            c[lane] = Rotl(b[lane], 30);
+            b[lane] = a[lane];
+            a[lane] = temp;
+        }
+    }
+}
+
+/// SHA-1 compression of one block per lane. The lane loops have no dependencies between lanes.
+void Compress(State& state, const Block& block) {
+    std::array<Lanes, 80> w;
+    for (std::size_t t = 0; t < 16; ++t) {
+        w[t] = block[t];
+    }
+    for (std::size_t t = 16; t < 80; ++t) {
+        for (std::size_t lane = 0; lane < kLanes; ++lane) {
+            w[t][lane] = Rotl(w[t - 3][lane] ^ w[t - 8][lane] ^ w[t - 14][lane] ^ w[t - 16][lane], 1);
+        }
+    }
+
+    auto a = state[0];
+    auto b = state[1];
+    auto c = state[2];
+    auto d = state[3];
+    auto e = state[4];
+    const auto choose = [](std::uint32_t x, std::uint32_t y, std::uint32_t z) { return (x & y) | (~x & z); };
+    const auto parity = [](std::uint32_t x, std::uint32_t y, std::uint32_t z) { return x ^ y ^ z; };
+    const auto majority = [](std::uint32_t x, std::uint32_t y, std::uint32_t z) {
+        return (x & y) | (x & z) | (y & z);
+    };
+    Rounds(0, 20, 0x5A827999, choose, w, a, b, c, d, e);
+    Rounds(20, 40, 0x6ED9EBA1, parity, w, a, b, c, d, e);
+    Rounds(40, 60, 0x8F1BBCDC, majority, w, a, b, c, d, e);
+    Rounds(60, 80, 0xCA62C1D6, parity, w, a, b, c, d, e);
+
+    for (std::size_t lane = 0; lane < kLanes; ++lane) {
+        state[0][lane] += a[lane];
+        state[1][lane] += b[lane];
+        state[2][lane] += c[lane];
+        state[3][lane] += d[lane];
+        state[4][lane] += e[lane];
+    }
+}
+
+/// Block of the lane keys XORed with an HMAC pad byte.
+Block KeyBlock(const std::array<std::array<std::uint8_t, kBlockBytes>, kLanes>& keys, std::uint8_t pad) {
+    Block block;
+    for (std::size_t word = 0; word < 16; ++word) {
+        for (std::size_t lane = 0; lane < kLanes; ++lane) {
+            const auto* bytes = keys[lane].data() + 4 * word;
+            block[word][lane] = (static_cast<std::uint32_t>(bytes[0] ^ pad) << 24) |
+                                (static_cast<std::uint32_t>(bytes[1] ^ pad) << 16) |
+                                (static_cast<std::uint32_t>(bytes[2] ^ pad) << 8) | (bytes[3] ^ pad);
+        }
+    }
+    return block;
+}
+
+/// HMAC keys of up to a block are zero-padded, longer ones are hashed first.
+void LoadKey(std::string_view key, std::array<std::uint8_t, kBlockBytes>& output) {
+    output.fill(0);
+    if (key.size() > kBlockBytes) {
+        CryptoPP::SHA1{}.CalculateDigest(
+            output.data(), reinterpret_cast<const CryptoPP::byte*>(key.data()), key.size()
+        );
+        return;
+    }
+    std::copy(key.begin(), key.end(), output.begin());
+}
+
+/// HMAC-SHA1 of the same 8-byte message under the key of every lane.
+State HmacLanes(const std::array<std::array<std::uint8_t, kBlockBytes>, kLanes>& keys, std::uint64_t message) {
+    // inner hash: (key ^ ipad) || message, padded to one block of (64 + 8) * 8 bits
+    auto inner = InitialState();
+    auto block = KeyBlock(keys, 0x36);
+    Compress(inner, block);
+    block = {};
+    for (std::size_t lane = 0; lane < kLanes; ++lane) {
+        block[0][lane] = static_cast<std::uint32_t>(message >> 32);
+        block[1][lane] = static_cast<std::uint32_t>(message);
+        block[2][lane] = 0x80000000;
+        block[15][lane] = (kBlockBytes + 8) * 8;
+    }
+    Compress(inner, block);
+
+    // outer hash: (key ^ opad) || inner digest, padded to one block of (64 + 20) * 8 bits
+    auto outer = InitialState();
+    block = KeyBlock(keys, 0x5C);
+    Compress(outer, block);
+    block = {};
+    for (std::size_t lane = 0; lane < kLanes; ++lane) {
+        for (std::size_t word = 0; word < 5; ++word) {
+            block[word][lane] = inner[word][lane];
+        }
+        block[5][lane] = 0x80000000;
+        block[15][lane] = (kBlockBytes + kDigestBytes) * 8;
+    }
+    Compress(outer, block);
+
+    // the inner state after the first block is as good as the key
+    secure::Wipe({reinterpret_cast<char*>(inner.data()), sizeof(inner)});
+    secure::Wipe({reinterpret_cast<char*>(block.data()), sizeof(block)});
+    return outer;
+}
+
+/// Dynamic truncation of RFC 4226 over the digest of a lane.
+std::uint32_t Truncate(const State& digest, std::size_t lane) {
+    std::array<std::uint8_t, kDigestBytes> bytes;
+    for (std::size_t word = 0; word < 5; ++word) {
+        const auto value = digest[word][lane];
+        bytes[4 * word] = static_cast<std::uint8_t>(value >> 24);
+        bytes[4 * word + 1] = static_cast<std::uint8_t>(value >> 16);
+        bytes[4 * word + 2] = static_cast<std::uint8_t>(value >> 8);
+        bytes[4 * word + 3] = static_cast<std::uint8_t>(value);
+    }
+    const auto offset = bytes.back() & 0x0F;
+    const std::uint32_t high = (static_cast<std::uint32_t>(bytes[offset] & 0x7F) << 24) |
+                               (static_cast<std::uint32_t>(bytes[offset + 1]) << 16);
+    return high | (static_cast<std::uint32_t>(bytes[offset + 2]) << 8) | bytes[offset + 3];
+}
+
+}  // namespace
+
+namespace totp {
+
+std::vector<std::uint32_t> GenerateTotpCodes(
+    std::span<const std::string_view> secrets,
+    std::uint32_t period,
+    std::size_t digits,
+    std::time_t timestamp
+) {
+    if (digits < 6 || digits > 8) {
+        throw std::invalid_argument("TOTP code must have between 6 and 8 digits");
+    }
+    const std::uint64_t counter = timestamp / period;
+
+    std::vector<std::uint32_t> codes;
+    codes.reserve(secrets.size());
+    std::array<std::array<std::uint8_t, kBlockBytes>, kLanes> keys;
+    for (std::size_t first = 0; first < secrets.size(); first += kLanes) {
+        const auto count = std::min(kLanes, secrets.size() - first);
+        for (std::size_t lane = 0; lane < kLanes; ++lane) {
+            if (lane >= count) {
+                // idle lanes of the last batch hash an empty key, their codes are dropped
+                keys[lane].fill(0);
+                continue;
+            }
+            auto key = DecodeTotpSecret(secrets[first + lane]);
+            LoadKey(key, keys[lane]);
+            secure::Wipe(key);
+        }
+
+        const auto digests = HmacLanes(keys, counter);
+        for (std::size_t lane = 0; lane < count; ++lane) {
+            codes.push_back(Truncate(digests, lane) % kPowersOf10[digits - 6]);
+        }
+    }
+    secure::Wipe({reinterpret_cast<char*>(keys.data()), sizeof(keys)});
+    return codes;
+}
+
+}  // namespace totp
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace totp {
+
+/// Number of HMAC-SHA1 computations GenerateTotpCodes() runs side by side.
+inline constexpr std::size_t kBatchLanes = 8;
+
+/// @brief Computes the TOTP codes of many secrets for the same moment.
+///
+/// Gives the same codes as GenerateTotpCode() for each secret. The secrets are
+/// decoded once, and the HMAC-SHA1s are computed kBatchLanes at a time, with the
+/// SHA-1 state and message words of the lanes interleaved. Every lane then
+/// runs the same instructions on adjacent words, which the compiler turns into
+/// vector instructions of the target. TOTP messages are a fixed 8-byte
+/// counter, so every HMAC takes exactly four compressions and lanes never
+/// diverge.
+///
+/// @param secrets Base32 secrets.
+/// @return The codes, in the order of the secrets.
+/// @throws std::invalid_argument On a malformed secret or digits out of 6-8.
+std::vector<std::uint32_t> GenerateTotpCodes(
+    std::span<const std::string_view> secrets,
+    std::uint32_t period = 30,
+    std::size_t digits = 6,
+    std::time_t timestamp = std::time(nullptr)
+);
+
+}  // namespace totp
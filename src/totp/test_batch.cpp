@@ -0,0 +1,48 @@
+#include "batch.hpp"
+#include "utils.hpp"
+
+#include <userver/utest/utest.hpp>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+constexpr std::time_t kFixedTime = 1672531200;  // 2023-01-01 00:00:00 UTC
+
+}  // namespace
+
+TEST(TotpBatchTest, MatchesRfc6238) {
+    // the SHA-1 test key of RFC 6238, "12345678901234567890"
+    const std::vector<std::string_view> secrets = {"GEZDGNBVGY3TQOJQGEZDGNBVGY3TQOJQ"};
+    EXPECT_EQ(totp::GenerateTotpCodes(secrets, 30, 8, 59), std::vector<std::uint32_t>{94287082});
+    EXPECT_EQ(totp::GenerateTotpCodes(secrets, 30, 8, 1111111109), std::vector<std::uint32_t>{7081804});
+    EXPECT_EQ(totp::GenerateTotpCodes(secrets, 30, 8, 20000000000), std::vector<std::uint32_t>{65353130});
+}
+
+TEST(TotpBatchTest, MatchesSingleCodes) {
+    // partial batches, a batch of its own and keys longer than a block
+    for (const std::size_t count : {0, 1, 7, 8, 9, 20}) {
+        std::vector<std::string> secrets;
+        for (std::size_t i = 0; i < count; ++i) {
+            secrets.push_back(totp::GenerateTotpSecret(i % 3 == 0 ? 80 : 10 + i));
+        }
+        const std::vector<std::string_view> views(secrets.begin(), secrets.end());
+
+        const auto codes = totp::GenerateTotpCodes(views, 30, 6, kFixedTime);
+        ASSERT_EQ(codes.size(), count);
+        for (std::size_t i = 0; i < count; ++i) {
+            EXPECT_EQ(codes[i], totp::GenerateTotpCode(secrets[i], 30, 6, kFixedTime)) << count << " " << i;
+        }
+    }
+}
+
+TEST(TotpBatchTest, RejectsInvalidInput) {
+    const std::vector<std::string_view> valid = {"GEZDGNBVGY3TQOJQ"};
+    EXPECT_THROW(totp::GenerateTotpCodes(valid, 30, 5), std::invalid_argument);
+    EXPECT_THROW(totp::GenerateTotpCodes(valid, 30, 9), std::invalid_argument);
+
+    const std::vector<std::string_view> invalid = {"GEZDGNBVGY3TQOJQ", "not base32!"};
+    EXPECT_THROW(totp::GenerateTotpCodes(invalid), std::invalid_argument);
+}
@@ -31,7 +31,7 @@ std::string Base32Encode(const std::string& input) {
     return output;
 }
 
-std::string Base32Decode(const std::string& input) {
+std::string Base32Decode(std::string_view input) {
     static const std::string base32_chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
     static const std::vector<int> base32_lookup = [] {
         std::vector<int> lookup(256, -1);
@@ -129,6 +129,8 @@ uint32_t GenerateTotpCode(const std::string& secret, uint32_t period, size_t dig
     return dbc % kPowersOf10[digits - 6];
 }
 
+std::string DecodeTotpSecret(std::string_view secret) { return Base32Decode(secret); }
+
 bool VerifyTotpCode(
     const std::string& secret,
     uint32_t totp_code,
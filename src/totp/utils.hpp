@@ -2,6 +2,7 @@
 
 #include <ctime>
 #include <string>
+#include <string_view>
 
 namespace totp {
 
@@ -31,6 +32,10 @@ uint32_t GenerateTotpCode(
     std::time_t timestamp = std::time(nullptr)
 );
 
+/// @brief Decodes a Base32 TOTP secret into the raw HMAC key.
+/// @throws std::invalid_argument On a character outside the Base32 alphabet.
+std::string DecodeTotpSecret(std::string_view secret);
+
 /// @brief Verifies the correctness of a given TOTP code.
 ///
 /// This function checks if the provided TOTP code matches the expected value
@@ -0,0 +1,84 @@
+#include "component.hpp"
+#include "db/sql.hpp"
+
+#include <userver/components/component.hpp>
+#include <userver/components/statistics_storage.hpp>
+#include <userver/logging/log.hpp>
+#include <userver/storages/postgres/cluster.hpp>
+#include <userver/storages/postgres/component.hpp>
+#include <userver/utils/statistics/writer.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+namespace usage {
+
+Component::Component(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& context
+)
+    : userver::components::LoggableComponentBase(config, context),
+      pg_cluster_{context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()} {
+    auto& storage = context.FindComponent<userver::components::StatisticsStorage>().GetStorage();
+    statistics_holder_ =
+        storage.RegisterWriter("vaulty.usage", [this](userver::utils::statistics::Writer& writer) {
+            writer["flushed"] = statistics_.flushed.load();
+            writer["batches"] = statistics_.batches.load();
+            writer["errors"] = statistics_.errors.load();
+            writer["pending"] = counters_.GetSize();
+        });
+
+    task_.Start(
+        "usage-flush",
+        {config["flush_interval"].As<std::chrono::milliseconds>(std::chrono::seconds{10})},
+        [this] { Flush(); }
+    );
+}
+
+Component::~Component() {
+    task_.Stop();
+    Flush();
+    statistics_holder_.Unregister();
+}
+
+Counters& Component::GetCounters() { return counters_; }
+
+void Component::Flush() {
+    const auto batch = counters_.Drain();
+    if (batch.Size() == 0) {
+        return;
+    }
+
+    try {
+        pg_cluster_->Execute(
+            userver::storages::postgres::ClusterHostType::kMaster,
+            db::sql::kUpdatePasswordUsage,
+            batch.password_ids,
+            batch.counts,
+            batch.last_used
+        );
+    } catch (const std::exception& ex) {
+        ++statistics_.errors;
+        LOG_WARNING() << "Failed to flush uses of " << batch.Size() << " password entries: " << ex.what();
+        counters_.Restore(batch);
+        return;
+    }
+
+    statistics_.flushed += batch.Size();
+    ++statistics_.batches;
+    LOG_DEBUG() << "Flushed uses of " << batch.Size() << " password entries";
+}
+
+userver::yaml_config::Schema Component::GetStaticConfigSchema() {
+    constexpr auto schema = R"(
+        type: object
+        description: in-memory use counters of password entries, flushed to the database in batches
+        additionalProperties: false
+        properties:
+            flush_interval:
+                type: string
+                description: how often the counters are written, ordering by frecency lags behind reads by this much
+                defaultDescription: 10s
+    )";
+    return userver::yaml_config::MergeSchemas<userver::components::LoggableComponentBase>(schema);
+}
+
+}  // namespace usage
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "counters.hpp"
+
+#include <userver/components/loggable_component_base.hpp>
+#include <userver/storages/postgres/postgres_fwd.hpp>
+#include <userver/utils/periodic_task.hpp>
+#include <userver/utils/statistics/entry.hpp>
+
+#include <atomic>
+#include <cstdint>
+
+namespace usage {
+
+/// Counters of the usage flusher.
+struct Statistics {
+    std::atomic<std::uint64_t> flushed{0};
+    std::atomic<std::uint64_t> batches{0};
+    std::atomic<std::uint64_t> errors{0};
+};
+
+/// @brief Tracks how often password entries are read, for frecency ordering.
+///
+/// Reads are counted in memory by usage::Counters and every `flush_interval`
+/// added to `passwords.use_count` and `passwords.last_used_at` with a single
+/// multi-row update, so a read never writes to the database by itself. A
+/// failed flush keeps the counters for the next one; the remaining uses are
+/// flushed once more on shutdown.
+class Component final : public userver::components::LoggableComponentBase {
+public:
+    static constexpr std::string_view kName = "component-usage";
+
+    Component(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
+    ~Component() override;
+
+    Counters& GetCounters();
+
+    static userver::yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    void Flush();
+
+    userver::storages::postgres::ClusterPtr pg_cluster_;
+
+    Counters counters_;
+    Statistics statistics_;
+    userver::utils::PeriodicTask task_;
+    userver::utils::statistics::Entry statistics_holder_;
+};
+
+}  // namespace usage
@@ -0,0 +1,63 @@
+#include "counters.hpp"
+
+#include <mutex>
+
+namespace usage {
+
+void Counters::Add(std::int64_t password_id, Clock::time_point time, std::uint32_t count) {
+    auto& shard = shards_[static_cast<std::uint64_t>(password_id) % kShardCount];
+    const auto time_us = std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+
+    {
+        const std::shared_lock lock{shard.mutex};
+        if (const auto it = shard.entries.find(password_id); it != shard.entries.end()) {
+            Update(it->second, time_us, count);
+            return;
+        }
+    }
+
+    const std::unique_lock lock{shard.mutex};
+    Update(shard.entries[password_id], time_us, count);
+}
+
+Batch Counters::Drain() {
+    Batch batch;
+    for (auto& shard : shards_) {
+        // the exclusive lock orders the relaxed updates of the entries before the reads below
+        const std::unique_lock lock{shard.mutex};
+        for (const auto& [password_id, entry] : shard.entries) {
+            batch.password_ids.push_back(password_id);
+            batch.counts.push_back(static_cast<std::int64_t>(entry.count.load(std::memory_order_relaxed)));
+            batch.last_used.push_back(entry.last_used.load(std::memory_order_relaxed));
+        }
+        shard.entries.clear();
+    }
+    return batch;
+}
+
+void Counters::Restore(const Batch& batch) {
+    for (std::size_t i = 0; i < batch.Size(); ++i) {
+        Add(batch.password_ids[i],
+            Clock::time_point{std::chrono::microseconds{batch.last_used[i]}},
+            static_cast<std::uint32_t>(batch.counts[i]));
+    }
+}
+
+std::size_t Counters::GetSize() const {
+    std::size_t size = 0;
+    for (const auto& shard : shards_) {
+        const std::shared_lock lock{shard.mutex};
+        size += shard.entries.size();
+    }
+    return size;
+}
+
+void Counters::Update(Entry& entry, std::int64_t time, std::uint32_t count) {
+    entry.count.fetch_add(count, std::memory_order_relaxed);
+
+    auto last_used = entry.last_used.load(std::memory_order_relaxed);
+    while (last_used < time && !entry.last_used.compare_exchange_weak(last_used, time, std::memory_order_relaxed)) {
+    }
+}
+
+}  // namespace usage
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace usage {
+
+/// Uses accumulated since the last drain, as column arrays for a single multi-row update.
+struct Batch {
+    std::vector<std::int64_t> password_ids;
+    std::vector<std::int64_t> counts;
+
+    /// Time of the latest use, microseconds since the epoch.
+    std::vector<std::int64_t> last_used;
+
+    std::size_t Size() const { return password_ids.size(); }
+};
+
+/// @brief In-memory use counters of password entries.
+///
+/// Entries are spread over a fixed number of shards. Counting a use of an
+/// entry that is already tracked takes a shared lock of its shard and updates
+/// relaxed atomics, so concurrent reads of the same or different entries do
+/// not serialize; only the first use of an entry since the last Drain() takes
+/// the shard exclusively.
+class Counters final {
+public:
+    using Clock = std::chrono::system_clock;
+
+    /// @brief Counts `count` uses of the entry, the latest one at `time`.
+    void Add(std::int64_t password_id, Clock::time_point time, std::uint32_t count = 1);
+
+    /// @brief Takes all accumulated uses and resets the counters.
+    Batch Drain();
+
+    /// @brief Adds back a drained batch that could not be written.
+    void Restore(const Batch& batch);
+
+    /// @brief Returns the number of entries with uses not drained yet.
+    std::size_t GetSize() const;
+
+private:
+    static constexpr std::size_t kShardCount = 64;
+
+    struct Entry {
+        std::atomic<std::uint64_t> count{0};
+        std::atomic<std::int64_t> last_used{0};
+    };
+
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::int64_t, Entry> entries;
+    };
+
+    static void Update(Entry& entry, std::int64_t time, std::uint32_t count);
+
+    std::array<Shard, kShardCount> shards_;
+};
+
+}  // namespace usage
@@ -0,0 +1,86 @@
+#include "counters.hpp"
+
+#include <userver/utest/utest.hpp>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using namespace usage;
+
+namespace {
+
+const Counters::Clock::time_point kTime{std::chrono::microseconds{1'700'000'000'000'000}};
+
+/// Returns (count, last_used) of the entry in the batch.
+std::pair<std::int64_t, std::int64_t> Find(const Batch& batch, std::int64_t password_id) {
+    const auto it = std::find(batch.password_ids.begin(), batch.password_ids.end(), password_id);
+    if (it == batch.password_ids.end()) {
+        return {0, 0};
+    }
+    const auto index = it - batch.password_ids.begin();
+    return {batch.counts[index], batch.last_used[index]};
+}
+
+}  // namespace
+
+TEST(UsageCountersTest, AccumulatesUntilDrained) {
+    Counters counters;
+    counters.Add(1, kTime);
+    counters.Add(1, kTime + std::chrono::seconds{2});
+    counters.Add(1, kTime + std::chrono::seconds{1});
+    counters.Add(65, kTime);
+    EXPECT_EQ(counters.GetSize(), 2);
+
+    const auto batch = counters.Drain();
+    ASSERT_EQ(batch.Size(), 2);
+    EXPECT_EQ(Find(batch, 1), std::make_pair(std::int64_t{3}, std::int64_t{1'700'000'002'000'000}));
+    EXPECT_EQ(Find(batch, 65), std::make_pair(std::int64_t{1}, std::int64_t{1'700'000'000'000'000}));
+
+    EXPECT_EQ(counters.GetSize(), 0);
+    EXPECT_EQ(counters.Drain().Size(), 0);
+}
+
+TEST(UsageCountersTest, RestoreMergesWithNewUses) {
+    Counters counters;
+    counters.Add(7, kTime, 2);
+    const auto failed = counters.Drain();
+
+    counters.Add(7, kTime - std::chrono::seconds{1});
+    counters.Restore(failed);
+
+    const auto batch = counters.Drain();
+    EXPECT_EQ(Find(batch, 7), std::make_pair(std::int64_t{3}, std::int64_t{1'700'000'000'000'000}));
+}
+
+TEST(UsageCountersTest, ConcurrentAddsAreNotLost) {
+    constexpr std::int64_t kEntries = 100;
+    constexpr int kThreads = 4;
+    constexpr int kRounds = 1000;
+
+    Counters counters;
+    std::int64_t drained = 0;
+    {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < kThreads; ++i) {
+            threads.emplace_back([&counters] {
+                for (int round = 0; round < kRounds; ++round) {
+                    counters.Add(round % kEntries, kTime);
+                }
+            });
+        }
+        for (int i = 0; i < 10; ++i) {
+            for (const auto count : counters.Drain().counts) {
+                drained += count;
+            }
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    for (const auto count : counters.Drain().counts) {
+        drained += count;
+    }
+
+    EXPECT_EQ(drained, kThreads * kRounds);
+}
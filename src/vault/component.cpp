@@ -0,0 +1,54 @@
+#include "component.hpp"
+#include "breach/component.hpp"
+#include "cache/deleted_users.hpp"
+#include "cache/users.hpp"
+#include "crypto/component.hpp"
+#include "hedge/component.hpp"
+#include "jwt/component.hpp"
+#include "notify/component.hpp"
+#include "rowcache/component.hpp"
+#include "sessions/component.hpp"
+#include "usage/component.hpp"
+
+#include <userver/components/component.hpp>
+#include <userver/storages/postgres/component.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+namespace vault {
+
+Component::Component(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& context
+)
+    : userver::components::LoggableComponentBase(config, context),
+      service_{
+          context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster(),
+          context.FindComponent<cache::UsersCache>(),
+          context.FindComponent<cache::DeletedUsersCache>(),
+          context.FindComponent<jwt::Component>().GetClient(),
+          context.FindComponent<crypto::Component>().GetKeyring(),
+          context.FindComponent<usage::Component>().GetCounters(),
+          context.FindComponent<breach::Component>().GetChecker(),
+          context.FindComponent<notify::Component>().GetHub(),
+          context.FindComponent<sessions::Component>().GetStore(),
+          context.FindComponent<rowcache::Component>().GetCache(),
+          context.FindComponent<hedge::Component>().GetPolicy(),
+      } {
+    reset_registration_ = userver::testsuite::RegisterCache(config, context, this, &Component::ResetCache);
+}
+
+const Service& Component::GetService() const { return service_; }
+
+void Component::ResetCache() { service_.ResetDeletedUsers(); }
+
+userver::yaml_config::Schema Component::GetStaticConfigSchema() {
+    constexpr auto schema = R"(
+        type: object
+        description: vault service component
+        additionalProperties: false
+        properties: {}
+    )";
+    return userver::yaml_config::MergeSchemas<userver::components::LoggableComponentBase>(schema);
+}
+
+}  // namespace vault
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "service.hpp"
+
+#include <userver/components/loggable_component_base.hpp>
+#include <userver/testsuite/cache_control.hpp>
+
+namespace vault {
+
+/// @brief Owns the vault::Service instance shared by the HTTP handlers and the gRPC service.
+///
+/// The testsuite resets the users the service has deleted through `tests-control`, as the tests reuse user IDs.
+class Component final : public userver::components::LoggableComponentBase {
+public:
+    static constexpr std::string_view kName = "component-vault";
+
+    Component(const userver::components::ComponentConfig& config, const userver::components::ComponentContext& context);
+
+    const Service& GetService() const;
+
+    static userver::yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    void ResetCache();
+
+    const Service service_;
+    userver::testsuite::CacheResetRegistration reset_registration_;
+};
+
+}  // namespace vault
@@ -0,0 +1,951 @@
+#include "service.hpp"
+#include "breach/checker.hpp"
+#include "crypto/keyring.hpp"
+#include "crypto/utils.hpp"
+#include "db/sql.hpp"
+#include "hedge/read.hpp"
+#include "jwt/client.hpp"
+#include "models/user.hpp"
+#include "notify/hub.hpp"
+#include "rowcache/cache.hpp"
+#include "secure/arena.hpp"
+#include "sessions/store.hpp"
+#include "totp/batch.hpp"
+#include "totp/utils.hpp"
+#include "usage/counters.hpp"
+
+#include <userver/crypto/base64.hpp>
+#include <userver/crypto/hash.hpp>
+#include <userver/engine/task/cancel.hpp>
+#include <userver/logging/log.hpp>
+#include <userver/storages/postgres/cluster.hpp>
+#include <userver/storages/postgres/io/chrono.hpp>
+#include <userver/storages/postgres/transaction.hpp>
+#include <userver/utils/algo.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <ctime>
+#include <tuple>
+
+namespace {
+
+const userver::storages::postgres::TransactionOptions kSnapshotOptions{
+    userver::storages::postgres::IsolationLevel::kRepeatableRead,
+    userver::storages::postgres::TransactionOptions::kReadOnly
+};
+
+std::int64_t VersionOrZero(const userver::storages::postgres::ResultSet& result) {
+    return result.IsEmpty() ? 0 : result.AsSingleRow<std::int64_t>();
+}
+
+std::string EncryptPassword(std::string_view password, std::string_view data_key) {
+    return userver::crypto::base64::Base64Encode(crypto::Encrypt(password, data_key));
+}
+
+/// Random bytes of an opaque session token, 43 characters in base64url.
+constexpr std::size_t kSessionTokenBytes = 32;
+constexpr std::size_t kSessionTokenLength = (kSessionTokenBytes * 4 + 2) / 3;
+
+/// Checks that the token could have been issued by CreateSession(), anything else is not worth a lookup.
+bool IsWellFormedSessionToken(std::string_view token) {
+    return token.size() == kSessionTokenLength && std::all_of(token.begin(), token.end(), [](char c) {
+               return std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_';
+           });
+}
+
+/// Opaque tokens are stored and looked up by their hash, the table alone does not give away sessions.
+std::string HashSessionToken(std::string_view token) {
+    return userver::crypto::hash::Sha256(token, userver::crypto::hash::OutputEncoding::kHex);
+}
+
+constexpr std::uint32_t kTotpPeriod = 30;
+constexpr std::size_t kTotpDigits = 6;
+
+bool IsValidTotpSecret(const std::string& secret) {
+    try {
+        auto key = totp::DecodeTotpSecret(secret);
+        const bool valid = !key.empty();
+        secure::Wipe(key);
+        return valid;
+    } catch (const std::invalid_argument&) {
+        return false;
+    }
+}
+
+std::string_view DecryptTotpSecret(
+    const models::Password& password,
+    std::string_view data_key,
+    secure::Arena& arena
+) {
+    return crypto::Decrypt(crypto::Base64Decode(*password.totp_secret_encrypted, arena), data_key, arena);
+}
+
+std::string WrapDataKey(std::string_view data_key, std::string_view master_key) {
+    return userver::crypto::base64::Base64Encode(crypto::Encrypt(data_key, master_key));
+}
+
+std::string_view UnwrapDataKey(std::string_view data_key_wrapped, std::string_view master_key, secure::Arena& arena) {
+    return crypto::Decrypt(crypto::Base64Decode(data_key_wrapped, arena), master_key, arena);
+}
+
+std::string_view GenerateDataKey(secure::Arena& arena) {
+    auto generated = crypto::GenerateMasterKey();
+    const auto data_key = arena.Copy(generated);
+    secure::Wipe(generated);
+    return data_key;
+}
+
+}  // namespace
+
+namespace vault {
+
+Error::Error(ErrorCode code, const std::string& message) : std::runtime_error{message}, code_{code} {}
+
+void CheckDeadline(userver::engine::Deadline deadline) {
+    if (userver::engine::current_task::ShouldCancel()) {
+        throw Error(ErrorCode::kDeadlineExceeded, "Request cancelled");
+    }
+    if (deadline.IsReached()) {
+        throw Error(ErrorCode::kDeadlineExceeded, "Deadline exceeded");
+    }
+}
+
+Service::Service(
+    userver::storages::postgres::ClusterPtr pg_cluster,
+    const cache::UsersCache& users_cache,
+    const cache::DeletedUsersCache& deleted_users_cache,
+    const jwt::Client& jwt_client,
+    const crypto::Keyring& keyring,
+    usage::Counters& usage_counters,
+    const breach::Checker& breach_checker,
+    notify::Hub& change_hub,
+    sessions::Store& session_store,
+    rowcache::Cache& row_cache,
+    hedge::Policy& hedge_policy
+)
+    : pg_cluster_{std::move(pg_cluster)},
+      users_cache_{users_cache},
+      deleted_users_cache_{deleted_users_cache},
+      jwt_client_{jwt_client},
+      keyring_{keyring},
+      usage_counters_{usage_counters},
+      breach_checker_{breach_checker},
+      change_hub_{change_hub},
+      session_store_{session_store},
+      row_cache_{row_cache},
+      hedge_policy_{hedge_policy} {}
+
+Registration Service::RegisterUser(const std::string& username) const {
+    auto master_key = crypto::GenerateMasterKey();
+    const auto salt = crypto::GenerateSalt();
+    const auto master_key_hash = crypto::HashMasterKeyWithSalt(master_key, salt);
+    auto totp_secret = totp::GenerateTotpSecret();
+    const auto salt_encoded = userver::crypto::base64::Base64Encode(salt);
+
+    auto data_key = crypto::GenerateMasterKey();
+    const auto data_key_wrapped = WrapDataKey(data_key, master_key);
+    secure::Wipe(data_key);
+
+    pg_cluster_->Execute(
+        userver::storages::postgres::ClusterHostType::kMaster,
+        db::sql::kCreateUser,
+        username,
+        master_key_hash,
+        salt_encoded,
+        keyring_.EncryptText(totp_secret),
+        data_key_wrapped
+    );
+
+    LOG_INFO() << "User successfully created in database: " << username;
+
+    return {std::move(master_key), std::move(totp_secret)};
+}
+
+std::string Service::Authenticate(
+    const std::string& username,
+    std::string_view master_key,
+    std::uint32_t totp_code,
+    secure::Arena& arena
+) const {
+    auto user_found = FindUser(username);
+    if (!user_found) {
+        LOG_WARNING() << "Unknown user: " << username;
+        throw Error(ErrorCode::kUnauthenticated, "Unknown user");
+    }
+
+    if (!VerifyMasterKey(*user_found, master_key)) {
+        // the cache may not have caught up with a master key change yet
+        user_found = GetUser(username, userver::storages::postgres::ClusterHostType::kMaster);
+        if (!user_found) {
+            throw Error(ErrorCode::kUnauthenticated, "Unknown user");
+        }
+    }
+
+    const auto& user = *user_found;
+    LOG_DEBUG() << "User found: " << user.id;
+    CheckCredentials(user, master_key, totp_code);
+
+    // the cache and the replica may not have seen a deletion yet
+    if (!IsUserActive(user.id)) {
+        LOG_WARNING() << "Login of a deleted user: " << username;
+        throw Error(ErrorCode::kUnauthenticated, "Unknown user");
+    }
+
+    const auto data_key = OpenVault(user, master_key, arena);
+    BackfillFingerprints(user.id, data_key, arena);
+    if (session_store_.GetSettings().opaque) {
+        auto token = CreateSession(user.id, keyring_.Encrypt(data_key));
+        LOG_INFO() << "Session created successfully for user: " << username;
+        return token;
+    }
+
+    jwt::Payload jwt_payload;
+    jwt_payload.user_id = user.id;
+    jwt_payload.data_key = keyring_.Encrypt(data_key);
+    auto token = jwt_client_.GenerateToken(jwt_payload);
+
+    LOG_INFO() << "JWT token generated successfully for user: " << username;
+    return token;
+}
+
+std::string Service::ChangeMasterKey(
+    const std::string& username,
+    std::string_view master_key,
+    std::uint32_t totp_code,
+    secure::Arena& arena
+) const {
+    // the cache may lag behind a previous change, the update below compares against the current hash
+    const auto user_found = GetUser(username, userver::storages::postgres::ClusterHostType::kMaster);
+    if (!user_found) {
+        LOG_WARNING() << "Unknown user: " << username;
+        throw Error(ErrorCode::kUnauthenticated, "Unknown user");
+    }
+
+    const auto& user = *user_found;
+    CheckCredentials(user, master_key, totp_code);
+    const auto data_key = OpenVault(user, master_key, arena);
+
+    auto new_master_key = crypto::GenerateMasterKey();
+    const auto salt = crypto::GenerateSalt();
+    const auto change_result = pg_cluster_->Execute(
+        userver::storages::postgres::ClusterHostType::kMaster,
+        db::sql::kChangeMasterKey,
+        user.id,
+        crypto::HashMasterKeyWithSalt(new_master_key, salt),
+        userver::crypto::base64::Base64Encode(salt),
+        WrapDataKey(data_key, new_master_key),
+        user.master_key_hash
+    );
+
+    if (change_result.RowsAffected() == 0) {
+        LOG_WARNING() << "Master key was changed concurrently for user: " << username;
+        throw Error(ErrorCode::kUnauthenticated, "Invalid master key or TOTP code");
+    }
+
+    LOG_INFO() << "Master key changed for user: " << username;
+    return new_master_key;
+}
+
+void Service::DeleteUser(const std::string& username, std::uint32_t totp_code) const {
+    const auto user_found = GetUser(username, userver::storages::postgres::ClusterHostType::kSlave);
+    if (!user_found) {
+        LOG_WARNING() << "Unknown user: " << username;
+        throw Error(ErrorCode::kUnauthenticated, "Unknown user");
+    }
+
+    const auto& user = *user_found;
+    LOG_DEBUG() << "User found in database: " << user.id;
+
+    if (!VerifyTotp(user, totp_code)) {
+        LOG_WARNING() << "Invalid TOTP code for user: " << username;
+        throw Error(ErrorCode::kUnauthenticated, "Invalid TOTP code");
+    }
+
+    auto transaction = pg_cluster_->Begin(userver::storages::postgres::ClusterHostType::kMaster, {});
+    const auto delete_result = transaction.Execute(db::sql::kMarkUserDeleted, user.id);
+
+    if (delete_result.RowsAffected() == 0) {
+        LOG_WARNING() << "User was deleted concurrently: " << username;
+        throw Error(ErrorCode::kUnauthenticated, "Unknown user");
+    }
+    // the revocations reach the session stores of all instances, this one included
+    transaction.Execute(db::sql::kRevokeUserSessions, user.id);
+    transaction.Commit();
+
+    // the deleted users cache only learns of the deletion with its next update
+    auto deleted = deleted_here_.StartWrite();
+    deleted->insert(user.id);
+    deleted.Commit();
+    row_cache_.Evict(user.id);
+
+    LOG_INFO() << "User marked deleted, rows are purged in the background: " << username;
+}
+
+void Service::ResetDeletedUsers() const {
+    auto deleted = deleted_here_.StartWrite();
+    deleted->clear();
+    deleted.Commit();
+}
+
+userver::storages::postgres::OptionalCommandControl Service::MakeCommandControl(userver::engine::Deadline deadline)
+    const {
+    if (!deadline.IsReachable()) {
+        return std::nullopt;
+    }
+    CheckDeadline(deadline);
+
+    // the budget only ever shortens the configured timeouts, a client cannot extend them
+    const auto left = std::max(
+        std::chrono::duration_cast<std::chrono::milliseconds>(deadline.TimeLeft()), std::chrono::milliseconds{1}
+    );
+    auto command_control = pg_cluster_->GetDefaultCommandControl();
+    command_control.network_timeout_ms = std::min(command_control.network_timeout_ms, left);
+    command_control.statement_timeout_ms = std::min(command_control.statement_timeout_ms, left);
+    return command_control;
+}
+
+std::optional<models::User> Service::FindUser(const std::string& username) const {
+    const auto users = users_cache_.Get();
+    if (const auto* user = userver::utils::FindOrNullptr(*users, username)) {
+        if (user->deleted_at) {
+            return std::nullopt;
+        }
+        return *user;
+    }
+    return GetUser(username, userver::storages::postgres::ClusterHostType::kSlave);
+}
+
+std::optional<models::User> Service::GetUser(
+    const std::string& username,
+    userver::storages::postgres::ClusterHostType host_type
+) const {
+    const auto result = pg_cluster_->Execute(host_type, db::sql::kGetUser, username);
+    if (result.IsEmpty()) {
+        return std::nullopt;
+    }
+    auto user = result.AsSingleRow<models::User>(userver::storages::postgres::kRowTag);
+    if (user.deleted_at) {
+        return std::nullopt;
+    }
+    return user;
+}
+
+Session Service::ValidateJwt(const std::string& token) const {
+    try {
+        auto payload = jwt_client_.ValidateToken(token);
+        return {payload.user_id, std::move(payload.data_key), std::move(payload.master_key), {}};
+    } catch (const std::exception& ex) {
+        LOG_WARNING() << "JWT validation failed: " << ex.what();
+        throw Error(ErrorCode::kUnauthenticated, ex.what());
+    }
+}
+
+std::string Service::CreateSession(std::int32_t user_id, std::string data_key_encrypted) const {
+    const auto random = crypto::GenerateRandomBytes(kSessionTokenBytes);
+    auto token = userver::crypto::base64::Base64UrlEncode(
+        std::string_view{reinterpret_cast<const char*>(random.data()), random.size()},
+        userver::crypto::base64::Pad::kWithout
+    );
+    auto id = HashSessionToken(token);
+
+    const auto ttl = std::chrono::duration_cast<std::chrono::seconds>(session_store_.GetSettings().ttl);
+    const auto result = pg_cluster_->Execute(
+        userver::storages::postgres::ClusterHostType::kMaster,
+        db::sql::kCreateSession,
+        id,
+        user_id,
+        data_key_encrypted,
+        static_cast<std::int64_t>(ttl.count())
+    );
+    const auto expires_at = result.AsSingleRow<std::chrono::system_clock::time_point>();
+    session_store_.Insert(id, {user_id, std::move(data_key_encrypted), expires_at});
+    return token;
+}
+
+Session Service::FindSession(const std::string& token) const {
+    if (!IsWellFormedSessionToken(token)) {
+        LOG_WARNING() << "Malformed session token";
+        throw Error(ErrorCode::kUnauthenticated, "Invalid or expired session");
+    }
+
+    auto id = HashSessionToken(token);
+    const auto now = std::chrono::system_clock::now();
+    auto entry = session_store_.Find(id, now);
+    if (!entry) {
+        if (session_store_.IsInvalid(id, now)) {
+            throw Error(ErrorCode::kUnauthenticated, "Invalid or expired session");
+        }
+
+        // issued by another instance, or dropped from memory
+        using userver::storages::postgres::ClusterHostType;
+        const auto load = [&](ClusterHostType host_type) -> std::optional<sessions::Entry> {
+            const auto result = pg_cluster_->Execute(host_type, db::sql::kGetSession, id);
+            if (result.IsEmpty()) {
+                return std::nullopt;
+            }
+            return result.AsSingleRow<sessions::Entry>(userver::storages::postgres::kRowTag);
+        };
+        const auto generation = session_store_.GetGeneration(id);
+        entry = load(ClusterHostType::kSlave);
+        if (entry && !session_store_.InsertLoaded(id, *entry, generation)) {
+            // revoked while loading, the replica may not have applied the revocation yet
+            entry = load(ClusterHostType::kMaster);
+        }
+        if (!entry) {
+            LOG_WARNING() << "Unknown or expired session";
+            session_store_.InsertInvalid(id, now);
+            throw Error(ErrorCode::kUnauthenticated, "Invalid or expired session");
+        }
+    }
+    return {entry->user_id, std::move(entry->data_key_encrypted), {}, std::move(id)};
+}
+
+bool Service::IsUserActive(std::int32_t user_id) const {
+    return !pg_cluster_
+                ->Execute(userver::storages::postgres::ClusterHostType::kMaster, db::sql::kCheckUserActive, user_id)
+                .IsEmpty();
+}
+
+bool Service::VerifyMasterKey(const models::User& user, std::string_view master_key) {
+    const auto salt = userver::crypto::base64::Base64Decode(user.salt_encoded);
+    return crypto::VerifyMasterKeyHashWithSalt(master_key, salt, user.master_key_hash);
+}
+
+void Service::CheckCredentials(const models::User& user, std::string_view master_key, std::uint32_t totp_code)
+    const {
+    if (!VerifyMasterKey(user, master_key)) {
+        LOG_WARNING() << "Invalid master key for user: " << user.username;
+        throw Error(ErrorCode::kUnauthenticated, "Invalid master key or TOTP code");
+    }
+
+    // verify TOTP code
+    if (!VerifyTotp(user, totp_code)) {
+        LOG_WARNING() << "Invalid TOTP code for user: " << user.username;
+        throw Error(ErrorCode::kUnauthenticated, "Invalid master key or TOTP code");
+    }
+}
+
+std::string_view Service::OpenVault(const models::User& user, std::string_view master_key, secure::Arena& arena)
+    const {
+    if (user.data_key_wrapped) {
+        return UnwrapDataKey(*user.data_key_wrapped, master_key, arena);
+    }
+    return ConvertVault(user.id, master_key, arena);
+}
+
+std::string_view Service::ConvertVault(std::int32_t user_id, std::string_view master_key, secure::Arena& arena)
+    const {
+    auto transaction = pg_cluster_->Begin(userver::storages::postgres::ClusterHostType::kMaster, {});
+
+    // the lock serializes concurrent logins of the user and password changes, which update the same row
+    const auto lock_result = transaction.Execute(db::sql::kLockUserDataKey, user_id);
+    if (lock_result.IsEmpty()) {
+        throw Error(ErrorCode::kUnauthenticated, "Unknown user");
+    }
+    if (const auto data_key_wrapped = lock_result.AsSingleRow<std::optional<std::string>>()) {
+        // converted by a concurrent login
+        return UnwrapDataKey(*data_key_wrapped, master_key, arena);
+    }
+
+    const auto data_key = GenerateDataKey(arena);
+    const auto passwords = transaction.Execute(db::sql::kGetPasswords, user_id)
+                               .AsContainer<std::vector<models::Password>>(userver::storages::postgres::kRowTag);
+
+    std::vector<std::int32_t> ids;
+    std::vector<std::string> passwords_encrypted;
+    std::vector<std::string> fingerprints;
+    std::vector<std::int32_t> totp_ids;
+    std::vector<std::string> totp_secrets_encrypted;
+    ids.reserve(passwords.size());
+    passwords_encrypted.reserve(passwords.size());
+    fingerprints.reserve(passwords.size());
+    for (const auto& password : passwords) {
+        const auto plaintext = DecryptPassword(password, master_key, arena);
+        ids.push_back(password.id);
+        passwords_encrypted.push_back(EncryptPassword(plaintext, data_key));
+        fingerprints.push_back(crypto::FingerprintPassword(plaintext, data_key));
+        if (password.totp_secret_encrypted) {
+            totp_ids.push_back(password.id);
+            totp_secrets_encrypted.push_back(EncryptPassword(DecryptTotpSecret(password, master_key, arena), data_key));
+        }
+    }
+
+    if (!ids.empty()) {
+        transaction.Execute(db::sql::kReencryptPasswords, ids, passwords_encrypted, fingerprints, user_id);
+    }
+    if (!totp_ids.empty()) {
+        transaction.Execute(db::sql::kReencryptPasswordTotpSecrets, totp_ids, totp_secrets_encrypted, user_id);
+    }
+    const auto version = transaction.Execute(db::sql::kSetUserDataKey, user_id, WrapDataKey(data_key, master_key))
+                             .AsSingleRow<std::int64_t>();
+    transaction.Commit();
+    // the cached rows are still encrypted with the master key
+    row_cache_.Invalidate(user_id, version);
+
+    LOG_INFO() << "Vault of user " << user_id << " converted to a data key, passwords: " << passwords.size();
+    return data_key;
+}
+
+void Service::BackfillFingerprints(std::int32_t user_id, std::string_view data_key, secure::Arena& arena) const {
+    const auto result = pg_cluster_->Execute(
+        userver::storages::postgres::ClusterHostType::kMaster, db::sql::kGetPasswordsWithoutFingerprint, user_id
+    );
+    const auto passwords = result.AsContainer<std::vector<models::Password>>(userver::storages::postgres::kRowTag);
+    if (passwords.empty()) {
+        return;
+    }
+
+    std::vector<std::int32_t> ids;
+    std::vector<std::string> fingerprints;
+    ids.reserve(passwords.size());
+    fingerprints.reserve(passwords.size());
+    for (const auto& password : passwords) {
+        ids.push_back(password.id);
+        fingerprints.push_back(crypto::FingerprintPassword(DecryptPassword(password, data_key, arena), data_key));
+    }
+    pg_cluster_->Execute(
+        userver::storages::postgres::ClusterHostType::kMaster,
+        db::sql::kSetPasswordFingerprints,
+        ids,
+        fingerprints,
+        user_id
+    );
+
+    LOG_INFO() << "Fingerprints computed for " << ids.size() << " passwords of user " << user_id;
+}
+
+bool Service::VerifyTotp(const models::User& user, std::uint32_t totp_code) const {
+    auto totp_secret = keyring_.DecryptText(user.totp_secret);
+    const bool valid = totp::VerifyTotpCode(totp_secret, totp_code);
+    secure::Wipe(totp_secret);
+    return valid;
+}
+
+Session Service::ValidateToken(const std::string& token) const {
+    // opaque tokens are base64url, JWTs always have dots
+    auto session = token.find('.') == std::string::npos ? FindSession(token) : ValidateJwt(token);
+
+    if (deleted_users_cache_.Get()->count(session.user_id) != 0 || deleted_here_.Read()->count(session.user_id) != 0) {
+        LOG_WARNING() << "Token of deleted user ID: " << session.user_id;
+        throw Error(ErrorCode::kUnauthenticated, "User deleted");
+    }
+    LOG_DEBUG() << "Token validated for user ID: " << session.user_id;
+    return session;
+}
+
+void Service::Logout(const Session& session) const {
+    if (session.session_id.empty()) {
+        throw Error(ErrorCode::kInvalidArgument, "Only opaque sessions can be revoked");
+    }
+    pg_cluster_->Execute(
+        userver::storages::postgres::ClusterHostType::kMaster, db::sql::kRevokeSession, session.session_id
+    );
+    session_store_.Erase(session.session_id);
+    LOG_INFO() << "Session revoked for user ID: " << session.user_id;
+}
+
+std::string_view Service::OpenDataKey(const Session& session, secure::Arena& arena) const {
+    if (!session.data_key_encrypted.empty()) {
+        return keyring_.Decrypt(session.data_key_encrypted, arena);
+    }
+
+    // token issued before data keys, the vault may have been converted since
+    const auto master_key = keyring_.Decrypt(session.master_key_encrypted, arena);
+    const auto result = pg_cluster_->Execute(
+        userver::storages::postgres::ClusterHostType::kMaster, db::sql::kGetUserDataKey, session.user_id
+    );
+    const auto data_key_wrapped = result.IsEmpty() ? std::nullopt : result.AsSingleRow<std::optional<std::string>>();
+    if (!data_key_wrapped) {
+        return master_key;
+    }
+
+    try {
+        return UnwrapDataKey(*data_key_wrapped, master_key, arena);
+    } catch (const std::exception& ex) {
+        LOG_WARNING() << "Failed to open the vault with the session master key: " << ex.what();
+        throw Error(ErrorCode::kUnauthenticated, "Session is no longer valid");
+    }
+}
+
+std::int64_t Service::GetVaultVersion(std::int32_t user_id, userver::engine::Deadline deadline) const {
+    if (const auto cached = row_cache_.Find(user_id)) {
+        return cached->version;
+    }
+    return VersionOrZero(pg_cluster_->Execute(
+        userver::storages::postgres::ClusterHostType::kSlave,
+        MakeCommandControl(deadline),
+        db::sql::kGetVaultVersion,
+        user_id
+    ));
+}
+
+std::uint64_t Service::GetWriteGeneration(std::int32_t user_id) const { return row_cache_.GetGeneration(user_id); }
+
+models::Password Service::GetPassword(
+    std::int32_t user_id,
+    std::int64_t password_id,
+    userver::engine::Deadline deadline
+) const {
+    if (const auto cached = row_cache_.Find(user_id)) {
+        const auto it = std::lower_bound(
+            cached->passwords.begin(),
+            cached->passwords.end(),
+            password_id,
+            [](const models::Password& password, std::int64_t id) { return password.id < id; }
+        );
+        if (it == cached->passwords.end() || it->id != password_id) {
+            LOG_WARNING() << "Password not found for ID: " << password_id;
+            throw Error(ErrorCode::kNotFound, "Password not found");
+        }
+        usage_counters_.Add(it->id, std::chrono::system_clock::now());
+        return *it;
+    }
+
+    const auto result = hedge::RunHedged(hedge_policy_, hedge::Read::kGetPassword, [&](auto hosts) {
+        return pg_cluster_->Execute(hosts, MakeCommandControl(deadline), db::sql::kGetPassword, password_id, user_id);
+    });
+
+    if (result.IsEmpty()) {
+        LOG_WARNING() << "Password not found for ID: " << password_id;
+        throw Error(ErrorCode::kNotFound, "Password not found");
+    }
+
+    auto password = result.AsSingleRow<models::Password>(userver::storages::postgres::kRowTag);
+    if (password.user_id != user_id) {
+        LOG_WARNING() << "Access denied for password ID: " << password_id;
+        throw Error(ErrorCode::kForbidden, "Access denied");
+    }
+
+    usage_counters_.Add(password.id, std::chrono::system_clock::now());
+    return password;
+}
+
+Vault Service::ListPasswords(
+    std::int32_t user_id,
+    std::string_view search_term,
+    const ListOptions& options,
+    userver::engine::Deadline deadline
+) const {
+    if (options.order == Order::kId && search_term.empty() && row_cache_.IsEnabled()) {
+        auto cached = row_cache_.Find(user_id);
+        if (!cached) {
+            cached = LoadVault(user_id, deadline);
+        }
+        const auto size = static_cast<std::int64_t>(cached->passwords.size());
+        const auto count = options.limit ? std::clamp<std::int64_t>(*options.limit, 0, size) : size;
+        return {cached->version, {cached->passwords.begin(), cached->passwords.begin() + count}};
+    }
+
+    return hedge::RunHedged(hedge_policy_, hedge::Read::kListPasswords, [&](auto hosts) {
+        // The version and the rows must come from the same snapshot, otherwise a lagging replica
+        // could pair an old body with a new ETag and hide the change from the client.
+        auto transaction = pg_cluster_->Begin(hosts, kSnapshotOptions, MakeCommandControl(deadline));
+        const auto version_result = transaction.Execute(db::sql::kGetVaultVersion, user_id);
+        const auto result = transaction.Execute(
+            options.order == Order::kFrecency ? db::sql::kSearchPasswordsByFrecency : db::sql::kSearchPasswords,
+            user_id,
+            search_term,
+            options.limit
+        );
+        transaction.Commit();
+
+        return Vault{
+            VersionOrZero(version_result),
+            result.AsContainer<std::vector<models::Password>>(userver::storages::postgres::kRowTag),
+        };
+    });
+}
+
+std::shared_ptr<const rowcache::CachedVault> Service::LoadVault(
+    std::int32_t user_id,
+    userver::engine::Deadline deadline
+) const {
+    const auto generation = row_cache_.GetGeneration(user_id);
+    const auto read = [&](userver::storages::postgres::ClusterHostType host) {
+        auto transaction = pg_cluster_->Begin(host, kSnapshotOptions, MakeCommandControl(deadline));
+        const auto version_result = transaction.Execute(db::sql::kGetVaultVersion, user_id);
+        const auto result = transaction.Execute(
+            db::sql::kSearchPasswords, user_id, std::string_view{}, std::optional<std::int64_t>{}
+        );
+        transaction.Commit();
+
+        auto vault = std::make_shared<rowcache::CachedVault>();
+        vault->version = VersionOrZero(version_result);
+        vault->passwords =
+            result.AsContainer<std::vector<models::Password>>(userver::storages::postgres::kRowTag);
+        return vault;
+    };
+
+    auto vault = read(userver::storages::postgres::ClusterHostType::kSlave);
+    if (vault->version < row_cache_.GetKnownVersion(user_id)) {
+        // the replica has not applied a change written here or notified already, e.g. the
+        // write of the client right before this read
+        vault = read(userver::storages::postgres::ClusterHostType::kMaster);
+    }
+    row_cache_.Insert(user_id, vault, generation);
+    return vault;
+}
+
+Changes Service::GetChanges(std::int32_t user_id, std::int64_t cursor, userver::engine::Deadline deadline) const {
+    if (cursor < 0) {
+        throw Error(ErrorCode::kInvalidArgument, "Cursor must not be negative");
+    }
+
+    auto transaction = pg_cluster_->Begin(
+        userver::storages::postgres::ClusterHostType::kSlave, kSnapshotOptions, MakeCommandControl(deadline)
+    );
+    const auto state = transaction.Execute(db::sql::kGetSyncState, user_id);
+
+    Changes changes;
+    if (state.IsEmpty()) {
+        transaction.Commit();
+        changes.full = true;
+        return changes;
+    }
+
+    const auto [version, horizon] =
+        state.AsSingleRow<std::tuple<std::int64_t, std::int64_t>>(userver::storages::postgres::kRowTag);
+    changes.cursor = version;
+    if (cursor >= version) {
+        // nothing new, or a cursor issued by the primary that this replica has not caught up with yet
+        transaction.Commit();
+        changes.cursor = cursor;
+        return changes;
+    }
+
+    changes.full = cursor == 0 || cursor < horizon;
+    // entries never changed since change versions were introduced carry 0, a full sync has to include them
+    const std::int64_t since = changes.full ? -1 : cursor;
+    changes.changed = transaction.Execute(db::sql::kGetChangedPasswords, user_id, since)
+                          .AsContainer<std::vector<models::Password>>(userver::storages::postgres::kRowTag);
+    if (!changes.full) {
+        changes.deleted = transaction.Execute(db::sql::kGetPasswordTombstones, user_id, since)
+                              .AsContainer<std::vector<std::int64_t>>();
+    }
+    transaction.Commit();
+
+    LOG_DEBUG() << "Changes of user " << user_id << " since " << cursor << ": " << changes.changed.size()
+                << " changed, " << changes.deleted.size() << " deleted";
+    return changes;
+}
+
+ChangeWait Service::WaitForChanges(std::int32_t user_id, std::int64_t cursor, userver::engine::Deadline deadline)
+    const {
+    if (cursor < 0) {
+        throw Error(ErrorCode::kInvalidArgument, "Cursor must not be negative");
+    }
+
+    const auto max_wait = change_hub_.GetMaxWait();
+    const auto wait_deadline = deadline.IsReachable() && deadline.TimeLeft() < max_wait
+                                   ? deadline
+                                   : userver::engine::Deadline::FromDuration(max_wait);
+
+    auto subscription = change_hub_.Subscribe(user_id);
+    if (!subscription) {
+        LOG_WARNING() << "Too many clients are waiting for changes, rejected user " << user_id;
+        throw Error(ErrorCode::kUnavailable, "Too many clients are waiting for changes");
+    }
+
+    const auto read_version = [&] {
+        return VersionOrZero(pg_cluster_->Execute(
+            userver::storages::postgres::ClusterHostType::kMaster,
+            MakeCommandControl(deadline),
+            db::sql::kGetVaultVersion,
+            user_id
+        ));
+    };
+
+    auto version = read_version();
+    while (version <= cursor) {
+        if (!subscription->Wait(wait_deadline)) {
+            return {cursor, false};
+        }
+        version = std::max(version, subscription->GetVersion());
+        if (subscription->TakeResync()) {
+            version = std::max(version, read_version());
+        }
+    }
+    return {version, true};
+}
+
+CreatedPassword Service::CreatePassword(
+    std::int32_t user_id,
+    std::string_view data_key,
+    const std::string& service,
+    const std::string& login,
+    const std::string& password,
+    const std::optional<std::string>& totp_secret,
+    userver::engine::Deadline deadline
+) const {
+    std::optional<std::string> totp_secret_encrypted;
+    if (totp_secret) {
+        if (!IsValidTotpSecret(*totp_secret)) {
+            throw Error(ErrorCode::kInvalidArgument, "Invalid TOTP secret");
+        }
+        totp_secret_encrypted = EncryptPassword(*totp_secret, data_key);
+    }
+
+    CreatedPassword created;
+    created.breached = breach_checker_.IsBreached(password);
+    if (created.breached) {
+        LOG_INFO() << "Password of a new entry appears in the breach index";
+    }
+
+    auto password_encrypted = EncryptPassword(password, data_key);
+    auto fingerprint = crypto::FingerprintPassword(password, data_key);
+    LOG_DEBUG() << "Password encrypted successfully";
+
+    const auto result = pg_cluster_->Execute(
+        userver::storages::postgres::ClusterHostType::kMaster,
+        MakeCommandControl(deadline),
+        db::sql::kCreatePassword,
+        user_id,
+        service,
+        login,
+        password_encrypted,
+        fingerprint,
+        totp_secret_encrypted
+    );
+
+    if (result.IsEmpty()) {
+        // the user was deleted after the token was issued, nothing was inserted
+        LOG_WARNING() << "Password not created for deleted user ID: " << user_id;
+        throw Error(ErrorCode::kUnauthenticated, "User deleted");
+    }
+
+    LOG_INFO() << "Password created successfully";
+    models::Password row{};
+    std::tie(created.id, created.vault_version, created.reused_in, row.created_at, row.updated_at) =
+        result.AsSingleRow<std::tuple<
+            std::int64_t,
+            std::int64_t,
+            std::vector<std::string>,
+            std::chrono::system_clock::time_point,
+            std::chrono::system_clock::time_point>>(userver::storages::postgres::kRowTag);
+
+    row.id = static_cast<std::int32_t>(created.id);
+    row.user_id = user_id;
+    row.service = service;
+    row.login = login;
+    row.password_encrypted = std::move(password_encrypted);
+    row.use_count = 0;
+    row.fingerprint = std::move(fingerprint);
+    row.change_version = created.vault_version;
+    row.totp_secret_encrypted = std::move(totp_secret_encrypted);
+    row_cache_.Add(user_id, created.vault_version, std::move(row));
+    return created;
+}
+
+std::vector<ReusedPassword> Service::FindReusedPasswords(std::int32_t user_id, userver::engine::Deadline deadline)
+    const {
+    return pg_cluster_
+        ->Execute(
+            userver::storages::postgres::ClusterHostType::kSlave,
+            MakeCommandControl(deadline),
+            db::sql::kGetReusedPasswords,
+            user_id
+        )
+        .AsContainer<std::vector<ReusedPassword>>(userver::storages::postgres::kRowTag);
+}
+
+BreachReport Service::FindBreachedPasswords(
+    std::int32_t user_id,
+    std::string_view data_key,
+    secure::Arena& arena,
+    userver::engine::Deadline deadline
+) const {
+    if (!breach_checker_.IsEnabled()) {
+        throw Error(ErrorCode::kUnavailable, "Breach check is not configured");
+    }
+
+    const auto result = hedge::RunHedged(hedge_policy_, hedge::Read::kScanVault, [&](auto hosts) {
+        return pg_cluster_->Execute(hosts, MakeCommandControl(deadline), db::sql::kGetPasswords, user_id);
+    });
+    auto passwords = result.AsContainer<std::vector<models::Password>>(userver::storages::postgres::kRowTag);
+
+    BreachReport report;
+    report.checked = passwords.size();
+    for (std::size_t i = 0; i < passwords.size(); ++i) {
+        if (i % kDeadlineCheckRows == 0) {
+            CheckDeadline(deadline);
+        }
+        auto& password = passwords[i];
+        if (breach_checker_.IsBreached(DecryptPassword(password, data_key, arena))) {
+            report.breached.push_back(std::move(password));
+        }
+    }
+
+    LOG_INFO() << "Breach check of user " << user_id << ": " << report.breached.size() << " of " << report.checked
+               << " passwords breached";
+    return report;
+}
+
+TotpCodes Service::GetTotpCodes(
+    std::int32_t user_id,
+    std::string_view data_key,
+    secure::Arena& arena,
+    userver::engine::Deadline deadline
+) const {
+    const auto result = hedge::RunHedged(hedge_policy_, hedge::Read::kScanVault, [&](auto hosts) {
+        return pg_cluster_->Execute(hosts, MakeCommandControl(deadline), db::sql::kGetPasswordsWithTotp, user_id);
+    });
+    const auto passwords = result.AsContainer<std::vector<models::Password>>(userver::storages::postgres::kRowTag);
+
+    std::vector<std::string_view> secrets;
+    secrets.reserve(passwords.size());
+    for (std::size_t i = 0; i < passwords.size(); ++i) {
+        if (i % kDeadlineCheckRows == 0) {
+            CheckDeadline(deadline);
+        }
+        secrets.push_back(DecryptTotpSecret(passwords[i], data_key, arena));
+    }
+
+    const auto now = std::time(nullptr);
+    TotpCodes totp_codes;
+    totp_codes.period = kTotpPeriod;
+    totp_codes.expires_in = kTotpPeriod - static_cast<std::uint32_t>(now % kTotpPeriod);
+
+    const auto codes = totp::GenerateTotpCodes(secrets, kTotpPeriod, kTotpDigits, now);
+    totp_codes.codes.reserve(codes.size());
+    for (std::size_t i = 0; i < codes.size(); ++i) {
+        totp_codes.codes.push_back({passwords[i].id, passwords[i].service, passwords[i].login, codes[i]});
+    }
+
+    LOG_INFO() << "Computed " << codes.size() << " TOTP codes of user " << user_id;
+    return totp_codes;
+}
+
+std::int64_t Service::DeletePassword(
+    std::int32_t user_id,
+    std::int64_t password_id,
+    userver::engine::Deadline deadline
+) const {
+    const auto result = pg_cluster_->Execute(
+        userver::storages::postgres::ClusterHostType::kMaster,
+        MakeCommandControl(deadline),
+        db::sql::kDeletePassword,
+        password_id,
+        user_id
+    );
+
+    if (result.RowsAffected() == 0) {
+        LOG_WARNING() << "Password not found for ID: " << password_id;
+        throw Error(ErrorCode::kNotFound, "Password not found");
+    }
+
+    LOG_INFO() << "Password deleted successfully";
+    const auto version = VersionOrZero(result);
+    row_cache_.Remove(user_id, version, password_id);
+    return version;
+}
+
+std::string_view Service::DecryptPassword(
+    const models::Password& password,
+    std::string_view data_key,
+    secure::Arena& arena
+) {
+    return crypto::Decrypt(crypto::Base64Decode(password.password_encrypted, arena), data_key, arena);
+}
+
+}  // namespace vault
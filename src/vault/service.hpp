@@ -0,0 +1,513 @@
+#pragma once
+
+#include "cache/deleted_users.hpp"
+#include "cache/users.hpp"
+#include "models/password.hpp"
+
+#include <userver/engine/deadline.hpp>
+#include <userver/rcu/rcu.hpp>
+#include <userver/storages/postgres/cluster_types.hpp>
+#include <userver/storages/postgres/options.hpp>
+#include <userver/storages/postgres/postgres_fwd.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace breach {
+
+class Checker;
+
+}  // namespace breach
+
+namespace crypto {
+
+class Keyring;
+
+}  // namespace crypto
+
+namespace hedge {
+
+class Policy;
+
+}  // namespace hedge
+
+namespace jwt {
+
+class Client;
+
+}  // namespace jwt
+
+namespace notify {
+
+class Hub;
+
+}  // namespace notify
+
+namespace rowcache {
+
+class Cache;
+struct CachedVault;
+
+}  // namespace rowcache
+
+namespace secure {
+
+class Arena;
+
+}  // namespace secure
+
+namespace sessions {
+
+class Store;
+
+}  // namespace sessions
+
+namespace usage {
+
+class Counters;
+
+}  // namespace usage
+
+namespace vault {
+
+/// Transport-independent failure classes, mapped to HTTP and gRPC status codes by the API layers.
+enum class ErrorCode {
+    kInvalidArgument,
+    kUnauthenticated,
+    kForbidden,
+    kNotFound,
+    kUnavailable,
+    kDeadlineExceeded,
+    kResourceExhausted,
+    kInternal,
+};
+
+/// Error reported by vault::Service. The message is safe to show to clients.
+class Error : public std::runtime_error {
+public:
+    Error(ErrorCode code, const std::string& message);
+
+    ErrorCode GetCode() const noexcept { return code_; }
+
+private:
+    ErrorCode code_;
+};
+
+/// Number of rows long decrypt and serialization loops process between CheckDeadline() calls.
+inline constexpr std::size_t kDeadlineCheckRows = 64;
+
+/// @brief Stops work on behalf of a request whose deadline has passed or whose task was cancelled,
+/// e.g. because the client went away.
+/// @throws Error kDeadlineExceeded
+void CheckDeadline(userver::engine::Deadline deadline);
+
+/// Authenticated caller, as extracted from a session token.
+struct Session {
+    std::int32_t user_id{0};
+
+    /// Data key encrypted with the server keyring.
+    std::string data_key_encrypted;
+
+    /// Master key encrypted with the server keyring, only in tokens issued before data keys were introduced.
+    std::string master_key_encrypted;
+
+    /// ID of an opaque session, empty for JWTs.
+    std::string session_id;
+};
+
+/// Credentials issued to a newly registered user.
+struct Registration {
+    /// Raw (not encoded) master key.
+    std::string master_key;
+
+    /// Base32 TOTP secret.
+    std::string totp_secret;
+};
+
+/// Entry added to a vault.
+struct CreatedPassword {
+    std::int64_t id{0};
+    std::int64_t vault_version{0};
+
+    /// The password appears in the breach index.
+    bool breached{false};
+
+    /// Services of the other entries of the user with the same password.
+    std::vector<std::string> reused_in;
+};
+
+/// Entries of a user that share one password, ordered by ID.
+struct ReusedPassword {
+    std::vector<std::int64_t> ids;
+    std::vector<std::string> services;
+    std::vector<std::string> logins;
+};
+
+/// Result of checking a vault against the breach index.
+struct BreachReport {
+    std::size_t checked{0};
+
+    /// Entries whose passwords appear in the index.
+    std::vector<models::Password> breached;
+};
+
+/// Current TOTP code of an entry.
+struct TotpCode {
+    std::int64_t id{0};
+    std::string service;
+    std::string login;
+    std::uint32_t code{0};
+};
+
+/// Current TOTP codes of the entries of a user that have a second factor.
+struct TotpCodes {
+    std::uint32_t period{0};
+
+    /// Seconds until the codes change.
+    std::uint32_t expires_in{0};
+
+    /// Ordered by entry ID.
+    std::vector<TotpCode> codes;
+};
+
+/// Order of listed entries.
+enum class Order {
+    /// Oldest first.
+    kId,
+
+    /// Most frequently and recently read first.
+    kFrecency,
+};
+
+/// Parameters of a listing.
+struct ListOptions {
+    Order order{Order::kId};
+
+    /// Maximum number of entries to return, all of them if not set.
+    std::optional<std::int64_t> limit;
+};
+
+/// Password entries of a user together with the vault version they were read at.
+struct Vault {
+    std::int64_t version;
+    std::vector<models::Password> passwords;
+};
+
+/// Changes of a vault since a sync cursor.
+struct Changes {
+    /// Cursor to pass to the next sync, the vault version the changes were read at.
+    std::int64_t cursor{0};
+
+    /// The cursor was too old to be served incrementally, `changed` holds the whole vault
+    /// and entries missing from it must be dropped.
+    bool full{false};
+
+    /// Entries created or changed since the cursor, in the order of their changes.
+    std::vector<models::Password> changed;
+
+    /// IDs of the entries deleted since the cursor.
+    std::vector<std::int64_t> deleted;
+};
+
+/// Outcome of waiting for a change of a vault.
+struct ChangeWait {
+    /// Vault version to sync up to, the cursor waited with if nothing changed.
+    std::int64_t cursor{0};
+
+    bool changed{false};
+};
+
+/// @brief Business logic shared by the HTTP and gRPC APIs.
+///
+/// Owns all database access and cryptography; the API layers only translate
+/// requests, responses and errors.
+///
+/// Methods serving vault reads and writes take the deadline of the request.
+/// Their queries get network and statement timeouts of at most the time left,
+/// and they fail with Error kDeadlineExceeded once it has passed. Reads of
+/// entries from the replicas are hedged if hedging is enabled, see
+/// hedge::RunHedged().
+///
+/// Passwords are encrypted with a random per-user data key that is stored in
+/// `users` encrypted ("wrapped") with the master key, so changing the master
+/// key rewrites a single row. Sessions carry the data key, never the master
+/// key. Vaults created before data keys were introduced are encrypted with the
+/// master key directly and are converted on the next login of their owner.
+///
+/// Encrypted rows of recently read vaults are kept in rowcache::Cache. Writes
+/// made through the service update it in place, changes made elsewhere reach
+/// it through the vault change notifications.
+class Service final {
+public:
+    Service(
+        userver::storages::postgres::ClusterPtr pg_cluster,
+        const cache::UsersCache& users_cache,
+        const cache::DeletedUsersCache& deleted_users_cache,
+        const jwt::Client& jwt_client,
+        const crypto::Keyring& keyring,
+        usage::Counters& usage_counters,
+        const breach::Checker& breach_checker,
+        notify::Hub& change_hub,
+        sessions::Store& session_store,
+        rowcache::Cache& row_cache,
+        hedge::Policy& hedge_policy
+    );
+
+    /// @brief Creates a user with a fresh master key, data key and TOTP secret.
+    ///
+    /// The TOTP secret is stored encrypted with the primary server key.
+    Registration RegisterUser(const std::string& username) const;
+
+    /// @brief Verifies the credentials and issues a session token.
+    ///
+    /// The token is a JWT or, if sessions::Settings::opaque is set, a random
+    /// opaque token whose state is kept server-side, see sessions::Component.
+    ///
+    /// The vault is converted to a data key here if it does not have one yet,
+    /// and entries without a fingerprint get one.
+    ///
+    /// @param master_key Raw (decoded) master key.
+    /// @throws Error kUnauthenticated on unknown user or wrong credentials.
+    std::string Authenticate(
+        const std::string& username,
+        std::string_view master_key,
+        std::uint32_t totp_code,
+        secure::Arena& arena
+    ) const;
+
+    /// @brief Replaces the master key of the user with a fresh one.
+    ///
+    /// Only the wrapped data key is re-encrypted, the passwords are not touched
+    /// and sessions issued before stay valid.
+    ///
+    /// @return The new raw (not encoded) master key.
+    /// @throws Error kUnauthenticated on unknown user, wrong credentials or a concurrent change.
+    std::string ChangeMasterKey(
+        const std::string& username,
+        std::string_view master_key,
+        std::uint32_t totp_code,
+        secure::Arena& arena
+    ) const;
+
+    /// @brief Deletes the user after checking the TOTP code.
+    ///
+    /// The user is only marked deleted and stops authenticating at once: their
+    /// opaque sessions are revoked on every instance, and this instance rejects
+    /// their JWTs before the deleted users cache is updated. Their passwords are
+    /// removed in the background by component-user-purge. The username is taken
+    /// until that is done.
+    ///
+    /// @throws Error kUnauthenticated on unknown user or wrong code.
+    void DeleteUser(const std::string& username, std::uint32_t totp_code) const;
+
+    /// @brief Forgets the users deleted through this instance, for tests that start over with the same user IDs.
+    void ResetDeletedUsers() const;
+
+    /// @brief Validates a session token.
+    ///
+    /// Opaque tokens are looked up in the session store, falling back to
+    /// Postgres for sessions the instance has not seen.
+    ///
+    /// @throws Error kUnauthenticated if the token is invalid or expired, or the user is deleted.
+    Session ValidateToken(const std::string& token) const;
+
+    /// @brief Revokes an opaque session on every instance.
+    /// @throws Error kInvalidArgument for JWT sessions, they cannot be revoked.
+    void Logout(const Session& session) const;
+
+    /// @brief Decrypts the data key carried by the session.
+    ///
+    /// For tokens issued before data keys were introduced the key is unwrapped
+    /// with the master key from the token, or the master key itself is returned
+    /// if the vault is not converted yet.
+    ///
+    /// @return A view of the key, valid for the lifetime of the arena.
+    std::string_view OpenDataKey(const Session& session, secure::Arena& arena) const;
+
+    /// @brief Returns the current vault version of the user, 0 for an unknown user.
+    ///
+    /// The version of a vault in the row cache is served without a query.
+    std::int64_t GetVaultVersion(std::int32_t user_id, userver::engine::Deadline deadline) const;
+
+    /// @brief Returns a counter that changes after every write of the vault made through this instance and every
+    /// change notification of it, without a query.
+    ///
+    /// Shared with other vaults, so it may also change without a write of this one. Reads that start with the same
+    /// value can share a result without missing a write their client has already seen completed.
+    std::uint64_t GetWriteGeneration(std::int32_t user_id) const;
+
+    /// @brief Returns a single password entry of the user and counts the read for frecency ordering.
+    ///
+    /// Served from the row cache if the vault is there, otherwise read from a replica.
+    ///
+    /// @throws Error kNotFound if there is no such entry.
+    models::Password GetPassword(std::int32_t user_id, std::int64_t password_id, userver::engine::Deadline deadline)
+        const;
+
+    /// @brief Returns the entries whose service contains the (lowercase) search term.
+    ///
+    /// The version and the rows come from the same snapshot, so the version
+    /// never runs ahead of the returned rows. Frecency reflects reads up to the
+    /// last flush of the usage counters, it is not covered by the version.
+    ///
+    /// A listing of the whole vault in ID order is served from the row cache,
+    /// and loads the vault into it from the primary on a miss. Searches and
+    /// frecency ordering are left to Postgres.
+    Vault ListPasswords(
+        std::int32_t user_id,
+        std::string_view search_term,
+        const ListOptions& options,
+        userver::engine::Deadline deadline
+    ) const;
+
+    /// @brief Returns the changes of the vault since the cursor of a previous sync.
+    ///
+    /// Every change of a vault bumps its version and stamps the entry, or the
+    /// tombstone of a deleted entry, with it, so the version doubles as the
+    /// change sequence. Tombstones are compacted after a retention period; a
+    /// cursor of 0 or one older than the newest compacted tombstone gets a full
+    /// sync instead. All of it is read from one snapshot.
+    ///
+    /// @throws Error kInvalidArgument on a negative cursor.
+    Changes GetChanges(std::int32_t user_id, std::int64_t cursor, userver::engine::Deadline deadline) const;
+
+    /// @brief Waits until the vault version moves past the cursor.
+    ///
+    /// The wait ends at the deadline or after the maximum wait of the hub,
+    /// whichever comes first. The caller is subscribed to notify::Hub before
+    /// the version is read from the primary, so a change committed around the
+    /// start of the wait is never missed.
+    ///
+    /// @throws Error kUnavailable if too many clients are waiting already.
+    ChangeWait WaitForChanges(std::int32_t user_id, std::int64_t cursor, userver::engine::Deadline deadline) const;
+
+    /// @brief Encrypts and stores a new entry.
+    ///
+    /// Breached passwords are stored too, the caller is only told about them.
+    ///
+    /// @param data_key The user's data key, see OpenDataKey().
+    /// @param totp_secret Base32 TOTP secret of the service, encrypted with the data key like the password.
+    /// @return The ID of the entry, the new vault version and the breach check result.
+    /// @throws Error kInvalidArgument on an empty or malformed TOTP secret.
+    CreatedPassword CreatePassword(
+        std::int32_t user_id,
+        std::string_view data_key,
+        const std::string& service,
+        const std::string& login,
+        const std::string& password,
+        const std::optional<std::string>& totp_secret,
+        userver::engine::Deadline deadline
+    ) const;
+
+    /// @brief Groups the entries of the user that share a password, by their fingerprints.
+    ///
+    /// Nothing is decrypted. Entries created before fingerprints were introduced
+    /// are only taken into account after the next login of the user.
+    std::vector<ReusedPassword> FindReusedPasswords(std::int32_t user_id, userver::engine::Deadline deadline) const;
+
+    /// @brief Checks every password of the user against the breach index.
+    /// @param data_key The user's data key, see OpenDataKey().
+    /// @throws Error kUnavailable if no breach index is configured.
+    BreachReport FindBreachedPasswords(
+        std::int32_t user_id,
+        std::string_view data_key,
+        secure::Arena& arena,
+        userver::engine::Deadline deadline
+    ) const;
+
+    /// @brief Computes the current TOTP codes of all entries of the user that have a TOTP secret.
+    ///
+    /// The secrets are decrypted into the arena and the codes are computed in
+    /// one batch, see totp::GenerateTotpCodes().
+    ///
+    /// @param data_key The user's data key, see OpenDataKey().
+    TotpCodes GetTotpCodes(
+        std::int32_t user_id,
+        std::string_view data_key,
+        secure::Arena& arena,
+        userver::engine::Deadline deadline
+    ) const;
+
+    /// @brief Deletes an entry of the user.
+    /// @return The new vault version.
+    /// @throws Error kNotFound if there is no such entry.
+    std::int64_t DeletePassword(std::int32_t user_id, std::int64_t password_id, userver::engine::Deadline deadline)
+        const;
+
+    /// @brief Decrypts the password of an entry with the user's data key.
+    /// @return A view of the plaintext, valid for the lifetime of the arena.
+    static std::string_view DecryptPassword(
+        const models::Password& password,
+        std::string_view data_key,
+        secure::Arena& arena
+    );
+
+private:
+    /// Default command control with the timeouts cut down to the time left until the deadline.
+    userver::storages::postgres::OptionalCommandControl MakeCommandControl(userver::engine::Deadline deadline) const;
+
+    /// Looks the user up in the cache, falling back to the database for users registered after the last update.
+    /// Deleted users are not found.
+    std::optional<models::User> FindUser(const std::string& username) const;
+
+    /// Deleted users are not found.
+    std::optional<models::User> GetUser(
+        const std::string& username,
+        userver::storages::postgres::ClusterHostType host_type
+    ) const;
+
+    Session ValidateJwt(const std::string& token) const;
+
+    /// Stores a new opaque session and returns its token.
+    std::string CreateSession(std::int32_t user_id, std::string data_key_encrypted) const;
+
+    Session FindSession(const std::string& token) const;
+
+    /// Reads the whole vault from a replica, or the primary if the replica is behind a known change, and caches it.
+    std::shared_ptr<const rowcache::CachedVault> LoadVault(std::int32_t user_id, userver::engine::Deadline deadline)
+        const;
+
+    /// Checks on the primary that the user exists and is not deleted.
+    bool IsUserActive(std::int32_t user_id) const;
+
+    static bool VerifyMasterKey(const models::User& user, std::string_view master_key);
+
+    /// Checks the code against the user's TOTP secret, decrypting it if it is stored encrypted.
+    bool VerifyTotp(const models::User& user, std::uint32_t totp_code) const;
+
+    /// Verifies the master key and the TOTP code of the user.
+    void CheckCredentials(const models::User& user, std::string_view master_key, std::uint32_t totp_code) const;
+
+    /// Returns the data key of the user, converting the vault if it does not have one yet.
+    std::string_view OpenVault(const models::User& user, std::string_view master_key, secure::Arena& arena) const;
+
+    /// Re-encrypts all passwords of the user from the master key to a fresh data key in one transaction.
+    std::string_view ConvertVault(std::int32_t user_id, std::string_view master_key, secure::Arena& arena) const;
+
+    /// Computes the missing fingerprints of the user's entries.
+    void BackfillFingerprints(std::int32_t user_id, std::string_view data_key, secure::Arena& arena) const;
+
+    userver::storages::postgres::ClusterPtr pg_cluster_;
+    const cache::UsersCache& users_cache_;
+    const cache::DeletedUsersCache& deleted_users_cache_;
+    const jwt::Client& jwt_client_;
+    const crypto::Keyring& keyring_;
+    usage::Counters& usage_counters_;
+    const breach::Checker& breach_checker_;
+    notify::Hub& change_hub_;
+    sessions::Store& session_store_;
+    rowcache::Cache& row_cache_;
+    hedge::Policy& hedge_policy_;
+
+    /// Users deleted through this instance, rejected before deleted_users_cache_ catches up with them.
+    /// One ID per deletion for the lifetime of the process, user IDs are only reused by the tests.
+    mutable userver::rcu::Variable<std::unordered_set<std::int32_t>> deleted_here_;
+};
+
+}  // namespace vault
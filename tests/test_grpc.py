@@ -0,0 +1,196 @@
+import importlib
+import os
+import sys
+import tempfile
+
+import grpc
+import psycopg2
+import pyotp
+import pytest
+import requests
+from grpc_tools import protoc
+
+GRPC_ADDRESS = "localhost:8081"
+
+PROTO_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "proto")
+
+DB_CONFIG = {
+    "dbname": "vaulty",
+    "user": "vaulty",
+    "password": "password",
+    "host": "localhost",
+    "port": 35432,
+}
+
+TRUNCATE_TABLES_SQL = """
+TRUNCATE TABLE passwords RESTART IDENTITY CASCADE;
+TRUNCATE TABLE users RESTART IDENTITY CASCADE;
+"""
+
+# ID пользователей начинаются заново после TRUNCATE, сервис должен забыть прежние хранилища и удалённых пользователей
+TESTS_CONTROL_URL = "http://localhost:8080/tests/control"
+RESET_CACHES = {"invalidate_caches": {"update_type": "full", "names": ["component-row-cache", "component-vault"]}}
+
+TEST_USER = "grpc_user"
+
+TEST_PASSWORDS = [
+    {"service": "eldom", "login": "kamila", "password": "123456"},
+    {"service": "docmed", "login": "kam-sai", "password": "987654"},
+]
+
+
+def load_stubs():
+    """Генерирует python-модули из proto-схемы сервиса."""
+    output_dir = tempfile.mkdtemp()
+    well_known_protos = os.path.join(os.path.dirname(protoc.__file__), "_proto")
+    result = protoc.main([
+        "grpc_tools.protoc",
+        f"-I{PROTO_DIR}",
+        f"-I{well_known_protos}",
+        f"--python_out={output_dir}",
+        f"--grpc_python_out={output_dir}",
+        "vaulty/v1/vaulty.proto",
+    ])
+    assert result == 0
+    sys.path.insert(0, output_dir)
+    return importlib.import_module("vaulty.v1.vaulty_pb2"), importlib.import_module("vaulty.v1.vaulty_pb2_grpc")
+
+
+vaulty_pb2, vaulty_pb2_grpc = load_stubs()
+
+
+@pytest.fixture(autouse=True)
+def clean_tables():
+    """Очищает таблицы после каждого теста."""
+    connection = psycopg2.connect(**DB_CONFIG)
+    cursor = connection.cursor()
+    cursor.execute(TRUNCATE_TABLES_SQL)
+    connection.commit()
+    cursor.close()
+    connection.close()
+
+    response = requests.post(TESTS_CONTROL_URL, json=RESET_CACHES)
+    assert response.status_code == 200, response.text
+
+
+@pytest.fixture
+def stub():
+    with grpc.insecure_channel(GRPC_ADDRESS) as channel:
+        yield vaulty_pb2_grpc.VaultServiceStub(channel)
+
+
+def register_and_login(stub, username=TEST_USER):
+    # Регистрация пользователя
+    registration = stub.Register(vaulty_pb2.RegisterRequest(username=username))
+    assert registration.master_key
+    assert registration.totp_secret
+
+    # Успешный логин
+    totp_code = int(pyotp.TOTP(registration.totp_secret).now())
+    response = stub.Authenticate(vaulty_pb2.AuthenticateRequest(
+        username=username, master_key=registration.master_key, totp_code=totp_code
+    ))
+    assert response.token
+
+    return registration, [("authorization", f"Bearer {response.token}")]
+
+
+def test_register_and_login(stub):
+    register_and_login(stub)
+
+
+def test_invalid_master_key(stub):
+    registration, _ = register_and_login(stub)
+
+    totp_code = int(pyotp.TOTP(registration.totp_secret).now())
+    with pytest.raises(grpc.RpcError) as error:
+        stub.Authenticate(vaulty_pb2.AuthenticateRequest(
+            username=TEST_USER, master_key=b"invalid_key", totp_code=totp_code
+        ))
+    assert error.value.code() == grpc.StatusCode.UNAUTHENTICATED
+    assert error.value.details() == "Invalid master key or TOTP code"
+
+
+def test_call_without_token(stub):
+    with pytest.raises(grpc.RpcError) as error:
+        stub.GetPassword(vaulty_pb2.GetPasswordRequest(id=1))
+    assert error.value.code() == grpc.StatusCode.UNAUTHENTICATED
+
+
+def test_create_get_list_and_delete_passwords(stub):
+    _, metadata = register_and_login(stub)
+
+    # Добавляем пароли, версия хранилища растет с каждой записью
+    versions = []
+    for password in TEST_PASSWORDS:
+        response = stub.CreatePassword(vaulty_pb2.CreatePasswordRequest(**password), metadata=metadata)
+        versions.append(response.vault_version)
+    assert versions == sorted(versions)
+
+    # Получаем все пароли потоком
+    listed = list(stub.ListPasswords(vaulty_pb2.ListPasswordsRequest(), metadata=metadata))
+    assert [(p.service, p.login, p.password) for p in listed] == [
+        (p["service"], p["login"], p["password"]) for p in TEST_PASSWORDS
+    ]
+    assert all(p.created_at.seconds > 0 for p in listed)
+
+    # Поиск по подстроке без учета регистра
+    found = list(stub.ListPasswords(vaulty_pb2.ListPasswordsRequest(search_term="DOC"), metadata=metadata))
+    assert [p.service for p in found] == ["docmed"]
+
+    # Получаем и удаляем конкретный пароль
+    password = stub.GetPassword(vaulty_pb2.GetPasswordRequest(id=listed[0].id), metadata=metadata)
+    assert password.password == TEST_PASSWORDS[0]["password"]
+
+    response = stub.DeletePassword(vaulty_pb2.DeletePasswordRequest(id=listed[0].id), metadata=metadata)
+    assert response.vault_version > versions[-1]
+
+    with pytest.raises(grpc.RpcError) as error:
+        stub.GetPassword(vaulty_pb2.GetPasswordRequest(id=listed[0].id), metadata=metadata)
+    assert error.value.code() == grpc.StatusCode.NOT_FOUND
+    assert error.value.details() == "Password not found"
+
+
+def test_password_isolation_between_users(stub):
+    _, owner_metadata = register_and_login(stub, "grpc_owner")
+    _, other_metadata = register_and_login(stub, "grpc_other")
+
+    stub.CreatePassword(vaulty_pb2.CreatePasswordRequest(**TEST_PASSWORDS[0]), metadata=owner_metadata)
+    [password] = stub.ListPasswords(vaulty_pb2.ListPasswordsRequest(), metadata=owner_metadata)
+
+    assert list(stub.ListPasswords(vaulty_pb2.ListPasswordsRequest(), metadata=other_metadata)) == []
+    with pytest.raises(grpc.RpcError) as error:
+        stub.GetPassword(vaulty_pb2.GetPasswordRequest(id=password.id), metadata=other_metadata)
+    assert error.value.code() == grpc.StatusCode.NOT_FOUND
+
+
+def test_delete_user(stub):
+    registration, metadata = register_and_login(stub)
+
+    totp_code = int(pyotp.TOTP(registration.totp_secret).now())
+    stub.DeleteUser(vaulty_pb2.DeleteUserRequest(username=TEST_USER, totp_code=totp_code))
+
+    with pytest.raises(grpc.RpcError) as error:
+        stub.Authenticate(vaulty_pb2.AuthenticateRequest(
+            username=TEST_USER, master_key=registration.master_key, totp_code=totp_code
+        ))
+    assert error.value.code() == grpc.StatusCode.UNAUTHENTICATED
+    assert error.value.details() == "Unknown user"
+
+
+def test_authenticate_rate_limited_per_username(stub):
+    # Перебор кодов для одного пользователя через gRPC упирается в тот же лимит, что и HTTP
+    request = vaulty_pb2.AuthenticateRequest(username="grpc_brute_force_target", master_key=b"key", totp_code=123456)
+    codes = []
+    for _ in range(30):
+        with pytest.raises(grpc.RpcError) as error:
+            stub.Authenticate(request)
+        codes.append(error.value.code())
+    assert codes[0] == grpc.StatusCode.UNAUTHENTICATED
+    assert grpc.StatusCode.RESOURCE_EXHAUSTED in codes
+    assert set(codes) <= {grpc.StatusCode.UNAUTHENTICATED, grpc.StatusCode.RESOURCE_EXHAUSTED}
+
+    with pytest.raises(grpc.RpcError) as error:
+        stub.Authenticate(request)
+    assert error.value.code() == grpc.StatusCode.RESOURCE_EXHAUSTED
+    assert error.value.details() == "Too many requests"
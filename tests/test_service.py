@@ -1,10 +1,18 @@
+import base64
+import concurrent.futures
+import os
 import pytest
 import psycopg2
 import pyotp
 import requests
+import time
+from cryptography.hazmat.primitives.ciphers.aead import AESGCM
 
 BASE_URL = "http://localhost:8080/api/v1"
 
+# Режим сессий запущенного сервиса: jwt по умолчанию, opaque с configs/config_vars.testing.yaml
+SESSION_MODE = os.environ.get("VAULTY_SESSION_MODE", "jwt")
+
 DB_CONFIG = {
     "dbname": "vaulty",
     "user": "vaulty",
@@ -16,8 +24,13 @@ DB_CONFIG = {
 TRUNCATE_TABLES_SQL = """
 TRUNCATE TABLE passwords RESTART IDENTITY CASCADE;
 TRUNCATE TABLE users RESTART IDENTITY CASCADE;
+TRUNCATE TABLE audit_events;
 """
 
+# ID пользователей начинаются заново после TRUNCATE, сервис должен забыть прежние хранилища и удалённых пользователей
+TESTS_CONTROL_URL = "http://localhost:8080/tests/control"
+RESET_CACHES = {"invalidate_caches": {"update_type": "full", "names": ["component-row-cache", "component-vault"]}}
+
 USERS = [
     {"username": "svinokrys2000"},
     {"username": "tech_master"},
@@ -44,6 +57,9 @@ def clean_tables():
     cursor.close()
     connection.close()
 
+    response = requests.post(TESTS_CONTROL_URL, json=RESET_CACHES)
+    assert response.status_code == 200, response.text
+
 
 @pytest.fixture
 def users():
@@ -115,6 +131,50 @@ def multiple_user_registration_and_login(users):
 def test_user_registration_and_login(test_user):
     user_registration_and_login(test_user)
 
+@pytest.mark.skipif(SESSION_MODE != "opaque", reason="сервис запущен без opaque-сессий")
+def test_logout(test_user):
+    master_key, totp_secret, token = user_registration_and_login(test_user)
+    headers = {"Authorization": f"Bearer {token}"}
+
+    # В режиме opaque токен не является JWT
+    assert "." not in token
+
+    response = requests.get(f"{BASE_URL}/passwords", headers=headers)
+    assert response.status_code == 200
+
+    response = requests.delete(f"{BASE_URL}/auth", headers=headers)
+    assert response.status_code == 200
+    assert response.json()["message"] == "Logged out successfully"
+
+    # Отозванная сессия сразу перестаёт работать
+    response = requests.get(f"{BASE_URL}/passwords", headers=headers)
+    assert response.status_code == 401
+
+    response = requests.delete(f"{BASE_URL}/auth", headers=headers)
+    assert response.status_code == 401
+
+
+def test_forged_session_tokens():
+    # Токены неверного формата и неизвестные токены отклоняются одинаково
+    for token in ["garbage", "a" * 43, "a" * 42 + "!", "b" * 44]:
+        response = requests.get(f"{BASE_URL}/passwords", headers={"Authorization": f"Bearer {token}"})
+        assert response.status_code == 401
+        assert response.json()["message"] == "Invalid or expired session"
+
+
+@pytest.mark.skipif(SESSION_MODE != "jwt", reason="сервис запущен с opaque-сессиями")
+def test_logout_jwt(test_user):
+    master_key, totp_secret, token = user_registration_and_login(test_user)
+    headers = {"Authorization": f"Bearer {token}"}
+
+    # JWT нельзя отозвать
+    assert "." in token
+    response = requests.delete(f"{BASE_URL}/auth", headers=headers)
+    assert response.status_code == 400
+
+    response = requests.get(f"{BASE_URL}/passwords", headers=headers)
+    assert response.status_code == 200
+
 def test_user_delete(test_user):
     # Регистрация и логин
     master_key, totp_secret, token = user_registration_and_login(test_user)
@@ -127,19 +187,12 @@ def test_user_delete(test_user):
     data = response.json()
     assert data["message"] == "User deleted successfully"
 
+    # Сессии удалённого пользователя сразу перестают работать
     response = requests.get(
         f"{BASE_URL}/passwords",
         headers={"Authorization": f"Bearer {token}"},
     )
-
-    # Получаем список всех паролей
-    response = requests.get(
-        f"{BASE_URL}/passwords",
-        headers={"Authorization": f"Bearer {token}"},
-    )
-    assert response.status_code == 200
-    passwords_data = response.json()
-    assert len(passwords_data) == 0
+    assert response.status_code == 401
 
     # Пытаемся залогиниться
     login_payload = {**test_user, "master_key": master_key, "totp_code": totp_code}
@@ -148,6 +201,69 @@ def test_user_delete(test_user):
     login_data = response.json()
     login_data["message"] = "Unknown user"
 
+def test_user_delete_purges_passwords(test_user, test_passwords):
+    master_key, totp_secret, token = user_registration_and_login(test_user)
+    headers = {"Authorization": f"Bearer {token}"}
+    for password in test_passwords:
+        response = requests.post(f"{BASE_URL}/password", headers=headers, json=password)
+        assert response.status_code == 200
+
+    payload = {**test_user, "totp_code": pyotp.TOTP(totp_secret).now()}
+    response = requests.delete(f"{BASE_URL}/user", json=payload)
+    assert response.status_code == 200
+
+    # Логин запрещён сразу, ещё до того как строки удалены
+    login_payload = {**test_user, "master_key": master_key, "totp_code": pyotp.TOTP(totp_secret).now()}
+    response = requests.post(f"{BASE_URL}/auth", json=login_payload)
+    assert response.status_code == 401
+
+    # Строки удаляются фоновым компонентом, затем удаляется и сам пользователь
+    connection = psycopg2.connect(**DB_CONFIG)
+    connection.autocommit = True
+    cursor = connection.cursor()
+    deadline = time.time() + 30
+    while True:
+        cursor.execute("SELECT COUNT(*) FROM users WHERE username = %s", (test_user["username"],))
+        (users_left,) = cursor.fetchone()
+        if users_left == 0 or time.time() > deadline:
+            break
+        time.sleep(0.5)
+    cursor.execute("SELECT COUNT(*) FROM passwords")
+    (passwords_left,) = cursor.fetchone()
+    cursor.close()
+    connection.close()
+    assert users_left == 0
+    assert passwords_left == 0
+
+    # Имя освобождается после очистки
+    response = requests.post(f"{BASE_URL}/user", json=test_user)
+    assert response.status_code == 200
+
+
+def test_create_password_after_user_delete(test_user, test_passwords):
+    master_key, totp_secret, token = user_registration_and_login(test_user)
+    headers = {"Authorization": f"Bearer {token}"}
+
+    payload = {**test_user, "totp_code": pyotp.TOTP(totp_secret).now()}
+    response = requests.delete(f"{BASE_URL}/user", json=payload)
+    assert response.status_code == 200
+
+    # Сессия ещё может быть в кэше, но запись в удалённое хранилище не выполняется
+    response = requests.post(f"{BASE_URL}/password", headers=headers, json=test_passwords[0])
+    assert response.status_code == 401
+    assert response.json()["message"] == "User deleted"
+
+    connection = psycopg2.connect(**DB_CONFIG)
+    cursor = connection.cursor()
+    cursor.execute(
+        "SELECT COUNT(*) FROM passwords p JOIN users u ON u.id = p.user_id WHERE u.username = %s",
+        (test_user["username"],),
+    )
+    assert cursor.fetchone()[0] == 0
+    cursor.close()
+    connection.close()
+
+
 def test_user_delete_invalid_totp_code(test_user):
     # Регистрация и логин
     master_key, totp_secret, token = user_registration_and_login(test_user)
@@ -192,6 +308,272 @@ def test_invalid_totp_code(test_user):
     assert data["message"] == "Invalid master key or TOTP code"
 
 
+def test_change_master_key(test_user, test_passwords):
+    # Регистрация, логин и пароль, зашифрованный ключом данных
+    master_key, totp_secret, token = user_registration_and_login(test_user)
+    response = requests.post(
+        f"{BASE_URL}/password",
+        headers={"Authorization": f"Bearer {token}"},
+        json=test_passwords[0],
+    )
+    assert response.status_code == 200
+
+    # Меняем мастер-ключ
+    totp_code = pyotp.TOTP(totp_secret).now()
+    payload = {**test_user, "master_key": master_key, "totp_code": totp_code}
+    response = requests.post(f"{BASE_URL}/user/master-key", json=payload)
+    assert response.status_code == 200
+    new_master_key = response.json()["master_key"]
+    assert new_master_key != master_key
+
+    # Старый мастер-ключ больше не подходит, как только кэш пользователей обновится
+    time.sleep(2)
+    response = requests.post(f"{BASE_URL}/auth", json=payload)
+    assert response.status_code == 401
+
+    # Новый мастер-ключ открывает те же пароли, старая сессия тоже продолжает работать
+    response = requests.post(f"{BASE_URL}/auth", json={**payload, "master_key": new_master_key})
+    assert response.status_code == 200
+    for session in (response.json()["token"], token):
+        response = requests.get(f"{BASE_URL}/passwords", headers={"Authorization": f"Bearer {session}"})
+        assert response.status_code == 200
+        assert [p["password"] for p in response.json()] == [test_passwords[0]["password"]]
+
+
+def test_password_access_is_audited(test_user, test_passwords):
+    master_key, totp_secret, token = user_registration_and_login(test_user)
+    headers = {"Authorization": f"Bearer {token}"}
+
+    response = requests.post(f"{BASE_URL}/password", headers=headers, json=test_passwords[0])
+    assert response.status_code == 200
+    password_id = requests.get(f"{BASE_URL}/passwords", headers=headers).json()[0]["id"]
+    assert requests.get(f"{BASE_URL}/password/{password_id}", headers=headers).status_code == 200
+    assert requests.delete(f"{BASE_URL}/password/{password_id}", headers=headers).status_code == 200
+
+    # События пишутся в базу асинхронно, пачками раз в секунду
+    expected = [("create", password_id), ("list", None), ("read", password_id), ("delete", password_id)]
+    events = []
+    for _ in range(50):
+        connection = psycopg2.connect(**DB_CONFIG)
+        cursor = connection.cursor()
+        cursor.execute("SELECT action, password_id FROM audit_events ORDER BY created_at")
+        events = cursor.fetchall()
+        connection.close()
+        if len(events) >= len(expected):
+            break
+        time.sleep(0.1)
+    assert events == expected
+
+
+def test_get_passwords_by_frecency(test_user, test_passwords):
+    master_key, totp_secret, token = user_registration_and_login(test_user)
+    headers = {"Authorization": f"Bearer {token}"}
+
+    for password in test_passwords:
+        assert requests.post(f"{BASE_URL}/password", headers=headers, json=password).status_code == 200
+    passwords = requests.get(f"{BASE_URL}/passwords", headers=headers).json()
+    assert [p["service"] for p in passwords] == [p["service"] for p in test_passwords]
+
+    # Последний добавленный пароль читают чаще остальных
+    last_id = passwords[-1]["id"]
+    for _ in range(3):
+        assert requests.get(f"{BASE_URL}/password/{last_id}", headers=headers).status_code == 200
+
+    # Счётчики чтений сбрасываются в базу раз в секунду
+    for _ in range(50):
+        response = requests.get(f"{BASE_URL}/passwords?order=frecency&limit=1", headers=headers)
+        assert response.status_code == 200
+        if response.json()[0]["id"] == last_id:
+            break
+        time.sleep(0.1)
+    assert [p["id"] for p in response.json()] == [last_id]
+    assert "ETag" not in response.headers
+
+    response = requests.get(f"{BASE_URL}/passwords?order=popular", headers=headers)
+    assert response.status_code == 400
+    response = requests.get(f"{BASE_URL}/passwords?limit=0", headers=headers)
+    assert response.status_code == 400
+
+
+def test_breached_passwords(test_user, test_passwords):
+    master_key, totp_secret, token = user_registration_and_login(test_user)
+    headers = {"Authorization": f"Bearer {token}"}
+
+    for password in test_passwords:
+        response = requests.post(f"{BASE_URL}/password", headers=headers, json=password)
+        assert response.status_code == 200
+        assert isinstance(response.json()["breached"], bool)
+
+    response = requests.get(f"{BASE_URL}/passwords/breached", headers=headers)
+    if response.status_code == 503:
+        pytest.skip("Индекс утёкших паролей не настроен")
+    assert response.status_code == 200
+    data = response.json()
+    assert data["checked"] == len(test_passwords)
+    # Сами пароли в ответ не попадают
+    for entry in data["breached"]:
+        assert set(entry) == {"id", "service", "login"}
+
+
+def test_reused_passwords(test_user):
+    master_key, totp_secret, token = user_registration_and_login(test_user)
+    headers = {"Authorization": f"Bearer {token}"}
+
+    entries = [
+        {"service": "eldom", "login": "kamila", "password": "same-secret"},
+        {"service": "docmed", "login": "kam-sai", "password": "unique-secret"},
+        {"service": "gitlab", "login": "kamila", "password": "same-secret"},
+    ]
+    reused_in = []
+    for entry in entries:
+        response = requests.post(f"{BASE_URL}/password", headers=headers, json=entry)
+        assert response.status_code == 200
+        reused_in.append(response.json()["reused_in"])
+    # При добавлении сообщается, где этот пароль уже используется
+    assert reused_in == [[], [], ["eldom"]]
+
+    response = requests.get(f"{BASE_URL}/passwords/reused", headers=headers)
+    assert response.status_code == 200
+    groups = response.json()["reused"]
+    assert len(groups) == 1
+    assert [(e["service"], e["login"]) for e in groups[0]] == [("eldom", "kamila"), ("gitlab", "kamila")]
+
+
+def test_totp_codes(test_user):
+    master_key, totp_secret, token = user_registration_and_login(test_user)
+    headers = {"Authorization": f"Bearer {token}"}
+
+    secrets = [pyotp.random_base32() for _ in range(10)]
+    for i, secret in enumerate(secrets):
+        entry = {"service": f"service-{i}", "login": "kamila", "password": "123456", "totp_secret": secret}
+        response = requests.post(f"{BASE_URL}/password", headers=headers, json=entry)
+        assert response.status_code == 200
+    # Записи без секрета в ответ не попадают
+    response = requests.post(
+        f"{BASE_URL}/password", headers=headers, json={"service": "plain", "login": "kamila", "password": "123456"}
+    )
+    assert response.status_code == 200
+
+    before = time.time()
+    response = requests.get(f"{BASE_URL}/passwords/totp", headers=headers)
+    after = time.time()
+    assert response.status_code == 200
+    data = response.json()
+    assert data["period"] == 30
+    assert 0 < data["expires_in"] <= 30
+    assert [entry["service"] for entry in data["codes"]] == [f"service-{i}" for i in range(len(secrets))]
+    for entry, secret in zip(data["codes"], secrets):
+        # Запрос мог попасть на смену периода
+        totp = pyotp.TOTP(secret)
+        assert entry["code"] in {totp.at(before), totp.at(after)}
+
+    # Невалидный секрет отклоняется
+    entry = {"service": "broken", "login": "kamila", "password": "123456", "totp_secret": "not base32!"}
+    response = requests.post(f"{BASE_URL}/password", headers=headers, json=entry)
+    assert response.status_code == 400
+
+
+def test_password_changes(test_user, test_passwords):
+    master_key, totp_secret, token = user_registration_and_login(test_user)
+    headers = {"Authorization": f"Bearer {token}"}
+
+    for password in test_passwords[:2]:
+        assert requests.post(f"{BASE_URL}/password", headers=headers, json=password).status_code == 200
+
+    # Первая синхронизация отдаёт всё хранилище
+    response = requests.get(f"{BASE_URL}/passwords/changes", headers=headers)
+    assert response.status_code == 200
+    data = response.json()
+    assert data["full"] is True
+    assert [p["service"] for p in data["changed"]] == [p["service"] for p in test_passwords[:2]]
+    assert data["deleted"] == []
+    cursor = data["cursor"]
+    first_id = data["changed"][0]["id"]
+
+    # Дальше приходят только изменения: новая запись и удалённая
+    assert requests.post(f"{BASE_URL}/password", headers=headers, json=test_passwords[2]).status_code == 200
+    assert requests.delete(f"{BASE_URL}/password/{first_id}", headers=headers).status_code == 200
+
+    response = requests.get(f"{BASE_URL}/passwords/changes?since={cursor}", headers=headers)
+    assert response.status_code == 200
+    data = response.json()
+    assert data["full"] is False
+    assert [p["service"] for p in data["changed"]] == [test_passwords[2]["service"]]
+    assert data["changed"][0]["password"] == test_passwords[2]["password"]
+    assert data["deleted"] == [first_id]
+    assert data["cursor"] > cursor
+
+    # Без изменений ответ пустой, курсор прежний
+    response = requests.get(f"{BASE_URL}/passwords/changes?since={data['cursor']}", headers=headers)
+    assert response.json() == {"cursor": data["cursor"], "full": False, "changed": [], "deleted": []}
+
+    response = requests.get(f"{BASE_URL}/passwords/changes?since=-1", headers=headers)
+    assert response.status_code == 400
+
+
+def test_wait_for_password_changes(test_user, test_passwords):
+    master_key, totp_secret, token = user_registration_and_login(test_user)
+    headers = {"Authorization": f"Bearer {token}"}
+    cursor = requests.get(f"{BASE_URL}/passwords/changes", headers=headers).json()["cursor"]
+
+    # Без изменений ожидание заканчивается по таймауту клиента
+    response = requests.get(
+        f"{BASE_URL}/passwords/changes/wait?since={cursor}",
+        headers={**headers, "X-Request-Timeout-Ms": "300"},
+    )
+    assert response.status_code == 200
+    assert response.json() == {"cursor": cursor, "changed": False}
+
+    # Изменение будит ожидающего клиента
+    with concurrent.futures.ThreadPoolExecutor(max_workers=1) as executor:
+        waiting = executor.submit(
+            requests.get, f"{BASE_URL}/passwords/changes/wait?since={cursor}", headers=headers, timeout=10
+        )
+        time.sleep(0.3)
+        started = time.monotonic()
+        assert requests.post(f"{BASE_URL}/password", headers=headers, json=test_passwords[0]).status_code == 200
+        response = waiting.result()
+        assert time.monotonic() - started < 1
+
+    assert response.status_code == 200
+    data = response.json()
+    assert data["changed"] is True
+    assert data["cursor"] > cursor
+
+    changes = requests.get(f"{BASE_URL}/passwords/changes?since={cursor}", headers=headers).json()
+    assert [p["service"] for p in changes["changed"]] == [test_passwords[0]["service"]]
+
+
+def test_request_timeout_header(test_user, test_passwords):
+    master_key, totp_secret, token = user_registration_and_login(test_user)
+    headers = {"Authorization": f"Bearer {token}"}
+
+    for password in test_passwords:
+        assert requests.post(f"{BASE_URL}/password", headers=headers, json=password).status_code == 200
+
+    # Запас времени клиента укладывается в лимит обработчика
+    response = requests.get(f"{BASE_URL}/passwords", headers={**headers, "X-Request-Timeout-Ms": "5000"})
+    assert response.status_code == 200
+    assert len(response.json()) == len(test_passwords)
+
+    for value in ["abc", "0", "-1"]:
+        response = requests.get(f"{BASE_URL}/passwords", headers={**headers, "X-Request-Timeout-Ms": value})
+        assert response.status_code == 400
+
+
+def test_auth_rate_limited_per_username():
+    # Перебор кодов для одного пользователя упирается в лимит до обращения к базе
+    payload = {"username": "brute_force_target", "master_key": "a2V5", "totp_code": "123456"}
+    statuses = [requests.post(f"{BASE_URL}/auth", json=payload).status_code for _ in range(30)]
+    assert statuses[0] == 401
+    assert 429 in statuses
+    assert set(statuses) <= {401, 429}
+
+    response = requests.post(f"{BASE_URL}/auth", json=payload)
+    assert response.status_code == 429
+    assert response.json()["message"] == "Too many requests"
+
+
 def test_add_password_with_invalid_jwt(invalid_jwt, test_passwords):
     # Добавляем пароль с неверным JWT
     response = requests.post(
@@ -234,6 +616,76 @@ def test_add_and_get_passwords(test_user, test_passwords):
             for p in passwords_data
         )
 
+def test_get_passwords_not_modified(test_user, test_passwords):
+    # Регистрация и логин
+    master_key, totp_secret, token = user_registration_and_login(test_user)
+    headers = {"Authorization": f"Bearer {token}"}
+
+    response = requests.post(f"{BASE_URL}/password", headers=headers, json=test_passwords[0])
+    assert response.status_code == 200
+
+    # Первый запрос возвращает ETag
+    response = requests.get(f"{BASE_URL}/passwords", headers=headers)
+    assert response.status_code == 200
+    etag = response.headers["ETag"]
+    assert etag.startswith('W/"')
+    assert len(response.json()) == 1
+
+    # Хранилище не изменилось
+    response = requests.get(f"{BASE_URL}/passwords", headers={**headers, "If-None-Match": etag})
+    assert response.status_code == 304
+    assert response.headers["ETag"] == etag
+    assert response.content == b""
+
+    # If-None-Match сравнивается слабо, тег без W/ тоже совпадает
+    response = requests.get(f"{BASE_URL}/passwords", headers={**headers, "If-None-Match": etag[2:]})
+    assert response.status_code == 304
+
+    # После добавления пароля ETag меняется
+    response = requests.post(f"{BASE_URL}/password", headers=headers, json=test_passwords[1])
+    assert response.status_code == 200
+
+    response = requests.get(f"{BASE_URL}/passwords", headers={**headers, "If-None-Match": etag})
+    assert response.status_code == 200
+    assert response.headers["ETag"] != etag
+    assert len(response.json()) == 2
+
+    # После удаления пароля ETag тоже меняется
+    etag = response.headers["ETag"]
+    response = requests.delete(f"{BASE_URL}/password/1", headers=headers)
+    assert response.status_code == 200
+
+    response = requests.get(f"{BASE_URL}/passwords", headers={**headers, "If-None-Match": etag})
+    assert response.status_code == 200
+    assert response.headers["ETag"] != etag
+    assert len(response.json()) == 1
+
+def test_get_passwords_compressed(test_user):
+    # Регистрация и логин
+    master_key, totp_secret, token = user_registration_and_login(test_user)
+    headers = {"Authorization": f"Bearer {token}"}
+
+    # Добавляем достаточно паролей, чтобы ответ превысил порог сжатия
+    for i in range(20):
+        password = {"service": f"service-{i}", "login": f"login-{i}", "password": f"password-{i}"}
+        response = requests.post(f"{BASE_URL}/password", headers=headers, json=password)
+        assert response.status_code == 200
+
+    response = requests.get(f"{BASE_URL}/passwords", headers={**headers, "Accept-Encoding": "gzip"})
+    assert response.status_code == 200
+    assert response.headers["Content-Encoding"] == "gzip"
+    assert "Accept-Encoding" in response.headers["Vary"]
+    assert len(response.json()) == 20
+    # Тело зависит от кодировки, поэтому ETag слабый
+    etag = response.headers["ETag"]
+    assert etag.startswith('W/"')
+
+    response = requests.get(f"{BASE_URL}/passwords", headers={**headers, "Accept-Encoding": "identity"})
+    assert response.status_code == 200
+    assert "Content-Encoding" not in response.headers
+    assert response.headers["ETag"] == etag
+    assert len(response.json()) == 20
+
 def test_delete_specific_password(test_user, test_passwords):
     # Регистрация и логин
     master_key, totp_secret, token = user_registration_and_login(test_user)
@@ -536,3 +988,140 @@ def test_access_other_users_passwords(users, passwords_for_users):
             p["service"] == password["service"] and p["login"] == password["login"] and p["password"] == password["password"]
             for p in data
         )
+
+
+def test_row_cache_sees_changes_of_other_instances(test_user, test_passwords):
+    master_key, totp_secret, token = user_registration_and_login(test_user)
+    headers = {"Authorization": f"Bearer {token}"}
+
+    for password in test_passwords:
+        response = requests.post(f"{BASE_URL}/password", headers=headers, json=password)
+        assert response.status_code == 200
+
+    # Первое чтение загружает хранилище в кэш, повторные обслуживаются из него
+    for _ in range(2):
+        response = requests.get(f"{BASE_URL}/passwords", headers=headers)
+        assert response.status_code == 200
+        assert len(response.json()) == len(test_passwords)
+    removed_id = response.json()[0]["id"]
+
+    # Изменение в обход сервиса, как его сделал бы другой экземпляр: уведомление об изменении сбрасывает кэш
+    connection = psycopg2.connect(**DB_CONFIG)
+    cursor = connection.cursor()
+    cursor.execute("DELETE FROM passwords WHERE id = %s RETURNING user_id", (removed_id,))
+    user_id = cursor.fetchone()[0]
+    cursor.execute("UPDATE users SET vault_version = vault_version + 1 WHERE id = %s", (user_id,))
+    connection.commit()
+    cursor.close()
+    connection.close()
+
+    deadline = time.time() + 5
+    while True:
+        response = requests.get(f"{BASE_URL}/passwords", headers=headers)
+        assert response.status_code == 200
+        if len(response.json()) == len(test_passwords) - 1 or time.time() > deadline:
+            break
+        time.sleep(0.1)
+    assert len(response.json()) == len(test_passwords) - 1
+    assert removed_id not in [p["id"] for p in response.json()]
+
+    response = requests.get(f"{BASE_URL}/password/{removed_id}", headers=headers)
+    assert response.status_code == 404
+
+
+def test_concurrent_identical_listings(users, passwords_for_users):
+    registered = multiple_user_registration_and_login(users)
+    tokens = {}
+    for user in registered:
+        totp_code = pyotp.TOTP(user["totp_secret"]).now()
+        response = requests.post(
+            f"{BASE_URL}/auth",
+            json={"username": user["username"], "master_key": user["master_key"], "totp_code": totp_code},
+        )
+        assert response.status_code == 200
+        tokens[user["username"]] = response.json()["token"]
+        for password in passwords_for_users[user["username"]]:
+            response = requests.post(
+                f"{BASE_URL}/password",
+                headers={"Authorization": f"Bearer {tokens[user['username']]}"},
+                json=password,
+            )
+            assert response.status_code == 200
+
+    # Одинаковые одновременные запросы разных пользователей получают только свои пароли
+    requests_to_send = [username for username in tokens for _ in range(8)]
+    with concurrent.futures.ThreadPoolExecutor(max_workers=len(requests_to_send)) as executor:
+        responses = list(executor.map(
+            lambda username: (
+                username,
+                requests.get(f"{BASE_URL}/passwords", headers={"Authorization": f"Bearer {tokens[username]}"}),
+            ),
+            requests_to_send,
+        ))
+
+    for username, response in responses:
+        assert response.status_code == 200
+        expected = {(p["service"], p["login"], p["password"]) for p in passwords_for_users[username]}
+        assert {(p["service"], p["login"], p["password"]) for p in response.json()} == expected
+
+
+def test_listing_after_write_under_concurrency(test_user):
+    master_key, totp_secret, token = user_registration_and_login(test_user)
+    headers = {"Authorization": f"Bearer {token}"}
+    stop = time.time() + 3
+
+    def poll():
+        # Постоянный поток одинаковых запросов, к которым могут присоединяться запросы после записи
+        while time.time() < stop:
+            assert requests.get(f"{BASE_URL}/passwords", headers=headers).status_code == 200
+
+    with concurrent.futures.ThreadPoolExecutor(max_workers=8) as executor:
+        pollers = [executor.submit(poll) for _ in range(7)]
+
+        # Список сразу после записи всегда содержит её
+        created = []
+        while time.time() < stop:
+            password = {"service": f"service-{len(created)}", "login": "login", "password": "password"}
+            response = requests.post(f"{BASE_URL}/password", headers=headers, json=password)
+            assert response.status_code == 200
+            created.append(password["service"])
+
+            response = requests.get(f"{BASE_URL}/passwords", headers=headers)
+            assert response.status_code == 200
+            assert [p["service"] for p in response.json()] == created
+
+        for poller in pollers:
+            poller.result()
+
+
+def test_list_right_after_vault_conversion(test_user):
+    master_key, totp_secret, token = user_registration_and_login(test_user)
+
+    # Хранилище в старом формате: пароль зашифрован мастер-ключом, ключа данных нет
+    iv = os.urandom(12)
+    password_encrypted = base64.b64encode(iv + AESGCM(base64.b64decode(master_key)).encrypt(iv, b"legacy", None))
+    connection = psycopg2.connect(**DB_CONFIG)
+    cursor = connection.cursor()
+    cursor.execute("SELECT id FROM users WHERE username = %s", (test_user["username"],))
+    user_id = cursor.fetchone()[0]
+    cursor.execute("UPDATE users SET data_key_wrapped = NULL WHERE id = %s", (user_id,))
+    cursor.execute(
+        "INSERT INTO passwords (user_id, service, login, password_encrypted) VALUES (%s, 'old', 'login', %s)",
+        (user_id, password_encrypted.decode()),
+    )
+    connection.commit()
+    cursor.close()
+    connection.close()
+
+    # Список заполняет кэш строк шифротекстом под мастер-ключом
+    requests.get(f"{BASE_URL}/passwords", headers={"Authorization": f"Bearer {token}"})
+
+    # Логин переводит хранилище на ключ данных, список сразу после него видит новые строки
+    login_payload = {**test_user, "master_key": master_key, "totp_code": pyotp.TOTP(totp_secret).now()}
+    response = requests.post(f"{BASE_URL}/auth", json=login_payload)
+    assert response.status_code == 200
+    token = response.json()["token"]
+
+    response = requests.get(f"{BASE_URL}/passwords", headers={"Authorization": f"Bearer {token}"})
+    assert response.status_code == 200
+    assert [(p["service"], p["password"]) for p in response.json()] == [("old", "legacy")]